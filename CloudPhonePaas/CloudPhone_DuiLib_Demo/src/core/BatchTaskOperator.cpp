@@ -298,7 +298,8 @@ void BatchTaskOperator::clearAppInstallBlackList(const std::vector<std::string>&
     executeNoParamTask("ClearAppInstallBlackList", instanceIds);
 }
 
-std::string BatchTaskOperator::getInstanceImage(const std::string& instanceId, int quality) {
+std::string BatchTaskOperator::getInstanceImage(const std::string& instanceId, int quality,
+                                                int width, int height) {
     constexpr int BUFFER_SIZE = 4096;
     std::vector<char> buffer(BUFFER_SIZE, 0);
 
@@ -310,7 +311,7 @@ std::string BatchTaskOperator::getInstanceImage(const std::string& instanceId, i
     }
 
     if (tcr_instance_get_image(tcrOperator, buffer.data(), BUFFER_SIZE,
-                               instanceId.c_str(), 0, 0, quality)) {
+                               instanceId.c_str(), width, height, quality)) {
         return std::string(buffer.data());
     }
     return {};
@@ -154,8 +154,9 @@ public:
     void describeAppInstallBlackList(const std::vector<std::string>& instanceIds);
     void clearAppInstallBlackList(const std::vector<std::string>& instanceIds);
 
-    // Get instance screenshot URL
-    std::string getInstanceImage(const std::string& instanceId, int quality = 20);
+    // Get instance screenshot URL (width/height <= 0 request the server's default resolution)
+    std::string getInstanceImage(const std::string& instanceId, int quality = 20, int width = 0,
+                                 int height = 0);
 
 private:
     BatchResult parseBatchResult(const std::string& jsonData);
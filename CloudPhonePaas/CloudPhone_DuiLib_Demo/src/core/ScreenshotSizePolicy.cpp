@@ -0,0 +1,38 @@
+#include "ScreenshotSizePolicy.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace {
+
+struct Bucket {
+    int width;
+    int quality;
+};
+
+// Portrait 9:16 buckets, smallest first
+const Bucket kBuckets[] = {
+    {144, 50}, {216, 50}, {288, 55}, {432, 60}, {576, 65}, {720, 70},
+};
+
+}  // namespace
+
+ScreenshotSizePolicy::Spec ScreenshotSizePolicy::forTile(double tileWidth, double tileHeight,
+                                                         double devicePixelRatio) {
+    // Width needed to cover the tile with a 9:16 image, in physical pixels
+    double needed = std::max(tileWidth, tileHeight * 9.0 / 16.0) * std::max(devicePixelRatio, 1.0);
+
+    const Bucket* bucket = &kBuckets[std::size(kBuckets) - 1];
+    for (const Bucket& b : kBuckets) {
+        if (b.width >= needed) {
+            bucket = &b;
+            break;
+        }
+    }
+
+    Spec spec;
+    spec.width = bucket->width;
+    spec.height = bucket->width * 16 / 9;
+    spec.quality = bucket->quality;
+    return spec;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+/**
+ * @brief Picks width/height/quality for tcr_instance_get_image from the tile size.
+ *
+ * Screenshots are portrait 9:16. The physical pixel width needed to cover the
+ * tile is rounded up to one of a few fixed buckets (144/216/288/432/576/720
+ * wide) so repeated requests hit the same CDN-cached variant; quality rises
+ * with the bucket since small thumbnails hide JPEG artifacts.
+ */
+class ScreenshotSizePolicy {
+public:
+    struct Spec {
+        int width = 0;
+        int height = 0;
+        int quality = 20;
+
+        bool operator==(const Spec& other) const {
+            return width == other.width && height == other.height && quality == other.quality;
+        }
+        bool operator!=(const Spec& other) const { return !(*this == other); }
+    };
+
+    /// tileWidth/tileHeight are logical pixels; devicePixelRatio converts to physical pixels
+    static Spec forTile(double tileWidth, double tileHeight, double devicePixelRatio = 1.0);
+};
@@ -15,6 +15,7 @@
 #include "services/ApiService.h"
 #include "services/NetworkService.h"
 #include "utils/CrashDumpHandler.h"
+#include "utils/ImageFetch.h"
 #include "utils/Logger.h"
 #include "core/BatchTaskOperator.h"
 #include "viewmodels/AndroidInstanceModel.h"
@@ -41,42 +42,48 @@ int WINAPI WinMain(_In_ HINSTANCE hInstance,
     curl_global_init(CURL_GLOBAL_ALL);
     Logger::info("libcurl initialized");
 
-    // Create service layer
-    NetworkService networkService;
-    networkService.setRequestHost("ap-shenzhen");
-    networkService.setOrigin("https://mouhong.test-cai-experience.crtrcloud.com");
-    ApiService apiService(&networkService);
-
-    // Create batch operator and instance model
-    BatchTaskOperator batchOperator;
-    AndroidInstanceModel instanceModel(&apiService, &batchOperator, &networkService);
-
     // Initialize DuiLib
     CPaintManagerUI::SetInstance(hInstance);
     CPaintManagerUI::SetResourcePath(CPaintManagerUI::GetInstancePath() + _T("skin\\"));
     Logger::info("DuiLib initialized");
 
-    // Show login window (modal)
-    LoginWindow loginWindow(&apiService);
-    loginWindow.Create(nullptr, _T("登录"), UI_WNDSTYLE_DIALOG, WS_EX_WINDOWEDGE);
-    loginWindow.CenterWindow();
-    Logger::info("LoginWindow created, entering modal loop");
-    loginWindow.ShowModal();
-
-    // If login succeeded, show main window
-    if (loginWindow.loginSucceeded()) {
-        Logger::info("Login succeeded, opening MainWindow");
-
-        MainWindow mainWindow(&apiService, &instanceModel, &batchOperator);
-        mainWindow.Create(nullptr, _T("主窗口"), UI_WNDSTYLE_FRAME, WS_EX_WINDOWEDGE);
-        mainWindow.CenterWindow();
-        mainWindow.ShowWindow(true);
-
-        // Enter message loop for main window
-        CPaintManagerUI::MessageLoop();
+    // Everything that owns curl handles lives in this block, so it is destroyed before the
+    // cleanup below: the HttpTransport inside NetworkService, and the instance model whose
+    // screenshot downloader waits for in-flight pool callbacks before the pool stops
+    {
+        // Create service layer
+        NetworkService networkService;
+        networkService.setRequestHost("ap-shenzhen");
+        networkService.setOrigin("https://mouhong.test-cai-experience.crtrcloud.com");
+        ApiService apiService(&networkService);
+
+        // Create batch operator and instance model
+        BatchTaskOperator batchOperator;
+        AndroidInstanceModel instanceModel(&apiService, &batchOperator, &networkService);
+
+        // Show login window (modal)
+        LoginWindow loginWindow(&apiService);
+        loginWindow.Create(nullptr, _T("登录"), UI_WNDSTYLE_DIALOG, WS_EX_WINDOWEDGE);
+        loginWindow.CenterWindow();
+        Logger::info("LoginWindow created, entering modal loop");
+        loginWindow.ShowModal();
+
+        // If login succeeded, show main window
+        if (loginWindow.loginSucceeded()) {
+            Logger::info("Login succeeded, opening MainWindow");
+
+            MainWindow mainWindow(&apiService, &instanceModel, &batchOperator);
+            mainWindow.Create(nullptr, _T("主窗口"), UI_WNDSTYLE_FRAME, WS_EX_WINDOWEDGE);
+            mainWindow.CenterWindow();
+            mainWindow.ShowWindow(true);
+
+            // Enter message loop for main window
+            CPaintManagerUI::MessageLoop();
+        }
     }
 
-    // Cleanup
+    // Cleanup: the screenshot pool's thread and curl handles must be gone before libcurl is
+    ImageFetch::Pool::shared().shutdown();
     Logger::info("Application exiting");
     curl_global_cleanup();
     ::CoUninitialize();
@@ -0,0 +1,179 @@
+#include "HttpTransport.h"
+
+#include <cstdio>
+
+#include <curl/curl.h>
+
+#include "utils/Logger.h"
+
+namespace {
+
+size_t appendCallback(char* ptr, size_t size, size_t nmemb, void* userdata) {
+    auto* out = static_cast<std::string*>(userdata);
+    size_t totalSize = size * nmemb;
+    out->append(ptr, totalSize);
+    return totalSize;
+}
+
+double toMs(curl_off_t us) { return static_cast<double>(us) / 1000.0; }
+
+// Phase durations from the cumulative CURLINFO_*_TIME_T timestamps
+HttpTransport::Timing readTiming(CURL* curl) {
+    curl_off_t dns = 0, connect = 0, appConnect = 0, pretransfer = 0, start = 0, total = 0;
+    long connects = 0;
+    curl_easy_getinfo(curl, CURLINFO_NAMELOOKUP_TIME_T, &dns);
+    curl_easy_getinfo(curl, CURLINFO_CONNECT_TIME_T, &connect);
+    curl_easy_getinfo(curl, CURLINFO_APPCONNECT_TIME_T, &appConnect);
+    curl_easy_getinfo(curl, CURLINFO_PRETRANSFER_TIME_T, &pretransfer);
+    curl_easy_getinfo(curl, CURLINFO_STARTTRANSFER_TIME_T, &start);
+    curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME_T, &total);
+    curl_easy_getinfo(curl, CURLINFO_NUM_CONNECTS, &connects);
+
+    HttpTransport::Timing timing;
+    timing.reusedConnection = connects == 0;
+    timing.dnsMs = toMs(dns);
+    if (connect > dns)
+        timing.connectMs = toMs(connect - dns);
+    if (appConnect > connect)  // 0 for plain HTTP and reused connections
+        timing.tlsMs = toMs(appConnect - connect);
+    if (start > pretransfer)
+        timing.ttfbMs = toMs(start - pretransfer);
+    timing.totalMs = toMs(total);
+    return timing;
+}
+
+std::string formatTiming(const HttpTransport::Timing& t) {
+    char buf[160];
+    snprintf(buf, sizeof(buf), "dns %.1f ms, connect %.1f ms, tls %.1f ms, ttfb %.1f ms, total %.1f ms (%s)",
+             t.dnsMs, t.connectMs, t.tlsMs, t.ttfbMs, t.totalMs,
+             t.reusedConnection ? "reused connection" : "new connection");
+    return buf;
+}
+
+}  // namespace
+
+// Easy handles on different threads use the share concurrently, so every
+// shared data kind gets its own lock
+struct HttpTransport::Share {
+    CURLSH* handle = nullptr;
+    std::mutex locks[CURL_LOCK_DATA_LAST];
+
+    static void lock(CURL*, curl_lock_data data, curl_lock_access, void* userptr) {
+        static_cast<Share*>(userptr)->locks[data].lock();
+    }
+    static void unlock(CURL*, curl_lock_data data, void* userptr) {
+        static_cast<Share*>(userptr)->locks[data].unlock();
+    }
+
+    Share() {
+        handle = curl_share_init();
+        curl_share_setopt(handle, CURLSHOPT_LOCKFUNC, &Share::lock);
+        curl_share_setopt(handle, CURLSHOPT_UNLOCKFUNC, &Share::unlock);
+        curl_share_setopt(handle, CURLSHOPT_USERDATA, this);
+        curl_share_setopt(handle, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+        curl_share_setopt(handle, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    }
+    ~Share() {
+        if (handle)
+            curl_share_cleanup(handle);
+    }
+};
+
+HttpTransport::HttpTransport(size_t maxIdleHandles) : m_share(new Share), m_maxIdle(maxIdleHandles) {}
+
+HttpTransport::~HttpTransport() {
+    // Easy handles must go before the share they reference
+    for (void* easy : m_idle)
+        curl_easy_cleanup(static_cast<CURL*>(easy));
+    m_idle.clear();
+}
+
+void* HttpTransport::checkout() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_idle.empty()) {
+            void* easy = m_idle.back();
+            m_idle.pop_back();
+            curl_easy_reset(static_cast<CURL*>(easy));  // keeps the live connection
+            return easy;
+        }
+    }
+    return curl_easy_init();
+}
+
+void HttpTransport::checkin(void* easy) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_idle.size() < m_maxIdle) {
+            m_idle.push_back(easy);
+            return;
+        }
+    }
+    curl_easy_cleanup(static_cast<CURL*>(easy));
+}
+
+HttpTransport::Stats HttpTransport::stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats snapshot = m_stats;
+    snapshot.idleHandles = m_idle.size();
+    return snapshot;
+}
+
+HttpTransport::Response HttpTransport::post(const Request& request) {
+    Response response;
+
+    CURL* curl = static_cast<CURL*>(checkout());
+    if (!curl) {
+        response.error = "Failed to initialize CURL";
+        return response;
+    }
+
+    struct curl_slist* headers = nullptr;
+    for (const std::string& header : request.headers)
+        headers = curl_slist_append(headers, header.c_str());
+
+    curl_easy_setopt(curl, CURLOPT_URL, request.url.c_str());
+    curl_easy_setopt(curl, CURLOPT_POST, 1L);
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, request.body.c_str());
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, static_cast<long>(request.body.size()));
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, appendCallback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response.body);
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, appendCallback);
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, &response.headers);
+    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 1L);
+    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 2L);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, request.timeoutSec);
+    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, request.connectTimeoutSec);
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);  // required for timeouts on worker threads
+    curl_easy_setopt(curl, CURLOPT_SHARE, m_share->handle);
+
+    CURLcode res = curl_easy_perform(curl);
+    response.timing = readTiming(curl);
+    if (res != CURLE_OK) {
+        response.error = curl_easy_strerror(res);
+        response.body.clear();
+    } else {
+        long httpCode = 0;
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
+        response.statusCode = static_cast<int>(httpCode);
+        response.transferOk = true;
+    }
+
+    curl_slist_free_all(headers);
+    // The header list is freed, so the handle must not point at it while idle
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, nullptr);
+    checkin(curl);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.requests++;
+        if (response.timing.reusedConnection)
+            m_stats.reusedConnections++;
+    }
+    Logger::debug("[HttpTransport] " + request.url + " -> " +
+                  (res == CURLE_OK ? std::to_string(response.statusCode) : response.error) + ", " +
+                  formatTiming(response.timing));
+    return response;
+}
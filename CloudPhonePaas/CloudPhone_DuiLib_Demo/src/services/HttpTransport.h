@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Blocking HTTP POST transport with warm connections.
+ *
+ * Keeps a small pool of reusable CURL easy handles. A handle returned to the
+ * pool keeps its live connection, so the next request to the same host skips
+ * DNS, TCP connect and the TLS handshake. All handles share one CURLSH for
+ * DNS results and TLS sessions, so even a freshly created handle resumes the
+ * TLS session instead of doing a full handshake.
+ *
+ * Thread-safe: concurrent post() calls from worker threads each check out
+ * their own handle; the pool only bounds how many idle handles are kept.
+ */
+class HttpTransport {
+public:
+    struct Request {
+        std::string url;
+        std::string body;
+        std::vector<std::string> headers;  ///< "Name: value" lines
+        long timeoutSec = 30;
+        long connectTimeoutSec = 10;
+    };
+
+    /// Per-request phase durations in milliseconds (from CURLINFO_*_TIME_T)
+    struct Timing {
+        double dnsMs = 0;
+        double connectMs = 0;  ///< TCP connect, after DNS
+        double tlsMs = 0;      ///< TLS handshake, after TCP connect
+        double ttfbMs = 0;     ///< from request sent to first response byte
+        double totalMs = 0;
+        bool reusedConnection = false;
+    };
+
+    struct Response {
+        bool transferOk = false;  ///< false on network/TLS/timeout errors
+        int statusCode = 0;
+        std::string body;
+        std::string headers;
+        std::string error;
+        Timing timing;
+    };
+
+    struct Stats {
+        uint64_t requests = 0;
+        uint64_t reusedConnections = 0;
+        size_t idleHandles = 0;
+    };
+
+    explicit HttpTransport(size_t maxIdleHandles = 4);
+    ~HttpTransport();
+
+    HttpTransport(const HttpTransport&) = delete;
+    HttpTransport& operator=(const HttpTransport&) = delete;
+
+    Response post(const Request& request);
+
+    Stats stats() const;
+
+private:
+    struct Share;
+
+    void* checkout();
+    void checkin(void* easy);
+
+    std::unique_ptr<Share> m_share;  // CURLSH plus the locks libcurl needs for it
+    const size_t m_maxIdle;
+
+    mutable std::mutex m_mutex;
+    std::vector<void*> m_idle;  // CURL* easy handles, most recently used last
+    Stats m_stats;              // guarded by m_mutex
+};
@@ -1,9 +1,13 @@
 #pragma once
 
+#include <memory>
+#include <mutex>
 #include <string>
 
 #include <json/json.h>
 
+#include "HttpTransport.h"
+
 /**
  * @brief HTTP response structure returned by NetworkService.
  */
@@ -20,7 +24,9 @@ struct HttpResponse {
  *
  * Provides synchronous POST requests with JSON body.
  * Designed to be called from worker threads (ApiService handles threading).
- * Thread-safe: each call creates its own CURL easy handle.
+ * Requests go through a shared HttpTransport, so repeated calls to the base URL
+ * reuse the connection, DNS lookup and TLS session. Thread-safe: concurrent
+ * calls are allowed, and settings may change while requests are in flight.
  */
 class NetworkService {
 public:
@@ -42,13 +48,11 @@ public:
     void setOrigin(const std::string& origin);
 
 private:
+    mutable std::mutex m_mutex;  // guards the settings below
     std::string m_baseUrl;
     std::string m_token;
     std::string m_requestHost;
     std::string m_origin;
 
-    // libcurl write callback
-    static size_t writeCallback(char* ptr, size_t size, size_t nmemb, void* userdata);
-    // libcurl header callback
-    static size_t headerCallback(char* ptr, size_t size, size_t nmemb, void* userdata);
+    std::unique_ptr<HttpTransport> m_transport;
 };
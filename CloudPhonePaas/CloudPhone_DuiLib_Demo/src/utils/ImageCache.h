@@ -1,67 +1,188 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 /**
- * @brief Simple thread-safe in-memory cache mapping instanceId -> raw image bytes.
+ * @brief Thread-safe in-memory cache mapping instanceId -> raw image bytes.
  *
- * Header-only implementation.
+ * - Entries are stored as shared_ptr<const Bytes>; get() hands out a reference
+ *   to the stored buffer, never a copy. A buffer stays alive while a reader
+ *   holds it, even after it has been replaced or evicted.
+ * - The total size is bounded by a byte budget, split evenly across shards.
+ *   Each shard evicts its least recently used entries when it exceeds its share.
+ * - Keys are spread over kShardCount shards with one mutex each, so the
+ *   downloader thread and the UI thread rarely contend on the same lock.
+ *
+ * Header-only implementation, no platform dependencies.
  */
 class ImageCache {
 public:
-    ImageCache() = default;
+    using Bytes = std::vector<uint8_t>;
+    using BytesPtr = std::shared_ptr<const Bytes>;
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        size_t entries = 0;
+        size_t bytes = 0;
+    };
+
+    static constexpr size_t kShardCount = 8;
+    static constexpr size_t kDefaultBudgetBytes = 32 * 1024 * 1024;
+
+    explicit ImageCache(size_t budgetBytes = kDefaultBudgetBytes) { setBudget(budgetBytes); }
+
+    /// Change the byte budget, evicting entries that no longer fit
+    void setBudget(size_t budgetBytes) {
+        size_t perShard = budgetBytes / kShardCount;
+        for (Shard& shard : m_shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.budget = perShard;
+            evictLocked(shard);
+        }
+    }
 
     /// Store image data for an instance (replaces any existing entry)
-    void put(const std::string& instanceId, const std::vector<uint8_t>& imageData) {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        m_cache[instanceId] = imageData;
+    void put(const std::string& instanceId, const Bytes& imageData) {
+        put(instanceId, std::make_shared<const Bytes>(imageData));
     }
 
     /// Store image data (move version)
-    void put(const std::string& instanceId, std::vector<uint8_t>&& imageData) {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        m_cache[instanceId] = std::move(imageData);
+    void put(const std::string& instanceId, Bytes&& imageData) {
+        put(instanceId, std::make_shared<const Bytes>(std::move(imageData)));
     }
 
-    /// Get image data for an instance. Returns empty vector if not found.
-    std::vector<uint8_t> get(const std::string& instanceId) const {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        auto it = m_cache.find(instanceId);
-        if (it != m_cache.end()) {
-            return it->second;
+    /// Store an already shared buffer without copying it
+    void put(const std::string& instanceId, BytesPtr imageData) {
+        if (!imageData)
+            return;
+        Shard& shard = shardFor(instanceId);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.index.find(instanceId);
+        if (it != shard.index.end()) {
+            shard.bytes -= it->second->data->size();
+            shard.lru.erase(it->second);
+            shard.index.erase(it);
         }
-        return {};
+        // An entry larger than the whole shard budget would evict everything and still not fit
+        if (imageData->size() > shard.budget)
+            return;
+        shard.bytes += imageData->size();
+        shard.lru.push_front(Node{instanceId, std::move(imageData)});
+        shard.index.emplace(instanceId, shard.lru.begin());
+        evictLocked(shard);
     }
 
-    /// Check if an instance has cached image data
+    /// Get image data for an instance, marking it most recently used. Returns nullptr if not found.
+    BytesPtr get(const std::string& instanceId) const {
+        Shard& shard = shardFor(instanceId);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.index.find(instanceId);
+        if (it == shard.index.end()) {
+            m_misses.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        m_hits.fetch_add(1, std::memory_order_relaxed);
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+        return it->second->data;
+    }
+
+    /// Check if an instance has cached image data (does not affect LRU order or stats)
     bool has(const std::string& instanceId) const {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        return m_cache.find(instanceId) != m_cache.end();
+        Shard& shard = shardFor(instanceId);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.index.find(instanceId) != shard.index.end();
     }
 
     /// Remove a specific entry
     void remove(const std::string& instanceId) {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        m_cache.erase(instanceId);
+        Shard& shard = shardFor(instanceId);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.index.find(instanceId);
+        if (it == shard.index.end())
+            return;
+        shard.bytes -= it->second->data->size();
+        shard.lru.erase(it->second);
+        shard.index.erase(it);
     }
 
     /// Clear all cached images
     void clear() {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        m_cache.clear();
+        for (Shard& shard : m_shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.index.clear();
+            shard.lru.clear();
+            shard.bytes = 0;
+        }
     }
 
     /// Get current cache size (number of entries)
     size_t size() const {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        return m_cache.size();
+        size_t total = 0;
+        for (const Shard& shard : m_shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            total += shard.index.size();
+        }
+        return total;
+    }
+
+    /// Hit/miss/eviction counters since construction plus current occupancy
+    Stats stats() const {
+        Stats s;
+        s.hits = m_hits.load(std::memory_order_relaxed);
+        s.misses = m_misses.load(std::memory_order_relaxed);
+        s.evictions = m_evictions.load(std::memory_order_relaxed);
+        for (const Shard& shard : m_shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            s.entries += shard.index.size();
+            s.bytes += shard.bytes;
+        }
+        return s;
     }
 
 private:
-    mutable std::mutex m_mutex;
-    std::unordered_map<std::string, std::vector<uint8_t>> m_cache;
+    struct Node {
+        std::string key;
+        BytesPtr data;
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::list<Node> lru;  // front = most recently used
+        std::unordered_map<std::string, std::list<Node>::iterator> index;
+        size_t bytes = 0;
+        size_t budget = 0;
+    };
+
+    Shard& shardFor(const std::string& key) const {
+        return m_shards[std::hash<std::string>()(key) % kShardCount];
+    }
+
+    // Drop least recently used entries until the shard fits its budget; caller holds shard.mutex
+    void evictLocked(Shard& shard) {
+        while (shard.bytes > shard.budget && !shard.lru.empty()) {
+            Node& victim = shard.lru.back();
+            shard.bytes -= victim.data->size();
+            shard.index.erase(victim.key);
+            shard.lru.pop_back();
+            m_evictions.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    mutable std::array<Shard, kShardCount> m_shards;
+    mutable std::atomic<uint64_t> m_hits{0};
+    mutable std::atomic<uint64_t> m_misses{0};
+    std::atomic<uint64_t> m_evictions{0};
 };
@@ -0,0 +1,326 @@
+#include "ImageFetch.h"
+
+#include <algorithm>
+#include <cctype>
+#include <future>
+#include <string>
+
+#include <curl/curl.h>
+
+#include "utils/Logger.h"
+
+namespace {
+
+size_t bodyCallback(char* ptr, size_t size, size_t nmemb, void* userdata) {
+    auto* buf = reinterpret_cast<std::vector<uint8_t>*>(userdata);
+    size_t total = size * nmemb;
+    buf->insert(buf->end(), reinterpret_cast<uint8_t*>(ptr),
+                reinterpret_cast<uint8_t*>(ptr) + total);
+    return total;
+}
+
+// Value of "name: value" if the header line matches name (case-insensitive)
+bool matchHeader(const std::string& line, const char* name, std::string& value) {
+    size_t len = std::char_traits<char>::length(name);
+    if (line.size() <= len || line[len] != ':')
+        return false;
+    for (size_t i = 0; i < len; ++i) {
+        if (std::tolower(static_cast<unsigned char>(line[i])) !=
+            std::tolower(static_cast<unsigned char>(name[i])))
+            return false;
+    }
+    size_t begin = line.find_first_not_of(" \t", len + 1);
+    size_t end = line.find_last_not_of(" \t\r\n");
+    value = (begin == std::string::npos || end < begin) ? std::string()
+                                                        : line.substr(begin, end - begin + 1);
+    return true;
+}
+
+size_t headerCallback(char* ptr, size_t size, size_t nmemb, void* userdata) {
+    auto* validators = reinterpret_cast<ImageFetch::Validators*>(userdata);
+    size_t total = size * nmemb;
+    std::string line(ptr, total);
+    // A redirect starts a new header block; keep only the final response's validators
+    if (line.compare(0, 5, "HTTP/") == 0)
+        *validators = ImageFetch::Validators();
+    std::string value;
+    if (matchHeader(line, "etag", value))
+        validators->etag = value;
+    else if (matchHeader(line, "last-modified", value))
+        validators->lastModified = value;
+    return total;
+}
+
+// Turn a finished transfer into a Result (HTTP status mapping shared by all callers)
+void classify(ImageFetch::Result& result, CURLcode res, long httpCode) {
+    using ImageFetch::Status;
+    if (res != CURLE_OK) {
+        result.error = curl_easy_strerror(res);
+        result.data.clear();
+        return;
+    }
+    if (httpCode == 304) {
+        result.status = Status::NotModified;
+        result.data.clear();
+        return;
+    }
+    if (httpCode >= 400 || result.data.empty()) {
+        result.error = "HTTP " + std::to_string(httpCode) + ", " +
+                       std::to_string(result.data.size()) + " bytes";
+        result.data.clear();
+        return;
+    }
+    result.status = Status::Ok;
+}
+
+// Log pool statistics after this many completed transfers
+constexpr uint64_t kStatsLogInterval = 200;
+
+}  // namespace
+
+namespace ImageFetch {
+
+Result fetch(const std::string& url, const Validators& validators, long timeoutSec) {
+    std::promise<Result> promise;
+    std::future<Result> future = promise.get_future();
+    Pool::shared().submit(url, validators, timeoutSec,
+                          [&promise](Result result) { promise.set_value(std::move(result)); });
+    return future.get();
+}
+
+// ==================== Pool ====================
+
+struct Pool::Transfer {
+    CURL* easy = nullptr;
+    struct curl_slist* headers = nullptr;
+    Result result;
+    Callback done;
+};
+
+struct Pool::Handles {
+    CURLM* multi = nullptr;
+    CURLSH* share = nullptr;
+    std::vector<CURL*> idle;  // finished easy handles, reset and reused
+
+    ~Handles() {
+        for (CURL* easy : idle)
+            curl_easy_cleanup(easy);
+        if (multi)
+            curl_multi_cleanup(multi);
+        if (share)
+            curl_share_cleanup(share);
+    }
+};
+
+Pool::Pool(int maxParallel) : m_handles(new Handles), m_maxParallel(std::max(1, maxParallel)) {
+    m_handles->multi = curl_multi_init();
+    curl_multi_setopt(m_handles->multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+
+    // All easy handles are driven by the pool thread only, so the share needs no lock callbacks
+    m_handles->share = curl_share_init();
+    curl_share_setopt(m_handles->share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(m_handles->share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+
+    m_thread = std::thread(&Pool::run, this);
+}
+
+Pool::~Pool() {
+    shutdown();
+}
+
+void Pool::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_stopping)
+            return;
+        m_stopping = true;
+    }
+    curl_multi_wakeup(m_handles->multi);
+    if (m_thread.joinable())
+        m_thread.join();
+    // Only the (now finished) pool thread used the handles
+    m_handles.reset();
+}
+
+// static
+Pool& Pool::shared() {
+    static Pool pool;
+    return pool;
+}
+
+void Pool::setMaxParallel(int maxParallel) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_maxParallel = std::max(1, maxParallel);
+    if (!m_stopping)
+        curl_multi_wakeup(m_handles->multi);
+}
+
+void Pool::submit(const std::string& url, const Validators& validators, long timeoutSec,
+                  Callback done) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_stopping) {
+            m_queue.push_back(Request{url, validators, timeoutSec, std::move(done)});
+            // Under the lock so shutdown() cannot free the multi handle in between
+            curl_multi_wakeup(m_handles->multi);
+            return;
+        }
+    }
+    Result cancelled;
+    cancelled.error = "cancelled";
+    done(std::move(cancelled));
+}
+
+Pool::Stats Pool::stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+void Pool::run() {
+    for (;;) {
+        std::deque<Request> toStart;
+        bool stopping;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            stopping = m_stopping;
+            while (!stopping && !m_queue.empty() &&
+                   m_active.size() + toStart.size() < static_cast<size_t>(m_maxParallel)) {
+                toStart.push_back(std::move(m_queue.front()));
+                m_queue.pop_front();
+            }
+            m_stats.queued = m_queue.size();
+            m_stats.active = m_active.size() + toStart.size();
+        }
+        if (stopping)
+            break;
+        for (Request& request : toStart)
+            startTransfer(std::move(request));
+
+        int running = 0;
+        curl_multi_perform(m_handles->multi, &running);
+        int left = 0;
+        bool finished = false;
+        while (CURLMsg* msg = curl_multi_info_read(m_handles->multi, &left)) {
+            if (msg->msg == CURLMSG_DONE) {
+                finishTransfer(msg->easy_handle, msg->data.result);
+                finished = true;
+            }
+        }
+        // Freed slots take queued requests right away; polling first could sit out the
+        // whole timeout when no other transfer is producing socket activity
+        if (finished)
+            continue;
+        // Sleeps until socket activity, a timeout, or curl_multi_wakeup() from submit()
+        curl_multi_poll(m_handles->multi, nullptr, 0, 1000, nullptr);
+    }
+
+    // Fail everything still pending so each caller gets its callback
+    std::deque<Request> pending;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        pending.swap(m_queue);
+    }
+    while (!m_active.empty())
+        finishTransfer(m_active.back()->easy, CURLE_ABORTED_BY_CALLBACK);
+    for (Request& request : pending) {
+        Result cancelled;
+        cancelled.error = "cancelled";
+        request.done(std::move(cancelled));
+    }
+}
+
+void Pool::startTransfer(Request request) {
+    auto transfer = std::make_unique<Transfer>();
+    transfer->done = std::move(request.done);
+    if (!m_handles->idle.empty()) {
+        transfer->easy = m_handles->idle.back();
+        m_handles->idle.pop_back();
+        curl_easy_reset(transfer->easy);  // keeps the live connection and session caches
+    } else {
+        transfer->easy = curl_easy_init();
+    }
+    if (!transfer->easy) {
+        transfer->result.error = "curl_easy_init failed";
+        transfer->done(std::move(transfer->result));
+        return;
+    }
+
+    CURL* curl = transfer->easy;
+    if (!request.validators.etag.empty())
+        transfer->headers = curl_slist_append(transfer->headers,
+                                              ("If-None-Match: " + request.validators.etag).c_str());
+    if (!request.validators.lastModified.empty())
+        transfer->headers = curl_slist_append(
+            transfer->headers, ("If-Modified-Since: " + request.validators.lastModified).c_str());
+
+    curl_easy_setopt(curl, CURLOPT_URL, request.url.c_str());
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, bodyCallback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &transfer->result.data);
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, headerCallback);
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, &transfer->result.validators);
+    if (transfer->headers)
+        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, transfer->headers);
+    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, request.timeoutSec);
+    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+    curl_easy_setopt(curl, CURLOPT_PIPEWAIT, 1L);
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(curl, CURLOPT_SHARE, m_handles->share);
+    curl_easy_setopt(curl, CURLOPT_PRIVATE, transfer.get());
+
+    curl_multi_add_handle(m_handles->multi, curl);
+    m_active.push_back(std::move(transfer));
+}
+
+void Pool::finishTransfer(void* easy, int curlCode) {
+    auto it = std::find_if(m_active.begin(), m_active.end(),
+                           [easy](const std::unique_ptr<Transfer>& t) { return t->easy == easy; });
+    if (it == m_active.end())
+        return;
+    std::unique_ptr<Transfer> transfer = std::move(*it);
+    m_active.erase(it);
+
+    CURL* curl = transfer->easy;
+    long httpCode = 0;
+    long connects = 0;
+    long httpVersion = 0;
+    double seconds = 0;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
+    curl_easy_getinfo(curl, CURLINFO_NUM_CONNECTS, &connects);
+    curl_easy_getinfo(curl, CURLINFO_HTTP_VERSION, &httpVersion);
+    curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME, &seconds);
+    curl_multi_remove_handle(m_handles->multi, curl);
+    curl_slist_free_all(transfer->headers);
+    m_handles->idle.push_back(curl);
+
+    classify(transfer->result, static_cast<CURLcode>(curlCode), httpCode);
+
+    Stats snapshot;
+    bool logStats = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.completed++;
+        if (transfer->result.status == Status::Failed)
+            m_stats.failed++;
+        m_stats.newConnections += static_cast<uint64_t>(connects);
+        if (httpVersion == CURL_HTTP_VERSION_2_0)
+            m_stats.http2++;
+        m_stats.totalSeconds += seconds;
+        logStats = m_stats.completed % kStatsLogInterval == 0;
+        snapshot = m_stats;
+    }
+    if (logStats) {
+        Logger::debug("[ImageFetch] " + std::to_string(snapshot.completed) + " transfers, " +
+                      std::to_string(snapshot.failed) + " failed, " +
+                      std::to_string(snapshot.newConnections) + " new connections, " +
+                      std::to_string(snapshot.http2) + " over HTTP/2, avg " +
+                      std::to_string(static_cast<int>(snapshot.totalSeconds * 1000 /
+                                                      snapshot.completed)) +
+                      " ms");
+    }
+
+    transfer->done(std::move(transfer->result));
+}
+
+}  // namespace ImageFetch
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Conditional HTTP GET for instance screenshots.
+ *
+ * Sends If-None-Match / If-Modified-Since when validators from a previous
+ * response are known, so an unchanged screenshot costs a 304 instead of a
+ * full JPEG download.
+ *
+ * Transfers run on a shared Pool (one curl_multi handle and thread), so
+ * screenshots from the same CDN host reuse connections, DNS lookups and TLS
+ * sessions instead of paying a handshake per image.
+ */
+namespace ImageFetch {
+
+/// Cache validators returned by the server (empty when not provided)
+struct Validators {
+    std::string etag;
+    std::string lastModified;
+};
+
+enum class Status {
+    Failed,
+    NotModified,  ///< 304: the previously downloaded bytes are still current
+    Ok,
+};
+
+struct Result {
+    Status status = Status::Failed;
+    std::vector<uint8_t> data;
+    Validators validators;
+    std::string error;
+};
+
+/// Blocking fetch on the shared pool. Thread-safe.
+Result fetch(const std::string& url, const Validators& validators, long timeoutSec);
+
+/**
+ * @brief Parallel downloader on a single curl_multi handle.
+ *
+ * - up to maxParallel transfers run at once; further requests queue in order
+ * - easy handles are reused, keeping their connections alive between images
+ * - HTTP/2 is negotiated over TLS when the server supports it, and new
+ *   transfers wait to multiplex on an existing connection (CURLOPT_PIPEWAIT)
+ * - DNS results and TLS sessions are shared by all transfers
+ *
+ * Completion callbacks run on the pool thread and must not block for long.
+ * Every submitted request gets exactly one callback, also when the pool is
+ * shut down first (status Failed, error "cancelled").
+ *
+ * shutdown() must run before curl_global_cleanup(): the shared() pool is a
+ * function-local static and would otherwise still be polling, and free its
+ * curl handles, after libcurl has been torn down.
+ */
+class Pool {
+public:
+    using Callback = std::function<void(Result result)>;
+
+    struct Stats {
+        uint64_t completed = 0;
+        uint64_t failed = 0;
+        uint64_t newConnections = 0;  ///< connections opened; the rest reused one
+        uint64_t http2 = 0;           ///< transfers that ran over HTTP/2
+        double totalSeconds = 0;      ///< summed transfer time (CURLINFO_TOTAL_TIME)
+        size_t queued = 0;
+        size_t active = 0;
+    };
+
+    explicit Pool(int maxParallel = 6);
+    ~Pool();
+
+    Pool(const Pool&) = delete;
+    Pool& operator=(const Pool&) = delete;
+
+    /// Process-wide pool used by fetch() and the screenshot downloaders
+    static Pool& shared();
+
+    void setMaxParallel(int maxParallel);
+
+    void submit(const std::string& url, const Validators& validators, long timeoutSec,
+                Callback done);
+
+    Stats stats() const;
+
+    /**
+     * @brief Cancel queued and running transfers, join the pool thread and free
+     * all curl handles. Later submit() calls fail with "cancelled". Idempotent.
+     */
+    void shutdown();
+
+private:
+    struct Request {
+        std::string url;
+        Validators validators;
+        long timeoutSec = 0;
+        Callback done;
+    };
+    struct Transfer;
+    struct Handles;
+
+    void run();
+    void startTransfer(Request request);
+    void finishTransfer(void* easy, int curlCode);
+
+    std::unique_ptr<Handles> m_handles;  // multi/share handles and idle easy handles
+    std::vector<std::unique_ptr<Transfer>> m_active;  // pool thread only
+
+    mutable std::mutex m_mutex;
+    std::deque<Request> m_queue;
+    int m_maxParallel;
+    bool m_stopping = false;
+    Stats m_stats;  // guarded by m_mutex
+    std::thread m_thread;
+};
+
+}  // namespace ImageFetch
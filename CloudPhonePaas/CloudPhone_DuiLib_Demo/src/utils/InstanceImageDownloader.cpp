@@ -1,24 +1,18 @@
 #include "InstanceImageDownloader.h"
 
+#include <algorithm>
 #include <chrono>
 
-#include <curl/curl.h>
-
 #include "core/BatchTaskOperator.h"
+#include "utils/ImageFetch.h"
 #include "utils/Logger.h"
 
-// curl write callback for downloading image bytes
-static size_t imageWriteCallback(char* ptr, size_t size, size_t nmemb, void* userdata) {
-    auto* buf = reinterpret_cast<std::vector<uint8_t>*>(userdata);
-    size_t total = size * nmemb;
-    buf->insert(buf->end(), reinterpret_cast<uint8_t*>(ptr),
-                reinterpret_cast<uint8_t*>(ptr) + total);
-    return total;
-}
-
 InstanceImageDownloader::InstanceImageDownloader(BatchTaskOperator* op,
                                                  NetworkService* networkService)
-    : m_operator(op), m_networkService(networkService) {}
+    : m_operator(op),
+      m_networkService(networkService),
+      m_scheduler(std::chrono::seconds(3), std::chrono::seconds(30)),
+      m_spec(ScreenshotSizePolicy::forTile(160, 260)) {}
 
 InstanceImageDownloader::~InstanceImageDownloader() {
     stopDownloading();
@@ -27,10 +21,7 @@ InstanceImageDownloader::~InstanceImageDownloader() {
 void InstanceImageDownloader::startDownloading(const std::vector<std::string>& instanceIds) {
     stopDownloading();
 
-    {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        m_pendingIds = instanceIds;
-    }
+    m_scheduler.setInstances(instanceIds);
 
     m_running.store(true);
     m_paused.store(false);
@@ -45,6 +36,10 @@ void InstanceImageDownloader::stopDownloading() {
     if (m_downloadThread.joinable()) {
         m_downloadThread.join();
     }
+
+    // Downloads already handed to the pool still call back into this object
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv.wait(lock, [this]() { return m_inFlight == 0; });
 }
 
 void InstanceImageDownloader::pauseDownloading() {
@@ -57,8 +52,25 @@ void InstanceImageDownloader::resumeDownloading() {
 }
 
 void InstanceImageDownloader::updateInstanceList(const std::vector<std::string>& instanceIds) {
+    m_scheduler.setInstances(instanceIds);
+    wakeLoop();
+}
+
+void InstanceImageDownloader::setVisibleInstances(const std::vector<std::string>& instanceIds) {
+    m_scheduler.setVisible(instanceIds);
+    wakeLoop();
+}
+
+void InstanceImageDownloader::setScreenshotSpec(const ScreenshotSizePolicy::Spec& spec) {
     std::lock_guard<std::mutex> lock(m_mutex);
-    m_pendingIds = instanceIds;
+    m_spec = spec;
+}
+
+void InstanceImageDownloader::wakeLoop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_scheduleChanged = true;
+    }
     m_cv.notify_all();
 }
 
@@ -75,71 +87,98 @@ void InstanceImageDownloader::downloadLoop() {
         if (!m_running.load())
             break;
 
-        // Get current pending IDs
-        std::vector<std::string> ids;
+        // Instances whose next poll is due (visible first), only as many as there are free slots
+        ScreenshotSizePolicy::Spec spec;
+        int freeSlots;
         {
             std::lock_guard<std::mutex> lock(m_mutex);
-            ids = m_pendingIds;
+            spec = m_spec;
+            freeSlots = kMaxInFlight - m_inFlight;
         }
+        std::vector<std::string> ids;
+        if (freeSlots > 0)
+            ids = m_scheduler.takeDue(static_cast<size_t>(freeSlots));
 
         for (const auto& instanceId : ids) {
-            if (!m_running.load())
-                break;
+            if (!m_running.load()) {
+                m_scheduler.report(instanceId, false, 0);
+                continue;
+            }
 
             // Get screenshot URL via BatchTaskOperator
-            std::string url = m_operator->getInstanceImage(instanceId);
+            std::string url =
+                m_operator->getInstanceImage(instanceId, spec.quality, spec.width, spec.height);
             if (url.empty()) {
                 Logger::debug("[InstanceImageDownloader] no URL for " + instanceId);
+                m_scheduler.report(instanceId, false, 0);
                 continue;
             }
 
-            // Download image bytes
-            std::vector<uint8_t> imageData = downloadImageFromUrl(url);
-            if (imageData.empty()) {
-                Logger::debug("[InstanceImageDownloader] download failed for " + instanceId);
-                continue;
-            }
-
-            // Invoke callback
-            if (onImageDownloaded) {
-                onImageDownloaded(instanceId, imageData);
+            // Download on the shared pool (conditional GET, parallel, reused connections)
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_inFlight++;
             }
+            ImageFetch::Pool::shared().submit(
+                url, m_scheduler.validators(instanceId), 10,
+                [this, instanceId](ImageFetch::Result fetched) {
+                    onFetched(instanceId, fetched);
+                    // A free slot may let the loop issue the next due instance
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_inFlight--;
+                    m_scheduleChanged = true;
+                    m_cv.notify_all();
+                });
+        }
 
-            // Brief sleep between downloads to avoid overwhelming
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        if (!ids.empty()) {
+            Logger::debug("[InstanceImageDownloader] polling " + std::to_string(ids.size()) +
+                          " instances at " + std::to_string(spec.width) + "x" +
+                          std::to_string(spec.height) + " q" + std::to_string(spec.quality) +
+                          ", " + std::to_string(m_scheduler.downloadedBytes()) +
+                          " bytes total, " + std::to_string(m_scheduler.requestsPerMinute()) +
+                          " req/min, skipped decode " +
+                          std::to_string(m_scheduler.skippedDecodes()) + "/" +
+                          std::to_string(m_scheduler.completedPolls()));
         }
 
-        // Sleep between full rounds
+        // Sleep until the next instance is due (or, with every slot busy, until a download
+        // finishes); visibility/list changes wake us early
         {
+            auto wait = freeSlots > static_cast<int>(ids.size())
+                            ? std::min<ScreenshotPollScheduler::Clock::duration>(
+                                  m_scheduler.timeUntilNextDue(), std::chrono::seconds(1))
+                            : ScreenshotPollScheduler::Clock::duration(std::chrono::seconds(1));
             std::unique_lock<std::mutex> lock(m_mutex);
-            m_cv.wait_for(lock, std::chrono::seconds(3),
-                          [this]() { return !m_running.load(); });
+            m_cv.wait_for(lock, wait,
+                          [this]() { return !m_running.load() || m_scheduleChanged; });
+            m_scheduleChanged = false;
         }
     }
 
     Logger::info("[InstanceImageDownloader] download loop stopped");
 }
 
-std::vector<uint8_t> InstanceImageDownloader::downloadImageFromUrl(const std::string& url) {
-    CURL* curl = curl_easy_init();
-    if (!curl)
-        return {};
-
-    std::vector<uint8_t> buf;
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, imageWriteCallback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &buf);
-    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 10L);
-    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
-
-    CURLcode res = curl_easy_perform(curl);
-    curl_easy_cleanup(curl);
-
-    if (res != CURLE_OK) {
-        Logger::warning("[InstanceImageDownloader] curl error: " + std::string(curl_easy_strerror(res)));
-        return {};
+void InstanceImageDownloader::onFetched(const std::string& instanceId,
+                                        ImageFetch::Result& fetched) {
+    if (fetched.status == ImageFetch::Status::Failed) {
+        Logger::debug("[InstanceImageDownloader] download failed for " + instanceId + ": " +
+                      fetched.error);
+        m_scheduler.report(instanceId, false, 0);
+        return;
     }
-
-    return buf;
+    if (fetched.status == ImageFetch::Status::NotModified) {
+        m_scheduler.reportNotModified(instanceId);
+        return;
+    }
+    m_scheduler.setValidators(instanceId, fetched.validators);
+    m_scheduler.addDownloadedBytes(fetched.data.size());
+    // Same bytes as last time: skip the callback (cache write, temp file, UI reload)
+    if (!m_scheduler.report(
+            instanceId, true,
+            ScreenshotPollScheduler::hashContent(fetched.data.data(), fetched.data.size())))
+        return;
+
+    if (onImageDownloaded && m_running.load())
+        onImageDownloaded(instanceId, fetched.data);
 }
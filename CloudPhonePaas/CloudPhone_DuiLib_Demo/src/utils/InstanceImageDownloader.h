@@ -9,6 +9,10 @@
 #include <thread>
 #include <vector>
 
+#include "core/ScreenshotSizePolicy.h"
+#include "utils/ImageFetch.h"
+#include "utils/ScreenshotPollScheduler.h"
+
 class BatchTaskOperator;
 class NetworkService;
 
@@ -16,7 +20,14 @@ class NetworkService;
  * @brief Downloads instance screenshots asynchronously in a background thread.
  *
  * Uses BatchTaskOperator::getInstanceImage() to get a screenshot URL,
- * then downloads the image bytes via curl.
+ * then downloads the image bytes on the shared ImageFetch::Pool (conditional
+ * GET, parallel transfers over reused connections).
+ * Screenshots whose bytes did not change are not passed to onImageDownloaded.
+ * Each instance is polled on its own schedule (see ScreenshotPollScheduler):
+ * visible instances every 3 s, hidden ones every 30 s, backing off while the
+ * image does not change. At most kMaxInFlight screenshots are requested or
+ * downloading at once, so a tile that scrolls into view never waits behind
+ * the whole hidden fleet.
  */
 class InstanceImageDownloader {
 public:
@@ -31,8 +42,14 @@ public:
     void pauseDownloading();
     void resumeDownloading();
     void updateInstanceList(const std::vector<std::string>& instanceIds);
+    void setVisibleInstances(const std::vector<std::string>& instanceIds);
+    /// Screenshot size/quality requested from tcr_instance_get_image (see ScreenshotSizePolicy)
+    void setScreenshotSpec(const ScreenshotSizePolicy::Spec& spec);
+
+    /// Screenshot requests issued during the last minute
+    int requestsPerMinute() const { return m_scheduler.requestsPerMinute(); }
 
-    /// Callback: (instanceId, JPEG/PNG raw bytes)
+    /// Callback: (instanceId, JPEG/PNG raw bytes), invoked on the ImageFetch pool thread
     std::function<void(const std::string& instanceId, const std::vector<uint8_t>& imageData)>
         onImageDownloaded;
 
@@ -44,8 +61,15 @@ private:
     std::atomic<bool> m_paused{false};
     std::mutex m_mutex;
     std::condition_variable m_cv;
-    std::vector<std::string> m_pendingIds;
+    ScreenshotPollScheduler m_scheduler;
+    bool m_scheduleChanged = false;  // guarded by m_mutex; wakes the loop early
+    ScreenshotSizePolicy::Spec m_spec;  // guarded by m_mutex
+    int m_inFlight = 0;                 // pool downloads not yet called back; guarded by m_mutex
+
+    static constexpr int kMaxInFlight = 8;
 
     void downloadLoop();
-    std::vector<uint8_t> downloadImageFromUrl(const std::string& url);
+    void wakeLoop();
+    // Pool thread: hand a finished download to the scheduler and onImageDownloaded
+    void onFetched(const std::string& instanceId, ImageFetch::Result& fetched);
 };
@@ -0,0 +1,217 @@
+#include "ScreenshotPollScheduler.h"
+
+#include <algorithm>
+#include <string_view>
+
+ScreenshotPollScheduler::ScreenshotPollScheduler(std::chrono::milliseconds visibleInterval,
+                                                 std::chrono::milliseconds hiddenInterval,
+                                                 std::chrono::milliseconds maxInterval,
+                                                 int unchangedBeforeBackoff)
+    : m_visibleInterval(visibleInterval),
+      m_hiddenInterval(hiddenInterval),
+      m_maxInterval(maxInterval),
+      m_unchangedBeforeBackoff(unchangedBeforeBackoff) {}
+
+void ScreenshotPollScheduler::setInstances(const std::vector<std::string>& instanceIds) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::unordered_map<std::string, Entry> entries;
+    entries.reserve(instanceIds.size());
+    Clock::time_point now = Clock::now();
+    size_t added = 0;
+    for (const auto& id : instanceIds) {
+        if (m_entries.count(id) == 0 && m_visible.count(id) == 0)
+            added++;
+    }
+    // New hidden instances get their first poll spread evenly over one hidden interval,
+    // so the first pass only serves visible ones
+    size_t addedIndex = 0;
+    for (const auto& id : instanceIds) {
+        auto it = m_entries.find(id);
+        if (it != m_entries.end()) {
+            entries.emplace(id, it->second);
+            continue;
+        }
+        Entry e;
+        e.visible = m_visible.count(id) > 0;
+        e.nextDue = now;
+        if (!e.visible)
+            e.nextDue += m_hiddenInterval * static_cast<int64_t>(++addedIndex) /
+                         static_cast<int64_t>(added);
+        entries.emplace(id, e);
+    }
+    m_entries.swap(entries);
+}
+
+void ScreenshotPollScheduler::setVisible(const std::vector<std::string>& instanceIds) {
+    std::unordered_set<std::string> visible(instanceIds.begin(), instanceIds.end());
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_visible.swap(visible);
+    Clock::time_point now = Clock::now();
+    for (auto& kv : m_entries) {
+        Entry& e = kv.second;
+        bool nowVisible = m_visible.count(kv.first) > 0;
+        if (nowVisible && !e.visible)
+            e.nextDue = now;  // scrolled into view: refresh right away
+        e.visible = nowVisible;
+    }
+}
+
+std::vector<std::string> ScreenshotPollScheduler::takeDue(size_t maxCount) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Clock::time_point now = Clock::now();
+    using Candidate = std::pair<const std::string, Entry>*;
+    std::vector<Candidate> visibleDue;
+    std::vector<Candidate> hiddenDue;
+    for (auto& kv : m_entries) {
+        Entry& e = kv.second;
+        if (e.inFlight || e.nextDue > now || intervalOf(e).count() == 0)
+            continue;
+        (e.visible ? visibleDue : hiddenDue).push_back(&kv);
+    }
+
+    std::vector<std::string> due;
+    auto take = [&](std::vector<Candidate>& candidates) {
+        size_t count = std::min(candidates.size(), maxCount - due.size());
+        // Longest overdue first when not all of them fit
+        if (count < candidates.size()) {
+            std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end(),
+                              [](Candidate a, Candidate b) {
+                                  return a->second.nextDue < b->second.nextDue;
+                              });
+        }
+        for (size_t i = 0; i < count; ++i) {
+            candidates[i]->second.inFlight = true;
+            due.push_back(candidates[i]->first);
+            m_issued.push_back(now);
+        }
+    };
+    take(visibleDue);
+    take(hiddenDue);
+    pruneIssued(now);
+    return due;
+}
+
+bool ScreenshotPollScheduler::report(const std::string& instanceId, bool ok, size_t contentHash) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_entries.find(instanceId);
+    if (it == m_entries.end())
+        return ok;
+
+    Entry& e = it->second;
+    bool changed = ok && !(e.hasHash && e.hash == contentHash);
+    if (changed) {
+        e.hash = contentHash;
+        e.hasHash = true;
+    }
+    finish(e, ok, changed);
+    return changed;
+}
+
+void ScreenshotPollScheduler::reportNotModified(const std::string& instanceId) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_entries.find(instanceId);
+    if (it != m_entries.end())
+        finish(it->second, true, false);
+}
+
+ImageFetch::Validators ScreenshotPollScheduler::validators(const std::string& instanceId) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_entries.find(instanceId);
+    return it != m_entries.end() ? it->second.validators : ImageFetch::Validators();
+}
+
+void ScreenshotPollScheduler::setValidators(const std::string& instanceId,
+                                            const ImageFetch::Validators& validators) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_entries.find(instanceId);
+    if (it != m_entries.end())
+        it->second.validators = validators;
+}
+
+void ScreenshotPollScheduler::finish(Entry& e, bool ok, bool changed) {
+    e.inFlight = false;
+    if (ok) {
+        m_completedPolls++;
+        if (changed) {
+            e.unchanged = 0;
+        } else {
+            e.unchanged++;
+            m_skippedDecodes++;
+        }
+    }
+    std::chrono::milliseconds interval = intervalOf(e);
+    e.nextDue = Clock::now() + (interval.count() > 0 ? interval : m_visibleInterval);
+}
+
+ScreenshotPollScheduler::Clock::duration ScreenshotPollScheduler::timeUntilNextDue() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Clock::time_point now = Clock::now();
+    Clock::duration best = Clock::duration::max();
+    for (const auto& kv : m_entries) {
+        const Entry& e = kv.second;
+        if (e.inFlight || intervalOf(e).count() == 0)
+            continue;
+        best = std::min(best, e.nextDue > now ? e.nextDue - now : Clock::duration::zero());
+    }
+    return best;
+}
+
+int ScreenshotPollScheduler::requestsPerMinute() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    pruneIssued(Clock::now());
+    return static_cast<int>(m_issued.size());
+}
+
+size_t ScreenshotPollScheduler::instanceCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_entries.size();
+}
+
+size_t ScreenshotPollScheduler::visibleCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return static_cast<size_t>(std::count_if(m_entries.begin(), m_entries.end(),
+                                             [](const auto& kv) { return kv.second.visible; }));
+}
+
+uint64_t ScreenshotPollScheduler::completedPolls() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_completedPolls;
+}
+
+uint64_t ScreenshotPollScheduler::skippedDecodes() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_skippedDecodes;
+}
+
+void ScreenshotPollScheduler::addDownloadedBytes(size_t bytes) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_downloadedBytes += bytes;
+}
+
+uint64_t ScreenshotPollScheduler::downloadedBytes() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_downloadedBytes;
+}
+
+// static
+size_t ScreenshotPollScheduler::hashContent(const void* data, size_t size) {
+    return std::hash<std::string_view>()(std::string_view(static_cast<const char*>(data), size));
+}
+
+std::chrono::milliseconds ScreenshotPollScheduler::intervalOf(const Entry& e) const {
+    std::chrono::milliseconds base = e.visible ? m_visibleInterval : m_hiddenInterval;
+    if (base.count() == 0)
+        return base;
+
+    int doublings = e.unchanged - m_unchangedBeforeBackoff + 1;
+    if (doublings <= 0)
+        return base;
+    // Cap the shift; maxInterval bounds the result anyway
+    std::chrono::milliseconds interval = base * (1LL << std::min(doublings, 10));
+    return std::min(interval, std::max(m_maxInterval, base));
+}
+
+void ScreenshotPollScheduler::pruneIssued(Clock::time_point now) const {
+    while (!m_issued.empty() && now - m_issued.front() > std::chrono::minutes(1))
+        m_issued.pop_front();
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "utils/ImageFetch.h"
+
+/**
+ * @brief Per-instance screenshot polling schedule.
+ *
+ * Each instance carries its own next-due time instead of being refreshed in
+ * fixed rounds:
+ * - visible instances poll at visibleInterval, hidden ones at hiddenInterval
+ *   (0 disables polling while hidden)
+ * - an instance becoming visible is due immediately
+ * - new instances start hidden, unless the last setVisible() named them, and
+ *   their first hidden poll is spread over one hidden interval, so a fleet
+ *   discovered at once does not turn into one burst of requests
+ * - after unchangedBeforeBackoff polls returning the same image bytes, the
+ *   interval doubles per further unchanged poll, capped at maxInterval
+ * - an instance is never handed out again while its request is in flight
+ *
+ * It also keeps each instance's HTTP validators and content hash, so callers
+ * can send conditional requests and skip decoding/UI updates for unchanged
+ * screenshots.
+ *
+ * Thread-safe: takeDue() and report() may be called from different threads.
+ */
+class ScreenshotPollScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    ScreenshotPollScheduler(std::chrono::milliseconds visibleInterval,
+                            std::chrono::milliseconds hiddenInterval,
+                            std::chrono::milliseconds maxInterval = std::chrono::seconds(30),
+                            int unchangedBeforeBackoff = 3);
+
+    /// Replace the instance set, keeping state for ids that are still present.
+    /// New ids take their visibility from the last setVisible() call.
+    void setInstances(const std::vector<std::string>& instanceIds);
+
+    /// Mark exactly these instances visible; all others become hidden.
+    /// Also remembered for instances added later by setInstances().
+    void setVisible(const std::vector<std::string>& instanceIds);
+
+    /// Up to maxCount instances due now: visible first, then the longest overdue.
+    /// They are marked in flight and counted as issued; the rest stay due.
+    std::vector<std::string> takeDue(size_t maxCount = SIZE_MAX);
+
+    /// Report a finished request. contentHash is only meaningful when ok is true.
+    /// Returns true if the content differs from the last reported one (decode/display it).
+    bool report(const std::string& instanceId, bool ok, size_t contentHash);
+
+    /// Report a 304 response: same as an unchanged hash
+    void reportNotModified(const std::string& instanceId);
+
+    /// Validators from the instance's last successful response (for a conditional GET)
+    ImageFetch::Validators validators(const std::string& instanceId) const;
+    void setValidators(const std::string& instanceId, const ImageFetch::Validators& validators);
+
+    /// Time until the next instance becomes due (Clock::duration::max() if none)
+    Clock::duration timeUntilNextDue() const;
+
+    /// Requests issued during the last 60 seconds
+    int requestsPerMinute() const;
+
+    size_t instanceCount() const;
+    size_t visibleCount() const;
+
+    /// Successful polls since construction, and how many of them were unchanged (decode skipped)
+    uint64_t completedPolls() const;
+    uint64_t skippedDecodes() const;
+
+    /// Screenshot bytes downloaded since construction (callers add after each download)
+    void addDownloadedBytes(size_t bytes);
+    uint64_t downloadedBytes() const;
+
+    /// Stable hash of raw image bytes, for report()
+    static size_t hashContent(const void* data, size_t size);
+
+private:
+    struct Entry {
+        bool visible = false;
+        bool inFlight = false;
+        bool hasHash = false;
+        size_t hash = 0;
+        int unchanged = 0;
+        Clock::time_point nextDue;
+        ImageFetch::Validators validators;
+    };
+
+    // Current interval of an entry; zero means "do not poll"
+    std::chrono::milliseconds intervalOf(const Entry& e) const;
+    void pruneIssued(Clock::time_point now) const;
+    // Finish an in-flight entry; caller holds m_mutex
+    void finish(Entry& e, bool ok, bool changed);
+
+    const std::chrono::milliseconds m_visibleInterval;
+    const std::chrono::milliseconds m_hiddenInterval;
+    const std::chrono::milliseconds m_maxInterval;
+    const int m_unchangedBeforeBackoff;
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::string, Entry> m_entries;
+    std::unordered_set<std::string> m_visible;  // last setVisible() set
+    mutable std::deque<Clock::time_point> m_issued;  // issue times within the last minute
+    uint64_t m_completedPolls = 0;
+    uint64_t m_skippedDecodes = 0;
+    uint64_t m_downloadedBytes = 0;
+};
@@ -0,0 +1,576 @@
+#include "ThumbnailStore.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+
+#ifdef _WIN32
+#include <io.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "utils/Logger.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Pack file: PackHeader, then records {RecordHeader, instanceId, image bytes}
+constexpr uint32_t kPackMagic = 0x4B415054;    // "TPAK"
+constexpr uint32_t kRecordMagic = 0x43455254;  // "TREC"
+constexpr uint32_t kIndexMagic = 0x58444954;   // "TIDX"
+constexpr uint32_t kFormatVersion = 1;
+
+// After a failed compaction, wait until the pack has grown by this much before trying again
+constexpr uint64_t kCompactRetryPercent = 10;
+
+// Rewrite the index after this many appended bytes, so recovery scans stay short
+constexpr uint64_t kIndexFlushBytes = 4 * 1024 * 1024;
+// Instance ids are short; anything longer is corruption
+constexpr uint32_t kMaxKeyLength = 256;
+
+struct PackHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t generation;  // changes on every compaction; the index must match it
+};
+
+struct RecordHeader {
+    uint32_t magic;
+    uint32_t keyLength;
+    uint32_t dataLength;
+    uint32_t checksum;  // FNV-1a over key and data
+    int64_t timestampMs;
+};
+
+struct Record {
+    std::string key;
+    const uint8_t* data = nullptr;
+    uint32_t size = 0;
+    int64_t timestampMs = 0;
+    uint64_t length = 0;  // whole record, header included
+};
+
+uint32_t fnv1a(const uint8_t* data, size_t size, uint32_t hash = 2166136261u) {
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+uint32_t recordChecksum(const std::string& key, const uint8_t* data, size_t size) {
+    return fnv1a(data, size,
+                 fnv1a(reinterpret_cast<const uint8_t*>(key.data()), key.size()));
+}
+
+int64_t nowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+// Parse and verify the record at offset; returns false on a torn or corrupt record
+bool parseRecord(const uint8_t* base, uint64_t available, uint64_t offset, Record* out) {
+    if (offset + sizeof(RecordHeader) > available)
+        return false;
+    RecordHeader header;
+    std::memcpy(&header, base + offset, sizeof(header));
+    if (header.magic != kRecordMagic || header.keyLength == 0 || header.keyLength > kMaxKeyLength)
+        return false;
+    uint64_t length = sizeof(RecordHeader) + uint64_t(header.keyLength) + header.dataLength;
+    if (offset + length > available)
+        return false;
+
+    const uint8_t* keyStart = base + offset + sizeof(RecordHeader);
+    out->key.assign(reinterpret_cast<const char*>(keyStart), header.keyLength);
+    out->data = keyStart + header.keyLength;
+    out->size = header.dataLength;
+    if (recordChecksum(out->key, out->data, out->size) != header.checksum)
+        return false;
+    out->timestampMs = header.timestampMs;
+    out->length = length;
+    return true;
+}
+
+bool writeRecord(FILE* f, const std::string& key, const uint8_t* data, uint32_t size,
+                 int64_t timestampMs) {
+    RecordHeader header{kRecordMagic, static_cast<uint32_t>(key.size()), size,
+                        recordChecksum(key, data, size), timestampMs};
+    return fwrite(&header, sizeof(header), 1, f) == 1 &&
+           fwrite(key.data(), 1, key.size(), f) == key.size() &&
+           fwrite(data, 1, size, f) == size;
+}
+
+// Flush stdio buffers and force the file contents to disk, so a rename never exposes a file
+// whose data is still only in the page cache after a power loss
+bool syncFile(FILE* f) {
+    if (fflush(f) != 0)
+        return false;
+#ifdef _WIN32
+    return FlushFileBuffers(reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(f)))) != 0;
+#else
+    return fsync(fileno(f)) == 0;
+#endif
+}
+
+// Write a file next to its final path and rename it over, so readers never see a partial file
+bool writeFileAtomically(const std::string& path, const std::vector<uint8_t>& bytes) {
+    std::string tmpPath = path + ".tmp";
+    FILE* f = fopen(tmpPath.c_str(), "wb");
+    if (!f)
+        return false;
+    bool ok = fwrite(bytes.data(), 1, bytes.size(), f) == bytes.size();
+    ok = syncFile(f) && ok;
+    ok = (fclose(f) == 0) && ok;
+    std::error_code ec;
+    if (ok)
+        fs::rename(tmpPath, path, ec);
+    if (!ok || ec) {
+        fs::remove(tmpPath, ec);
+        return false;
+    }
+    return true;
+}
+
+template <typename T>
+void append(std::vector<uint8_t>& out, const T& value) {
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(&value);
+    out.insert(out.end(), p, p + sizeof(T));
+}
+
+template <typename T>
+bool take(const std::vector<uint8_t>& in, size_t& pos, T* value) {
+    if (pos + sizeof(T) > in.size())
+        return false;
+    std::memcpy(value, in.data() + pos, sizeof(T));
+    pos += sizeof(T);
+    return true;
+}
+
+}  // namespace
+
+// ==================== MappedFile ====================
+
+/// Read-only mapping of the whole pack file as it was when mapped
+class ThumbnailStore::MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+#ifdef _WIN32
+        m_file = ::CreateFileA(path.c_str(), GENERIC_READ,
+                               FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                               OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (m_file == INVALID_HANDLE_VALUE)
+            return;
+        LARGE_INTEGER size;
+        if (!::GetFileSizeEx(m_file, &size) || size.QuadPart == 0)
+            return;
+        m_mapping = ::CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!m_mapping)
+            return;
+        m_data = static_cast<const uint8_t*>(::MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+        if (m_data)
+            m_size = static_cast<uint64_t>(size.QuadPart);
+#else
+        m_fd = ::open(path.c_str(), O_RDONLY);
+        if (m_fd < 0)
+            return;
+        struct stat st;
+        if (::fstat(m_fd, &st) != 0 || st.st_size == 0)
+            return;
+        void* p = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, m_fd, 0);
+        if (p == MAP_FAILED)
+            return;
+        m_data = static_cast<const uint8_t*>(p);
+        m_size = static_cast<uint64_t>(st.st_size);
+#endif
+    }
+
+    ~MappedFile() {
+#ifdef _WIN32
+        if (m_data)
+            ::UnmapViewOfFile(m_data);
+        if (m_mapping)
+            ::CloseHandle(m_mapping);
+        if (m_file != INVALID_HANDLE_VALUE)
+            ::CloseHandle(m_file);
+#else
+        if (m_data)
+            ::munmap(const_cast<uint8_t*>(m_data), static_cast<size_t>(m_size));
+        if (m_fd >= 0)
+            ::close(m_fd);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const uint8_t* data() const { return m_data; }
+    uint64_t size() const { return m_size; }
+
+private:
+#ifdef _WIN32
+    HANDLE m_file = INVALID_HANDLE_VALUE;
+    HANDLE m_mapping = nullptr;
+#else
+    int m_fd = -1;
+#endif
+    const uint8_t* m_data = nullptr;
+    uint64_t m_size = 0;
+};
+
+// ==================== ThumbnailStore ====================
+
+ThumbnailStore::ThumbnailStore(std::string directory, uint64_t maxBytes)
+    : m_directory(std::move(directory)), m_maxBytes(maxBytes), m_compactAt(maxBytes) {}
+
+ThumbnailStore::~ThumbnailStore() {
+    flush();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    closePack();
+}
+
+bool ThumbnailStore::open() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    closePack();
+    m_index.clear();
+
+    std::error_code ec;
+    fs::create_directories(m_directory, ec);
+
+    uint64_t fileSize = fs::exists(packPath(), ec) ? fs::file_size(packPath(), ec) : 0;
+    if (ec)
+        fileSize = 0;
+
+    remap();
+    PackHeader header{};
+    bool validPack = m_mapping && m_mapping->size() >= sizeof(PackHeader);
+    if (validPack) {
+        std::memcpy(&header, m_mapping->data(), sizeof(header));
+        validPack = header.magic == kPackMagic && header.version == kFormatVersion;
+    }
+
+    if (!validPack) {
+        // Missing or unreadable pack: start a new one
+        if (fileSize > 0)
+            Logger::warning("[ThumbnailStore] discarding unreadable pack " + packPath());
+        m_mapping.reset();
+        PackHeader fresh{kPackMagic, kFormatVersion, static_cast<uint64_t>(nowMs())};
+        std::vector<uint8_t> bytes;
+        append(bytes, fresh);
+        if (!writeFileAtomically(packPath(), bytes)) {
+            Logger::warning("[ThumbnailStore] cannot create " + packPath());
+            return false;
+        }
+        fs::remove(indexPath(), ec);
+        fileSize = sizeof(PackHeader);
+        m_packSize = sizeof(PackHeader);
+        m_indexedSize = 0;
+        remap();
+    } else {
+        // Trust the index for the prefix it covers, recover everything appended after it
+        if (!loadIndex() || m_packSize > fileSize) {
+            m_index.clear();
+            m_packSize = sizeof(PackHeader);
+            m_indexedSize = 0;
+        }
+        scanPack(m_packSize);
+    }
+
+    // Cut off a torn tail left by a crash during put()
+    if (m_packSize < fileSize) {
+        Logger::warning("[ThumbnailStore] truncating " + std::to_string(fileSize - m_packSize) +
+                        " bytes of incomplete records");
+        m_mapping.reset();
+        fs::resize_file(packPath(), m_packSize, ec);
+        if (ec) {
+            Logger::warning("[ThumbnailStore] truncate failed: " + ec.message());
+            return false;
+        }
+        remap();
+    }
+
+    m_pack = fopen(packPath().c_str(), "ab");
+    if (!m_pack) {
+        Logger::warning("[ThumbnailStore] cannot open " + packPath() + " for writing");
+        return false;
+    }
+
+    if (m_packSize > m_compactAt)
+        compact();
+    else if (m_indexedSize != m_packSize)
+        writeIndex();
+
+    Logger::info("[ThumbnailStore] opened " + packPath() + ": " + std::to_string(m_index.size()) +
+                 " thumbnails, " + std::to_string(m_packSize) + " bytes");
+    return true;
+}
+
+ThumbnailStore::Thumbnail ThumbnailStore::get(const std::string& instanceId) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_index.find(instanceId);
+    if (it == m_index.end())
+        return {};
+
+    const IndexEntry& entry = it->second;
+    uint64_t end = entry.offset + sizeof(RecordHeader) + instanceId.size() + entry.size;
+    if (!m_mapping || end > m_mapping->size())
+        remap();  // the record was appended after the current mapping was made
+    if (!m_mapping)
+        return {};
+
+    Record record;
+    if (!parseRecord(m_mapping->data(), m_mapping->size(), entry.offset, &record) ||
+        record.key != instanceId) {
+        Logger::warning("[ThumbnailStore] dropping corrupt thumbnail for " + instanceId);
+        m_index.erase(it);
+        return {};
+    }
+
+    Thumbnail thumbnail;
+    thumbnail.mapping = m_mapping;
+    thumbnail.data = record.data;
+    thumbnail.size = record.size;
+    thumbnail.timestampMs = record.timestampMs;
+    return thumbnail;
+}
+
+bool ThumbnailStore::put(const std::string& instanceId, const uint8_t* data, size_t size) {
+    if (instanceId.empty() || instanceId.size() > kMaxKeyLength || !data || size == 0 ||
+        size > std::numeric_limits<uint32_t>::max())
+        return false;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_pack)
+        return false;
+
+    int64_t timestamp = nowMs();
+    if (!writeRecord(m_pack, instanceId, data, static_cast<uint32_t>(size), timestamp) ||
+        fflush(m_pack) != 0) {
+        // The tail may be partial now; stop writing and let the next open() cut it off
+        Logger::warning("[ThumbnailStore] write failed, disabling thumbnail persistence");
+        closePack();
+        return false;
+    }
+
+    IndexEntry& entry = m_index[instanceId];
+    entry.offset = m_packSize;
+    entry.size = static_cast<uint32_t>(size);
+    entry.timestampMs = timestamp;
+    m_packSize += sizeof(RecordHeader) + instanceId.size() + size;
+
+    if (m_packSize > m_compactAt)
+        compact();
+    else if (m_packSize - m_indexedSize >= kIndexFlushBytes)
+        writeIndex();
+    return true;
+}
+
+void ThumbnailStore::flush() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_pack && m_indexedSize != m_packSize)
+        writeIndex();
+}
+
+size_t ThumbnailStore::count() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_index.size();
+}
+
+bool ThumbnailStore::loadIndex() {
+    FILE* f = fopen(indexPath().c_str(), "rb");
+    if (!f)
+        return false;
+    std::vector<uint8_t> bytes;
+    uint8_t buf[64 * 1024];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+        bytes.insert(bytes.end(), buf, buf + n);
+    fclose(f);
+
+    // Trailing checksum covers everything before it
+    if (bytes.size() < sizeof(uint32_t))
+        return false;
+    uint32_t storedChecksum;
+    std::memcpy(&storedChecksum, bytes.data() + bytes.size() - sizeof(uint32_t),
+                sizeof(storedChecksum));
+    bytes.resize(bytes.size() - sizeof(uint32_t));
+    if (fnv1a(bytes.data(), bytes.size()) != storedChecksum)
+        return false;
+
+    size_t pos = 0;
+    uint32_t magic = 0, version = 0, count = 0;
+    uint64_t generation = 0, covered = 0;
+    if (!take(bytes, pos, &magic) || !take(bytes, pos, &version) ||
+        !take(bytes, pos, &generation) || !take(bytes, pos, &covered) ||
+        !take(bytes, pos, &count) || magic != kIndexMagic || version != kFormatVersion)
+        return false;
+
+    // The index belongs to one pack generation; a compacted pack invalidates it
+    PackHeader header;
+    std::memcpy(&header, m_mapping->data(), sizeof(header));
+    if (generation != header.generation)
+        return false;
+
+    std::unordered_map<std::string, IndexEntry> index;
+    index.reserve(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t keyLength = 0;
+        if (!take(bytes, pos, &keyLength) || keyLength > kMaxKeyLength ||
+            pos + keyLength > bytes.size())
+            return false;
+        std::string key(reinterpret_cast<const char*>(bytes.data() + pos), keyLength);
+        pos += keyLength;
+        IndexEntry entry;
+        if (!take(bytes, pos, &entry.offset) || !take(bytes, pos, &entry.size) ||
+            !take(bytes, pos, &entry.timestampMs) || entry.offset + entry.size > covered)
+            return false;
+        index[key] = entry;
+    }
+
+    m_index.swap(index);
+    m_packSize = covered;
+    m_indexedSize = covered;
+    return true;
+}
+
+void ThumbnailStore::scanPack(uint64_t from) {
+    if (!m_mapping)
+        return;
+    uint64_t offset = from;
+    Record record;
+    while (parseRecord(m_mapping->data(), m_mapping->size(), offset, &record)) {
+        IndexEntry& entry = m_index[record.key];
+        entry.offset = offset;
+        entry.size = record.size;
+        entry.timestampMs = record.timestampMs;
+        offset += record.length;
+    }
+    if (offset > from)
+        Logger::info("[ThumbnailStore] recovered " + std::to_string(offset - from) +
+                     " bytes of records not in the index");
+    m_packSize = offset;
+}
+
+bool ThumbnailStore::writeIndex() {
+    if (!m_mapping || m_mapping->size() < sizeof(PackHeader))
+        remap();
+    if (!m_mapping)
+        return false;
+    PackHeader header;
+    std::memcpy(&header, m_mapping->data(), sizeof(header));
+
+    std::vector<uint8_t> bytes;
+    append(bytes, kIndexMagic);
+    append(bytes, kFormatVersion);
+    append(bytes, header.generation);
+    append(bytes, m_packSize);
+    append(bytes, static_cast<uint32_t>(m_index.size()));
+    for (const auto& kv : m_index) {
+        append(bytes, static_cast<uint32_t>(kv.first.size()));
+        bytes.insert(bytes.end(), kv.first.begin(), kv.first.end());
+        append(bytes, kv.second.offset);
+        append(bytes, kv.second.size);
+        append(bytes, kv.second.timestampMs);
+    }
+    append(bytes, fnv1a(bytes.data(), bytes.size()));
+
+    if (!writeFileAtomically(indexPath(), bytes)) {
+        Logger::warning("[ThumbnailStore] failed to write " + indexPath());
+        return false;
+    }
+    m_indexedSize = m_packSize;
+    return true;
+}
+
+bool ThumbnailStore::compact() {
+    remap();
+    if (!m_mapping)
+        return false;
+
+    // Newest first; keep instances until half the budget is used so compaction stays rare
+    std::vector<std::pair<std::string, IndexEntry>> entries(m_index.begin(), m_index.end());
+    std::sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) {
+        return a.second.timestampMs > b.second.timestampMs;
+    });
+
+    std::string tmpPath = packPath() + ".tmp";
+    FILE* f = fopen(tmpPath.c_str(), "wb");
+    if (!f)
+        return false;
+
+    PackHeader header{kPackMagic, kFormatVersion, static_cast<uint64_t>(nowMs())};
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1;
+    uint64_t size = sizeof(PackHeader);
+    std::unordered_map<std::string, IndexEntry> index;
+    for (const auto& kv : entries) {
+        Record record;
+        if (!ok || !parseRecord(m_mapping->data(), m_mapping->size(), kv.second.offset, &record))
+            continue;
+        if (size + record.length > m_maxBytes / 2)
+            break;
+        ok = writeRecord(f, record.key, record.data, record.size, record.timestampMs);
+        index[record.key] = IndexEntry{size, record.size, record.timestampMs};
+        size += record.length;
+    }
+    ok = syncFile(f) && ok;
+    ok = (fclose(f) == 0) && ok;
+
+    // Readers holding the old mapping keep it alive; on Windows that can make the rename fail,
+    // in which case we keep appending to the old pack and retry only after it has grown by
+    // another kCompactRetryPercent, instead of rewriting the whole pack on every put()
+    closePack();
+    std::error_code ec;
+    if (ok)
+        fs::rename(tmpPath, packPath(), ec);
+    if (!ok || ec) {
+        fs::remove(tmpPath, ec);
+        m_compactAt = m_packSize + m_packSize * kCompactRetryPercent / 100;
+        Logger::warning("[ThumbnailStore] compaction failed, keeping the current pack until it reaches " +
+                        std::to_string(m_compactAt) + " bytes");
+        m_pack = fopen(packPath().c_str(), "ab");
+        remap();
+        return false;
+    }
+
+    Logger::info("[ThumbnailStore] compacted " + std::to_string(m_packSize) + " -> " +
+                 std::to_string(size) + " bytes, kept " + std::to_string(index.size()) + "/" +
+                 std::to_string(m_index.size()) + " thumbnails");
+    m_index.swap(index);
+    m_packSize = size;
+    m_indexedSize = 0;
+    m_compactAt = m_maxBytes;
+    m_pack = fopen(packPath().c_str(), "ab");
+    remap();
+    writeIndex();
+    return m_pack != nullptr;
+}
+
+bool ThumbnailStore::remap() {
+    auto mapping = std::make_shared<const MappedFile>(packPath());
+    m_mapping = mapping->data() ? std::move(mapping) : nullptr;
+    return m_mapping != nullptr;
+}
+
+void ThumbnailStore::closePack() {
+    if (m_pack) {
+        fclose(m_pack);
+        m_pack = nullptr;
+    }
+    m_mapping.reset();
+}
+
+std::string ThumbnailStore::packPath() const {
+    return (fs::path(m_directory) / "thumbnails.pack").string();
+}
+
+std::string ThumbnailStore::indexPath() const {
+    return (fs::path(m_directory) / "thumbnails.idx").string();
+}
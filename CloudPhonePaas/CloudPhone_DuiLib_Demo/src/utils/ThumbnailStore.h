@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Persistent, size-bounded store of the last screenshot per instance.
+ *
+ * Lets the instance grid show last-known thumbnails as soon as the cards exist,
+ * before the first screenshot round has finished.
+ *
+ * On-disk layout (in one directory):
+ * - thumbnails.pack: append-only records {header, instanceId, image bytes}; each
+ *   header carries a magic, the lengths, a timestamp and a checksum
+ * - thumbnails.idx:  snapshot of the newest record per instance plus how much of
+ *   the pack it covers; written to a temp file and renamed over the old one
+ *
+ * Crash safety: a put() only appends to the pack. On open, records after the
+ * indexed prefix are recovered by scanning, and a torn or corrupt tail is cut
+ * off. A missing or damaged index falls back to scanning the whole pack.
+ *
+ * Reads go through a read-only memory mapping of the pack; a Thumbnail keeps
+ * its mapping alive, so its bytes stay valid until it is released.
+ *
+ * When the pack grows past maxBytes it is compacted to the newest record per
+ * instance, dropping the oldest instances if that is still over half the budget.
+ * If the compacted pack cannot replace the old one (mapped by a reader on Windows),
+ * the next attempt waits until the pack has grown by another 10%.
+ *
+ * Thread-safe.
+ */
+class ThumbnailStore {
+public:
+    class MappedFile;
+
+    struct Thumbnail {
+        std::shared_ptr<const MappedFile> mapping;  ///< keeps data valid
+        const uint8_t* data = nullptr;
+        size_t size = 0;
+        int64_t timestampMs = 0;  ///< when the screenshot was stored (ms since epoch)
+
+        explicit operator bool() const { return data != nullptr; }
+    };
+
+    static constexpr uint64_t kDefaultMaxBytes = 64ull * 1024 * 1024;
+
+    explicit ThumbnailStore(std::string directory, uint64_t maxBytes = kDefaultMaxBytes);
+    ~ThumbnailStore();
+
+    ThumbnailStore(const ThumbnailStore&) = delete;
+    ThumbnailStore& operator=(const ThumbnailStore&) = delete;
+
+    /// Open (or create) the store and recover its index. Returns false if unusable.
+    bool open();
+
+    /// Newest thumbnail for an instance; empty if none is stored
+    Thumbnail get(const std::string& instanceId);
+
+    /// Append a thumbnail for an instance (replaces the previous one)
+    bool put(const std::string& instanceId, const uint8_t* data, size_t size);
+
+    /// Write the index so the next open() does not have to rescan appended records
+    void flush();
+
+    size_t count() const;
+
+private:
+    struct IndexEntry {
+        uint64_t offset = 0;  ///< start of the record in the pack
+        uint32_t size = 0;
+        int64_t timestampMs = 0;
+    };
+
+    // Caller holds m_mutex for all of these
+    bool loadIndex();
+    void scanPack(uint64_t from);
+    bool writeIndex();
+    bool compact();
+    bool remap();
+    void closePack();
+
+    std::string packPath() const;
+    std::string indexPath() const;
+
+    const std::string m_directory;
+    const uint64_t m_maxBytes;
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::string, IndexEntry> m_index;
+    FILE* m_pack = nullptr;          ///< opened for append
+    uint64_t m_packSize = 0;         ///< bytes of valid records
+    uint64_t m_indexedSize = 0;      ///< pack prefix covered by the index file on disk
+    uint64_t m_compactAt;            ///< compact once the pack exceeds this; raised after a failed attempt
+    std::shared_ptr<const MappedFile> m_mapping;
+};
@@ -8,7 +8,26 @@
 AndroidInstanceModel::AndroidInstanceModel(ApiService* apiService,
                                            BatchTaskOperator* batchOperator,
                                            NetworkService* networkService)
-    : m_apiService(apiService), m_batchOperator(batchOperator), m_networkService(networkService) {
+    : m_apiService(apiService),
+      m_batchOperator(batchOperator),
+      m_networkService(networkService),
+      m_imageDownloader(std::make_unique<InstanceImageDownloader>(batchOperator, networkService)) {
+    // Created up front so the UI thread can forward visibility and card size at any time;
+    // polling starts once TcrSdk is ready
+    m_imageDownloader->onImageDownloaded =
+        [this](const std::string& instanceId, const std::vector<uint8_t>& imageData) {
+            m_imageCache.put(instanceId, imageData);
+            ImageCache::Stats stats = m_imageCache.stats();
+            Logger::debug("Image cached for " + instanceId + " (" +
+                          std::to_string(imageData.size()) + " bytes), cache " +
+                          std::to_string(stats.entries) + " entries / " +
+                          std::to_string(stats.bytes) + " bytes, hits " +
+                          std::to_string(stats.hits) + ", misses " +
+                          std::to_string(stats.misses) + ", evictions " +
+                          std::to_string(stats.evictions));
+            if (onImageDownloaded)
+                onImageDownloaded(instanceId, imageData);
+        };
     Logger::info("AndroidInstanceModel initialized");
 }
 
@@ -92,30 +111,23 @@ void AndroidInstanceModel::startImageDownloading() {
     if (!m_batchOperator)
         return;
 
-    // Collect first 10 instance IDs
+    // All instances: the downloader polls visible cards first and hidden ones rarely
     std::vector<std::string> ids;
-    size_t count = std::min(m_instances.size(), static_cast<size_t>(10));
-    for (size_t i = 0; i < count; ++i) {
-        ids.push_back(m_instances[i].AndroidInstanceId);
-    }
+    ids.reserve(m_instances.size());
+    for (const auto& inst : m_instances)
+        ids.push_back(inst.AndroidInstanceId);
 
     if (ids.empty())
         return;
 
-    if (!m_imageDownloader) {
-        m_imageDownloader =
-            std::make_unique<InstanceImageDownloader>(m_batchOperator, m_networkService);
-
-        m_imageDownloader->onImageDownloaded =
-            [this](const std::string& instanceId, const std::vector<uint8_t>& imageData) {
-                m_imageCache.put(instanceId, imageData);
-                Logger::debug("Image cached for " + instanceId + " (" +
-                              std::to_string(imageData.size()) + " bytes)");
-                if (onImageDownloaded)
-                    onImageDownloaded(instanceId, imageData);
-            };
-    }
-
     m_imageDownloader->startDownloading(ids);
     Logger::info("Started image downloading for " + std::to_string(ids.size()) + " instances");
 }
+
+void AndroidInstanceModel::setVisibleInstances(const std::vector<std::string>& instanceIds) {
+    m_imageDownloader->setVisibleInstances(instanceIds);
+}
+
+void AndroidInstanceModel::setScreenshotSpec(const ScreenshotSizePolicy::Spec& spec) {
+    m_imageDownloader->setScreenshotSpec(spec);
+}
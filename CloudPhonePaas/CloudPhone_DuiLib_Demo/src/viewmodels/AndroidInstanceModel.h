@@ -7,6 +7,7 @@
 #include <string>
 #include <vector>
 
+#include "core/ScreenshotSizePolicy.h"
 #include "services/ApiService.h"
 #include "utils/ImageCache.h"
 #include "utils/InstanceImageDownloader.h"
@@ -43,6 +44,12 @@ public:
     std::function<void(const std::string& instanceId, const std::vector<uint8_t>& imageData)>
         onImageDownloaded;
 
+    /// Forward on-screen instances to the background screenshot downloader (UI thread)
+    void setVisibleInstances(const std::vector<std::string>& instanceIds);
+
+    /// Forward the grid's screenshot size/quality to the background downloader (UI thread)
+    void setScreenshotSpec(const ScreenshotSizePolicy::Spec& spec);
+
     /// Access the image cache
     ImageCache& imageCache() { return m_imageCache; }
 
@@ -51,8 +58,8 @@ private:
     BatchTaskOperator* m_batchOperator;
     NetworkService* m_networkService;
     std::vector<AndroidInstance> m_instances;
+    ImageCache m_imageCache;  // declared first: outlives the downloader's in-flight callbacks
     std::unique_ptr<InstanceImageDownloader> m_imageDownloader;
-    ImageCache m_imageCache;
 
     void onInstancesReceived(bool success, const std::vector<AndroidInstance>& instances,
                              int totalCount, const std::string& error);
@@ -1,15 +1,15 @@
 #include "MainWindow.h"
 
-#include <thread>
+#include <filesystem>
 
-#include <curl/curl.h>
 #include <windows.h>
 
 #include "core/BatchTaskOperator.h"
+#include "core/ScreenshotSizePolicy.h"
 #include "services/ApiService.h"
-#include "tcr_c_api.h"
 #include "utils/Logger.h"
 #include "utils/StringUtils.h"
+#include "utils/ThumbnailStore.h"
 #include "utils/UiThreadHelper.h"
 #include "viewmodels/AndroidInstanceModel.h"
 #include "viewmodels/BatchTaskOperatorModel.h"
@@ -22,16 +22,20 @@
 #define WM_INSTANCE_CARD_CLICKED (WM_USER + 200)
 #define WM_INSTANCE_CHECK_CHANGED (WM_USER + 201)
 
-// ---- curl write callback (for image download) ----
-static size_t curlWriteCallback(char* ptr, size_t size, size_t nmemb, void* userdata) {
-    auto* buf = reinterpret_cast<std::vector<char>*>(userdata);
-    buf->insert(buf->end(), ptr, ptr + size * nmemb);
-    return size * nmemb;
-}
-
 MainWindow::MainWindow(ApiService* apiService, AndroidInstanceModel* instanceModel,
                        BatchTaskOperator* batchOperator)
     : m_apiService(apiService), m_instanceModel(instanceModel), m_batchOperator(batchOperator) {
+    m_screenshotSlots = std::make_shared<ScreenshotSlots>();
+
+    // Thumbnails live next to the executable, like the logs
+    wchar_t exePath[MAX_PATH] = {};
+    ::GetModuleFileNameW(nullptr, exePath, MAX_PATH);
+    std::string thumbnailDir =
+        (std::filesystem::path(exePath).parent_path() / "thumbnails").string();
+    m_thumbnailStore = std::make_shared<ThumbnailStore>(thumbnailDir);
+    if (!m_thumbnailStore->open())
+        Logger::warning("Thumbnail store unavailable, starting with empty cards");
+
     m_batchModel = new BatchTaskOperatorModel(batchOperator);
     m_batchModel->onShowDialog = [this](const std::string& title, const std::string& msg) {
         showResultDialog(title, msg);
@@ -40,6 +44,7 @@ MainWindow::MainWindow(ApiService* apiService, AndroidInstanceModel* instanceMod
 
 MainWindow::~MainWindow() {
     ::KillTimer(GetHWND(), TIMER_SCREENSHOT);
+    m_thumbnailStore->flush();
     delete m_batchModel;
 }
 
@@ -85,42 +90,13 @@ void MainWindow::InitWindow() {
         });
     };
 
-    // Handle images downloaded by InstanceImageDownloader (from AndroidInstanceModel)
+    // Screenshots polled by the model's InstanceImageDownloader (the only screenshot scheduler);
+    // only changed images arrive here, on the ImageFetch pool thread
+    std::shared_ptr<ThumbnailStore> store = m_thumbnailStore;
+    std::shared_ptr<ScreenshotSlots> slots = m_screenshotSlots;
     m_instanceModel->onImageDownloaded =
-        [hwnd](const std::string& instanceId, const std::vector<uint8_t>& imageData) {
-            // Save to temp file and update UI on main thread
-            if (imageData.empty())
-                return;
-
-            // Write to temp file
-            char tempDir[MAX_PATH] = {};
-            ::GetTempPathA(MAX_PATH, tempDir);
-            std::string path = std::string(tempDir) + "cai_dl_" + instanceId + ".jpg";
-
-            FILE* f = fopen(path.c_str(), "wb");
-            if (!f)
-                return;
-            fwrite(imageData.data(), 1, imageData.size(), f);
-            fclose(f);
-
-            std::string capturedId = instanceId;
-            std::string capturedPath = path;
-            UiThreadHelper::postToUiThread(hwnd, [hwnd, capturedId, capturedPath]() {
-                MainWindow* self =
-                    reinterpret_cast<MainWindow*>(::GetWindowLongPtr(hwnd, GWLP_USERDATA));
-                if (!self || !self->m_tileInstances)
-                    return;
-
-                std::wstring ctrlName = L"img_" + StringUtils::Utf8ToWide(capturedId);
-                CControlUI* imgCtrl = self->m_PaintManager.FindControl(ctrlName.c_str());
-                if (!imgCtrl)
-                    return;
-
-                imgCtrl->SetBkImage(L"");
-                std::wstring wPath = StringUtils::Utf8ToWide(capturedPath);
-                imgCtrl->SetBkImage(wPath.c_str());
-                imgCtrl->Invalidate();
-            });
+        [hwnd, store, slots](const std::string& instanceId, const std::vector<uint8_t>& imageData) {
+            handleScreenshot(instanceId, imageData, hwnd, *store, *slots);
         };
 
     // Trigger initial instance fetch (login already succeeded)
@@ -129,111 +105,155 @@ void MainWindow::InitWindow() {
 
 void MainWindow::startScreenshotTimer() {
     m_tcrSdkReady.store(true);
-    Logger::info("TcrSdk ready — starting screenshot polling (2s interval)");
-    ::SetTimer(GetHWND(), TIMER_SCREENSHOT, 2000, nullptr);
-    // Fetch immediately without waiting for first tick
-    fetchAndUpdateScreenshots();
+    Logger::info("TcrSdk ready — tracking visible cards for screenshot polling");
+    ::SetTimer(GetHWND(), TIMER_SCREENSHOT, SCREENSHOT_TICK_MS, nullptr);
+    // Report the visible cards without waiting for the first tick
+    updateVisibleScreenshots();
 }
 
-void MainWindow::fetchAndUpdateScreenshots() {
+void MainWindow::updateVisibleScreenshots() {
     if (!m_tcrSdkReady.load())
         return;
 
-    const auto& instances = m_instanceModel->instances();
-    if (instances.empty())
+    if (m_instanceModel->instances().empty())
         return;
 
-    // Collect instance IDs for the worker thread
-    std::vector<std::string> ids;
-    for (const auto& inst : instances)
-        ids.push_back(inst.AndroidInstanceId);
+    std::vector<std::string> visibleIds = visibleInstanceIds();
+    m_instanceModel->setVisibleInstances(visibleIds);
+    updateScreenshotSpec(visibleIds);
+}
 
-    HWND hwnd = GetHWND();
-    int slot = m_screenshotSlot.fetch_xor(1);  // toggle 0->1->0 each poll round
+int MainWindow::ScreenshotSlots::next(const std::string& instanceId) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return current[instanceId] ^= 1;
+}
+
+// static
+void MainWindow::handleScreenshot(const std::string& instanceId,
+                                  const std::vector<uint8_t>& imageData, HWND hwnd,
+                                  ThumbnailStore& store, ScreenshotSlots& slots) {
+    if (imageData.empty())
+        return;
+
+    store.put(instanceId, imageData.data(), imageData.size());
+    int slot = slots.next(instanceId);
+    std::string tempPath = writeTempFile(imageData.data(), imageData.size(), instanceId, slot);
+    if (tempPath.empty()) {
+        Logger::warning("Failed to write screenshot for " + instanceId);
+        return;
+    }
 
-    std::thread([ids, hwnd, slot]() {
-        TcrClientHandle client = tcr_client_get_instance();
-        TcrAndroidInstance androidInst = tcr_client_get_android_instance(client);
-        if (!androidInst) {
-            Logger::warning("tcr_client_get_android_instance returned null — TcrSdk not ready?");
+    // Post to UI thread to update the image control
+    std::string capturedId = instanceId;
+    std::string capturedPath = tempPath;
+    UiThreadHelper::postToUiThread(hwnd, [hwnd, capturedId, capturedPath]() {
+        MainWindow* self =
+            reinterpret_cast<MainWindow*>(::GetWindowLongPtr(hwnd, GWLP_USERDATA));
+        if (!self || !self->m_tileInstances)
+            return;
+
+        std::wstring ctrlName = L"img_" + StringUtils::Utf8ToWide(capturedId);
+        CControlUI* imgCtrl = self->m_PaintManager.FindControl(ctrlName.c_str());
+        if (!imgCtrl) {
+            Logger::debug("Image control not found: " + StringUtils::WideToUtf8(ctrlName));
             return;
         }
 
-        for (const auto& instanceId : ids) {
-            char urlBuf[1024] = {};
-            bool ok = tcr_instance_get_image(androidInst, urlBuf, sizeof(urlBuf),
-                                             instanceId.c_str(), 144, 256, 60);
-            if (!ok || urlBuf[0] == '\0') {
-                Logger::debug("tcr_instance_get_image failed for " + instanceId);
-                continue;
-            }
+        // Log control rect for diagnosis
+        RECT rc = imgCtrl->GetPos();
+        Logger::info("imgCtrl rect: (" + std::to_string(rc.left) + "," + std::to_string(rc.top) +
+                     ") -> (" + std::to_string(rc.right) + "," + std::to_string(rc.bottom) +
+                     ")  size=" + std::to_string(rc.right - rc.left) + "x" +
+                     std::to_string(rc.bottom - rc.top));
+        Logger::info("SetBkImage path: " + capturedPath);
+
+        // Clear previous image first to force DuiLib reload
+        imgCtrl->SetBkImage(L"");
+        std::wstring wPath = StringUtils::Utf8ToWide(capturedPath);
+        imgCtrl->SetBkImage(wPath.c_str());
+        imgCtrl->Invalidate();
+        Logger::debug("Screenshot updated for " + capturedId);
+    });
+}
 
-            std::string url(urlBuf);
+void MainWindow::updateScreenshotSpec(const std::vector<std::string>& visibleIds) {
+    if (visibleIds.empty())
+        return;
 
-            std::string tempPath = downloadToTempFile(url, instanceId, slot);
-            if (tempPath.empty()) {
-                Logger::warning("Failed to download screenshot for " + instanceId);
-                continue;
-            }
+    // All cards share one size; control rects are already in physical pixels
+    std::wstring ctrlName = L"img_" + StringUtils::Utf8ToWide(visibleIds.front());
+    CControlUI* imgCtrl = m_PaintManager.FindControl(ctrlName.c_str());
+    if (!imgCtrl)
+        return;
+    RECT rc = imgCtrl->GetPos();
+    if (rc.right <= rc.left || rc.bottom <= rc.top)
+        return;
 
-            // Post to UI thread to update the image control
-            std::string capturedId = instanceId;
-            std::string capturedPath = tempPath;
-            UiThreadHelper::postToUiThread(hwnd, [hwnd, capturedId, capturedPath]() {
-                MainWindow* self =
-                    reinterpret_cast<MainWindow*>(::GetWindowLongPtr(hwnd, GWLP_USERDATA));
-                if (!self || !self->m_tileInstances)
-                    return;
-
-                std::wstring ctrlName = L"img_" + StringUtils::Utf8ToWide(capturedId);
-                CControlUI* imgCtrl = self->m_PaintManager.FindControl(ctrlName.c_str());
-                if (!imgCtrl) {
-                    Logger::debug("Image control not found: " +
-                                  StringUtils::WideToUtf8(ctrlName));
-                    return;
-                }
-
-                // Log control rect for diagnosis
-                RECT rc = imgCtrl->GetPos();
-                Logger::info("imgCtrl rect: (" + std::to_string(rc.left) + "," +
-                             std::to_string(rc.top) + ") -> (" +
-                             std::to_string(rc.right) + "," + std::to_string(rc.bottom) +
-                             ")  size=" + std::to_string(rc.right - rc.left) + "x" +
-                             std::to_string(rc.bottom - rc.top));
-                Logger::info("SetBkImage path: " + capturedPath);
-
-                // Clear previous image first to force DuiLib reload
-                imgCtrl->SetBkImage(L"");
-                std::wstring wPath = StringUtils::Utf8ToWide(capturedPath);
-                imgCtrl->SetBkImage(wPath.c_str());
-                imgCtrl->Invalidate();
-                Logger::debug("Screenshot updated for " + capturedId);
-            });
-        }
-    }).detach();
+    ScreenshotSizePolicy::Spec spec =
+        ScreenshotSizePolicy::forTile(rc.right - rc.left, rc.bottom - rc.top);
+    if (spec == m_screenshotSpec)
+        return;
+    m_screenshotSpec = spec;
+    m_instanceModel->setScreenshotSpec(spec);
+    Logger::info("Screenshot size: " + std::to_string(spec.width) + "x" +
+                 std::to_string(spec.height) + " q" + std::to_string(spec.quality));
 }
 
-// static
-std::string MainWindow::downloadToTempFile(const std::string& url,
-                                            const std::string& instanceId, int slot) {
-    CURL* curl = curl_easy_init();
-    if (!curl)
-        return {};
-
-    std::vector<char> buf;
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, curlWriteCallback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &buf);
-    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 5L);
-    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+std::vector<std::string> MainWindow::visibleInstanceIds() {
+    std::vector<std::string> ids;
+    if (!m_tileInstances || ::IsIconic(GetHWND()) || !::IsWindowVisible(GetHWND()))
+        return ids;
+
+    RECT view = m_tileInstances->GetPos();
+    for (int i = 0; i < m_tileInstances->GetCount(); ++i) {
+        CControlUI* card = m_tileInstances->GetItemAt(i);
+        RECT rc = card->GetPos();
+        RECT overlap;
+        if (!card->IsVisible() || !::IntersectRect(&overlap, &rc, &view))
+            continue;
+        // Card name is "card_<id>"
+        std::wstring name(card->GetName().GetData());
+        if (name.find(L"card_") == 0)
+            ids.push_back(StringUtils::WideToUtf8(name.substr(5)));
+    }
+    return ids;
+}
 
-    CURLcode res = curl_easy_perform(curl);
-    curl_easy_cleanup(curl);
+bool MainWindow::showLastThumbnail(const std::string& instanceId) {
+    std::wstring ctrlName = L"img_" + StringUtils::Utf8ToWide(instanceId);
+    CControlUI* imgCtrl = m_PaintManager.FindControl(ctrlName.c_str());
+    if (!imgCtrl)
+        return false;
+
+    // Newest bytes downloaded this session first; the persisted store only covers earlier runs
+    // or instances that fell out of the memory budget
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    ImageCache::BytesPtr cached = m_instanceModel->imageCache().get(instanceId);
+    ThumbnailStore::Thumbnail thumbnail;
+    if (cached && !cached->empty()) {
+        data = cached->data();
+        size = cached->size();
+    } else if ((thumbnail = m_thumbnailStore->get(instanceId))) {
+        data = thumbnail.data;
+        size = thumbnail.size;
+    } else {
+        return false;
+    }
 
-    if (res != CURLE_OK || buf.empty())
-        return {};
+    // Same ping-pong as a polled screenshot, so DuiLib does not reuse a stale decode of the path
+    std::string path =
+        writeTempFile(data, size, instanceId, m_screenshotSlots->next(instanceId));
+    if (path.empty())
+        return false;
+    imgCtrl->SetBkImage(L"");
+    imgCtrl->SetBkImage(StringUtils::Utf8ToWide(path).c_str());
+    return true;
+}
 
+// static
+std::string MainWindow::writeTempFile(const uint8_t* data, size_t size,
+                                      const std::string& instanceId, int slot) {
     // Write to %TEMP%\cai_<instanceId>_<slot>.jpg  (slot 0/1 alternates to bypass DuiLib cache)
     char tempDir[MAX_PATH] = {};
     ::GetTempPathA(MAX_PATH, tempDir);
@@ -242,7 +262,7 @@ std::string MainWindow::downloadToTempFile(const std::string& url,
     FILE* f = fopen(path.c_str(), "wb");
     if (!f)
         return {};
-    fwrite(buf.data(), 1, buf.size(), f);
+    fwrite(data, 1, size, f);
     fclose(f);
 
     return path;
@@ -337,7 +357,7 @@ LRESULT MainWindow::HandleMessage(UINT uMsg, WPARAM wParam, LPARAM lParam) {
         }
     }
     if (uMsg == WM_TIMER && wParam == TIMER_SCREENSHOT) {
-        fetchAndUpdateScreenshots();
+        updateVisibleScreenshots();
         return 0;
     }
     if (uMsg == WM_DESTROY) {
@@ -469,6 +489,13 @@ void MainWindow::rebuildInstanceList() {
         m_tileInstances->Add(card);
     }
 
+    // Last-known screenshots (this session's cache, else previous runs); polling refreshes them
+    size_t restored = 0;
+    for (const auto& inst : instances) {
+        if (showLastThumbnail(inst.AndroidInstanceId))
+            restored++;
+    }
+
     // Restore checkbox state for any instances that were already checked
     for (const auto& checkedId : m_checkedInstanceIds) {
         std::wstring chkName = L"chk_" + StringUtils::Utf8ToWide(checkedId);
@@ -483,11 +510,15 @@ void MainWindow::rebuildInstanceList() {
         m_lblStatus->SetText(statusText.c_str());
     }
 
-    Logger::info("Instance list rebuilt, " + std::to_string(instances.size()) + " cards");
+    ImageCache::Stats cacheStats = m_instanceModel->imageCache().stats();
+    Logger::info("Instance list rebuilt, " + std::to_string(instances.size()) + " cards, " +
+                 std::to_string(restored) + " with last-known thumbnails (image cache hits " +
+                 std::to_string(cacheStats.hits) + ", misses " +
+                 std::to_string(cacheStats.misses) + ")");
 
-    // If TcrSdk is already ready, refresh screenshots immediately for the new cards
+    // If TcrSdk is already ready, tell the downloader which of the new cards are on screen
     if (m_tcrSdkReady.load())
-        fetchAndUpdateScreenshots();
+        updateVisibleScreenshots();
 }
 
 void MainWindow::onInstanceCardClicked(const std::string& instanceId) {
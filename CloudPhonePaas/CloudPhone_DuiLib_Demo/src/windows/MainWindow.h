@@ -1,18 +1,24 @@
 #pragma once
 
 #include <atomic>
+#include <cstdint>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
 #include <UIlib.h>
 
+#include "core/ScreenshotSizePolicy.h"
+
 using namespace DuiLib;
 
 class ApiService;
 class AndroidInstanceModel;
 class BatchTaskOperator;
 class BatchTaskOperatorModel;
+class ThumbnailStore;
 
 // Menu item IDs for batch operations
 #define ID_BATCH_FIRST 40000
@@ -43,9 +49,24 @@ private:
     std::map<std::string, HWND> m_streamingWindowMap;
 
     // Screenshot polling
+    // The model's InstanceImageDownloader is the only scheduler: it polls each instance on its
+    // own interval, visible cards first. The timer only reports the visible cards and card size.
     static constexpr UINT_PTR TIMER_SCREENSHOT = 1001;
+    static constexpr UINT SCREENSHOT_TICK_MS = 500;
     std::atomic<bool> m_tcrSdkReady{false};
-    std::atomic<int> m_screenshotSlot{0};  // ping-pong 0/1 to bypass DuiLib image cache
+    // Ping-pong slot 0/1 per card: each write goes to the other slot so DuiLib's image cache
+    // (keyed by path) does not serve the old picture. Shared with the download callbacks.
+    struct ScreenshotSlots {
+        std::mutex mutex;
+        std::map<std::string, int> current;
+        // Flip to the slot not written last time and return it
+        int next(const std::string& instanceId);
+    };
+    std::shared_ptr<ScreenshotSlots> m_screenshotSlots;
+    // Size/quality requested from tcr_instance_get_image, derived from the card's image area
+    ScreenshotSizePolicy::Spec m_screenshotSpec = ScreenshotSizePolicy::forTile(160, 260);
+    // Last screenshot per instance, persisted across launches; shared with the fetch threads
+    std::shared_ptr<ThumbnailStore> m_thumbnailStore;
 
     void rebuildInstanceList();
     void onInstanceCardClicked(const std::string& instanceId);
@@ -53,11 +74,25 @@ private:
     void openStreamingWindow(const std::string& instanceId);
 
     void startScreenshotTimer();
-    void fetchAndUpdateScreenshots();
-
-    // Download image URL to a temp file, return the file path (empty on failure)
-    static std::string downloadToTempFile(const std::string& url,
-                                          const std::string& instanceId, int slot);
+    // Forward the visible cards and the card size to the model's screenshot downloader
+    void updateVisibleScreenshots();
+    // Instances whose card currently intersects the visible part of the tile layout
+    std::vector<std::string> visibleInstanceIds();
+    // Re-derive m_screenshotSpec from the current card size
+    void updateScreenshotSpec(const std::vector<std::string>& visibleIds);
+    // Show the last-known screenshot on a freshly created card until the first poll replaces it:
+    // the model's in-memory ImageCache first, then the persisted ThumbnailStore
+    bool showLastThumbnail(const std::string& instanceId);
+
+    // ImageFetch pool thread: persist a changed screenshot, write the next slot's temp file and
+    // post the card update
+    static void handleScreenshot(const std::string& instanceId,
+                                 const std::vector<uint8_t>& imageData, HWND hwnd,
+                                 ThumbnailStore& store, ScreenshotSlots& slots);
+
+    // Write image bytes to a temp file, return the file path (empty on failure)
+    static std::string writeTempFile(const uint8_t* data, size_t size,
+                                     const std::string& instanceId, int slot);
 
     // Build a single instance card control
     CContainerUI* createInstanceCard(const std::string& instanceId,
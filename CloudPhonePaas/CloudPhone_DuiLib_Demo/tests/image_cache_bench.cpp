@@ -0,0 +1,149 @@
+/**
+ * @file image_cache_bench.cpp
+ * @brief ImageCache (sharded, shared buffers) vs a single-mutex LRU that copies on get.
+ *
+ * The baseline is what the cache replaced: one mutex around a map of byte vectors,
+ * get() returning a copy. Reader threads stand in for the UI/restore path, one writer
+ * for the screenshot downloader. Std-only:
+ *   ./image_cache_bench [readers] [instances] [imageBytes] [seconds]
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "utils/ImageCache.h"
+
+namespace {
+
+class SingleMutexCache {
+public:
+    explicit SingleMutexCache(size_t budget) : m_budget(budget) {}
+
+    void put(const std::string& key, const std::vector<uint8_t>& data) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_index.find(key);
+        if (it != m_index.end()) {
+            m_bytes -= it->second->second.size();
+            m_lru.erase(it->second);
+            m_index.erase(it);
+        }
+        m_lru.emplace_front(key, data);
+        m_index[key] = m_lru.begin();
+        m_bytes += data.size();
+        while (m_bytes > m_budget && !m_lru.empty()) {
+            m_bytes -= m_lru.back().second.size();
+            m_index.erase(m_lru.back().first);
+            m_lru.pop_back();
+        }
+    }
+
+    std::vector<uint8_t> get(const std::string& key) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_index.find(key);
+        if (it == m_index.end())
+            return {};
+        m_lru.splice(m_lru.begin(), m_lru, it->second);
+        return it->second->second;
+    }
+
+private:
+    using Node = std::pair<std::string, std::vector<uint8_t>>;
+    std::mutex m_mutex;
+    std::list<Node> m_lru;
+    std::unordered_map<std::string, std::list<Node>::iterator> m_index;
+    size_t m_bytes = 0;
+    size_t m_budget;
+};
+
+struct Result {
+    double getsPerSec;
+    double putsPerSec;
+};
+
+template <typename Cache, typename Get>
+Result run(Cache& cache, Get get, int readers, const std::vector<std::string>& keys,
+           size_t imageBytes, double seconds) {
+    std::vector<uint8_t> image(imageBytes, 0x5A);
+    for (const std::string& key : keys)
+        cache.put(key, image);
+
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> gets{0};
+    std::atomic<uint64_t> puts{0};
+    std::vector<std::thread> threads;
+    for (int r = 0; r < readers; ++r) {
+        threads.emplace_back([&, r]() {
+            uint64_t n = 0;
+            size_t checksum = 0;
+            for (size_t i = r; !stop.load(std::memory_order_relaxed); i += 7, ++n)
+                checksum += get(cache, keys[i % keys.size()]);
+            gets += n;
+            if (checksum == 1)
+                std::printf(" ");  // keep the reads
+        });
+    }
+    threads.emplace_back([&]() {
+        uint64_t n = 0;
+        for (size_t i = 0; !stop.load(std::memory_order_relaxed); i += 13, ++n)
+            cache.put(keys[i % keys.size()], image);
+        puts += n;
+    });
+
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    stop = true;
+    for (std::thread& thread : threads)
+        thread.join();
+    return {gets / seconds, puts / seconds};
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    const int readers = argc > 1 ? std::atoi(argv[1]) : 4;
+    const int instances = argc > 2 ? std::atoi(argv[2]) : 1000;
+    const size_t imageBytes = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 16 * 1024;
+    const double seconds = argc > 4 ? std::atof(argv[4]) : 1.0;
+    if (readers <= 0 || instances <= 0 || imageBytes == 0 || seconds <= 0)
+        return 1;
+
+    std::vector<std::string> keys;
+    for (int i = 0; i < instances; ++i)
+        keys.push_back("cai-251197962-" + std::to_string(100000 + i));
+    // Budget holds every image, so the comparison measures locking and copying, not eviction
+    const size_t budget = static_cast<size_t>(instances) * imageBytes * 2;
+
+    ImageCache sharded(budget);
+    Result shardedResult = run(
+        sharded, [](ImageCache& c, const std::string& k) {
+            ImageCache::BytesPtr data = c.get(k);
+            return data ? data->size() : 0;
+        },
+        readers, keys, imageBytes, seconds);
+
+    SingleMutexCache baseline(budget);
+    Result baselineResult = run(
+        baseline, [](SingleMutexCache& c, const std::string& k) { return c.get(k).size(); },
+        readers, keys, imageBytes, seconds);
+
+    ImageCache::Stats stats = sharded.stats();
+    std::printf("%d readers + 1 writer, %d instances, %zu-byte images, %.1f s each\n", readers,
+                instances, imageBytes, seconds);
+    std::printf("  single mutex, copy on get : %12.0f get/s %10.0f put/s\n",
+                baselineResult.getsPerSec, baselineResult.putsPerSec);
+    std::printf("  ImageCache (%zu shards)     : %12.0f get/s %10.0f put/s  (%.1fx gets)\n",
+                ImageCache::kShardCount, shardedResult.getsPerSec, shardedResult.putsPerSec,
+                shardedResult.getsPerSec / baselineResult.getsPerSec);
+    std::printf("  ImageCache stats: %llu hits, %llu misses, %llu evictions\n",
+                static_cast<unsigned long long>(stats.hits),
+                static_cast<unsigned long long>(stats.misses),
+                static_cast<unsigned long long>(stats.evictions));
+    return 0;
+}
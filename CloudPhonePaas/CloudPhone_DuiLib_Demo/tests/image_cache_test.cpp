@@ -0,0 +1,161 @@
+/**
+ * @file image_cache_test.cpp
+ * @brief Checks ImageCache eviction, sharding and statistics.
+ *
+ * Std-only; returns non-zero and prints the failed check on error.
+ */
+
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "utils/ImageCache.h"
+
+namespace {
+
+int g_failures = 0;
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            g_failures++;                                                   \
+        }                                                                   \
+    } while (0)
+
+ImageCache::Bytes bytes(size_t size, uint8_t fill = 0) { return ImageCache::Bytes(size, fill); }
+
+// Keys that land in the same shard as `key`, so a test can fill exactly one shard
+std::vector<std::string> sameShardKeys(const std::string& key, size_t count) {
+    size_t shard = std::hash<std::string>()(key) % ImageCache::kShardCount;
+    std::vector<std::string> keys;
+    for (int i = 0; keys.size() < count; ++i) {
+        std::string candidate = "cai-" + std::to_string(i);
+        if (std::hash<std::string>()(candidate) % ImageCache::kShardCount == shard)
+            keys.push_back(candidate);
+    }
+    return keys;
+}
+
+void testPutGetReplace() {
+    ImageCache cache(ImageCache::kShardCount * 1000);
+    CHECK(cache.get("missing") == nullptr);
+    cache.put("a", bytes(10, 1));
+    ImageCache::BytesPtr first = cache.get("a");
+    CHECK(first && first->size() == 10 && (*first)[0] == 1);
+
+    // Replacing keeps the old buffer alive for the reader holding it
+    cache.put("a", bytes(20, 2));
+    ImageCache::BytesPtr second = cache.get("a");
+    CHECK(second && second->size() == 20 && (*second)[0] == 2);
+    CHECK(first->size() == 10 && (*first)[0] == 1);
+    CHECK(cache.size() == 1);
+    CHECK(cache.stats().bytes == 20);
+
+    cache.remove("a");
+    CHECK(!cache.has("a"));
+    CHECK(cache.stats().bytes == 0);
+}
+
+void testLruEvictionWithinShard() {
+    // 100 bytes per shard: three 40-byte entries in one shard do not fit
+    ImageCache cache(ImageCache::kShardCount * 100);
+    std::vector<std::string> keys = sameShardKeys("x", 3);
+    cache.put(keys[0], bytes(40));
+    cache.put(keys[1], bytes(40));
+    CHECK(cache.get(keys[0]) != nullptr);  // keys[0] is now most recently used
+    cache.put(keys[2], bytes(40));
+
+    CHECK(cache.has(keys[0]));
+    CHECK(!cache.has(keys[1]));
+    CHECK(cache.has(keys[2]));
+    CHECK(cache.stats().evictions == 1);
+    CHECK(cache.stats().bytes == 80);
+
+    // Larger than the shard budget: not stored, and nothing else is evicted for it
+    cache.put(keys[1], bytes(101));
+    CHECK(!cache.has(keys[1]));
+    CHECK(cache.size() == 2);
+
+    // Shrinking the budget evicts the least recently used entry
+    cache.setBudget(ImageCache::kShardCount * 50);
+    CHECK(cache.size() == 1);
+    CHECK(cache.stats().evictions == 2);
+}
+
+void testShardsAreIndependent() {
+    // Filling one shard past its budget must not evict entries of another shard
+    ImageCache cache(ImageCache::kShardCount * 100);
+    std::vector<std::string> crowded = sameShardKeys("x", 10);
+    std::string other;
+    for (int i = 0; other.empty(); ++i) {
+        std::string candidate = "other-" + std::to_string(i);
+        if (std::hash<std::string>()(candidate) % ImageCache::kShardCount !=
+            std::hash<std::string>()(crowded[0]) % ImageCache::kShardCount)
+            other = candidate;
+    }
+    cache.put(other, bytes(90));
+    for (const std::string& key : crowded)
+        cache.put(key, bytes(30));
+    CHECK(cache.has(other));
+    CHECK(cache.size() == 1 + 3);  // 3 x 30 bytes fit in the crowded shard
+
+    // 1000 ids spread over all shards
+    ImageCache spread(ImageCache::kShardCount * 1000 * 10);
+    for (int i = 0; i < 1000; ++i)
+        spread.put("cai-251197962-" + std::to_string(i), bytes(10));
+    CHECK(spread.size() == 1000);
+    CHECK(spread.stats().evictions == 0);
+}
+
+void testStats() {
+    ImageCache cache(ImageCache::kShardCount * 1000);
+    cache.put("a", bytes(10));
+    cache.get("a");
+    cache.get("a");
+    cache.get("b");
+    CHECK(!cache.has("b"));  // has() does not count
+    ImageCache::Stats stats = cache.stats();
+    CHECK(stats.hits == 2);
+    CHECK(stats.misses == 1);
+    CHECK(stats.entries == 1);
+    CHECK(stats.bytes == 10);
+}
+
+void testConcurrentAccess() {
+    ImageCache cache(ImageCache::kShardCount * 4096);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&cache, t]() {
+            for (int i = 0; i < 20000; ++i) {
+                std::string key = "cai-" + std::to_string((i * 7 + t) % 64);
+                if (i % 4 == 0)
+                    cache.put(key, bytes(64, static_cast<uint8_t>(t)));
+                else if (ImageCache::BytesPtr data = cache.get(key))
+                    CHECK(data->size() == 64);
+            }
+        });
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+    ImageCache::Stats stats = cache.stats();
+    CHECK(stats.hits + stats.misses == 4 * 15000);
+    CHECK(stats.bytes == stats.entries * 64);
+}
+
+}  // namespace
+
+int main() {
+    testPutGetReplace();
+    testLruEvictionWithinShard();
+    testShardsAreIndependent();
+    testStats();
+    testConcurrentAccess();
+    if (g_failures) {
+        std::fprintf(stderr, "%d check(s) failed\n", g_failures);
+        return 1;
+    }
+    std::printf("image_cache_test: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,340 @@
+/**
+ * @file image_fetch_bench.cpp
+ * @brief ImageFetch::Pool vs the previous one-easy-handle-per-download fetch.
+ *
+ * Starts an in-process HTTPS server on 127.0.0.1 (OpenSSL, self-signed cert,
+ * HTTP/1.1 keep-alive) and downloads the same set of screenshots three ways:
+ * - easy per download, sequential: what the downloader did before the pool
+ * - easy per download, N threads: the old fetch with the same parallelism as the pool
+ * - ImageFetch::Pool(N)
+ * The server sleeps one simulated RTT per request and two (TCP + TLS) per new
+ * connection, so connection reuse shows up the way it does against a real CDN.
+ * The server speaks HTTP/1.1 only; HTTP/2 multiplexing is not measured here.
+ * POSIX sockets, libcurl and OpenSSL:
+ *   ./image_fetch_bench [images] [parallel] [rttMs] [imageBytes]
+ */
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <curl/curl.h>
+#include <openssl/evp.h>
+#include <openssl/ssl.h>
+#include <openssl/x509v3.h>
+
+#include "utils/ImageFetch.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/// Minimal HTTPS server returning a fixed body for every GET
+class LocalHttpsServer {
+public:
+    LocalHttpsServer(int rttMs, size_t imageBytes)
+        : m_rtt(rttMs), m_body(imageBytes, 'J') {}
+
+    ~LocalHttpsServer() { stop(); }
+
+    bool start() {
+        if (!makeContext())
+            return false;
+        m_listenFd = socket(AF_INET, SOCK_STREAM, 0);
+        if (m_listenFd < 0)
+            return false;
+        int one = 1;
+        setsockopt(m_listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t len = sizeof(addr);
+        if (bind(m_listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+            listen(m_listenFd, 128) != 0 ||
+            getsockname(m_listenFd, reinterpret_cast<sockaddr*>(&addr), &len) != 0)
+            return false;
+        m_port = ntohs(addr.sin_port);
+        m_acceptThread = std::thread(&LocalHttpsServer::acceptLoop, this);
+        return true;
+    }
+
+    void stop() {
+        if (m_listenFd >= 0) {
+            shutdown(m_listenFd, SHUT_RDWR);
+            if (m_acceptThread.joinable())
+                m_acceptThread.join();
+            close(m_listenFd);
+            m_listenFd = -1;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (int fd : m_openFds)
+                shutdown(fd, SHUT_RDWR);
+        }
+        for (std::thread& thread : m_connectionThreads)
+            thread.join();
+        m_connectionThreads.clear();
+        if (m_ctx) {
+            SSL_CTX_free(m_ctx);
+            m_ctx = nullptr;
+        }
+    }
+
+    std::string url(int index) const {
+        return "https://127.0.0.1:" + std::to_string(m_port) + "/screenshot/cai-" +
+               std::to_string(index) + ".jpg";
+    }
+
+    uint64_t connections() const { return m_connections.load(); }
+
+private:
+    // Self-signed P-256 certificate for 127.0.0.1, generated in memory
+    bool makeContext() {
+        EVP_PKEY* key = EVP_EC_gen("P-256");
+        X509* cert = X509_new();
+        if (!key || !cert) {
+            EVP_PKEY_free(key);
+            X509_free(cert);
+            return false;
+        }
+        X509_set_version(cert, 2);
+        ASN1_INTEGER_set(X509_get_serialNumber(cert), 1);
+        X509_gmtime_adj(X509_getm_notBefore(cert), 0);
+        X509_gmtime_adj(X509_getm_notAfter(cert), 3600);
+        X509_set_pubkey(cert, key);
+        X509_NAME* name = X509_get_subject_name(cert);
+        X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC,
+                                   reinterpret_cast<const unsigned char*>("localhost"), -1, -1, 0);
+        X509_set_issuer_name(cert, name);
+        X509_EXTENSION* san = X509V3_EXT_conf_nid(nullptr, nullptr, NID_subject_alt_name,
+                                                  "DNS:localhost,IP:127.0.0.1");
+        if (san) {
+            X509_add_ext(cert, san, -1);
+            X509_EXTENSION_free(san);
+        }
+        X509_sign(cert, key, EVP_sha256());
+
+        m_ctx = SSL_CTX_new(TLS_server_method());
+        bool ok = m_ctx && SSL_CTX_use_certificate(m_ctx, cert) == 1 &&
+                  SSL_CTX_use_PrivateKey(m_ctx, key) == 1;
+        X509_free(cert);
+        EVP_PKEY_free(key);
+        return ok;
+    }
+
+    void acceptLoop() {
+        for (;;) {
+            int fd = accept(m_listenFd, nullptr, nullptr);
+            if (fd < 0)
+                return;
+            m_connections++;
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_openFds.insert(fd);
+            m_connectionThreads.emplace_back(&LocalHttpsServer::serve, this, fd);
+        }
+    }
+
+    void serve(int fd) {
+        // TCP and TLS handshakes each cost a round trip
+        std::this_thread::sleep_for(m_rtt * 2);
+        SSL* ssl = SSL_new(m_ctx);
+        SSL_set_fd(ssl, fd);
+        if (SSL_accept(ssl) == 1) {
+            // One write per response: a separate header write would stall on delayed ACKs
+            const std::string response = "HTTP/1.1 200 OK\r\nContent-Type: image/jpeg\r\n"
+                                         "Content-Length: " + std::to_string(m_body.size()) +
+                                         "\r\nETag: \"bench\"\r\nConnection: keep-alive\r\n\r\n" +
+                                         m_body;
+            std::string pending;
+            while (readRequest(ssl, pending)) {
+                std::this_thread::sleep_for(m_rtt);
+                if (!writeAll(ssl, response))
+                    break;
+            }
+        }
+        SSL_free(ssl);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_openFds.erase(fd);
+        }
+        close(fd);
+    }
+
+    // Consume one request header block; false once the client has gone
+    static bool readRequest(SSL* ssl, std::string& pending) {
+        size_t end;
+        while ((end = pending.find("\r\n\r\n")) == std::string::npos) {
+            char chunk[4096];
+            int n = SSL_read(ssl, chunk, sizeof(chunk));
+            if (n <= 0)
+                return false;
+            pending.append(chunk, static_cast<size_t>(n));
+        }
+        pending.erase(0, end + 4);
+        return true;
+    }
+
+    static bool writeAll(SSL* ssl, const std::string& data) {
+        size_t written = 0;
+        while (written < data.size()) {
+            int n = SSL_write(ssl, data.data() + written, static_cast<int>(data.size() - written));
+            if (n <= 0)
+                return false;
+            written += static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    std::chrono::milliseconds m_rtt;
+    std::string m_body;
+    SSL_CTX* m_ctx = nullptr;
+    int m_listenFd = -1;
+    int m_port = 0;
+    std::thread m_acceptThread;
+    std::mutex m_mutex;
+    std::set<int> m_openFds;
+    std::vector<std::thread> m_connectionThreads;
+    std::atomic<uint64_t> m_connections{0};
+};
+
+size_t bodyCallback(char* ptr, size_t size, size_t nmemb, void* userdata) {
+    auto* buf = reinterpret_cast<std::vector<uint8_t>*>(userdata);
+    size_t total = size * nmemb;
+    buf->insert(buf->end(), reinterpret_cast<uint8_t*>(ptr),
+                reinterpret_cast<uint8_t*>(ptr) + total);
+    return total;
+}
+
+// ImageFetch::fetch before the pool: a fresh easy handle (connection, TLS handshake) per image
+bool fetchWithNewHandle(const std::string& url) {
+    CURL* curl = curl_easy_init();
+    if (!curl)
+        return false;
+    std::vector<uint8_t> data;
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, bodyCallback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &data);
+    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 10L);
+    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+    CURLcode res = curl_easy_perform(curl);
+    long httpCode = 0;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
+    curl_easy_cleanup(curl);
+    return res == CURLE_OK && httpCode == 200 && !data.empty();
+}
+
+struct Result {
+    double seconds = 0;
+    int failed = 0;
+    uint64_t connections = 0;
+};
+
+Result runNewHandles(LocalHttpsServer& server, int images, int threads) {
+    const uint64_t connectionsBefore = server.connections();
+    std::atomic<int> next{0};
+    std::atomic<int> failed{0};
+    const Clock::time_point begin = Clock::now();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&]() {
+            for (int i = next++; i < images; i = next++) {
+                if (!fetchWithNewHandle(server.url(i)))
+                    failed++;
+            }
+        });
+    }
+    for (std::thread& worker : workers)
+        worker.join();
+    Result result;
+    result.seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+    result.failed = failed;
+    result.connections = server.connections() - connectionsBefore;
+    return result;
+}
+
+Result runPool(LocalHttpsServer& server, int images, int parallel) {
+    const uint64_t connectionsBefore = server.connections();
+    ImageFetch::Pool pool(parallel);
+    std::mutex mutex;
+    std::condition_variable allDone;
+    int remaining = images;
+    int failed = 0;
+    const Clock::time_point begin = Clock::now();
+    for (int i = 0; i < images; ++i) {
+        pool.submit(server.url(i), ImageFetch::Validators(), 10, [&](ImageFetch::Result fetched) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (fetched.status != ImageFetch::Status::Ok)
+                failed++;
+            if (--remaining == 0)
+                allDone.notify_one();
+        });
+    }
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        allDone.wait(lock, [&]() { return remaining == 0; });
+    }
+    Result result;
+    result.seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+    pool.shutdown();
+    result.failed = failed;
+    result.connections = server.connections() - connectionsBefore;
+    return result;
+}
+
+void report(const char* name, const Result& result, int images) {
+    std::printf("  %-32s: %8.0f ms %8.1f img/s %6llu connections %4d failed\n", name,
+                result.seconds * 1000, images / result.seconds,
+                static_cast<unsigned long long>(result.connections), result.failed);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    const int images = argc > 1 ? std::atoi(argv[1]) : 300;
+    const int parallel = argc > 2 ? std::atoi(argv[2]) : 6;
+    const int rttMs = argc > 3 ? std::atoi(argv[3]) : 20;
+    const size_t imageBytes = argc > 4 ? std::strtoul(argv[4], nullptr, 10) : 60 * 1024;
+    if (images <= 0 || parallel <= 0 || rttMs < 0 || imageBytes == 0)
+        return 1;
+
+    std::signal(SIGPIPE, SIG_IGN);  // clients closing mid-response must not kill the server
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    LocalHttpsServer server(rttMs, imageBytes);
+    if (!server.start()) {
+        std::fprintf(stderr, "cannot start the local HTTPS server\n");
+        return 1;
+    }
+
+    std::printf("%d images of %zu bytes, %d in parallel, simulated RTT %d ms\n", images,
+                imageBytes, parallel, rttMs);
+    Result sequential = runNewHandles(server, images, 1);
+    Result threaded = runNewHandles(server, images, parallel);
+    Result pooled = runPool(server, images, parallel);
+    report("easy per download, sequential", sequential, images);
+    report(("easy per download, " + std::to_string(parallel) + " threads").c_str(), threaded,
+           images);
+    report(("ImageFetch::Pool(" + std::to_string(parallel) + ")").c_str(), pooled, images);
+    std::printf("  Pool vs %d threads: %.1fx throughput\n", parallel,
+                threaded.seconds / pooled.seconds);
+
+    server.stop();
+    curl_global_cleanup();
+    return sequential.failed + threaded.failed + pooled.failed == 0 ? 0 : 1;
+}
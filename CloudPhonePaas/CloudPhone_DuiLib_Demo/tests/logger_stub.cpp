@@ -0,0 +1,25 @@
+/**
+ * @file logger_stub.cpp
+ * @brief Logger's static interface on stderr, so tests can link sources that log
+ *        without spdlog.
+ */
+
+#include <cstdio>
+#include <string>
+
+#include "utils/Logger.h"
+
+namespace {
+
+void write(const char* level, const std::string& message) {
+    std::fprintf(stderr, "[%s] %s\n", level, message.c_str());
+}
+
+}  // namespace
+
+void Logger::globalInit() {}
+
+void Logger::debug(const std::string& message) { write("debug", message); }
+void Logger::info(const std::string& message) { write("info", message); }
+void Logger::warning(const std::string& message) { write("warning", message); }
+void Logger::error(const std::string& message) { write("error", message); }
@@ -0,0 +1,122 @@
+/**
+ * @file screenshot_poll_scheduler_test.cpp
+ * @brief Checks that ScreenshotPollScheduler serves visible tiles first and
+ *        never hands out the whole fleet at once.
+ *
+ * Std-only; returns non-zero and prints the failed check on error.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "utils/ScreenshotPollScheduler.h"
+
+namespace {
+
+int g_failures = 0;
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            g_failures++;                                                   \
+        }                                                                   \
+    } while (0)
+
+using std::chrono::milliseconds;
+
+std::vector<std::string> fleet(size_t count) {
+    std::vector<std::string> ids;
+    for (size_t i = 0; i < count; ++i)
+        ids.push_back("cai-" + std::to_string(i));
+    return ids;
+}
+
+bool contains(const std::vector<std::string>& ids, const std::string& id) {
+    return std::find(ids.begin(), ids.end(), id) != ids.end();
+}
+
+void testNewInstancesStartHiddenAndStaggered() {
+    ScreenshotPollScheduler scheduler(milliseconds(1000), milliseconds(400));
+    scheduler.setInstances(fleet(1000));
+    CHECK(scheduler.visibleCount() == 0);
+    // Right after discovery only the first few staggered slots (0.4 ms apart) can be due
+    size_t first = scheduler.takeDue().size();
+    CHECK(first < 50);
+
+    // Half a hidden interval later, roughly half of the fleet has come due
+    std::this_thread::sleep_for(milliseconds(200));
+    size_t due = first + scheduler.takeDue().size();
+    CHECK(due >= 250 && due <= 800);
+    std::this_thread::sleep_for(milliseconds(250));
+    CHECK(due + scheduler.takeDue().size() == 1000);
+}
+
+void testVisibilityReportedBeforeStart() {
+    ScreenshotPollScheduler scheduler(milliseconds(1000), milliseconds(30000));
+    scheduler.setVisible({"cai-3", "cai-7"});
+    scheduler.setInstances(fleet(1000));
+    CHECK(scheduler.visibleCount() == 2);
+
+    std::vector<std::string> due = scheduler.takeDue();
+    CHECK(due.size() == 2);
+    CHECK(contains(due, "cai-3") && contains(due, "cai-7"));
+
+    // Later instance lists keep applying the remembered set
+    scheduler.setInstances({"cai-3", "cai-7", "cai-2000"});
+    scheduler.setVisible({"cai-2000"});
+    scheduler.setInstances({"cai-2000", "cai-2001"});
+    CHECK(scheduler.visibleCount() == 1);
+}
+
+void testTakeDueCap() {
+    ScreenshotPollScheduler scheduler(milliseconds(1000), milliseconds(30000));
+    std::vector<std::string> ids = fleet(20);
+    scheduler.setVisible(ids);
+    scheduler.setInstances(ids);
+
+    std::set<std::string> taken;
+    for (int round = 0; round < 4; ++round) {
+        std::vector<std::string> due = scheduler.takeDue(5);
+        CHECK(due.size() == 5);
+        taken.insert(due.begin(), due.end());
+    }
+    CHECK(taken.size() == 20);  // in-flight instances are not handed out twice
+    CHECK(scheduler.takeDue(5).empty());
+    CHECK(scheduler.requestsPerMinute() == 20);
+}
+
+void testVisibleBeforeHidden() {
+    ScreenshotPollScheduler scheduler(milliseconds(1000), milliseconds(50));
+    std::vector<std::string> ids = fleet(10);
+    scheduler.setInstances(ids);
+    std::this_thread::sleep_for(milliseconds(80));  // every hidden instance is due now
+
+    scheduler.setVisible({"cai-9"});
+    std::vector<std::string> due = scheduler.takeDue(3);
+    CHECK(due.size() == 3);
+    CHECK(!due.empty() && due[0] == "cai-9");
+
+    // The rest stay due and come out on the next call
+    CHECK(scheduler.takeDue().size() == 7);
+}
+
+}  // namespace
+
+int main() {
+    testNewInstancesStartHiddenAndStaggered();
+    testVisibilityReportedBeforeStart();
+    testTakeDueCap();
+    testVisibleBeforeHidden();
+    if (g_failures) {
+        std::fprintf(stderr, "%d check(s) failed\n", g_failures);
+        return 1;
+    }
+    std::printf("screenshot_poll_scheduler_test: all checks passed\n");
+    return 0;
+}
@@ -12,6 +12,7 @@ Window {
     height: 879
 
     property var checkedInstanceIds: []
+    onCheckedInstanceIdsChanged: multiStreamViewModel.setSelectedInstances(checkedInstanceIds)
     property var streamingWindowMap: ({}) // AndroidInstanceId -> window
     property StreamingViewModel streamingViewModel: StreamingViewModel {}
     property var groupStreamingViewModels: []
@@ -147,6 +148,35 @@ Window {
         }
 
         Item { Layout.fillWidth: true }
+
+        // 按实例ID/名称和状态过滤，查询走索引，不遍历实例列表
+        TextField {
+            id: filterField
+            placeholderText: "搜索实例ID/名称"
+            selectByMouse: true
+            Layout.preferredWidth: 240
+            onTextChanged: {
+                androidInstanceModel.filterText = text;
+                gridView.positionViewAtBeginning();
+            }
+        }
+
+        ComboBox {
+            id: stateFilterBox
+            Layout.preferredWidth: 160
+            model: ["全部状态"].concat(androidInstanceModel.availableStates)
+            // 选中项跟随过滤条件：出现新状态重建下拉列表后不会回到"全部状态"
+            currentIndex: androidInstanceModel.stateFilter.length > 0
+                          ? Math.max(0, model.indexOf(androidInstanceModel.stateFilter[0])) : 0
+            onActivated: function(index) {
+                androidInstanceModel.stateFilter = index > 0 ? [model[index]] : [];
+                gridView.positionViewAtBeginning();
+            }
+        }
+
+        Text {
+            text: androidInstanceModel.count + " / " + androidInstanceModel.totalCount
+        }
     }
 
     // 卡片区域
@@ -164,7 +194,7 @@ Window {
         clip: true
         cellWidth: 320
         cellHeight: 569
-        model: androidInstanceModel.instances
+        model: androidInstanceModel
 
         // 滚动停止后更新可见实例，通知MultiStreamViewModel切换拉流
         Timer {
@@ -182,28 +212,32 @@ Window {
             }
         }
 
+        // 过滤结果变化后可见实例也随之变化
+        onCountChanged: scrollStopTimer.restart()
+
+        // 单元格尺寸或屏幕缩放变化时上报物理像素尺寸，用于协商子码流分辨率和帧率
+        function reportTileSize() {
+            multiStreamViewModel.updateTileSize(cellWidth - 10, cellHeight - 10, Screen.devicePixelRatio);
+            androidInstanceModel.setTileSize(cellWidth - 10, cellHeight - 10, Screen.devicePixelRatio);
+        }
+
+        onCellWidthChanged: reportTileSize()
+        Screen.onDevicePixelRatioChanged: reportTileSize()
+        Component.onCompleted: reportTileSize()
+
         function updateVisibleInstances() {
-            var visibleIds = [];
-            var invisibleIds = [];
             var columns = Math.floor(width / cellWidth);
             if (columns < 1) columns = 1;
             var firstVisibleIndex = Math.floor(contentY / cellHeight) * columns;
             if (firstVisibleIndex < 0) firstVisibleIndex = 0;
             var visibleRowCount = Math.ceil(height / cellHeight) + 1;
             var lastVisibleIndex = firstVisibleIndex + visibleRowCount * columns - 1;
-            if (lastVisibleIndex >= model.count) lastVisibleIndex = model.count - 1;
 
-            for (var i = 0; i < model.count; i++) {
-                if (model[i]) {
-                    var id = model[i].AndroidInstanceId;
-                    if (i >= firstVisibleIndex && i <= lastVisibleIndex) {
-                        visibleIds.push(id);
-                    } else {
-                        invisibleIds.push(id);
-                    }
-                }
-            }
+            // 只取可见区间的实例ID，不遍历整个列表
+            var visibleIds = androidInstanceModel.instanceIds(firstVisibleIndex, lastVisibleIndex);
+            var invisibleIds = [];
             multiStreamViewModel.onVisibilityChanged(visibleIds, invisibleIds);
+            androidInstanceModel.setVisibleInstances(visibleIds);
         }
 
         delegate: Rectangle {
@@ -214,8 +248,11 @@ Window {
             // 点击卡片打开单实例全质量视频窗口
             MouseArea {
                 anchors.fill: parent
+                hoverEnabled: true      // 悬停的卡片每帧渲染，其余卡片按后台帧率抽帧
+                onEntered: multiStreamViewModel.setHoveredInstance(model.AndroidInstanceId)
+                onExited: multiStreamViewModel.setHoveredInstance("")
                 onClicked: {
-                    var instanceId = modelData.AndroidInstanceId;
+                    var instanceId = model.AndroidInstanceId;
                     if (mainWindow.streamingWindowMap[instanceId]) {
                         var win = mainWindow.streamingWindowMap[instanceId];
                         win.show();
@@ -244,28 +281,41 @@ Window {
             // 视频渲染项（替代原来的截图Image）
             VideoRenderItem {
                 id: videoRenderItem
-                objectName: "videoRenderItem_" + modelData.AndroidInstanceId
+                objectName: "videoRenderItem_" + model.AndroidInstanceId
                 anchors.fill: parent
 
                 Component.onCompleted: {
                     multiStreamViewModel.registerVideoRenderItem(
-                        modelData.AndroidInstanceId, videoRenderItem)
+                        model.AndroidInstanceId, videoRenderItem)
                 }
             }
 
+            // 未连上视频流时显示实例截图；thumbnailVersion 变化时 source 随之变化，图像提供者返回新截图。
+            // 委托创建时版本号为 0，图像提供者从 ThumbnailStore 解码上次保存的截图，首帧即可显示
+            Image {
+                anchors.fill: parent
+                visible: model.connectionState !== 2
+                asynchronous: true
+                cache: false
+                fillMode: Image.PreserveAspectFit
+                sourceSize.width: width * Screen.devicePixelRatio
+                sourceSize.height: height * Screen.devicePixelRatio
+                source: "image://instance/" + model.AndroidInstanceId + "?v=" + model.thumbnailVersion
+            }
+
             // 选择复选框
             CheckBox { 
                 anchors.right: parent.right
                 anchors.top: parent.top
-                checked: mainWindow.checkedInstanceIds.indexOf(modelData.AndroidInstanceId) !== -1
+                checked: mainWindow.checkedInstanceIds.indexOf(model.AndroidInstanceId) !== -1
                 onCheckedChanged: {
                     if (checked) {
-                        if (mainWindow.checkedInstanceIds.indexOf(modelData.AndroidInstanceId) === -1)
-                            mainWindow.checkedInstanceIds.push(modelData.AndroidInstanceId);
+                        if (mainWindow.checkedInstanceIds.indexOf(model.AndroidInstanceId) === -1)
+                            mainWindow.checkedInstanceIds.push(model.AndroidInstanceId);
                     } else {
                         if (mainWindow.groupStreamingViewModels.length > 0
                             && mainWindow.checkedInstanceIds.length === 2
-                            && mainWindow.checkedInstanceIds.indexOf(modelData.AndroidInstanceId) !== -1) {
+                            && mainWindow.checkedInstanceIds.indexOf(model.AndroidInstanceId) !== -1) {
                             checked = true;
                             dialogs.genericTipDialog.close();
                             dialogs.genericTipDialog.tipTitle = "操作提示"
@@ -273,7 +323,7 @@ Window {
                             dialogs.genericTipDialog.open();
                             return;
                         }
-                        var idx = mainWindow.checkedInstanceIds.indexOf(modelData.AndroidInstanceId);
+                        var idx = mainWindow.checkedInstanceIds.indexOf(model.AndroidInstanceId);
                         if (idx !== -1)
                             mainWindow.checkedInstanceIds.splice(idx, 1);
                     }
@@ -296,7 +346,7 @@ Window {
                     anchors.fill: parent
                     anchors.margins: 5
                     Text {
-                        text: modelData.AndroidInstanceId
+                        text: model.AndroidInstanceId
                         color: "white"
                         elide: Text.ElideRight
                     }
@@ -315,12 +365,12 @@ Window {
                                 "BACKING_UP": '备份中',
                                 "RESTORING": '还原中'
                             };
-                            return stateMap[modelData.State] || modelData.State;
+                            return stateMap[model.State] || model.State;
                         })()
                         color: "white"
                     }
                     Text {
-                        text: modelData.AndroidInstanceRegion
+                        text: model.AndroidInstanceRegion
                         color: "white"
                         elide: Text.ElideRight
                     }
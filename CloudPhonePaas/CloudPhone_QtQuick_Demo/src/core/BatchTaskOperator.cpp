@@ -408,7 +408,7 @@ void BatchTaskOperator::clearAppInstallBlackList(const QVector<QString> &instanc
   executeBatchTask("ClearAppInstallBlackList", jsonParams);
 }
 
-QString BatchTaskOperator::getInstanceImage(const QString &instanceId, int quality) {
+QString BatchTaskOperator::getInstanceImage(const QString &instanceId, int quality, int width, int height) {
   constexpr int BUFFER_SIZE = 4096;
   std::vector<char> buffer(BUFFER_SIZE, 0);
 
@@ -419,7 +419,8 @@ QString BatchTaskOperator::getInstanceImage(const QString &instanceId, int quali
     return QString();
   }
 
-  if (tcr_instance_get_image(tcrOperator, buffer.data(), BUFFER_SIZE, instanceId.toUtf8().constData(), 0, 0, quality)) {
+  if (tcr_instance_get_image(tcrOperator, buffer.data(), BUFFER_SIZE, instanceId.toUtf8().constData(), width, height,
+                             quality)) {
     return QString::fromUtf8(buffer.data());
   }
   return QString();
@@ -439,9 +439,11 @@ class BatchTaskOperator : public QObject {
    * @brief 获取指定实例的小流截图URL
    * @param instanceId 实例ID
    * @param quality 图片质量（1-100，默认20）
+   * @param width 图片宽度（<=0 使用服务端默认分辨率）
+   * @param height 图片高度（<=0 使用服务端默认分辨率）
    * @return 截图URL字符串，失败返回空字符串
    */
-  QString getInstanceImage(const QString &instanceId, int quality = 20);
+  QString getInstanceImage(const QString &instanceId, int quality = 20, int width = 0, int height = 0);
 
  signals:
   /**
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QReadWriteLock>
+#include <QString>
+#include <QVector>
+
+/// 实例句柄：实例ID驻留后得到的稠密整数下标，可直接索引按句柄组织的 QVector
+using InstanceHandle = int;
+constexpr InstanceHandle kInvalidInstanceHandle = -1;
+
+/**
+ * @brief 实例注册表：把实例ID字符串驻留为稠密整数句柄
+ *
+ * 字符串查找只发生在 API 边界（QML 调用、SDK 回调入口），之后帧缓存、渲染项、连接状态等
+ * 逐帧/逐事件路径都用句柄直接索引 QVector，不再做字符串哈希和比较。
+ *
+ * - 只增不减：句柄在 ViewModel 生命周期内保持稳定，重连或切换实例列表不会让已注册的渲染项失效
+ * - 线程安全：驻留只在 GUI 线程发生（写锁），SDK 回调线程通过 find() 查找（读锁）
+ */
+class InstanceRegistry {
+ public:
+  /**
+   * @brief 驻留实例ID，已存在时返回原句柄（GUI 线程调用）
+   */
+  InstanceHandle intern(const QString& instanceId);
+
+  /**
+   * @brief 查找实例ID对应的句柄，未驻留时返回 kInvalidInstanceHandle
+   */
+  InstanceHandle find(const QString& instanceId) const;
+
+  /**
+   * @brief 按 SDK 回调给出的 UTF-8 字符串查找句柄，不构造 QString
+   */
+  InstanceHandle find(const char* utf8InstanceId) const;
+
+  /**
+   * @brief 句柄对应的实例ID
+   */
+  QString idOf(InstanceHandle handle) const;
+
+  /**
+   * @brief 已驻留的实例数（即有效句柄上界）
+   */
+  int size() const;
+
+ private:
+  mutable QReadWriteLock m_lock;
+  QHash<QByteArray, InstanceHandle> m_handles;  ///< UTF-8 实例ID -> 句柄
+  QVector<QString> m_ids;                       ///< 句柄 -> 实例ID
+};
@@ -0,0 +1,209 @@
+#include "InstanceSearchIndex.h"
+
+#include <algorithm>
+
+#include <QtAlgorithms>
+
+namespace {
+
+/// 倒排表至少这么长才考虑转为位图，避免行数很少时频繁转换
+constexpr int kDenseMinRows = 1024;
+
+inline void setBit(QVector<quint64>& bits, int row) { bits[row >> 6] |= quint64(1) << (row & 63); }
+
+inline bool testBit(const QVector<quint64>& bits, int row) {
+  return (row >> 6) < bits.size() && (bits[row >> 6] & (quint64(1) << (row & 63)));
+}
+
+}  // namespace
+
+quint64 InstanceSearchIndex::gramKey(const QChar* s, int len) {
+  quint64 key = quint64(len) << 48;
+  for (int i = 0; i < len; ++i) {
+    key |= quint64(s[i].unicode()) << (16 * (2 - i));
+  }
+  return key;
+}
+
+void InstanceSearchIndex::Facet::add(int row, const QString& value) {
+  int words = (row >> 6) + 1;
+  auto it = ids.constFind(value);
+  int id = 0;
+  if (it == ids.constEnd()) {
+    id = values.size();
+    ids.insert(value, id);
+    values.append(value);
+    bits.append(Bitmap());
+  } else {
+    id = it.value();
+  }
+  Bitmap& b = bits[id];
+  if (b.size() < words) {
+    b.resize(words);  // 新增的字为 0
+  }
+  setBit(b, row);
+}
+
+void InstanceSearchIndex::Facet::restrict(const QStringList& selected, Bitmap& filter) const {
+  if (selected.isEmpty()) {
+    return;
+  }
+  Bitmap any(filter.size(), 0);
+  for (const QString& value : selected) {
+    auto it = ids.constFind(value);
+    if (it == ids.constEnd()) {
+      continue;
+    }
+    const Bitmap& b = bits[it.value()];
+    for (int w = 0; w < any.size() && w < b.size(); ++w) {
+      any[w] |= b[w];
+    }
+  }
+  for (int w = 0; w < filter.size(); ++w) {
+    filter[w] &= any[w];
+  }
+}
+
+int InstanceSearchIndex::add(const QString& instanceId, const QString& name, const QString& region,
+                             const QString& state) {
+  const int row = m_texts.size();
+  const int words = (row >> 6) + 1;
+  m_texts.append((instanceId + QLatin1Char('\n') + name).toLower());
+  m_state.add(row, state);
+  m_region.add(row, region);
+
+  // 每个不同的 1~3 字符子串登记一次，行号递增所以倒排表天然有序；跨越 '\n' 的子串查询串里不会出现
+  const QString& text = m_texts.last();
+  QVector<quint64> grams;
+  grams.reserve(text.size() * 3);
+  for (int i = 0; i < text.size(); ++i) {
+    for (int len = 1; len <= 3 && i + len <= text.size(); ++len) {
+      grams.append(gramKey(text.constData() + i, len));
+    }
+  }
+  std::sort(grams.begin(), grams.end());
+  grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+
+  for (quint64 key : grams) {
+    Postings& p = m_postings[key];
+    if (p.dense) {
+      if (p.bits.size() < words) {
+        p.bits.resize(words);
+      }
+      setBit(p.bits, row);
+      continue;
+    }
+    p.rows.append(row);
+    if (p.rows.size() > kDenseMinRows && p.rows.size() * 32 > m_texts.size()) {
+      p.bits.fill(0, words);
+      for (int r : p.rows) {
+        setBit(p.bits, r);
+      }
+      p.rows = QVector<int>();
+      p.dense = true;
+    }
+  }
+  return row;
+}
+
+void InstanceSearchIndex::clear() {
+  m_texts.clear();
+  m_postings.clear();
+  m_state = Facet();
+  m_region = Facet();
+}
+
+QVector<int> InstanceSearchIndex::query(const Query& query) const {
+  QVector<int> result;
+  if (m_texts.isEmpty()) {
+    return result;
+  }
+
+  // 状态、区域位图先求出候选行
+  const int rows = m_texts.size();
+  Bitmap filter((rows + 63) >> 6, ~quint64(0));
+  if (rows & 63) {
+    filter.last() = (quint64(1) << (rows & 63)) - 1;
+  }
+  m_state.restrict(query.states, filter);
+  m_region.restrict(query.regions, filter);
+
+  const QString q = query.text.toLower();
+  const bool verify = q.size() > 3 || query.prefix;
+  auto accept = [&](int row) {
+    if (verify) {
+      const QString& t = m_texts[row];
+      if (query.prefix) {
+        // 名称紧跟在 '\n' 之后
+        int nameStart = t.indexOf(QLatin1Char('\n')) + 1;
+        if (!t.startsWith(q) && !QStringView(t).mid(nameStart).startsWith(q)) {
+          return;
+        }
+      } else if (!t.contains(q)) {
+        return;
+      }
+    }
+    result.append(row);
+  };
+
+  // 查询串的全部 3-gram（短查询只有它本身），任何一个不存在就没有结果；稠密表直接与候选位图相与
+  QVector<const Postings*> sparse;
+  if (!q.isEmpty()) {
+    const int gramLen = qMin(int(q.size()), 3);
+    for (int i = 0; i + gramLen <= q.size(); ++i) {
+      auto it = m_postings.constFind(gramKey(q.constData() + i, gramLen));
+      if (it == m_postings.constEnd()) {
+        return result;
+      }
+      const Postings* p = &it.value();
+      if (p->dense) {
+        for (int w = 0; w < filter.size(); ++w) {
+          filter[w] &= w < p->bits.size() ? p->bits[w] : 0;
+        }
+      } else if (!sparse.contains(p)) {
+        sparse.append(p);
+      }
+    }
+  }
+
+  if (sparse.isEmpty()) {
+    for (int w = 0; w < filter.size(); ++w) {
+      for (quint64 bits = filter[w]; bits; bits &= bits - 1) {
+        accept((w << 6) + qCountTrailingZeroBits(bits));
+      }
+    }
+    return result;
+  }
+
+  // 以最短的稀疏表为候选，其余稀疏表单调前移游标求交：
+  // 长度相近的表逐个前移（总代价与表长成正比），长得多的表二分查找
+  std::sort(sparse.begin(), sparse.end(),
+            [](const Postings* a, const Postings* b) { return a->rows.size() < b->rows.size(); });
+  const int shortest = sparse[0]->rows.size();
+  QVector<QVector<int>::const_iterator> cursors;
+  for (int i = 1; i < sparse.size(); ++i) {
+    cursors.append(sparse[i]->rows.cbegin());
+  }
+  for (int row : sparse[0]->rows) {
+    if (!testBit(filter, row)) {
+      continue;
+    }
+    bool all = true;
+    for (int i = 0; i < cursors.size() && all; ++i) {
+      const QVector<int>& list = sparse[i + 1]->rows;
+      auto& cur = cursors[i];
+      if (list.size() > shortest * 16) {
+        cur = std::lower_bound(cur, list.cend(), row);
+      } else {
+        while (cur != list.cend() && *cur < row) {
+          ++cur;
+        }
+      }
+      all = cur != list.cend() && *cur == row;
+    }
+    if (all) {
+      accept(row);
+    }
+  }
+  return result;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * @brief 实例搜索索引：按实例ID/名称子串以及状态、区域过滤，不做逐行线性扫描
+ *
+ * - 文本：实例ID和名称（小写）的每个 1~3 字符子串建立倒排表（行号升序）。
+ *   查询不超过 3 个字符时倒排表就是结果；更长的查询对全部 3-gram 的倒排表求交集，再对候选做一次子串校验
+ * - 超过 1/32 行都包含的 n-gram（如实例ID的共同前缀）改存位图，既省内存，求交也只是按字与
+ * - 状态、区域：每个取值一张行位图，选中的取值取并集，不同维度之间取交集
+ *
+ * 行号按 add() 的顺序分配，与调用方的行存储一一对应。非线程安全，只在 GUI 线程使用。
+ */
+class InstanceSearchIndex {
+ public:
+  struct Query {
+    QString text;         ///< 为空表示不按文本过滤
+    QStringList states;   ///< 为空表示不按状态过滤
+    QStringList regions;  ///< 为空表示不按区域过滤
+    bool prefix = false;  ///< true 时要求实例ID或名称以 text 开头
+  };
+
+  /**
+   * @brief 追加一行
+   * @return 行号
+   */
+  int add(const QString& instanceId, const QString& name, const QString& region, const QString& state);
+
+  void clear();
+
+  int size() const { return m_texts.size(); }
+
+  /**
+   * @brief 满足查询条件的行号，升序
+   */
+  QVector<int> query(const Query& query) const;
+
+  /**
+   * @brief 出现过的状态取值
+   */
+  QStringList states() const { return m_state.values; }
+
+  /**
+   * @brief 出现过的区域取值
+   */
+  QStringList regions() const { return m_region.values; }
+
+ private:
+  using Bitmap = QVector<quint64>;
+
+  /// 一个 n-gram 的倒排表：稀疏时是升序行号，稠密后转为行位图（可能短于当前行数，缺的字视为 0）
+  struct Postings {
+    QVector<int> rows;
+    Bitmap bits;
+    bool dense = false;
+  };
+
+  /// 一个离散维度（状态/区域）：每个取值一张行位图
+  struct Facet {
+    QHash<QString, int> ids;  ///< 取值 -> 下标
+    QStringList values;       ///< 下标 -> 取值
+    QVector<Bitmap> bits;     ///< 下标 -> 行位图
+
+    void add(int row, const QString& value);
+    /// 选中取值的并集与 filter 相与；values 为空时不限制
+    void restrict(const QStringList& selected, Bitmap& filter) const;
+  };
+
+  static quint64 gramKey(const QChar* s, int len);
+
+  QVector<QString> m_texts;  ///< 行 -> 小写的 "实例ID\n名称"
+  QHash<quint64, Postings> m_postings;
+  Facet m_state;
+  Facet m_region;
+};
@@ -0,0 +1,36 @@
+#include "ScreenshotSizePolicy.h"
+
+#include <iterator>
+
+namespace {
+
+struct Bucket {
+  int width;
+  int quality;
+};
+
+// 9:16 竖屏档位，从小到大
+const Bucket kBuckets[] = {
+    {144, 50}, {216, 50}, {288, 55}, {432, 60}, {576, 65}, {720, 70},
+};
+
+}  // namespace
+
+ScreenshotSizePolicy::Spec ScreenshotSizePolicy::forTile(qreal tileWidth, qreal tileHeight, qreal devicePixelRatio) {
+  // 用 9:16 图像覆盖宫格所需的物理像素宽度
+  qreal needed = qMax(tileWidth, tileHeight * 9.0 / 16.0) * qMax<qreal>(devicePixelRatio, 1.0);
+
+  const Bucket* bucket = &kBuckets[std::size(kBuckets) - 1];
+  for (const Bucket& b : kBuckets) {
+    if (b.width >= needed) {
+      bucket = &b;
+      break;
+    }
+  }
+
+  Spec spec;
+  spec.width = bucket->width;
+  spec.height = bucket->width * 16 / 9;
+  spec.quality = bucket->quality;
+  return spec;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <QtGlobal>
+
+/**
+ * @brief 截图规格策略：按宫格尺寸决定 tcr_instance_get_image 的宽、高和质量
+ *
+ * 截图为 9:16 竖屏。覆盖宫格所需的物理像素宽度向上取整到固定档位（宽 144/216/288/432/576/720），
+ * 同一档位的重复请求可以命中 CDN 缓存；小图的压缩瑕疵不明显，质量随档位升高。
+ */
+class ScreenshotSizePolicy {
+ public:
+  struct Spec {
+    int width = 0;
+    int height = 0;
+    int quality = 20;
+
+    bool operator==(const Spec& other) const {
+      return width == other.width && height == other.height && quality == other.quality;
+    }
+    bool operator!=(const Spec& other) const { return !(*this == other); }
+  };
+
+  /**
+   * @brief 根据宫格逻辑尺寸和设备像素比选择截图规格
+   */
+  static Spec forTile(qreal tileWidth, qreal tileHeight, qreal devicePixelRatio = 1.0);
+};
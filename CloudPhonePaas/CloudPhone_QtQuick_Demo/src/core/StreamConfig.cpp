@@ -71,4 +71,41 @@ void StreamConfig::setSubStreamMaxBitrate(int bitrate) {
     m_subStreamMaxBitrate = bitrate;
     emit subStreamMaxBitrateChanged();
   }
-}
\ No newline at end of file
+}
+// Adaptive concurrency
+ConcurrencyPolicy StreamConfig::concurrencyPolicy() const { return m_concurrencyPolicy; }
+
+void StreamConfig::setAdaptiveConcurrency(bool enabled) {
+  if (m_concurrencyPolicy.enabled != enabled) {
+    m_concurrencyPolicy.enabled = enabled;
+    emit concurrencyPolicyChanged();
+  }
+}
+
+void StreamConfig::setConcurrencyMin(int streams) {
+  if (m_concurrencyPolicy.minStreams != streams) {
+    m_concurrencyPolicy.minStreams = streams;
+    emit concurrencyPolicyChanged();
+  }
+}
+
+void StreamConfig::setConcurrencyMax(int streams) {
+  if (m_concurrencyPolicy.maxStreams != streams) {
+    m_concurrencyPolicy.maxStreams = streams;
+    emit concurrencyPolicyChanged();
+  }
+}
+
+void StreamConfig::setConcurrencyShrinkCooldownMs(int ms) {
+  if (m_concurrencyPolicy.shrinkCooldownMs != ms) {
+    m_concurrencyPolicy.shrinkCooldownMs = ms;
+    emit concurrencyPolicyChanged();
+  }
+}
+
+void StreamConfig::setConcurrencyGrowCooldownMs(int ms) {
+  if (m_concurrencyPolicy.growCooldownMs != ms) {
+    m_concurrencyPolicy.growCooldownMs = ms;
+    emit concurrencyPolicyChanged();
+  }
+}
@@ -4,6 +4,8 @@
 #include <QMutexLocker>
 #include <QObject>
 
+#include "ConcurrencyController.h"
+
 class StreamConfig : public QObject {
   Q_OBJECT
   Q_PROPERTY(int mainStreamWidth READ mainStreamWidth WRITE setMainStreamWidth NOTIFY mainStreamWidthChanged)
@@ -20,6 +22,16 @@ class StreamConfig : public QObject {
   Q_PROPERTY(
       int subStreamMaxBitrate READ subStreamMaxBitrate WRITE setSubStreamMaxBitrate NOTIFY subStreamMaxBitrateChanged)
 
+  // Adaptive concurrency (applied when the multi-stream session is created)
+  Q_PROPERTY(
+      bool adaptiveConcurrency READ adaptiveConcurrency WRITE setAdaptiveConcurrency NOTIFY concurrencyPolicyChanged)
+  Q_PROPERTY(int concurrencyMin READ concurrencyMin WRITE setConcurrencyMin NOTIFY concurrencyPolicyChanged)
+  Q_PROPERTY(int concurrencyMax READ concurrencyMax WRITE setConcurrencyMax NOTIFY concurrencyPolicyChanged)
+  Q_PROPERTY(int concurrencyShrinkCooldownMs READ concurrencyShrinkCooldownMs WRITE setConcurrencyShrinkCooldownMs
+                 NOTIFY concurrencyPolicyChanged)
+  Q_PROPERTY(int concurrencyGrowCooldownMs READ concurrencyGrowCooldownMs WRITE setConcurrencyGrowCooldownMs NOTIFY
+                 concurrencyPolicyChanged)
+
  public:
   // Get singleton instance
   static StreamConfig* instance();
@@ -36,6 +48,14 @@ class StreamConfig : public QObject {
   int subStreamMinBitrate() const { return m_subStreamMinBitrate; }
   int subStreamMaxBitrate() const { return m_subStreamMaxBitrate; }
 
+  // Adaptive concurrency getters; concurrencyMax <= 0 means the session's concurrentStreamingInstances
+  ConcurrencyPolicy concurrencyPolicy() const;
+  bool adaptiveConcurrency() const { return m_concurrencyPolicy.enabled; }
+  int concurrencyMin() const { return m_concurrencyPolicy.minStreams; }
+  int concurrencyMax() const { return m_concurrencyPolicy.maxStreams; }
+  int concurrencyShrinkCooldownMs() const { return m_concurrencyPolicy.shrinkCooldownMs; }
+  int concurrencyGrowCooldownMs() const { return m_concurrencyPolicy.growCooldownMs; }
+
   // Main stream setters
   void setMainStreamWidth(int width);
   void setMainStreamFps(int fps);
@@ -48,6 +68,13 @@ class StreamConfig : public QObject {
   void setSubStreamMinBitrate(int bitrate);
   void setSubStreamMaxBitrate(int bitrate);
 
+  // Adaptive concurrency setters
+  void setAdaptiveConcurrency(bool enabled);
+  void setConcurrencyMin(int streams);
+  void setConcurrencyMax(int streams);
+  void setConcurrencyShrinkCooldownMs(int ms);
+  void setConcurrencyGrowCooldownMs(int ms);
+
  signals:
   void mainStreamWidthChanged();
   void mainStreamFpsChanged();
@@ -59,6 +86,8 @@ class StreamConfig : public QObject {
   void subStreamMinBitrateChanged();
   void subStreamMaxBitrateChanged();
 
+  void concurrencyPolicyChanged();
+
  private:
   explicit StreamConfig(QObject* parent = nullptr);
   ~StreamConfig() override = default;
@@ -81,4 +110,7 @@ class StreamConfig : public QObject {
   int m_subStreamFps = 1;
   int m_subStreamMinBitrate = 100;
   int m_subStreamMaxBitrate = 200;
+
+  // Adaptive concurrency (default values)
+  ConcurrencyPolicy m_concurrencyPolicy;
 };
\ No newline at end of file
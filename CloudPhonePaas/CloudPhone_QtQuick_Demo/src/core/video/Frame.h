@@ -1,5 +1,6 @@
 #pragma once
 
+#include <QByteArray>
 #include <QMetaType>
 #include <QSharedPointer>
 #include <QVector>
@@ -39,6 +40,7 @@ struct VideoFrameData {
 
   // 帧资源管理
   void* frame_handle = nullptr;  ///< 底层帧句柄，用于引用计数管理
+  QByteArray ownedBuffer;        ///< 自持有的 I420 数据（冻结帧等无 frame_handle 的帧使用）
 
   // 帧尺寸信息（所有类型通用）
   int width = 0;             ///< 帧宽度（像素）
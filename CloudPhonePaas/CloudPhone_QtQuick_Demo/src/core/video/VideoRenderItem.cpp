@@ -31,7 +31,12 @@ bool VideoRenderItem::hasFrame() const {
 }
 
 QSGNode* VideoRenderItem::updatePaintNode(QSGNode* oldNode, UpdatePaintNodeData*) {
+  // 帧引用在上传后即释放，此时纹理仍在 GPU 上：保留旧节点继续显示上一帧，只更新尺寸
   if (!hasFrame()) {
+    if (YuvNode* yuvNode = dynamic_cast<YuvNode*>(oldNode)) {
+      yuvNode->setItemSize(QSizeF(width(), height()));
+      return yuvNode;
+    }
     delete oldNode;
     return nullptr;
   }
@@ -18,6 +18,9 @@ class YuvNode : public QSGGeometryNode {
   // 设置帧数据和渲染区域尺寸，frameDirty表示是否需要上传新数据
   void setFrame(QQuickWindow* window, const VideoFrameData* frame, const QSizeF& itemSize, bool frameDirty);
 
+  // 仅更新渲染尺寸并保留已上传的纹理，没有新帧时用于继续显示上一帧
+  void setItemSize(const QSizeF& itemSize) { updateGeometry(itemSize); }
+
  private:
   // 更新几何信息（顶点、纹理坐标等）
   void updateGeometry(const QSizeF& itemSize);
@@ -5,6 +5,8 @@
 #include <QJsonDocument>
 #include <QNetworkCookie>
 #include <QNetworkReply>
+#include <QPointer>
+#include <QThreadPool>
 #include <QUuid>
 
 #include "../utils/Logger.h"
@@ -130,8 +132,8 @@ void ApiService::login(const QString& userId, const QString& password) {
       true);  // true表示需要处理响应头
 }
 
-void ApiService::describeAndroidInstances(int offset, int limit, const QStringList& instanceIds,
-                                          const QString& region) {
+QJsonObject ApiService::describeRequestData(int offset, int limit, const QStringList& instanceIds,
+                                            const QString& region) {
   QJsonObject data;
   data["Offset"] = offset;
   data["Limit"] = limit;
@@ -147,7 +149,12 @@ void ApiService::describeAndroidInstances(int offset, int limit, const QStringLi
   if (!region.isEmpty()) {
     data["AndroidInstanceRegion"] = region;
   }
+  return data;
+}
 
+void ApiService::describeAndroidInstances(int offset, int limit, const QStringList& instanceIds,
+                                          const QString& region) {
+  QJsonObject data = describeRequestData(offset, limit, instanceIds, region);
   sendRequest("/DescribeAndroidInstances", data, [this](const QJsonObject& response) {
     int totalCount = response["TotalCount"].toInt();
     QJsonArray instances = response["AndroidInstances"].toArray();
@@ -155,6 +162,120 @@ void ApiService::describeAndroidInstances(int offset, int limit, const QStringLi
   });
 }
 
+void ApiService::discoverAndroidInstances(const QStringList& instanceIds, const QString& region) {
+  auto discovery = std::make_shared<Discovery>();
+  discovery->generation = ++m_discoveryGeneration;
+  discovery->instanceIds = instanceIds;
+  discovery->region = region;
+  discovery->timer.start();
+
+  // 第一页返回 TotalCount 后才知道其余页的范围
+  requestInstancePage(discovery, 0);
+}
+
+void ApiService::requestInstancePage(const std::shared_ptr<Discovery>& discovery, int offset) {
+  QJsonObject data = describeRequestData(offset, kDiscoveryPageSize, discovery->instanceIds, discovery->region);
+  Logger::info(QString("API request sent: /DescribeAndroidInstances (offset %1)").arg(offset));
+
+  discovery->inFlight++;
+  QNetworkReply* reply = m_networkService->postRequest("/DescribeAndroidInstances", data);
+  connect(reply, &QNetworkReply::finished, this, [this, reply, discovery, offset]() {
+    reply->deleteLater();
+    if (reply->error() != QNetworkReply::NoError) {
+      InstancePage page;
+      page.errorCode = "NetworkError";
+      page.errorMessage = reply->errorString();
+      onInstancePage(discovery, offset, page);
+      return;
+    }
+
+    // 大页的 JSON 解析放到线程池，GUI 线程只负责合并结果
+    QByteArray responseData = reply->readAll();
+    QPointer<ApiService> self(this);
+    QThreadPool::globalInstance()->start([self, discovery, offset, responseData]() {
+      InstancePage page = parseInstancePage(responseData);
+      QMetaObject::invokeMethod(
+          self.data(),
+          [self, discovery, offset, page]() {
+            if (self) self->onInstancePage(discovery, offset, page);
+          },
+          Qt::QueuedConnection);
+    });
+  });
+}
+
+ApiService::InstancePage ApiService::parseInstancePage(const QByteArray& responseData) {
+  InstancePage page;
+  QJsonDocument doc = QJsonDocument::fromJson(responseData);
+  if (doc.isNull()) {
+    page.errorCode = "InvalidResponse";
+    page.errorMessage = "Invalid JSON format";
+    return page;
+  }
+
+  QJsonObject root = doc.object();
+  if (root.contains("Error")) {
+    QJsonObject error = root["Error"].toObject();
+    page.errorCode = error["Code"].toString();
+    page.errorMessage = error["Message"].toString();
+    return page;
+  }
+
+  QJsonObject response = root["Response"].toObject();
+  page.totalCount = response["TotalCount"].toInt();
+  page.instances = parseAndroidInstances(response["AndroidInstances"].toArray());
+  return page;
+}
+
+void ApiService::onInstancePage(const std::shared_ptr<Discovery>& discovery, int offset, const InstancePage& page) {
+  discovery->inFlight--;
+  if (discovery->generation != m_discoveryGeneration) {
+    return;  // 已被新的拉取取代
+  }
+
+  if (!page.errorCode.isEmpty()) {
+    discovery->failedPages++;
+    Logger::error(QString("DescribeAndroidInstances page at offset %1 failed: code=%2, message=%3")
+                      .arg(offset)
+                      .arg(page.errorCode, page.errorMessage));
+    if (page.errorCode == "AuthenticationFailed") {
+      emit authFailed(page.errorMessage);
+    } else {
+      emit apiError(page.errorCode, page.errorMessage);
+    }
+  } else {
+    if (offset == 0) {
+      discovery->totalCount = page.totalCount;
+      for (int next = kDiscoveryPageSize; next < page.totalCount; next += kDiscoveryPageSize) {
+        discovery->pendingOffsets.append(next);
+      }
+    }
+    discovery->received += page.instances.size();
+    Logger::debug(QString("DescribeAndroidInstances page at offset %1: %2 instances, %3/%4 after %5 ms")
+                      .arg(offset)
+                      .arg(page.instances.size())
+                      .arg(discovery->received)
+                      .arg(discovery->totalCount)
+                      .arg(discovery->timer.elapsed()));
+    if (!page.instances.isEmpty()) {
+      emit instancesPageReceived(page.instances, discovery->totalCount);
+    }
+  }
+
+  while (discovery->inFlight < kDiscoveryMaxParallel && !discovery->pendingOffsets.isEmpty()) {
+    requestInstancePage(discovery, discovery->pendingOffsets.takeFirst());
+  }
+
+  if (discovery->inFlight == 0 && discovery->pendingOffsets.isEmpty()) {
+    Logger::info(QString("Instance discovery finished: %1/%2 instances, %3 failed pages, %4 ms")
+                     .arg(discovery->received)
+                     .arg(discovery->totalCount)
+                     .arg(discovery->failedPages)
+                     .arg(discovery->timer.elapsed()));
+    emit instancesDiscoveryFinished(discovery->received, discovery->totalCount, discovery->failedPages);
+  }
+}
+
 void ApiService::connectAndroidGroupInstances(const QStringList& instanceIds, const QStringList& clientSessions) {
   QJsonObject data;
   QJsonArray idsArray, sessionsArray;
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <functional>
+#include <memory>
+#include <QElapsedTimer>
 #include <QJsonArray>
 #include <QJsonObject>
 #include <QObject>
@@ -45,6 +47,17 @@ class ApiService : public QObject {
   void describeAndroidInstances(int offset, int limit, const QStringList& instanceIds = QStringList(),
                                 const QString& region = QString());
 
+  /**
+   * @brief 分页拉取全部安卓实例
+   *
+   * 先请求第一页拿到 TotalCount，再以最多 kDiscoveryMaxParallel 个并发请求拉取剩余页。
+   * 每页的 JSON 在线程池中解析，解析完成后立即发出 instancesPageReceived，
+   * 全部页结束后发出 instancesDiscoveryFinished。再次调用会放弃上一次未完成的拉取。
+   * @param instanceIds 实例ID列表（可选）
+   * @param region 实例区域（可选）
+   */
+  void discoverAndroidInstances(const QStringList& instanceIds = QStringList(), const QString& region = QString());
+
   /**
    * @brief 创建安卓实例访问令牌
    * @param androidInstanceIds 安卓实例ID列表
@@ -70,7 +83,10 @@ class ApiService : public QObject {
    * @param instances JSON数组
    * @return QList<AndroidInstance>
    */
-  QList<AndroidInstance> parseAndroidInstances(const QJsonArray& instances);
+  static QList<AndroidInstance> parseAndroidInstances(const QJsonArray& instances);
+
+  static constexpr int kDiscoveryPageSize = 100;    ///< 分页拉取的每页数量
+  static constexpr int kDiscoveryMaxParallel = 4;  ///< 分页拉取的最大并发请求数
 
  signals:
   /// @brief 登录成功信号
@@ -82,6 +98,12 @@ class ApiService : public QObject {
   /// @brief 收到实例列表信号
   void instancesReceived(const QList<AndroidInstance>& instances, int totalCount);
 
+  /// @brief 分页拉取收到一页实例（各页按完成顺序到达）
+  void instancesPageReceived(const QList<AndroidInstance>& instances, int totalCount);
+
+  /// @brief 分页拉取结束；failedPages 为失败的页数
+  void instancesDiscoveryFinished(int receivedCount, int totalCount, int failedPages);
+
   /// @brief 组连接成功信号
   void groupConnected(const QStringList& serverSessions);
 
@@ -95,7 +117,34 @@ class ApiService : public QObject {
   void apiError(const QString& errorCode, const QString& message);
 
  private:
+  /// 一页实例的解析结果（在线程池中生成）
+  struct InstancePage {
+    QString errorCode;  ///< 为空表示成功
+    QString errorMessage;
+    int totalCount = 0;
+    QList<AndroidInstance> instances;
+  };
+
+  /// 一次分页拉取的状态，仅在 GUI 线程访问
+  struct Discovery {
+    quint64 generation = 0;
+    QStringList instanceIds;
+    QString region;
+    QList<int> pendingOffsets;  ///< 尚未发出的页
+    int inFlight = 0;
+    int totalCount = 0;
+    int received = 0;
+    int failedPages = 0;
+    QElapsedTimer timer;
+  };
+
+  static QJsonObject describeRequestData(int offset, int limit, const QStringList& instanceIds, const QString& region);
+  static InstancePage parseInstancePage(const QByteArray& responseData);
+  void requestInstancePage(const std::shared_ptr<Discovery>& discovery, int offset);
+  void onInstancePage(const std::shared_ptr<Discovery>& discovery, int offset, const InstancePage& page);
+
   NetworkService* m_networkService;  ///< 网络服务实例
+  quint64 m_discoveryGeneration = 0;  ///< 每次 discoverAndroidInstances 递增，旧拉取的结果被丢弃
 
   // 统一请求处理模板
   template <typename SuccessHandler>
@@ -1,33 +1,69 @@
 #include "InstanceImageDownloader.h"
 
+#include <QBuffer>
+#include <QEventLoop>
+#include <QImageReader>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
 #include <QSslConfiguration>
 #include <QSslSocket>
-#include <QtConcurrent>
+#include <QtMath>
 
 #include "utils/Logger.h"
 
+namespace {
+
+constexpr int kTickIntervalMs = 250;  // 调度器检查到期实例的间隔，不是单个实例的轮询间隔
+constexpr int kVisiblePollMs = 1000;
+constexpr int kHiddenPollMs = 15000;
+constexpr int kStatsLogIntervalMs = 60000;
+constexpr int kDefaultMaxInFlight = 4;
+constexpr int kTransferTimeoutMs = 10000;
+constexpr int kVisiblePriority = 1;  // QThreadPool::start 的优先级，不可见实例为 0
+
+}  // namespace
+
 InstanceImageDownloader::InstanceImageDownloader(BatchTaskOperator* tcrOperator, QObject* parent)
     : QObject(parent),
       m_tcrOperator(tcrOperator),
-      m_networkManager(new QNetworkAccessManager(this)),
-      m_downloadTimer(new QTimer(this)) {
+      m_downloadTimer(new QTimer(this)),
+      m_scheduler(kVisiblePollMs, kHiddenPollMs) {
+  m_pool.setMaxThreadCount(kDefaultMaxInFlight);
+  // 线程默认空闲 30 秒后退出，thread_local 的 QNetworkAccessManager 和保持的连接随之销毁，
+  // 不可见实例按 15 秒以上的间隔轮询时每次都要重新建连
+  m_pool.setExpiryTimeout(-1);
   connect(m_downloadTimer, &QTimer::timeout, this, &InstanceImageDownloader::downloadBatch);
 }
 
+InstanceImageDownloader::~InstanceImageDownloader() {
+  stopDownloading();
+  m_pool.waitForDone();
+}
+
 void InstanceImageDownloader::startDownloading(const QStringList& instanceIds) {
   m_instanceIds = instanceIds;
+  m_scheduler.setInstances(instanceIds);
   m_paused = false;  // 重置暂停状态
-  m_downloadingSet.clear();
-  m_downloadTimer->start(1000);
+  m_statsTimer.start();
+  m_downloadTimer->start(kTickIntervalMs);
 }
 
 void InstanceImageDownloader::stopDownloading() {
   m_downloadTimer->stop();
   m_paused = false;  // 重置暂停状态
-  m_downloadingSet.clear();
+
+  // 丢弃尚未开始的任务，正在执行的任务完成后也不再发出结果；被丢弃的任务不会上报，调度状态一并清空
+  m_generation++;
+  m_pool.clear();
+  m_inFlight = 0;
+  m_scheduler.setInstances(QStringList());
 }
 
-void InstanceImageDownloader::updateInstanceList(const QStringList& newInstances) { m_instanceIds = newInstances; }
+void InstanceImageDownloader::updateInstanceList(const QStringList& newInstances) {
+  m_instanceIds = newInstances;
+  m_scheduler.setInstances(newInstances);
+}
 
 // 添加暂停下载方法
 void InstanceImageDownloader::pauseDownloading() {
@@ -38,90 +74,189 @@ void InstanceImageDownloader::pauseDownloading() {
 // 添加恢复下载方法
 void InstanceImageDownloader::resumeDownloading() {
   m_paused = false;
-  m_downloadTimer->start(1000);
+  m_downloadTimer->start(kTickIntervalMs);
+}
+
+void InstanceImageDownloader::setMaxInFlight(int maxInFlight) { m_pool.setMaxThreadCount(qMax(1, maxInFlight)); }
+
+void InstanceImageDownloader::setTileSize(qreal tileWidth, qreal tileHeight, qreal devicePixelRatio) {
+  ScreenshotSizePolicy::Spec spec = ScreenshotSizePolicy::forTile(tileWidth, tileHeight, devicePixelRatio);
+  m_decodeSize = QSize(qCeil(tileWidth * devicePixelRatio), qCeil(tileHeight * devicePixelRatio));
+  if (spec != m_spec) {
+    m_spec = spec;
+    Logger::info(QString("InstanceImageDownloader: screenshot size %1x%2 q%3 for tile %4x%5 @%6x")
+                     .arg(spec.width)
+                     .arg(spec.height)
+                     .arg(spec.quality)
+                     .arg(tileWidth)
+                     .arg(tileHeight)
+                     .arg(devicePixelRatio));
+  }
+}
+
+void InstanceImageDownloader::setVisibleInstances(const QStringList& instanceIds) {
+  m_scheduler.setVisible(instanceIds);
 }
 
 void InstanceImageDownloader::downloadBatch() {
   if (m_paused || m_instanceIds.isEmpty()) {
-    Logger::info("InstanceImageDownloader is paused or instance list is empty");
+    Logger::debug("InstanceImageDownloader is paused or instance list is empty");
     return;
   }
 
-  // 每次都遍历最新的 m_instanceIds
-  for (const QString& instanceId : m_instanceIds) {
-    if (m_downloadingSet.contains(instanceId)) {
-      // 已经在下载中，跳过
-      continue;
-    }
+  if (m_statsTimer.elapsed() >= kStatsLogIntervalMs) {
+    m_statsTimer.restart();
+    quint64 polls = m_scheduler.completedPolls();
+    quint64 skipped = m_scheduler.skippedDecodes();
+    quint64 bytes = m_scheduler.downloadedBytes();
+    quint64 pollsInWindow = polls - m_lastLoggedPolls;
+    Logger::info(QString("InstanceImageDownloader: %1/%2 visible, %3 req/min, %4 KB/min (%5 bytes/poll), "
+                         "skipped decode %6/%7 (%8%)")
+                     .arg(m_scheduler.visibleCount())
+                     .arg(m_scheduler.instanceCount())
+                     .arg(m_scheduler.requestsPerMinute())
+                     .arg((bytes - m_lastLoggedBytes) / 1024)
+                     .arg(pollsInWindow ? (bytes - m_lastLoggedBytes) / pollsInWindow : 0)
+                     .arg(skipped)
+                     .arg(polls)
+                     .arg(polls ? skipped * 100 / polls : 0));
+    m_lastLoggedBytes = bytes;
+    m_lastLoggedPolls = polls;
+  }
+
+  // 只下发到期且没有请求在途的实例，可见实例在前；每次最多补满空闲线程，其余到期实例留在调度器中
+  const int freeSlots = m_pool.maxThreadCount() - m_inFlight;
+  if (freeSlots <= 0) {
+    return;
+  }
+  const QStringList dueIds = m_scheduler.takeDue(freeSlots);
+  m_inFlight += dueIds.size();
+  for (const QString& instanceId : dueIds) {
+    FetchTask task;
+    task.instanceId = instanceId;
+    task.generation = m_generation.load();
+    task.visible = m_scheduler.isVisible(instanceId);
+    task.validators = m_scheduler.validators(instanceId);
+    task.hasHash = m_scheduler.lastHash(instanceId, &task.lastHash);
+    task.decodeSize = m_decodeSize;
+    task.spec = m_spec;
+    m_pool.start([this, task]() { fetchImage(task); }, task.visible ? kVisiblePriority : 0);
+  }
+}
 
-    QString imageUrl = QString::fromStdString(m_tcrOperator->getInstanceImage(instanceId).toStdString());
+void InstanceImageDownloader::fetchImage(const FetchTask& task) {
+  const QString& instanceId = task.instanceId;
+  const int generation = task.generation;
+  FetchResult result;
+  if (generation == m_generation.load()) {
+    QString imageUrl =
+        m_tcrOperator->getInstanceImage(instanceId, task.spec.quality, task.spec.width, task.spec.height);
 
     if (imageUrl.isEmpty() || !imageUrl.startsWith("http")) {
       Logger::error("Invalid image URL for instance: " + instanceId);
-      continue;
-    }
+    } else {
+      // URL 带签名，不写入日志
+      Logger::debug(QString("Starting download for instance %1").arg(instanceId));
 
-    Logger::info(QString("Starting download for instance %1: %2").arg(instanceId).arg(imageUrl));
+      // 每个工作线程复用一个 QNetworkAccessManager（保持连接复用），用局部事件循环等待下载完成
+      thread_local QNetworkAccessManager networkManager;
 
-    QNetworkRequest request(imageUrl);
-    // 关键修复：配置 SSL 以接受自签名证书（用于开发/测试环境）
-    QSslConfiguration sslConfig = QSslConfiguration::defaultConfiguration();
-    sslConfig.setPeerVerifyMode(QSslSocket::VerifyNone);  // 禁用证书验证
-    request.setSslConfiguration(sslConfig);
+      QNetworkRequest request(imageUrl);
+      // 关键修复：配置 SSL 以接受自签名证书（用于开发/测试环境）
+      QSslConfiguration sslConfig = QSslConfiguration::defaultConfiguration();
+      sslConfig.setPeerVerifyMode(QSslSocket::VerifyNone);  // 禁用证书验证
+      request.setSslConfiguration(sslConfig);
+      request.setTransferTimeout(kTransferTimeoutMs);
+      // 条件请求：服务端支持时未变化的截图只返回 304，不再传输 JPEG
+      if (!task.validators.etag.isEmpty()) {
+        request.setRawHeader("If-None-Match", task.validators.etag);
+      }
+      if (!task.validators.lastModified.isEmpty()) {
+        request.setRawHeader("If-Modified-Since", task.validators.lastModified);
+      }
 
-    QNetworkReply* reply = m_networkManager->get(request);
+      QNetworkReply* reply = networkManager.get(request);
+      QEventLoop loop;
+      connect(reply, &QNetworkReply::finished, &loop, &QEventLoop::quit);
+      loop.exec();
 
-    // 标记为正在下载
-    m_downloadingSet.insert(instanceId);
+      QByteArray imageData;
+      if (reply->error() != QNetworkReply::NoError) {
+        // SSL 错误（HTTPS 证书验证失败）或其他网络错误
+        Logger::error(QString("Failed to download image for instance %1: %2 (error code: %3)")
+                          .arg(instanceId)
+                          .arg(reply->errorString())
+                          .arg(reply->error()));
+      } else if (reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 304) {
+        result.status = FetchStatus::NotModified;
+      } else {
+        imageData = reply->readAll();
+        if (imageData.isEmpty()) {
+          Logger::error(QString("Image data is empty for instance: %1").arg(instanceId));
+        } else {
+          result.status = FetchStatus::Content;
+          result.contentHash = qHash(imageData);
+          result.bytes = imageData.size();
+          result.validators.etag = reply->rawHeader("ETag");
+          result.validators.lastModified = reply->rawHeader("Last-Modified");
+        }
+      }
+      delete reply;
 
-    // 连接信号，处理 SSL 错误和其他错误
-    connect(reply, &QNetworkReply::errorOccurred, this, [this, reply, instanceId](QNetworkReply::NetworkError) {
-      Logger::warning(QString("Network error for instance %1: %2").arg(instanceId).arg(reply->errorString()));
-    });
+      // 与上次内容相同：跳过解码和界面刷新
+      bool unchanged =
+          result.status == FetchStatus::Content && task.hasHash && task.lastHash == result.contentHash;
 
-    connect(reply, &QNetworkReply::finished, this,
-            [this, reply, instanceId]() { onImageDownloaded(reply, instanceId); });
-  }
-}
+      if (result.status == FetchStatus::Content && !unchanged && m_thumbnailStore) {
+        m_thumbnailStore->put(instanceId, imageData);
+      }
 
-void InstanceImageDownloader::onImageDownloaded(QNetworkReply* reply, const QString& instanceId) {
-  // 下载完成，移除标记
-  m_downloadingSet.remove(instanceId);
-
-  // 检查是否有错误
-  if (reply->error() != QNetworkReply::NoError) {
-    // SSL 错误（HTTPS 证书验证失败）或其他网络错误
-    Logger::error(QString("Failed to download image for instance %1: %2 (error code: %3)")
-                      .arg(instanceId)
-                      .arg(reply->errorString())
-                      .arg(reply->error()));
-    reply->deleteLater();
-    return;
+      QImage image;
+      if (result.status == FetchStatus::Content && !unchanged && generation == m_generation.load()) {
+        // 直接解码到宫格尺寸：JPEG 解码器在 DCT 域缩小，不会先解出整张原图
+        QBuffer buffer(&imageData);
+        QImageReader reader(&buffer);
+        QSize sourceSize = reader.size();
+        if (!task.decodeSize.isEmpty() && sourceSize.isValid()) {
+          QSize scaledSize = sourceSize.scaled(task.decodeSize, Qt::KeepAspectRatio);
+          if (scaledSize.width() < sourceSize.width()) {
+            reader.setScaledSize(scaledSize);
+          }
+        }
+        if (reader.read(&image)) {
+          Logger::debug(QString("Image loaded successfully for instance: %1, size: %2x%3 (source %4x%5)")
+                            .arg(instanceId)
+                            .arg(image.width())
+                            .arg(image.height())
+                            .arg(sourceSize.width())
+                            .arg(sourceSize.height()));
+          emit imageDownloaded(instanceId, image);
+        } else {
+          Logger::error(QString("Failed to decode image data for instance: %1").arg(instanceId));
+        }
+      }
+    }
   }
 
-  // 读取图片数据
-  QByteArray imageData = reply->readAll();
+  QMetaObject::invokeMethod(this, [this, task, result]() { onFetchFinished(task, result); }, Qt::QueuedConnection);
+}
 
-  if (imageData.isEmpty()) {
-    Logger::error(QString("Image data is empty for instance: %1").arg(instanceId));
-    reply->deleteLater();
+void InstanceImageDownloader::onFetchFinished(const FetchTask& task, const FetchResult& result) {
+  if (task.generation != m_generation.load()) {
     return;
   }
-
-  // 将图片解码放到后台线程
-  (void)QtConcurrent::run([this, instanceId, imageData]() {
-    QImage image;
-    if (image.loadFromData(imageData)) {
-      // 解码完成后发出信号
-      Logger::info(QString("Image loaded successfully for instance: %1, size: %2x%3")
-                       .arg(instanceId)
-                       .arg(image.width())
-                       .arg(image.height()));
-      emit imageDownloaded(instanceId, image);
-    } else {
-      Logger::error(QString("Failed to decode image data for instance: %1").arg(instanceId));
-    }
-  });
-
-  reply->deleteLater();
+  m_inFlight--;
+  switch (result.status) {
+    case FetchStatus::Failed:
+      m_scheduler.report(task.instanceId, false, 0);
+      break;
+    case FetchStatus::NotModified:
+      m_scheduler.reportNotModified(task.instanceId);
+      break;
+    case FetchStatus::Content:
+      m_scheduler.setValidators(task.instanceId, result.validators);
+      m_scheduler.addDownloadedBytes(result.bytes);
+      m_scheduler.report(task.instanceId, true, result.contentHash);
+      break;
+  }
 }
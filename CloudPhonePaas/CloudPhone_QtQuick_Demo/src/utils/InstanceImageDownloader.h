@@ -1,19 +1,40 @@
 #pragma once
 
+#include <atomic>
+#include <QElapsedTimer>
 #include <QImage>  // 添加QImage头文件
-#include <QNetworkAccessManager>
-#include <QNetworkReply>  // 添加QNetworkReply头文件
 #include <QObject>
+#include <QSet>
+#include <QSize>
 #include <QStringList>
+#include <QThreadPool>
 #include <QTimer>
 
 #include "core/BatchTaskOperator.h"
+#include "core/ScreenshotSizePolicy.h"
+#include "utils/ScreenshotPollScheduler.h"
+#include "utils/ThumbnailStore.h"
 
+/**
+ * @brief 实例截图轮询下载器
+ *
+ * GUI 线程只负责按调度器下发到期实例和接收解码好的图片：
+ * - 截图 URL 获取（阻塞的 tcr_instance_get_image）、HTTP 下载和 JPEG 解码都在内部线程池中执行
+ * - 线程池大小即同时进行的请求数上限（setMaxInFlight），每次只按空闲线程数从调度器取任务，
+ *   可见实例以更高优先级提交，刚变为可见的实例不会排在已入队的不可见请求之后
+ * - 线程池线程不过期：每个线程的 QNetworkAccessManager 及其保持的连接在两次轮询之间保留
+ * - 每个实例独立计时（ScreenshotPollScheduler）：可见实例 1 秒，不可见实例 15 秒，
+ *   截图长时间不变时指数退避；同一实例请求未返回前不会重复下发
+ * - 带 If-None-Match / If-Modified-Since 条件请求；304 或内容哈希与上次相同时不解码、不发信号
+ * - 按宫格尺寸向服务端请求分档的截图规格，并用 QImageReader::setScaledSize 直接解码到宫格尺寸（setTileSize），
+ *   流量和内存随宫格大小而非手机分辨率增长
+ */
 class InstanceImageDownloader : public QObject {
   Q_OBJECT
 
  public:
   explicit InstanceImageDownloader(BatchTaskOperator* tcrOperator, QObject* parent = nullptr);
+  ~InstanceImageDownloader() override;
 
   void startDownloading(const QStringList& instanceIds);
   void stopDownloading();
@@ -26,19 +47,68 @@ class InstanceImageDownloader : public QObject {
   // 添加恢复下载方法
   void resumeDownloading();
 
+  // 设置同时进行的截图请求数上限
+  void setMaxInFlight(int maxInFlight);
+
+  // 设置宫格逻辑尺寸和设备像素比：据此选择请求的截图规格（ScreenshotSizePolicy），并按宫格物理像素尺寸解码；
+  // 未设置时请求服务端默认分辨率并按原图解码
+  void setTileSize(qreal tileWidth, qreal tileHeight, qreal devicePixelRatio);
+
+  // 设置当前可见的实例，其余实例按不可见间隔轮询
+  void setVisibleInstances(const QStringList& instanceIds);
+
+  // 最近一分钟下发的截图请求数
+  int requestsPerMinute() { return m_scheduler.requestsPerMinute(); }
+
+  // 设置持久化截图缓存，内容变化的截图在工作线程写入（在 startDownloading 前设置）
+  void setThumbnailStore(std::shared_ptr<ThumbnailStore> store) { m_thumbnailStore = std::move(store); }
+
  signals:
+  // 在工作线程发出，连接到 GUI 线程对象时自动排队投递
   void imageDownloaded(const QString& instanceId, const QImage& image);
 
  private slots:
   void downloadBatch();
-  void onImageDownloaded(QNetworkReply* reply, const QString& instanceId);
 
  private:
+  // 一次截图请求的输入，下发时从调度器取出该实例的缓存状态
+  struct FetchTask {
+    QString instanceId;
+    int generation = 0;
+    bool visible = false;
+    ScreenshotPollScheduler::Validators validators;
+    bool hasHash = false;
+    size_t lastHash = 0;
+    QSize decodeSize;
+    ScreenshotSizePolicy::Spec spec;
+  };
+  enum class FetchStatus { Failed, NotModified, Content };
+  struct FetchResult {
+    FetchStatus status = FetchStatus::Failed;
+    size_t contentHash = 0;
+    qint64 bytes = 0;
+    ScreenshotPollScheduler::Validators validators;
+  };
+
+  // 在工作线程执行：获取 URL、条件下载，内容变化时解码并发出 imageDownloaded
+  void fetchImage(const FetchTask& task);
+  // GUI 线程：把请求结果交给调度器
+  void onFetchFinished(const FetchTask& task, const FetchResult& result);
+
   BatchTaskOperator* m_tcrOperator;
-  QNetworkAccessManager* m_networkManager;
   QTimer* m_downloadTimer;
+  QThreadPool m_pool;
 
   QStringList m_instanceIds;  // 添加实例ID列表成员
-  QSet<QString> m_downloadingSet;
   bool m_paused = false;
+  QSize m_decodeSize;
+  ScreenshotSizePolicy::Spec m_spec;  ///< 宽高为 0 表示服务端默认分辨率
+  std::shared_ptr<ThumbnailStore> m_thumbnailStore;
+
+  ScreenshotPollScheduler m_scheduler;
+  std::atomic<int> m_generation{0};  // stop 后递增，旧任务的结果直接丢弃
+  int m_inFlight = 0;                // 本代已提交到线程池、尚未 onFetchFinished 的任务数
+  QElapsedTimer m_statsTimer;
+  quint64 m_lastLoggedBytes = 0;
+  quint64 m_lastLoggedPolls = 0;
 };
@@ -1,25 +1,226 @@
 #include "InstanceImageProvider.h"
 
+#include <QBuffer>
+#include <QElapsedTimer>
 #include <QImage>
+#include <QImageReader>
 #include <QMutexLocker>
 
-// 图像提供者实现
-InstanceImageProvider::InstanceImageProvider() : QQuickImageProvider(QQuickImageProvider::Image) {}
+#include "utils/Logger.h"
 
-QImage InstanceImageProvider::requestImage(const QString &id, QSize *size, const QSize &requestedSize) {
-  QMutexLocker locker(&m_mutex);
-  if (m_imageCache.contains(id)) {
-    return m_imageCache.value(id);
+namespace {
+
+// 每个实例最多保留的缩放尺寸数（网格、列表等不同视图各一种）
+constexpr int kMaxVariantsPerInstance = 3;
+// 缩放线程数，缩略图缩放很轻，不需要占满线程池
+constexpr int kMaxScaleThreads = 2;
+// 每多少次请求输出一次耗时统计
+constexpr int kStatsInterval = 100;
+
+quint64 sizeKey(const QSize &size) { return (quint64(quint32(size.width())) << 32) | quint32(size.height()); }
+
+// 去掉 "?v=<version>" 等后缀，得到实例ID
+QString instanceIdOf(const QString &id) {
+  int pos = id.indexOf(QLatin1Char('?'));
+  return pos < 0 ? id : id.left(pos);
+}
+
+}  // namespace
+
+// -------------------- InstanceImageResponse --------------------
+
+InstanceImageResponse::InstanceImageResponse(InstanceImageProvider *provider, const QString &instanceId,
+                                             const QSize &requestedSize)
+    : m_provider(provider), m_instanceId(instanceId), m_requestedSize(requestedSize) {
+  setAutoDelete(false);
+}
+
+QQuickTextureFactory *InstanceImageResponse::textureFactory() const {
+  return QQuickTextureFactory::textureFactoryForImage(m_image);
+}
+
+void InstanceImageResponse::cancel() { m_canceled.storeRelease(1); }
+
+void InstanceImageResponse::run() {
+  if (!m_canceled.loadAcquire()) {
+    m_image = m_provider->imageFor(m_instanceId, m_requestedSize);
   }
-  return QImage();  // 返回空图片
+  emit finished();
 }
 
-void InstanceImageProvider::updateImage(const QString &instanceId, const QImage &image) {
+// -------------------- InstanceImageProvider --------------------
+
+InstanceImageProvider::InstanceImageProvider() { m_pool.setMaxThreadCount(kMaxScaleThreads); }
+
+QQuickImageResponse *InstanceImageProvider::requestImageResponse(const QString &id, const QSize &requestedSize) {
+  QElapsedTimer timer;
+  timer.start();
+  auto *response = new InstanceImageResponse(this, instanceIdOf(id), requestedSize);
+  m_pool.start(response);
+  recordTiming(timer.nsecsElapsed(), -1, false);
+  return response;
+}
+
+QImage InstanceImageProvider::imageFor(const QString &instanceId, const QSize &requestedSize) {
+  QElapsedTimer timer;
+  timer.start();
+  loadStoredImage(instanceId);
+
+  QImage source;
+  QSize target;
+  quint64 key = 0;
+  {
+    QMutexLocker locker(&m_mutex);
+    auto it = m_imageCache.constFind(instanceId);
+    if (it == m_imageCache.constEnd() || it->source.isNull()) {
+      return QImage();  // 返回空图片
+    }
+    source = it->source;  // 隐式共享，不拷贝像素
+    target = targetSize(source.size(), requestedSize);
+    if (target == source.size()) {
+      recordTiming(-1, timer.nsecsElapsed(), false);
+      return source;
+    }
+    key = sizeKey(target);
+    auto variant = it->variants.constFind(key);
+    if (variant != it->variants.constEnd()) {
+      recordTiming(-1, timer.nsecsElapsed(), false);
+      return variant.value();
+    }
+  }
+
+  // 缩放不持锁，避免阻塞 updateImage
+  QImage scaled = source.scaled(target, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+  {
+    QMutexLocker locker(&m_mutex);
+    auto it = m_imageCache.find(instanceId);
+    // 缩放期间原图可能已被替换，此时不缓存旧图的缩放结果
+    if (it != m_imageCache.end() && it->source.cacheKey() == source.cacheKey()) {
+      if (it->variants.size() >= kMaxVariantsPerInstance) {
+        it->variants.clear();
+      }
+      it->variants.insert(key, scaled);
+    }
+  }
+  recordTiming(-1, timer.nsecsElapsed(), true);
+  return scaled;
+}
+
+void InstanceImageProvider::loadStoredImage(const QString &instanceId) {
+  if (!m_thumbnailStore) {
+    return;
+  }
+  {
+    QMutexLocker locker(&m_mutex);
+    if (m_imageCache.contains(instanceId)) {
+      return;
+    }
+  }
+
+  ThumbnailStore::Thumbnail thumbnail = m_thumbnailStore->get(instanceId);
+  if (thumbnail.isNull()) {
+    return;
+  }
+  // 直接从映射内存解码，不拷贝字节
+  QByteArray bytes = thumbnail.bytes();
+  QBuffer buffer(&bytes);
+  QImage image;
+  if (!QImageReader(&buffer).read(&image)) {
+    Logger::warning(QString("[InstanceImageProvider] stored thumbnail for %1 is not decodable").arg(instanceId));
+    return;
+  }
+
   QMutexLocker locker(&m_mutex);
-  m_imageCache.insert(instanceId, image);
+  // 解码期间可能已有新下载的截图，不覆盖
+  if (!m_imageCache.contains(instanceId)) {
+    m_imageCache[instanceId].source = image;
+  }
+}
+
+quint64 InstanceImageProvider::updateImage(const QString &instanceId, const QImage &image) {
+  QElapsedTimer timer;
+  timer.start();
+  quint64 version = 0;
+  {
+    QMutexLocker locker(&m_mutex);
+    Entry &entry = m_imageCache[instanceId];
+    entry.source = image;
+    entry.variants.clear();
+    version = ++entry.version;
+  }
+  QMutexLocker statsLocker(&m_statsMutex);
+  m_statsUpdateNs += timer.nsecsElapsed();
+  m_statsUpdates++;
+  return version;
+}
+
+void InstanceImageProvider::setThumbnailStore(std::shared_ptr<ThumbnailStore> store) {
+  m_thumbnailStore = std::move(store);
 }
 
 void InstanceImageProvider::clearCache() {
   QMutexLocker locker(&m_mutex);
   m_imageCache.clear();
-}
\ No newline at end of file
+}
+
+quint64 InstanceImageProvider::version(const QString &instanceId) {
+  QMutexLocker locker(&m_mutex);
+  auto it = m_imageCache.constFind(instanceId);
+  return it != m_imageCache.constEnd() ? it->version : 0;
+}
+
+QString InstanceImageProvider::imageSource(const QString &instanceId) {
+  return QStringLiteral("image://instance/%1?v=%2").arg(instanceId).arg(version(instanceId));
+}
+
+void InstanceImageProvider::recordTiming(qint64 callerNs, qint64 workerNs, bool scaled) {
+  QMutexLocker locker(&m_statsMutex);
+  if (callerNs >= 0) {
+    m_statsCallerNs += callerNs;
+    m_statsRequests++;
+  }
+  if (workerNs >= 0) {
+    m_statsWorkerNs += workerNs;
+  }
+  if (scaled) {
+    m_statsScaled++;
+  }
+  if (m_statsRequests < kStatsInterval) {
+    return;
+  }
+
+  Logger::debug(QString("[InstanceImageProvider] %1 requests: caller thread avg %2 us, worker avg %3 us "
+                        "(%4 scaled), updateImage avg %5 us over %6 updates")
+                    .arg(m_statsRequests)
+                    .arg(m_statsCallerNs / 1000.0 / m_statsRequests, 0, 'f', 1)
+                    .arg(m_statsWorkerNs / 1000.0 / m_statsRequests, 0, 'f', 1)
+                    .arg(m_statsScaled)
+                    .arg(m_statsUpdates ? m_statsUpdateNs / 1000.0 / m_statsUpdates : 0.0, 0, 'f', 1)
+                    .arg(m_statsUpdates));
+  m_statsRequests = 0;
+  m_statsScaled = 0;
+  m_statsCallerNs = 0;
+  m_statsWorkerNs = 0;
+  m_statsUpdateNs = 0;
+  m_statsUpdates = 0;
+}
+
+QSize InstanceImageProvider::targetSize(const QSize &sourceSize, const QSize &requestedSize) {
+  int width = requestedSize.width();
+  int height = requestedSize.height();
+  if (width <= 0 && height <= 0) {
+    return sourceSize;
+  }
+  // 只给出一边时按原图宽高比补全另一边
+  if (width <= 0) {
+    width = sourceSize.width() * height / qMax(1, sourceSize.height());
+  } else if (height <= 0) {
+    height = sourceSize.height() * width / qMax(1, sourceSize.width());
+  }
+
+  QSize target = sourceSize.scaled(QSize(width, height), Qt::KeepAspectRatio);
+  if (target.width() >= sourceSize.width() || target.isEmpty()) {
+    return sourceSize;
+  }
+  return target;
+}
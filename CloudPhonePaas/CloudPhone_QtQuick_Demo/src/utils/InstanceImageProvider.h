@@ -1,20 +1,100 @@
 #pragma once
 
+#include <QAtomicInt>
+#include <QHash>
 #include <QImage>
-#include <QMap>
 #include <QMutex>
-#include <QQuickImageProvider>
+#include <QQuickAsyncImageProvider>
+#include <QQuickImageResponse>
+#include <QRunnable>
+#include <QSize>
+#include <QThreadPool>
+#include <memory>
 
-// 图像提供者类
-class InstanceImageProvider : public QQuickImageProvider {
+#include "utils/ThumbnailStore.h"
+
+class InstanceImageProvider;
+
+// 单次图片请求：在线程池中取缓存图像（必要时缩放），完成后通知 QML
+class InstanceImageResponse : public QQuickImageResponse, public QRunnable {
+ public:
+  InstanceImageResponse(InstanceImageProvider *provider, const QString &instanceId, const QSize &requestedSize);
+
+  QQuickTextureFactory *textureFactory() const override;
+  void cancel() override;
+  void run() override;
+
+ private:
+  InstanceImageProvider *m_provider;
+  QString m_instanceId;
+  QSize m_requestedSize;
+  QImage m_image;
+  QAtomicInt m_canceled;
+};
+
+// 异步图像提供者
+// 原图由下载器在工作线程解码后通过 updateImage 放入缓存，请求时直接交出隐式共享的 QImage，不做深拷贝；
+// 需要缩小时在线程池中完成并按尺寸缓存，调用线程只负责创建响应对象。
+// id 格式为 "<instanceId>?v=<version>"，QML 刷新缩略图时只需把 source 中的版本号换成 version() 的新值，
+// 版本号之后的部分不参与查找。
+// 设置了 ThumbnailStore 时，内存中没有的实例会从上次保存的截图解码，启动后不必等第一轮截图下载完成。
+class InstanceImageProvider : public QQuickAsyncImageProvider {
  public:
   InstanceImageProvider();
-  QImage requestImage(const QString &id, QSize *size, const QSize &requestedSize) override;
+  QQuickImageResponse *requestImageResponse(const QString &id, const QSize &requestedSize) override;
 
-  void updateImage(const QString &instanceId, const QImage &image);
+  /**
+   * @brief 替换实例原图
+   * @return 该实例的新版本号
+   */
+  quint64 updateImage(const QString &instanceId, const QImage &image);
   void clearCache();
 
+  /**
+   * @brief 设置持久化截图缓存，内存未命中时从中解码（在首次请求前设置）
+   */
+  void setThumbnailStore(std::shared_ptr<ThumbnailStore> store);
+
+  /**
+   * @brief 实例当前版本号，未缓存时为 0
+   */
+  quint64 version(const QString &instanceId);
+
+  /**
+   * @brief 供 QML Image.source 使用的地址，形如 "image://instance/<instanceId>?v=<version>"
+   */
+  QString imageSource(const QString &instanceId);
+
  private:
-  QMap<QString, QImage> m_imageCache;
+  friend class InstanceImageResponse;
+
+  struct Entry {
+    QImage source;
+    quint64 version = 0;
+    QHash<quint64, QImage> variants;  ///< 目标尺寸 -> 缩放结果
+  };
+
+  // 在工作线程执行：取出（必要时缩放）指定尺寸的图像
+  QImage imageFor(const QString &instanceId, const QSize &requestedSize);
+  // 在工作线程执行：内存中没有该实例时，从 ThumbnailStore 解码上次保存的截图放入缓存
+  void loadStoredImage(const QString &instanceId);
+  // 记录一次请求在调用线程和工作线程上的耗时，每 kStatsInterval 次输出一行统计
+  void recordTiming(qint64 callerNs, qint64 workerNs, bool scaled);
+
+  // 根据 requestedSize 计算目标尺寸（保持宽高比，不放大）
+  static QSize targetSize(const QSize &sourceSize, const QSize &requestedSize);
+
+  QHash<QString, Entry> m_imageCache;
   QMutex m_mutex;
+  QThreadPool m_pool;
+  std::shared_ptr<ThumbnailStore> m_thumbnailStore;
+
+  // 耗时统计（受 m_statsMutex 保护）
+  QMutex m_statsMutex;
+  int m_statsRequests = 0;
+  int m_statsScaled = 0;
+  qint64 m_statsCallerNs = 0;
+  qint64 m_statsWorkerNs = 0;
+  qint64 m_statsUpdateNs = 0;
+  int m_statsUpdates = 0;
 };
@@ -1,11 +1,15 @@
 #include "Logger.h"
 
+#include <algorithm>
+#include <cstring>
+#include <deque>
 #include <iostream>
 #include <QCoreApplication>
 #include <QDebug>
 #include <QDir>
 #include <QElapsedTimer>
 #include <QFileInfo>
+#include <vector>
 
 #include "tcr_c_api.h"
 #include "tcr_types.h"
@@ -13,6 +17,15 @@
 
 Logger* Logger::m_instance = nullptr;
 
+namespace {
+// "[RateLimit] N messages suppressed at file:line"
+QString suppressedMessage(const char* site, int line, quint64 count) {
+  QString where = QFileInfo(QString::fromUtf8(site)).fileName();
+  if (line > 0) where += QString(":%1").arg(line);
+  return QString("[RateLimit] %1 messages suppressed at %2").arg(count).arg(where);
+}
+}  // namespace
+
 Logger* Logger::instance() {
   if (!m_instance) {
     m_instance = new Logger();
@@ -26,6 +39,7 @@ Logger::Logger() : m_logLevel(LOG_DEBUG), m_logToFile(false), m_stopThread(false
 
 Logger::~Logger() {
   stopLogThread();
+  QMutexLocker locker(&m_fileMutex);
   if (m_logFile.isOpen()) {
     m_logFile.close();
   }
@@ -35,21 +49,31 @@ void Logger::globalInit() {
   // 1. 初始化TCR SDK日志系统（C API方式）
   static TcrLogCallback logCallback;
   logCallback.user_data = nullptr;
+  // SDK 线程上只拷贝原始字节；DEBUG/INFO 按级别限流
   logCallback.on_log = [](void* /*user_data*/, TcrLogLevel level, const char* tag, const char* log) {
-    QString msg = QString("[%1] %2").arg(tag).arg(log);
+    static LogRateLimiter debugLimiter(LOG_DEBUG, "TcrSdk", 0, SDK_DEBUG_LOGS_PER_SEC, SDK_LOG_BURST);
+    static LogRateLimiter infoLimiter(LOG_INFO, "TcrSdk", 0, SDK_INFO_LOGS_PER_SEC, SDK_LOG_BURST);
+    Logger* logger = Logger::instance();
+    quint64 suppressed = 0;
     switch (level) {
       case TCR_LOG_LEVEL_TRACE:
       case TCR_LOG_LEVEL_DEBUG:
-        Logger::debug(msg);
+        if (logger->isEnabled(LOG_DEBUG) && debugLimiter.allow(&suppressed)) {
+          if (suppressed > 0) logger->logSuppressed(LOG_DEBUG, "TcrSdk", 0, suppressed);
+          logger->logRaw(LOG_DEBUG, tag, log);
+        }
         break;
       case TCR_LOG_LEVEL_INFO:
-        Logger::info(msg);
+        if (logger->isEnabled(LOG_INFO) && infoLimiter.allow(&suppressed)) {
+          if (suppressed > 0) logger->logSuppressed(LOG_INFO, "TcrSdk", 0, suppressed);
+          logger->logRaw(LOG_INFO, tag, log);
+        }
         break;
       case TCR_LOG_LEVEL_WARN:
-        Logger::warning(msg);
+        Logger::instance()->logRaw(LOG_WARNING, tag, log);
         break;
       case TCR_LOG_LEVEL_ERROR:
-        Logger::error(msg);
+        Logger::instance()->logRaw(LOG_ERROR, tag, log);
         break;
     }
   };
@@ -68,12 +92,41 @@ void Logger::globalInit() {
 
   // 打印运行环境信息
   EnvInfoPrinter::printEnvironmentInfo();
+
+  // 设置 LOGGER_BENCHMARK 环境变量时测量日志调用开销
+  if (qEnvironmentVariableIsSet("LOGGER_BENCHMARK")) {
+    Logger::instance()->benchmark();
+  }
 }
 
 void Logger::setLogLevel(LogLevel level) { m_logLevel = level; }
+void Logger::setOverflowPolicy(OverflowPolicy policy) { m_overflowPolicy = policy; }
+
+Logger::Counters Logger::counters() const {
+  Counters c;
+  c.dropped = m_dropped.load(std::memory_order_relaxed);
+  c.suppressed = m_suppressed.load(std::memory_order_relaxed);
+  c.blocked = m_fullWaits.load(std::memory_order_relaxed);
+  return c;
+}
+
+void Logger::logSuppressed(LogLevel level, const char* site, int line, quint64 count) {
+  log(level, suppressedMessage(site, line, count));
+}
+
+void Logger::registerLimiter(LogRateLimiter* limiter) {
+  QMutexLocker locker(&m_limiterMutex);
+  m_limiters.push_back(limiter);
+}
+
+// 静态限流器在进程退出时析构
+void Logger::unregisterLimiter(LogRateLimiter* limiter) {
+  QMutexLocker locker(&m_limiterMutex);
+  m_limiters.erase(std::remove(m_limiters.begin(), m_limiters.end(), limiter), m_limiters.end());
+}
 
 void Logger::setLogToFile(bool enable, const QString& filePath) {
-  QMutexLocker locker(&m_queueMutex);
+  QMutexLocker locker(&m_fileMutex);
   m_logToFile = enable;
   if (enable) {
     if (m_logFile.isOpen()) {
@@ -81,9 +134,8 @@ void Logger::setLogToFile(bool enable, const QString& filePath) {
     }
     m_logFilePath = filePath;
     m_logFile.setFileName(m_logFilePath);
-    if (m_logFile.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
-      m_textStream.setDevice(&m_logFile);
-    }
+    m_logFile.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text);
+    m_fileBytes = m_logFile.isOpen() ? m_logFile.size() : 0;
   }
 }
 
@@ -91,30 +143,154 @@ void Logger::setMaxFileSize(qint64 bytes) { m_maxFileSize = bytes; }
 void Logger::setMaxBackupFiles(int count) { m_maxBackupFiles = count; }
 
 void Logger::log(LogLevel level, const QString& message) {
-  if (level < m_logLevel) return;
+  if (level < m_logLevel.load(std::memory_order_relaxed)) return;
+
+  // 只记录原始时间戳和线程ID，格式化在写入线程完成
+  LogRecord record;
+  record.timeMs = QDateTime::currentMSecsSinceEpoch();
+  record.threadId = reinterpret_cast<quintptr>(QThread::currentThreadId());
+  record.level = level;
+  record.message = message;
+  enqueue(std::move(record));
+}
+
+void Logger::logRaw(LogLevel level, const char* tag, const char* text) {
+  if (level < m_logLevel.load(std::memory_order_relaxed)) return;
+
+  const qsizetype tagLen = tag ? qsizetype(qstrlen(tag)) : 0;
+  const qsizetype textLen = text ? qsizetype(qstrlen(text)) : 0;
+
+  LogRecord record;
+  record.timeMs = QDateTime::currentMSecsSinceEpoch();
+  record.threadId = reinterpret_cast<quintptr>(QThread::currentThreadId());
+  record.level = level;
+  record.raw.resize(tagLen + 1 + textLen);
+  char* out = record.raw.data();
+  if (tagLen > 0) memcpy(out, tag, size_t(tagLen));
+  out[tagLen] = '\0';
+  if (textLen > 0) memcpy(out + tagLen + 1, text, size_t(textLen));
+  enqueue(std::move(record));
+}
 
-  QString threadIdStr = QString::number(reinterpret_cast<quintptr>(QThread::currentThreadId()));
-  QString timeStr = QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss.zzz");
+void Logger::enqueue(LogRecord&& record) {
+  // 队列满时按策略处理；WARNING/ERROR 总是等待写入线程取走一批。
+  // OVERFLOW_DROP_OLDEST 的最老记录是 WARNING/ERROR 时保留它，改为丢弃当前这条，队列顺序不变
+  LogRecord evicted;  // 在锁外释放
+  QMutexLocker locker(&m_queueMutex);
+  if (m_logQueue.size() >= QUEUE_CAPACITY && !m_stopThread) {
+    const OverflowPolicy policy =
+        record.level >= LOG_WARNING ? OVERFLOW_BLOCK : m_overflowPolicy.load(std::memory_order_relaxed);
+    if (policy == OVERFLOW_DROP_NEWEST ||
+        (policy == OVERFLOW_DROP_OLDEST && m_logQueue.front().level >= LOG_WARNING)) {
+      m_dropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    if (policy == OVERFLOW_DROP_OLDEST) {
+      evicted = std::move(m_logQueue.front());
+      m_logQueue.pop_front();
+      m_dropped.fetch_add(1, std::memory_order_relaxed);
+    } else {
+      m_fullWaits.fetch_add(1, std::memory_order_relaxed);
+      // 停止后写入线程不再取记录，不再等待
+      while (m_logQueue.size() >= QUEUE_CAPACITY && !m_stopThread) m_queueNotFull.wait(&m_queueMutex);
+    }
+  }
+  m_logQueue.push_back(std::move(record));
+  m_queueNotEmpty.wakeOne();
+}
 
-  LogMsg logMsg{level, message, timeStr, threadIdStr};
+// 记录进入私有的同容量队列，队列满时等待（OVERFLOW_BLOCK），由消费线程按批取出释放；
+// 不经过正在使用的日志队列，结果附带期间真实日志的丢弃条数（m_dropped 增量）
+double Logger::benchmark(int threads, int callsPerThread) {
+  const QString message = QStringLiteral("[Benchmark] Frame callback sample message with some text");
+  const quint64 droppedBefore = m_dropped.load(std::memory_order_relaxed);
+
+  QMutex mutex;
+  QWaitCondition notEmpty;
+  QWaitCondition notFull;
+  std::deque<LogRecord> queue;
+  bool producing = true;
+  quint64 fullWaits = 0;
+
+  // 代替写入线程：按批取出记录并在本线程释放，不格式化、不写文件
+  QThread* consumer = QThread::create([&]() {
+    std::vector<LogRecord> batch;
+    batch.reserve(BATCH_SIZE);
+    while (true) {
+      {
+        QMutexLocker locker(&mutex);
+        if (queue.empty() && producing) notEmpty.wait(&mutex, FLUSH_INTERVAL_MS);
+        while (!queue.empty() && batch.size() < size_t(BATCH_SIZE)) {
+          batch.push_back(std::move(queue.front()));
+          queue.pop_front();
+        }
+        notFull.wakeAll();
+        if (batch.empty() && !producing) break;
+      }
+      batch.clear();
+    }
+  });
+  consumer->start();
+
+  QElapsedTimer timer;
+  timer.start();
+  std::vector<QThread*> workers;
+  for (int t = 0; t < threads; ++t) {
+    workers.push_back(QThread::create([&, callsPerThread]() {
+      for (int i = 0; i < callsPerThread; ++i) {
+        LogRecord record;
+        record.timeMs = QDateTime::currentMSecsSinceEpoch();
+        record.threadId = reinterpret_cast<quintptr>(QThread::currentThreadId());
+        record.level = LOG_INFO;
+        record.message = message;
+        QMutexLocker locker(&mutex);
+        if (queue.size() >= QUEUE_CAPACITY) {
+          ++fullWaits;
+          while (queue.size() >= QUEUE_CAPACITY) notFull.wait(&mutex);
+        }
+        queue.push_back(std::move(record));
+        notEmpty.wakeOne();
+      }
+    }));
+    workers.back()->start();
+  }
+  for (QThread* worker : workers) {
+    worker->wait();
+    delete worker;
+  }
+  const qint64 elapsedNs = timer.nsecsElapsed();
 
   {
-    QMutexLocker locker(&m_queueMutex);
-    m_logQueue.push(logMsg);
-    m_queueNotEmpty.wakeOne();
+    QMutexLocker locker(&mutex);
+    producing = false;
+    notEmpty.wakeOne();
   }
+  consumer->wait();
+  delete consumer;
+
+  const double totalCalls = double(threads) * callsPerThread;
+  const double nsPerCall = totalCalls > 0 ? elapsedNs / totalCalls : 0;
+  info(QString("[Logger] Benchmark: %1 threads x %2 calls, %3 ns/call (wall %4 ms, %5 ns per call per thread), "
+               "queue full %6 times, %7 live log messages dropped meanwhile")
+           .arg(threads)
+           .arg(callsPerThread)
+           .arg(nsPerCall, 0, 'f', 1)
+           .arg(elapsedNs / 1e6, 0, 'f', 1)
+           .arg(threads > 0 ? nsPerCall * threads : 0, 0, 'f', 1)
+           .arg(fullWaits)
+           .arg(m_dropped.load(std::memory_order_relaxed) - droppedBefore));
+  return nsPerCall;
 }
 
 void Logger::rotateLogFileIfNeeded() {
   if (!m_logToFile || !m_logFile.isOpen()) return;
-  if (m_logFile.size() < m_maxFileSize) return;
+  if (m_fileBytes < m_maxFileSize) return;
 
-  m_textStream.flush();
   m_logFile.close();
   doRotate();
   m_logFile.setFileName(m_logFilePath);
   m_logFile.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text);
-  m_textStream.setDevice(&m_logFile);
+  m_fileBytes = m_logFile.isOpen() ? m_logFile.size() : 0;
 }
 
 void Logger::doRotate() {
@@ -134,64 +310,130 @@ void Logger::doRotate() {
   QFile::rename(base, firstBackup);
 }
 
+QString Logger::formatRecord(const LogRecord& record) {
+  // 时间前缀按秒缓存
+  const qint64 second = record.timeMs / 1000;
+  if (second != m_cachedSecond) {
+    m_cachedSecond = second;
+    m_cachedTimePrefix = QDateTime::fromMSecsSinceEpoch(second * 1000).toString("yyyy-MM-dd hh:mm:ss");
+  }
+
+  const char* levelStr = "DEBUG";
+  switch (record.level) {
+    case LOG_DEBUG:
+      levelStr = "DEBUG";
+      break;
+    case LOG_INFO:
+      levelStr = "INFO ";
+      break;
+    case LOG_WARNING:
+      levelStr = "WARN ";
+      break;
+    case LOG_ERROR:
+      levelStr = "ERROR";
+      break;
+  }
+
+  QString message = record.message;
+  if (message.isEmpty() && !record.raw.isEmpty()) {
+    const qsizetype sep = record.raw.indexOf('\0');
+    message = QString("[%1] %2").arg(QString::fromUtf8(record.raw.constData(), sep),
+                                     QString::fromUtf8(record.raw.constData() + sep + 1, record.raw.size() - sep - 1));
+  }
+
+  return QString("[%1.%2] [%3] [%4] %5")
+      .arg(m_cachedTimePrefix)
+      .arg(int(record.timeMs % 1000), 3, 10, QLatin1Char('0'))
+      .arg(record.threadId)
+      .arg(QLatin1String(levelStr))
+      .arg(message);
+}
+
+// 在写入线程直接追加到缓冲区，不经过队列，避免队列满时自己阻塞自己
+void Logger::appendDropSummary(QByteArray& buffer) {
+  const quint64 dropped = m_dropped.load(std::memory_order_relaxed);
+  if (dropped == m_reportedDropped) return;
+  const qint64 now = QDateTime::currentMSecsSinceEpoch();
+  if (now - m_lastDropReportMs < DROP_REPORT_INTERVAL_MS) return;
+
+  appendDirect(buffer, LOG_WARNING,
+               QString("[Logger] Queue full, %1 messages dropped (%2 in total)")
+                   .arg(dropped - m_reportedDropped)
+                   .arg(dropped));
+
+  m_reportedDropped = dropped;
+  m_lastDropReportMs = now;
+}
+
+// LOGGER_RATE_LIMITED 只在下一次放行时输出汇总，突发停止后的计数在这里补上
+void Logger::appendSuppressedSummaries(QByteArray& buffer, bool force) {
+  const qint64 now = QDateTime::currentMSecsSinceEpoch();
+  if (!force && now - m_lastSuppressedReportMs < DROP_REPORT_INTERVAL_MS) return;
+  m_lastSuppressedReportMs = now;
+
+  QMutexLocker locker(&m_limiterMutex);
+  for (LogRateLimiter* limiter : m_limiters) {
+    const quint64 count = limiter->takeSuppressed();
+    if (count > 0) appendDirect(buffer, limiter->level(), suppressedMessage(limiter->site(), limiter->line(), count));
+  }
+}
+
+void Logger::appendDirect(QByteArray& buffer, LogLevel level, const QString& message) {
+  LogRecord record;
+  record.timeMs = QDateTime::currentMSecsSinceEpoch();
+  record.threadId = reinterpret_cast<quintptr>(QThread::currentThreadId());
+  record.level = level;
+  record.message = message;
+  const QString line = formatRecord(record);
+  qDebug() << line;
+  buffer += line.toUtf8();
+  buffer += '\n';
+}
+
+void Logger::writeBatch(const QByteArray& data) {
+  QMutexLocker locker(&m_fileMutex);
+  if (!m_logToFile || !m_logFile.isOpen()) return;
+  const qint64 written = m_logFile.write(data);
+  if (written > 0) m_fileBytes += written;
+  m_logFile.flush();
+  rotateLogFileIfNeeded();
+}
+
 void Logger::logWriterLoop() {
-  std::vector<QString> batch;
+  QByteArray buffer;
+  std::vector<LogRecord> batch;
   batch.reserve(BATCH_SIZE);
-  QElapsedTimer timer;
-  timer.start();
 
   while (true) {
+    // 锁内只取出一批，格式化在锁外
+    bool stop = false;
     {
       QMutexLocker locker(&m_queueMutex);
-      while (m_logQueue.empty() && !m_stopThread) {
-        m_queueNotEmpty.wait(&m_queueMutex, FLUSH_INTERVAL_MS);
-        break;  // 超时后也要检查flush
+      if (m_logQueue.empty() && !m_stopThread) m_queueNotEmpty.wait(&m_queueMutex, FLUSH_INTERVAL_MS);
+      while (!m_logQueue.empty() && batch.size() < size_t(BATCH_SIZE)) {
+        batch.push_back(std::move(m_logQueue.front()));
+        m_logQueue.pop_front();
       }
-      while (!m_logQueue.empty() && batch.size() < BATCH_SIZE) {
-        const LogMsg& msg = m_logQueue.front();
-        QString levelStr;
-        switch (msg.level) {
-          case LOG_DEBUG:
-            levelStr = "DEBUG";
-            break;
-          case LOG_INFO:
-            levelStr = "INFO ";
-            break;
-          case LOG_WARNING:
-            levelStr = "WARN ";
-            break;
-          case LOG_ERROR:
-            levelStr = "ERROR";
-            break;
-        }
-        QString logMsg =
-            QString("[%1] [%2] [%3] %4").arg(msg.timeStr).arg(msg.threadIdStr).arg(levelStr).arg(msg.message);
-        batch.push_back(logMsg);
-        m_logQueue.pop();
-      }
-      if (m_stopThread && m_logQueue.empty() && batch.empty()) break;
+      if (!batch.empty()) m_queueNotFull.wakeAll();
+      stop = m_stopThread && m_logQueue.empty();
     }
 
-    if (!batch.empty()) {
-      // 文件
-      if (m_logToFile && m_logFile.isOpen()) {
-        for (const auto& logMsg : batch) {
-          m_textStream << logMsg << "\n";
-          qDebug() << logMsg;  // 同时输出到控制台
-        }
-        m_textStream.flush();
-        rotateLogFileIfNeeded();
-      }
-      batch.clear();
-      timer.restart();
-    } else if (timer.elapsed() > FLUSH_INTERVAL_MS) {
-      // 定时flush
-      if (m_logToFile && m_logFile.isOpen()) {
-        m_textStream.flush();
-        rotateLogFileIfNeeded();
-      }
-      timer.restart();
+    for (const LogRecord& record : batch) {
+      const QString line = formatRecord(record);
+      qDebug() << line;  // 同时输出到控制台
+      buffer += line.toUtf8();
+      buffer += '\n';
+    }
+    batch.clear();  // 在写入线程释放消息内存
+
+    appendDropSummary(buffer);
+    appendSuppressedSummaries(buffer, stop);
+
+    if (!buffer.isEmpty()) {
+      writeBatch(buffer);
+      buffer.clear();
     }
+    if (stop) break;
   }
 }
 
@@ -206,6 +448,7 @@ void Logger::stopLogThread() {
     QMutexLocker locker(&m_queueMutex);
     m_stopThread = true;
     m_queueNotEmpty.wakeAll();
+    m_queueNotFull.wakeAll();
   }
   if (m_logThread) {
     m_logThread->wait();
@@ -214,6 +457,41 @@ void Logger::stopLogThread() {
   }
 }
 
+namespace {
+qint64 steadyNowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+}  // namespace
+
+LogRateLimiter::LogRateLimiter(Logger::LogLevel level, const char* site, int line, double perSecond, int burst)
+    : m_level(level),
+      m_site(site),
+      m_line(line),
+      m_intervalNs(perSecond > 0 ? qint64(1e9 / perSecond) : 0),
+      m_burstNs(m_intervalNs * qMax(1, burst)) {
+  Logger::instance()->registerLimiter(this);
+}
+
+LogRateLimiter::~LogRateLimiter() { Logger::instance()->unregisterLimiter(this); }
+
+bool LogRateLimiter::allow(quint64* suppressed) {
+  const qint64 now = steadyNowNs();
+  qint64 tat = m_tat.load(std::memory_order_relaxed);
+  for (;;) {
+    // 每条日志把理论到达时间推后一个间隔，超出 burst 个间隔即为令牌耗尽
+    const qint64 next = qMax(tat, now) + m_intervalNs;
+    if (next - now > m_burstNs) {
+      m_suppressed.fetch_add(1, std::memory_order_relaxed);
+      Logger::instance()->noteSuppressed();
+      return false;
+    }
+    if (m_tat.compare_exchange_weak(tat, next, std::memory_order_relaxed)) break;
+  }
+  *suppressed = m_suppressed.exchange(0, std::memory_order_relaxed);
+  return true;
+}
+
 void Logger::debug(const QString& message) { instance()->log(LOG_DEBUG, message); }
 void Logger::info(const QString& message) { instance()->log(LOG_INFO, message); }
 void Logger::warning(const QString& message) { instance()->log(LOG_WARNING, message); }
@@ -1,29 +1,59 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <vector>
+#include <QByteArray>
 #include <QDateTime>
 #include <QFile>
 #include <QMutex>
 #include <QObject>
-#include <QTextStream>
 #include <QThread>
 #include <QTimer>
-#include <queue>
 #include <QWaitCondition>
 
+class LogRateLimiter;
+
 class Logger : public QObject {
   Q_OBJECT
  public:
   enum LogLevel { LOG_DEBUG, LOG_INFO, LOG_WARNING, LOG_ERROR };
 
+  // 队列满时的处理策略，只作用于 DEBUG/INFO（WARNING/ERROR 总是等待空位）
+  enum OverflowPolicy {
+    OVERFLOW_BLOCK,        // 等待写入线程腾出空位
+    OVERFLOW_DROP_OLDEST,  // 淘汰最老的一条；最老的是 WARNING/ERROR 时保留它，改为丢弃当前这条
+    OVERFLOW_DROP_NEWEST   // 丢弃当前这条
+  };
+
+  // 丢弃/限流计数（进程启动以来累计）
+  struct Counters {
+    quint64 dropped = 0;     // 队列满被丢弃
+    quint64 suppressed = 0;  // 被调用点限流抑制
+    quint64 blocked = 0;     // 队列满时等待的次数
+  };
+
   static void globalInit();
   static Logger* instance();
 
   void setLogLevel(LogLevel level);
+  bool isEnabled(LogLevel level) const { return level >= m_logLevel.load(std::memory_order_relaxed); }
+  void setOverflowPolicy(OverflowPolicy policy);  // 默认 OVERFLOW_DROP_OLDEST
+  Counters counters() const;
   void setLogToFile(bool enable, const QString& filePath = QString());
   void setMaxFileSize(qint64 bytes);  // 设置单个日志文件最大字节数
   void setMaxBackupFiles(int count);  // 设置轮转文件个数
 
   void log(LogLevel level, const QString& message);
+  // SDK 日志：拼接和解码推迟到写入线程
+  void logRaw(LogLevel level, const char* tag, const char* text);
+  // 调用开销基准：threads 个线程各调用 callsPerThread 次，返回并记录 ns/call
+  // 使用私有的同容量队列并按 OVERFLOW_BLOCK 入队，不占用也不淘汰正在使用的日志队列
+  double benchmark(int threads = 8, int callsPerThread = 100000);
+  // LOGGER_RATE_LIMITED 使用：输出 "N messages suppressed" 汇总 / 记录一次抑制
+  void logSuppressed(LogLevel level, const char* site, int line, quint64 count);
+  void noteSuppressed() { m_suppressed.fetch_add(1, std::memory_order_relaxed); }
 
   // 方便使用的静态函数
   static void debug(const QString& message);
@@ -42,33 +72,112 @@ class Logger : public QObject {
   void rotateLogFileIfNeeded();  // 轮转日志文件
   void doRotate();               // 执行轮转
 
-  struct LogMsg {
-    LogLevel level;
+  // 调用线程只填原始数据，格式化在写入线程完成
+  struct LogRecord {
+    qint64 timeMs = 0;
+    quintptr threadId = 0;
+    LogLevel level = LOG_DEBUG;
     QString message;
-    QString timeStr;
-    QString threadIdStr;
+    QByteArray raw;  // 未解码的 SDK 日志 "tag\0text"
   };
 
+  void enqueue(LogRecord&& record);
+  QString formatRecord(const LogRecord& record);
+  void appendDropSummary(QByteArray& buffer);  // 写入线程直接追加丢弃汇总，不经过队列
+  // 写入线程汇总各调用点尚未输出的限流抑制条数（最多每秒一次，停止时强制），突发停止后计数也不丢
+  void appendSuppressedSummaries(QByteArray& buffer, bool force);
+  void appendDirect(QByteArray& buffer, LogLevel level, const QString& message);  // 格式化一行直接追加
+  void writeBatch(const QByteArray& data);
+
+  // 调用点限流器登记在 Logger 中，供写入线程汇总
+  friend class LogRateLimiter;
+  void registerLimiter(LogRateLimiter* limiter);
+  void unregisterLimiter(LogRateLimiter* limiter);
+
   static Logger* m_instance;
-  LogLevel m_logLevel;
+  std::atomic<LogLevel> m_logLevel;
   bool m_logToFile;
   QString m_logFilePath;
   QFile m_logFile;
-  QTextStream m_textStream;
+  QMutex m_fileMutex;
+  qint64 m_fileBytes = 0;  // 已写入字节数，代替每条日志查询文件大小
 
-  // 线程安全队列
+  // 有界队列，锁内只移动记录
+  static constexpr size_t QUEUE_CAPACITY = 8192;
   QMutex m_queueMutex;
   QWaitCondition m_queueNotEmpty;
-  std::queue<LogMsg> m_logQueue;
-  bool m_stopThread;
+  QWaitCondition m_queueNotFull;  // OVERFLOW_BLOCK 等待空位
+  std::deque<LogRecord> m_logQueue;
+  bool m_stopThread;  // 受 m_queueMutex 保护
   QThread* m_logThread;
 
+  // 溢出策略与计数
+  std::atomic<OverflowPolicy> m_overflowPolicy{OVERFLOW_DROP_OLDEST};
+  std::atomic<quint64> m_fullWaits{0};
+  std::atomic<quint64> m_dropped{0};
+  std::atomic<quint64> m_suppressed{0};
+  quint64 m_reportedDropped = 0;  // 写入线程已汇总过的丢弃条数
+  qint64 m_lastDropReportMs = 0;
+  QMutex m_limiterMutex;
+  std::vector<LogRateLimiter*> m_limiters;  // 受 m_limiterMutex 保护
+  qint64 m_lastSuppressedReportMs = 0;
+
   // 批量写入相关
-  static constexpr int BATCH_SIZE = 100;
-  static constexpr int FLUSH_INTERVAL_MS = 100;  // 100ms强制flush
-  qint64 m_lastFlushTime = 0;
+  static constexpr int BATCH_SIZE = 256;
+  static constexpr int FLUSH_INTERVAL_MS = 100;         // 空闲时最长等待
+  static constexpr int DROP_REPORT_INTERVAL_MS = 1000;  // 丢弃汇总最多每秒一次
+
+  // SDK 日志限流（WARN/ERROR 不限流）
+  static constexpr double SDK_DEBUG_LOGS_PER_SEC = 50;
+  static constexpr double SDK_INFO_LOGS_PER_SEC = 100;
+  static constexpr int SDK_LOG_BURST = 200;
+
+  // 写入线程的时间格式缓存（按秒）
+  qint64 m_cachedSecond = -1;
+  QString m_cachedTimePrefix;
 
   // 日志轮转相关
   qint64 m_maxFileSize = 200 * 1024 * 1024;  // 200MB
   int m_maxBackupFiles = 5;
-};
\ No newline at end of file
+};
+
+// 单个调用点的令牌桶限流（GCRA 形式，单个原子变量，线程安全）
+// 被抑制的条数在下一次放行时输出；之后不再放行时由写入线程每秒汇总一次
+class LogRateLimiter {
+ public:
+  // level/site/line：汇总行的级别和调用点（site 需为静态字符串，line 为 0 时不输出）
+  LogRateLimiter(Logger::LogLevel level, const char* site, int line, double perSecond, int burst);
+  ~LogRateLimiter();
+  LogRateLimiter(const LogRateLimiter&) = delete;
+  LogRateLimiter& operator=(const LogRateLimiter&) = delete;
+
+  bool allow(quint64* suppressed);  // 放行时返回上次放行以来被抑制的条数
+  // 取走尚未汇总的抑制条数，与 allow 之间每条只汇总一次
+  quint64 takeSuppressed() { return m_suppressed.exchange(0, std::memory_order_relaxed); }
+  Logger::LogLevel level() const { return m_level; }
+  const char* site() const { return m_site; }
+  int line() const { return m_line; }
+
+ private:
+  Logger::LogLevel m_level;
+  const char* m_site;
+  int m_line;
+  qint64 m_intervalNs;
+  qint64 m_burstNs;
+  std::atomic<qint64> m_tat{0};  // 理论到达时间（steady_clock 纳秒）
+  std::atomic<quint64> m_suppressed{0};
+};
+
+// 按调用点限流记录日志，message 只在放行时求值
+#define LOGGER_RATE_LIMITED(level, perSecond, burst, message)                                                          \
+  do {                                                                                                                 \
+    static LogRateLimiter loggerRateLimiter_((level), __FILE__, __LINE__, (perSecond), (burst));                       \
+    quint64 loggerSuppressed_ = 0;                                                                                     \
+    Logger* logger_ = Logger::instance();                                                                              \
+    if (logger_->isEnabled(level) && loggerRateLimiter_.allow(&loggerSuppressed_)) {                                   \
+      if (loggerSuppressed_ > 0) {                                                                                     \
+        logger_->logSuppressed((level), __FILE__, __LINE__, loggerSuppressed_);                                        \
+      }                                                                                                                \
+      logger_->log((level), (message));                                                                                \
+    }                                                                                                                  \
+  } while (0)
@@ -0,0 +1,179 @@
+#include "ScreenshotPollScheduler.h"
+
+#include <QSet>
+#include <algorithm>
+#include <vector>
+
+ScreenshotPollScheduler::ScreenshotPollScheduler(int visibleIntervalMs, int hiddenIntervalMs, int maxIntervalMs,
+                                                 int unchangedBeforeBackoff)
+    : m_visibleIntervalMs(visibleIntervalMs),
+      m_hiddenIntervalMs(hiddenIntervalMs),
+      m_maxIntervalMs(maxIntervalMs),
+      m_unchangedBeforeBackoff(unchangedBeforeBackoff) {
+  m_clock.start();
+}
+
+void ScreenshotPollScheduler::setInstances(const QStringList& instanceIds) {
+  QHash<QString, Entry> entries;
+  entries.reserve(instanceIds.size());
+  qint64 now = m_clock.elapsed();
+  qint64 added = 0;
+  for (const QString& id : instanceIds) {
+    if (!m_entries.contains(id) && !m_visible.contains(id)) {
+      added++;
+    }
+  }
+  // 新的不可见实例：首次轮询在一个不可见间隔内均匀错开，第一轮只处理可见实例
+  qint64 addedIndex = 0;
+  for (const QString& id : instanceIds) {
+    auto it = m_entries.constFind(id);
+    if (it != m_entries.constEnd()) {
+      entries.insert(id, it.value());
+      continue;
+    }
+    Entry e;
+    e.visible = m_visible.contains(id);
+    e.nextDueMs = now;
+    if (!e.visible) {
+      e.nextDueMs += m_hiddenIntervalMs * ++addedIndex / added;
+    }
+    entries.insert(id, e);
+  }
+  m_entries.swap(entries);
+}
+
+void ScreenshotPollScheduler::setVisible(const QStringList& instanceIds) {
+  m_visible = QSet<QString>(instanceIds.begin(), instanceIds.end());
+  qint64 now = m_clock.elapsed();
+  for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+    Entry& e = it.value();
+    bool nowVisible = m_visible.contains(it.key());
+    if (nowVisible && !e.visible) {
+      e.nextDueMs = now;  // 滚动进入视野：立即刷新
+    }
+    e.visible = nowVisible;
+  }
+}
+
+QStringList ScreenshotPollScheduler::takeDue(int maxCount) {
+  qint64 now = m_clock.elapsed();
+  using Candidate = QHash<QString, Entry>::iterator;
+  std::vector<Candidate> visibleDue;
+  std::vector<Candidate> hiddenDue;
+  for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+    const Entry& e = it.value();
+    if (e.inFlight || e.nextDueMs > now || intervalOf(e) == 0) {
+      continue;
+    }
+    (e.visible ? visibleDue : hiddenDue).push_back(it);
+  }
+
+  QStringList due;
+  auto take = [&](std::vector<Candidate>& candidates) {
+    const size_t count = std::min(candidates.size(), size_t(std::max(0, maxCount - int(due.size()))));
+    // 放不下时逾期最久的在前
+    if (count < candidates.size()) {
+      std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end(),
+                        [](const Candidate& a, const Candidate& b) { return a->nextDueMs < b->nextDueMs; });
+    }
+    for (size_t i = 0; i < count; ++i) {
+      candidates[i]->inFlight = true;
+      due.append(candidates[i].key());
+      m_issuedMs.enqueue(now);
+    }
+  };
+  take(visibleDue);
+  take(hiddenDue);
+  pruneIssued(now);
+  return due;
+}
+
+bool ScreenshotPollScheduler::report(const QString& instanceId, bool ok, size_t contentHash) {
+  auto it = m_entries.find(instanceId);
+  if (it == m_entries.end()) {
+    return ok;
+  }
+
+  Entry& e = it.value();
+  bool changed = ok && !(e.hasHash && e.hash == contentHash);
+  if (changed) {
+    e.hash = contentHash;
+    e.hasHash = true;
+  }
+  finish(e, ok, changed);
+  return changed;
+}
+
+void ScreenshotPollScheduler::reportNotModified(const QString& instanceId) {
+  auto it = m_entries.find(instanceId);
+  if (it != m_entries.end()) {
+    finish(it.value(), true, false);
+  }
+}
+
+ScreenshotPollScheduler::Validators ScreenshotPollScheduler::validators(const QString& instanceId) const {
+  auto it = m_entries.constFind(instanceId);
+  return it != m_entries.constEnd() ? it.value().validators : Validators();
+}
+
+void ScreenshotPollScheduler::setValidators(const QString& instanceId, const Validators& validators) {
+  auto it = m_entries.find(instanceId);
+  if (it != m_entries.end()) {
+    it.value().validators = validators;
+  }
+}
+
+bool ScreenshotPollScheduler::lastHash(const QString& instanceId, size_t* hash) const {
+  auto it = m_entries.constFind(instanceId);
+  if (it == m_entries.constEnd() || !it.value().hasHash) {
+    return false;
+  }
+  *hash = it.value().hash;
+  return true;
+}
+
+void ScreenshotPollScheduler::finish(Entry& e, bool ok, bool changed) {
+  e.inFlight = false;
+  if (ok) {
+    m_completedPolls++;
+    if (changed) {
+      e.unchanged = 0;
+    } else {
+      e.unchanged++;
+      m_skippedDecodes++;
+    }
+  }
+  int interval = intervalOf(e);
+  e.nextDueMs = m_clock.elapsed() + (interval > 0 ? interval : m_visibleIntervalMs);
+}
+
+int ScreenshotPollScheduler::requestsPerMinute() {
+  pruneIssued(m_clock.elapsed());
+  return m_issuedMs.size();
+}
+
+int ScreenshotPollScheduler::visibleCount() const {
+  return static_cast<int>(
+      std::count_if(m_entries.cbegin(), m_entries.cend(), [](const Entry& e) { return e.visible; }));
+}
+
+int ScreenshotPollScheduler::intervalOf(const Entry& e) const {
+  int base = e.visible ? m_visibleIntervalMs : m_hiddenIntervalMs;
+  if (base == 0) {
+    return 0;
+  }
+
+  int doublings = e.unchanged - m_unchangedBeforeBackoff + 1;
+  if (doublings <= 0) {
+    return base;
+  }
+  // 限制移位次数，结果最终受 maxIntervalMs 约束
+  qint64 interval = static_cast<qint64>(base) << std::min(doublings, 10);
+  return static_cast<int>(std::min<qint64>(interval, std::max(m_maxIntervalMs, base)));
+}
+
+void ScreenshotPollScheduler::pruneIssued(qint64 nowMs) {
+  while (!m_issuedMs.isEmpty() && nowMs - m_issuedMs.head() > 60000) {
+    m_issuedMs.dequeue();
+  }
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <climits>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QQueue>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+/**
+ * @brief 按实例独立计时的截图轮询调度器
+ *
+ * 每个实例有自己的下次到期时间，不再按固定轮次刷新全部实例：
+ * - 可见实例按 visibleIntervalMs 轮询，不可见实例按 hiddenIntervalMs 轮询（0 表示不可见时不轮询）
+ * - 实例从不可见变为可见时立即到期
+ * - 新加入的实例默认不可见（除非在最近一次 setVisible 的集合中），首次轮询在一个不可见间隔内错开，
+ *   发现大量实例后不会一次性下发全部请求
+ * - 连续 unchangedBeforeBackoff 次拿到相同内容后，每多一次未变化间隔翻倍，上限 maxIntervalMs
+ * - 请求未返回前不会重复下发同一实例
+ *
+ * 同时记录每个实例的 HTTP 缓存校验字段和内容哈希，用于条件请求以及跳过未变化截图的解码。
+ *
+ * 仅在 GUI 线程使用，不加锁。
+ */
+class ScreenshotPollScheduler {
+ public:
+  /// 服务端返回的缓存校验字段（未提供时为空）
+  struct Validators {
+    QByteArray etag;
+    QByteArray lastModified;
+  };
+
+  ScreenshotPollScheduler(int visibleIntervalMs, int hiddenIntervalMs, int maxIntervalMs = 30000,
+                          int unchangedBeforeBackoff = 3);
+
+  /**
+   * @brief 替换实例集合，保留仍存在实例的状态；新实例的可见性取最近一次 setVisible 的集合
+   */
+  void setInstances(const QStringList& instanceIds);
+
+  /**
+   * @brief 仅这些实例可见，其余实例视为不可见；集合会保留，之后 setInstances 加入的实例同样适用
+   */
+  void setVisible(const QStringList& instanceIds);
+
+  /**
+   * @brief 取出最多 maxCount 个当前到期的实例（可见实例在前，其次是逾期最久的），标记为请求中并计入请求数；
+   * 其余到期实例留到下次
+   */
+  QStringList takeDue(int maxCount = INT_MAX);
+
+  /**
+   * @brief 上报请求结果，ok 为 false 时 contentHash 无意义
+   * @return 内容与上次不同时返回 true（需要解码和刷新界面）
+   */
+  bool report(const QString& instanceId, bool ok, size_t contentHash);
+
+  /**
+   * @brief 上报 304 响应，等同于内容未变化
+   */
+  void reportNotModified(const QString& instanceId);
+
+  /**
+   * @brief 上次成功响应的缓存校验字段，用于条件请求
+   */
+  Validators validators(const QString& instanceId) const;
+  void setValidators(const QString& instanceId, const Validators& validators);
+
+  /**
+   * @brief 上次内容的哈希，没有时返回 false
+   */
+  bool lastHash(const QString& instanceId, size_t* hash) const;
+
+  /**
+   * @brief 最近 60 秒内下发的请求数
+   */
+  int requestsPerMinute();
+
+  int instanceCount() const { return m_entries.size(); }
+  bool isVisible(const QString& instanceId) const { return m_entries.value(instanceId).visible; }
+  int visibleCount() const;
+
+  /// 累计成功轮询次数，以及其中内容未变化（跳过解码）的次数
+  quint64 completedPolls() const { return m_completedPolls; }
+  quint64 skippedDecodes() const { return m_skippedDecodes; }
+
+  /// 累计下载的截图字节数（调用方在每次下载后累加）
+  void addDownloadedBytes(qint64 bytes) { m_downloadedBytes += quint64(bytes); }
+  quint64 downloadedBytes() const { return m_downloadedBytes; }
+
+ private:
+  struct Entry {
+    bool visible = false;
+    bool inFlight = false;
+    bool hasHash = false;
+    size_t hash = 0;
+    int unchanged = 0;
+    qint64 nextDueMs = 0;
+    Validators validators;
+  };
+
+  // 当前轮询间隔，0 表示不轮询
+  int intervalOf(const Entry& e) const;
+  void pruneIssued(qint64 nowMs);
+  // 结束一次在途请求
+  void finish(Entry& e, bool ok, bool changed);
+
+  const int m_visibleIntervalMs;
+  const int m_hiddenIntervalMs;
+  const int m_maxIntervalMs;
+  const int m_unchangedBeforeBackoff;
+
+  QElapsedTimer m_clock;
+  QHash<QString, Entry> m_entries;
+  QSet<QString> m_visible;  ///< 最近一次 setVisible 的集合
+  QQueue<qint64> m_issuedMs;  ///< 最近一分钟内的下发时间
+  quint64 m_completedPolls = 0;
+  quint64 m_skippedDecodes = 0;
+  quint64 m_downloadedBytes = 0;
+};
@@ -0,0 +1,465 @@
+#include "ThumbnailStore.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "utils/Logger.h"
+
+namespace {
+
+// pack 文件：PackHeader，之后是记录 {RecordHeader, 实例ID(UTF-8), 图片字节}
+constexpr quint32 kPackMagic = 0x4B415054;    // "TPAK"
+constexpr quint32 kRecordMagic = 0x43455254;  // "TREC"
+constexpr quint32 kIndexMagic = 0x58444954;   // "TIDX"
+constexpr quint32 kFormatVersion = 1;
+
+// 追加超过这么多字节后重写索引，缩短崩溃后的恢复扫描
+constexpr qint64 kIndexFlushBytes = 4 * 1024 * 1024;
+// 实例ID很短，超过此长度视为损坏
+constexpr quint32 kMaxKeyLength = 256;
+
+struct PackHeader {
+  quint32 magic;
+  quint32 version;
+  quint64 generation;  ///< 每次压缩都会变化，索引必须与之匹配
+};
+
+struct RecordHeader {
+  quint32 magic;
+  quint32 keyLength;
+  quint32 dataLength;
+  quint32 checksum;  ///< 实例ID与图片字节的 FNV-1a
+  qint64 timestampMs;
+};
+
+struct Record {
+  QByteArray key;
+  const uchar* data = nullptr;
+  quint32 size = 0;
+  qint64 timestampMs = 0;
+  qint64 length = 0;  ///< 整条记录长度（含记录头）
+};
+
+quint32 fnv1a(const char* data, qint64 size, quint32 hash = 2166136261u) {
+  for (qint64 i = 0; i < size; ++i) {
+    hash ^= uchar(data[i]);
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+quint32 recordChecksum(const QByteArray& key, const char* data, qint64 size) {
+  return fnv1a(data, size, fnv1a(key.constData(), key.size()));
+}
+
+// 解析并校验 offset 处的记录，写了一半或损坏时返回 false
+bool parseRecord(const uchar* base, qint64 available, qint64 offset, Record* out) {
+  if (offset + qint64(sizeof(RecordHeader)) > available) {
+    return false;
+  }
+  RecordHeader header;
+  std::memcpy(&header, base + offset, sizeof(header));
+  if (header.magic != kRecordMagic || header.keyLength == 0 || header.keyLength > kMaxKeyLength) {
+    return false;
+  }
+  qint64 length = qint64(sizeof(RecordHeader)) + header.keyLength + header.dataLength;
+  if (offset + length > available) {
+    return false;
+  }
+
+  const uchar* keyStart = base + offset + sizeof(RecordHeader);
+  out->key = QByteArray(reinterpret_cast<const char*>(keyStart), int(header.keyLength));
+  out->data = keyStart + header.keyLength;
+  out->size = header.dataLength;
+  if (recordChecksum(out->key, reinterpret_cast<const char*>(out->data), out->size) != header.checksum) {
+    return false;
+  }
+  out->timestampMs = header.timestampMs;
+  out->length = length;
+  return true;
+}
+
+bool writeRecord(QIODevice* device, const QByteArray& key, const char* data, quint32 size, qint64 timestampMs) {
+  RecordHeader header{kRecordMagic, quint32(key.size()), size, recordChecksum(key, data, size), timestampMs};
+  return device->write(reinterpret_cast<const char*>(&header), sizeof(header)) == qint64(sizeof(header)) &&
+         device->write(key) == key.size() && device->write(data, size) == qint64(size);
+}
+
+template <typename T>
+void append(QByteArray& out, const T& value) {
+  out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+bool take(const QByteArray& in, qint64& pos, T* value) {
+  if (pos + qint64(sizeof(T)) > in.size()) {
+    return false;
+  }
+  std::memcpy(value, in.constData() + pos, sizeof(T));
+  pos += sizeof(T);
+  return true;
+}
+
+}  // namespace
+
+ThumbnailStore::ThumbnailStore(const QString& directory, qint64 maxBytes)
+    : m_directory(directory), m_maxBytes(maxBytes) {}
+
+ThumbnailStore::~ThumbnailStore() {
+  flush();
+  QMutexLocker locker(&m_mutex);
+  closePack();
+}
+
+bool ThumbnailStore::open() {
+  QMutexLocker locker(&m_mutex);
+  closePack();
+  m_index.clear();
+  QDir().mkpath(m_directory);
+
+  qint64 fileSize = QFileInfo(packPath()).size();
+  remap();
+  bool validPack = m_mapping && m_mapSize >= qint64(sizeof(PackHeader));
+  if (validPack) {
+    PackHeader header;
+    std::memcpy(&header, m_mapData, sizeof(header));
+    validPack = header.magic == kPackMagic && header.version == kFormatVersion;
+  }
+
+  if (!validPack) {
+    // pack 不存在或无法识别：新建
+    if (fileSize > 0) {
+      Logger::warning(QString("[ThumbnailStore] discarding unreadable pack %1").arg(packPath()));
+    }
+    m_mapping.reset();
+    QSaveFile file(packPath());
+    PackHeader fresh{kPackMagic, kFormatVersion, quint64(QDateTime::currentMSecsSinceEpoch())};
+    if (!file.open(QIODevice::WriteOnly) ||
+        file.write(reinterpret_cast<const char*>(&fresh), sizeof(fresh)) != qint64(sizeof(fresh)) || !file.commit()) {
+      Logger::warning(QString("[ThumbnailStore] cannot create %1").arg(packPath()));
+      return false;
+    }
+    QFile::remove(indexPath());
+    fileSize = sizeof(PackHeader);
+    m_packSize = sizeof(PackHeader);
+    m_indexedSize = 0;
+    remap();
+  } else {
+    // 索引覆盖的部分直接信任，之后追加的记录扫描恢复
+    if (!loadIndex(generation()) || m_packSize > fileSize) {
+      m_index.clear();
+      m_packSize = sizeof(PackHeader);
+      m_indexedSize = 0;
+    }
+    scanPack(m_packSize);
+  }
+
+  // 截掉崩溃时写了一半的尾部
+  if (m_packSize < fileSize) {
+    Logger::warning(QString("[ThumbnailStore] truncating %1 bytes of incomplete records").arg(fileSize - m_packSize));
+    m_mapping.reset();
+    if (!QFile::resize(packPath(), m_packSize)) {
+      Logger::warning(QString("[ThumbnailStore] truncate failed for %1").arg(packPath()));
+      return false;
+    }
+    remap();
+  }
+
+  m_pack.setFileName(packPath());
+  if (!m_pack.open(QIODevice::WriteOnly | QIODevice::Append)) {
+    Logger::warning(QString("[ThumbnailStore] cannot open %1 for writing").arg(packPath()));
+    return false;
+  }
+
+  if (m_packSize > m_maxBytes) {
+    compact();
+  } else if (m_indexedSize != m_packSize) {
+    writeIndex();
+  }
+
+  Logger::info(QString("[ThumbnailStore] opened %1: %2 thumbnails, %3 bytes")
+                   .arg(packPath())
+                   .arg(m_index.size())
+                   .arg(m_packSize));
+  return true;
+}
+
+ThumbnailStore::Thumbnail ThumbnailStore::get(const QString& instanceId) {
+  QMutexLocker locker(&m_mutex);
+  auto it = m_index.find(instanceId);
+  if (it == m_index.end()) {
+    return Thumbnail();
+  }
+
+  QByteArray key = instanceId.toUtf8();
+  qint64 end = it->offset + qint64(sizeof(RecordHeader)) + key.size() + it->size;
+  if (!m_mapping || end > m_mapSize) {
+    remap();  // 记录是在当前映射建立之后追加的
+  }
+  if (!m_mapping) {
+    return Thumbnail();
+  }
+
+  Record record;
+  if (!parseRecord(m_mapData, m_mapSize, it->offset, &record) || record.key != key) {
+    Logger::warning(QString("[ThumbnailStore] dropping corrupt thumbnail for %1").arg(instanceId));
+    m_index.erase(it);
+    return Thumbnail();
+  }
+
+  Thumbnail thumbnail;
+  thumbnail.mapping = m_mapping;
+  thumbnail.data = record.data;
+  thumbnail.size = record.size;
+  thumbnail.timestampMs = record.timestampMs;
+  return thumbnail;
+}
+
+bool ThumbnailStore::put(const QString& instanceId, const QByteArray& data) {
+  QByteArray key = instanceId.toUtf8();
+  if (key.isEmpty() || quint32(key.size()) > kMaxKeyLength || data.isEmpty()) {
+    return false;
+  }
+
+  QMutexLocker locker(&m_mutex);
+  if (!m_pack.isOpen()) {
+    return false;
+  }
+
+  qint64 timestamp = QDateTime::currentMSecsSinceEpoch();
+  if (!writeRecord(&m_pack, key, data.constData(), quint32(data.size()), timestamp) || !m_pack.flush()) {
+    // 尾部可能只写了一半：停止写入，由下次 open() 截掉
+    Logger::warning("[ThumbnailStore] write failed, disabling thumbnail persistence");
+    closePack();
+    return false;
+  }
+
+  IndexEntry& entry = m_index[instanceId];
+  entry.offset = m_packSize;
+  entry.size = quint32(data.size());
+  entry.timestampMs = timestamp;
+  m_packSize += qint64(sizeof(RecordHeader)) + key.size() + data.size();
+
+  if (m_packSize > m_maxBytes) {
+    compact();
+  } else if (m_packSize - m_indexedSize >= kIndexFlushBytes) {
+    writeIndex();
+  }
+  return true;
+}
+
+void ThumbnailStore::flush() {
+  QMutexLocker locker(&m_mutex);
+  if (m_pack.isOpen() && m_indexedSize != m_packSize) {
+    writeIndex();
+  }
+}
+
+int ThumbnailStore::count() const {
+  QMutexLocker locker(&m_mutex);
+  return m_index.size();
+}
+
+bool ThumbnailStore::loadIndex(quint64 packGeneration) {
+  QFile file(indexPath());
+  if (!file.open(QIODevice::ReadOnly)) {
+    return false;
+  }
+  QByteArray bytes = file.readAll();
+
+  // 末尾的校验和覆盖之前的全部内容
+  if (bytes.size() < qint64(sizeof(quint32))) {
+    return false;
+  }
+  quint32 storedChecksum;
+  std::memcpy(&storedChecksum, bytes.constData() + bytes.size() - sizeof(quint32), sizeof(storedChecksum));
+  bytes.chop(sizeof(quint32));
+  if (fnv1a(bytes.constData(), bytes.size()) != storedChecksum) {
+    return false;
+  }
+
+  qint64 pos = 0;
+  quint32 magic = 0, version = 0, count = 0;
+  quint64 indexGeneration = 0;
+  qint64 covered = 0;
+  if (!take(bytes, pos, &magic) || !take(bytes, pos, &version) || !take(bytes, pos, &indexGeneration) ||
+      !take(bytes, pos, &covered) || !take(bytes, pos, &count) || magic != kIndexMagic || version != kFormatVersion ||
+      indexGeneration != packGeneration) {
+    return false;  // 索引属于压缩前的 pack
+  }
+
+  QHash<QString, IndexEntry> index;
+  index.reserve(count);
+  for (quint32 i = 0; i < count; ++i) {
+    quint32 keyLength = 0;
+    if (!take(bytes, pos, &keyLength) || keyLength > kMaxKeyLength || pos + keyLength > bytes.size()) {
+      return false;
+    }
+    QString key = QString::fromUtf8(bytes.constData() + pos, int(keyLength));
+    pos += keyLength;
+    IndexEntry entry;
+    if (!take(bytes, pos, &entry.offset) || !take(bytes, pos, &entry.size) || !take(bytes, pos, &entry.timestampMs) ||
+        entry.offset + entry.size > covered) {
+      return false;
+    }
+    index.insert(key, entry);
+  }
+
+  m_index.swap(index);
+  m_packSize = covered;
+  m_indexedSize = covered;
+  return true;
+}
+
+void ThumbnailStore::scanPack(qint64 from) {
+  if (!m_mapping) {
+    return;
+  }
+  qint64 offset = from;
+  Record record;
+  while (parseRecord(m_mapData, m_mapSize, offset, &record)) {
+    IndexEntry& entry = m_index[QString::fromUtf8(record.key)];
+    entry.offset = offset;
+    entry.size = record.size;
+    entry.timestampMs = record.timestampMs;
+    offset += record.length;
+  }
+  if (offset > from) {
+    Logger::info(QString("[ThumbnailStore] recovered %1 bytes of records not in the index").arg(offset - from));
+  }
+  m_packSize = offset;
+}
+
+bool ThumbnailStore::writeIndex() {
+  if (!m_mapping && !remap()) {
+    return false;
+  }
+
+  QByteArray bytes;
+  append(bytes, kIndexMagic);
+  append(bytes, kFormatVersion);
+  append(bytes, generation());
+  append(bytes, m_packSize);
+  append(bytes, quint32(m_index.size()));
+  for (auto it = m_index.cbegin(); it != m_index.cend(); ++it) {
+    QByteArray key = it.key().toUtf8();
+    append(bytes, quint32(key.size()));
+    bytes.append(key);
+    append(bytes, it->offset);
+    append(bytes, it->size);
+    append(bytes, it->timestampMs);
+  }
+  append(bytes, fnv1a(bytes.constData(), bytes.size()));
+
+  // QSaveFile 写临时文件后原子替换
+  QSaveFile file(indexPath());
+  if (!file.open(QIODevice::WriteOnly) || file.write(bytes) != bytes.size() || !file.commit()) {
+    Logger::warning(QString("[ThumbnailStore] failed to write %1").arg(indexPath()));
+    return false;
+  }
+  m_indexedSize = m_packSize;
+  return true;
+}
+
+bool ThumbnailStore::compact() {
+  if (!remap()) {
+    return false;
+  }
+
+  // 按时间从新到旧保留，只用到一半上限，避免频繁压缩
+  std::vector<std::pair<QString, IndexEntry>> entries;
+  entries.reserve(m_index.size());
+  for (auto it = m_index.cbegin(); it != m_index.cend(); ++it) {
+    entries.emplace_back(it.key(), it.value());
+  }
+  std::sort(entries.begin(), entries.end(),
+            [](const auto& a, const auto& b) { return a.second.timestampMs > b.second.timestampMs; });
+
+  QSaveFile file(packPath());
+  if (!file.open(QIODevice::WriteOnly)) {
+    return false;
+  }
+  PackHeader header{kPackMagic, kFormatVersion, quint64(QDateTime::currentMSecsSinceEpoch())};
+  bool ok = file.write(reinterpret_cast<const char*>(&header), sizeof(header)) == qint64(sizeof(header));
+  qint64 size = sizeof(PackHeader);
+  QHash<QString, IndexEntry> index;
+  for (const auto& entry : entries) {
+    Record record;
+    if (!ok || !parseRecord(m_mapData, m_mapSize, entry.second.offset, &record)) {
+      continue;
+    }
+    if (size + record.length > m_maxBytes / 2) {
+      break;
+    }
+    ok = writeRecord(&file, record.key, reinterpret_cast<const char*>(record.data), record.size, record.timestampMs);
+    index.insert(entry.first, IndexEntry{size, record.size, record.timestampMs});
+    size += record.length;
+  }
+
+  // 其他线程仍持有旧映射时，Windows 上替换可能失败：继续追加旧 pack，之后的 put() 再重试
+  closePack();
+  if (!ok || !file.commit()) {
+    Logger::warning("[ThumbnailStore] compaction failed, keeping the current pack");
+    m_pack.open(QIODevice::WriteOnly | QIODevice::Append);
+    remap();
+    return false;
+  }
+
+  Logger::info(QString("[ThumbnailStore] compacted %1 -> %2 bytes, kept %3/%4 thumbnails")
+                   .arg(m_packSize)
+                   .arg(size)
+                   .arg(index.size())
+                   .arg(m_index.size()));
+  m_index.swap(index);
+  m_packSize = size;
+  m_indexedSize = 0;
+  bool reopened = m_pack.open(QIODevice::WriteOnly | QIODevice::Append);
+  remap();
+  writeIndex();
+  return reopened;
+}
+
+bool ThumbnailStore::remap() {
+  m_mapping.reset();
+  m_mapData = nullptr;
+  m_mapSize = 0;
+
+  auto file = std::make_shared<QFile>(packPath());
+  if (!file->open(QIODevice::ReadOnly) || file->size() == 0) {
+    return false;
+  }
+  uchar* data = file->map(0, file->size());
+  if (!data) {
+    return false;
+  }
+  m_mapData = data;
+  m_mapSize = file->size();
+  m_mapping = std::move(file);
+  return true;
+}
+
+quint64 ThumbnailStore::generation() const {
+  if (!m_mapping || m_mapSize < qint64(sizeof(PackHeader))) {
+    return 0;
+  }
+  PackHeader header;
+  std::memcpy(&header, m_mapData, sizeof(header));
+  return header.generation;
+}
+
+void ThumbnailStore::closePack() {
+  m_pack.close();
+  m_mapping.reset();
+  m_mapData = nullptr;
+  m_mapSize = 0;
+}
+
+QString ThumbnailStore::packPath() const { return QDir(m_directory).filePath("thumbnails.pack"); }
+
+QString ThumbnailStore::indexPath() const { return QDir(m_directory).filePath("thumbnails.idx"); }
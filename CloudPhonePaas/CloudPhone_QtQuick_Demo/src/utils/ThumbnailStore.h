@@ -0,0 +1,102 @@
+#pragma once
+
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <memory>
+
+/**
+ * @brief 持久化、有容量上限的实例截图缓存
+ *
+ * 启动时实例宫格可以直接显示上次保存的截图，不必等第一轮截图全部下载完成。
+ *
+ * 目录内的文件：
+ * - thumbnails.pack：只追加的记录文件，每条记录为 {记录头, 实例ID, 图片字节}，记录头带校验和与时间戳
+ * - thumbnails.idx：每个实例最新记录的位置，以及它覆盖到的 pack 长度；先写临时文件再原子替换
+ *
+ * 崩溃安全：put() 只追加 pack。open() 时索引之后追加的记录通过扫描恢复，
+ * 写了一半或校验失败的尾部会被截掉；索引缺失或损坏时扫描整个 pack。
+ *
+ * 读取走 pack 的只读内存映射，Thumbnail 持有映射，释放前数据一直有效。
+ *
+ * pack 超过 maxBytes 时压缩为每个实例的最新记录，仍超过一半上限时丢弃最久未更新的实例。
+ *
+ * 线程安全。
+ */
+class ThumbnailStore {
+ public:
+  struct Thumbnail {
+    std::shared_ptr<QFile> mapping;  ///< 持有映射，保证 data 有效
+    const uchar* data = nullptr;
+    qint64 size = 0;
+    qint64 timestampMs = 0;  ///< 保存时间（Unix 毫秒）
+
+    bool isNull() const { return data == nullptr; }
+    /// 不拷贝的字节视图，生命周期不能超过本对象
+    QByteArray bytes() const { return QByteArray::fromRawData(reinterpret_cast<const char*>(data), size); }
+  };
+
+  static constexpr qint64 kDefaultMaxBytes = 64ll * 1024 * 1024;
+
+  explicit ThumbnailStore(const QString& directory, qint64 maxBytes = kDefaultMaxBytes);
+  ~ThumbnailStore();
+
+  ThumbnailStore(const ThumbnailStore&) = delete;
+  ThumbnailStore& operator=(const ThumbnailStore&) = delete;
+
+  /**
+   * @brief 打开（或新建）缓存并恢复索引
+   * @return 不可用时返回 false
+   */
+  bool open();
+
+  /**
+   * @brief 实例最新的截图，没有时返回空 Thumbnail
+   */
+  Thumbnail get(const QString& instanceId);
+
+  /**
+   * @brief 追加实例截图（替换之前的）
+   */
+  bool put(const QString& instanceId, const QByteArray& data);
+
+  /**
+   * @brief 写出索引，下次 open() 无需重新扫描已追加的记录
+   */
+  void flush();
+
+  int count() const;
+
+ private:
+  struct IndexEntry {
+    qint64 offset = 0;  ///< 记录在 pack 中的起始位置
+    quint32 size = 0;
+    qint64 timestampMs = 0;
+  };
+
+  // 以下函数调用方需持有 m_mutex
+  bool loadIndex(quint64 generation);
+  void scanPack(qint64 from);
+  bool writeIndex();
+  bool compact();
+  bool remap();
+  quint64 generation() const;
+  void closePack();
+
+  QString packPath() const;
+  QString indexPath() const;
+
+  const QString m_directory;
+  const qint64 m_maxBytes;
+
+  mutable QMutex m_mutex;
+  QHash<QString, IndexEntry> m_index;
+  QFile m_pack;                      ///< 追加写
+  qint64 m_packSize = 0;             ///< 有效记录的总长度
+  qint64 m_indexedSize = 0;          ///< 磁盘上索引覆盖到的 pack 长度
+  std::shared_ptr<QFile> m_mapping;  ///< pack 的只读映射，重新映射时替换
+  const uchar* m_mapData = nullptr;
+  qint64 m_mapSize = 0;
+};
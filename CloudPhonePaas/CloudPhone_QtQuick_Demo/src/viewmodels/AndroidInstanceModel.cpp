@@ -1,5 +1,10 @@
 #include "AndroidInstanceModel.h"
 
+#include <algorithm>
+#include <numeric>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+
 #include "services/ApiService.h"
 #include "utils/Logger.h"
 #include "viewmodels/MultiStreamViewModel.h"
@@ -8,48 +13,343 @@
 InstanceImageProvider* AndroidInstanceModel::s_imageProvider = new InstanceImageProvider();
 
 AndroidInstanceModel::AndroidInstanceModel(ApiService* apiService, BatchTaskOperator* op, QObject* parent)
-    : QObject(parent), m_apiService(apiService) {
+    : QAbstractListModel(parent), m_apiService(apiService), m_imageDownloader(new InstanceImageDownloader(op, this)) {
+  m_flushTimer.setSingleShot(true);
+  m_flushTimer.setInterval(0);
+  connect(&m_flushTimer, &QTimer::timeout, this, &AndroidInstanceModel::flushChangedRows);
+
+  // 上次运行保存的截图，图像提供者在内存未命中时从中解码；下载器把内容变化的截图写回，供下次启动使用
+  m_thumbnailStore = std::make_shared<ThumbnailStore>(QCoreApplication::applicationDirPath() + "/thumbnails");
+  if (m_thumbnailStore->open()) {
+    s_imageProvider->setThumbnailStore(m_thumbnailStore);
+    m_imageDownloader->setThumbnailStore(m_thumbnailStore);
+  } else {
+    Logger::warning("Thumbnail store unavailable, starting with empty thumbnails");
+  }
+
+  // 截图在下载器工作线程解码，直接放入图像提供者（内部加锁），再回到主线程刷新对应行
+  connect(
+      m_imageDownloader, &InstanceImageDownloader::imageDownloaded, this,
+      [](const QString& instanceId, const QImage& image) { s_imageProvider->updateImage(instanceId, image); },
+      Qt::DirectConnection);
+  connect(
+      m_imageDownloader, &InstanceImageDownloader::imageDownloaded, this,
+      [this](const QString& instanceId) { onThumbnailUpdated(instanceId); }, Qt::QueuedConnection);
+
   // 连接信号
   connect(m_apiService, &ApiService::loginSuccess, this, &AndroidInstanceModel::onLoginSuccess);
-  connect(m_apiService, &ApiService::instancesReceived, this, &AndroidInstanceModel::onInstancesReceived);
+  connect(m_apiService, &ApiService::instancesPageReceived, this, &AndroidInstanceModel::onInstancesPageReceived);
+  connect(m_apiService, &ApiService::instancesDiscoveryFinished, this,
+          &AndroidInstanceModel::onInstancesDiscoveryFinished);
 }
 
 AndroidInstanceModel::~AndroidInstanceModel() {
+  // 先等在途的下载任务结束，之后不再有线程访问图像提供者和截图缓存
+  delete m_imageDownloader;
+  m_imageDownloader = nullptr;
+  m_thumbnailStore->flush();
   if (m_multiStreamViewModel) {
     m_multiStreamViewModel->closeSession();
   }
 }
 
 void AndroidInstanceModel::setMultiStreamViewModel(MultiStreamViewModel* viewModel) {
+  if (m_multiStreamViewModel) {
+    disconnect(m_multiStreamViewModel, nullptr, this, nullptr);
+  }
   m_multiStreamViewModel = viewModel;
+  if (m_multiStreamViewModel) {
+    connect(m_multiStreamViewModel, &MultiStreamViewModel::instanceConnectionChanged, this,
+            &AndroidInstanceModel::onInstanceConnectionChanged);
+  }
+}
+
+int AndroidInstanceModel::rowCount(const QModelIndex& parent) const {
+  return parent.isValid() ? 0 : m_viewRows.size();
+}
+
+QVariant AndroidInstanceModel::data(const QModelIndex& index, int role) const {
+  if (!index.isValid() || index.row() < 0 || index.row() >= m_viewRows.size()) {
+    return QVariant();
+  }
+  const InstanceRow& row = m_rows[m_viewRows[index.row()]];
+  switch (role) {
+    case InstanceIdRole:
+      return row.instance.AndroidInstanceId;
+    case RegionRole:
+      return row.instance.AndroidInstanceRegion;
+    case NameRole:
+      return row.instance.Name;
+    case StateRole:
+      return row.instance.State;
+    case ConnectionStateRole:
+      return row.connectionState;
+    case ThumbnailVersionRole:
+      return row.thumbnailVersion;
+    default:
+      return QVariant();
+  }
+}
+
+QHash<int, QByteArray> AndroidInstanceModel::roleNames() const {
+  return {
+      {InstanceIdRole, "AndroidInstanceId"},
+      {RegionRole, "AndroidInstanceRegion"},
+      {NameRole, "Name"},
+      {StateRole, "State"},
+      {ConnectionStateRole, "connectionState"},
+      {ThumbnailVersionRole, "thumbnailVersion"},
+  };
+}
+
+QStringList AndroidInstanceModel::instanceIds(int first, int last) const {
+  QStringList ids;
+  first = qMax(first, 0);
+  last = qMin(last, int(m_viewRows.size()) - 1);
+  for (int i = first; i <= last; ++i) {
+    ids.append(m_rows[m_viewRows[i]].instance.AndroidInstanceId);
+  }
+  return ids;
+}
+
+int AndroidInstanceModel::rowOf(const QString& instanceId) const {
+  int row = m_rowById.value(instanceId, -1);
+  return row < 0 ? -1 : m_viewRowOf[row];
+}
+
+void AndroidInstanceModel::setVisibleInstances(const QStringList& instanceIds) {
+  m_imageDownloader->setVisibleInstances(instanceIds);
+}
+
+void AndroidInstanceModel::setTileSize(qreal tileWidth, qreal tileHeight, qreal devicePixelRatio) {
+  m_imageDownloader->setTileSize(tileWidth, tileHeight, devicePixelRatio);
+}
+
+void AndroidInstanceModel::setFilterText(const QString& text) {
+  if (m_filterText == text) {
+    return;
+  }
+  m_filterText = text;
+  emit filterTextChanged();
+  applyFilter();
+}
+
+void AndroidInstanceModel::setStateFilter(const QStringList& states) {
+  if (m_stateFilter == states) {
+    return;
+  }
+  m_stateFilter = states;
+  emit stateFilterChanged();
+  applyFilter();
+}
+
+void AndroidInstanceModel::applyFilter() {
+  QElapsedTimer timer;
+  timer.start();
+
+  QVector<int> viewRows;
+  if (isFiltered()) {
+    viewRows = m_searchIndex.query({m_filterText, m_stateFilter, {}, false});
+  } else {
+    viewRows.resize(m_rows.size());
+    std::iota(viewRows.begin(), viewRows.end(), 0);
+  }
+  const qint64 queryUs = timer.nsecsElapsed() / 1000;
+
+  // 过滤结果整体替换，待发出的行变化随重置一起失效
+  beginResetModel();
+  m_viewRows = std::move(viewRows);
+  m_viewRowOf.fill(-1, m_rows.size());
+  for (int i = 0; i < m_viewRows.size(); ++i) {
+    m_viewRowOf[m_viewRows[i]] = i;
+  }
+  m_changedRows.clear();
+  m_changedRoles.clear();
+  endResetModel();
+  emit countChanged();
+
+  Logger::debug(QString("Instance filter \"%1\" states [%2]: %3/%4 rows, query %5 us, total %6 us")
+                    .arg(m_filterText, m_stateFilter.join(','))
+                    .arg(m_viewRows.size())
+                    .arg(m_rows.size())
+                    .arg(queryUs)
+                    .arg(timer.nsecsElapsed() / 1000));
+}
+
+void AndroidInstanceModel::clearRows() {
+  if (m_rows.isEmpty()) {
+    return;
+  }
+  beginResetModel();
+  m_rows.clear();
+  m_rowById.clear();
+  m_searchIndex.clear();
+  m_viewRows.clear();
+  m_viewRowOf.clear();
+  m_changedRows.clear();
+  m_changedRoles.clear();
+  endResetModel();
+  emit countChanged();
+  emit totalCountChanged();
+  emit availableStatesChanged();
+}
+
+void AndroidInstanceModel::markRowChanged(int row, int role) {
+  int viewRow = m_viewRowOf[row];
+  if (viewRow < 0) {
+    return;
+  }
+  m_changedRows.insert(viewRow);
+  m_changedRoles.insert(role);
+  if (!m_flushTimer.isActive()) {
+    m_flushTimer.start();
+  }
 }
 
-QVariantList AndroidInstanceModel::instances() const {
-  QVariantList list;
-  for (const auto& instance : m_instances) {
-    QVariantMap map;
-    map["AndroidInstanceId"] = instance.AndroidInstanceId;
-    map["AndroidInstanceRegion"] = instance.AndroidInstanceRegion;
-    map["State"] = instance.State;
-    list.append(map);
+void AndroidInstanceModel::flushChangedRows() {
+  if (m_changedRows.isEmpty()) {
+    return;
+  }
+  QVector<int> rows(m_changedRows.begin(), m_changedRows.end());
+  QList<int> roles(m_changedRoles.begin(), m_changedRoles.end());
+  m_changedRows.clear();
+  m_changedRoles.clear();
+  std::sort(rows.begin(), rows.end());
+
+  // 连续的行合并为一次 dataChanged
+  int first = rows.first();
+  int last = first;
+  for (int i = 1; i <= rows.size(); ++i) {
+    if (i < rows.size() && rows[i] == last + 1) {
+      last = rows[i];
+      continue;
+    }
+    if (last < m_viewRows.size()) {
+      emit dataChanged(index(first), index(last), roles);
+    }
+    if (i < rows.size()) {
+      first = last = rows[i];
+    }
+  }
+}
+
+void AndroidInstanceModel::onInstanceConnectionChanged(const QString& instanceId, bool connected) {
+  Q_UNUSED(connected);  // 连接中也会以 false 通知，状态以 MultiStreamViewModel 为准
+  int row = m_rowById.value(instanceId, -1);
+  if (row < 0 || !m_multiStreamViewModel) {
+    return;
+  }
+  int state = m_multiStreamViewModel->getInstanceConnectionState(instanceId);
+  if (m_rows[row].connectionState != state) {
+    m_rows[row].connectionState = state;
+    markRowChanged(row, ConnectionStateRole);
+  }
+}
+
+void AndroidInstanceModel::onThumbnailUpdated(const QString& instanceId) {
+  int row = m_rowById.value(instanceId, -1);
+  if (row < 0) {
+    return;
+  }
+  quint64 version = s_imageProvider->version(instanceId);
+  if (m_rows[row].thumbnailVersion != version) {
+    m_rows[row].thumbnailVersion = version;
+    markRowChanged(row, ThumbnailVersionRole);
   }
-  return list;
 }
 
 void AndroidInstanceModel::onLoginSuccess(const QString& userType) {
-  m_apiService->describeAndroidInstances(
-      0, 200, {"cai-251197962-fe2d8imcyfh", "cai-251197962-fe2df5kvpil", "cai-251197962-fe2dhv9ztl8"});
+  m_imageDownloader->stopDownloading();
+  clearRows();
+  m_apiService->discoverAndroidInstances(
+      {"cai-251197962-fe2d8imcyfh", "cai-251197962-fe2df5kvpil", "cai-251197962-fe2dhv9ztl8"});
+}
+
+void AndroidInstanceModel::onInstancesPageReceived(const QList<AndroidInstance>& instances, int totalCount) {
+  if (m_rows.isEmpty()) {
+    m_rows.reserve(totalCount);
+    m_rowById.reserve(totalCount);
+    m_viewRows.reserve(totalCount);
+    m_viewRowOf.reserve(totalCount);
+  }
+
+  // 分页期间实例可能在页之间移动，已有的实例不重复追加
+  QVector<InstanceRow> added;
+  added.reserve(instances.size());
+  for (const auto& instance : instances) {
+    if (m_rowById.contains(instance.AndroidInstanceId)) {
+      continue;
+    }
+    InstanceRow row;
+    row.instance = instance;
+    row.thumbnailVersion = s_imageProvider->version(instance.AndroidInstanceId);
+    if (m_multiStreamViewModel) {
+      row.connectionState = m_multiStreamViewModel->getInstanceConnectionState(instance.AndroidInstanceId);
+    }
+    m_rowById.insert(instance.AndroidInstanceId, m_rows.size() + added.size());
+    added.append(row);
+  }
+  if (added.isEmpty()) {
+    return;
+  }
+
+  const int firstNew = m_rows.size();
+  const int stateCount = m_searchIndex.states().size();
+  m_rows.append(added);
+  for (const auto& row : added) {
+    m_searchIndex.add(row.instance.AndroidInstanceId, row.instance.Name, row.instance.AndroidInstanceRegion,
+                      row.instance.State);
+  }
+  if (m_searchIndex.states().size() != stateCount) {
+    emit availableStatesChanged();
+  }
+  m_viewRowOf.resize(m_rows.size(), -1);
+
+  // 新行号都大于已有行号，过滤时只需把查询结果中的新行追加到显示末尾
+  QVector<int> shown;
+  if (isFiltered()) {
+    const QVector<int> matched = m_searchIndex.query({m_filterText, m_stateFilter, {}, false});
+    shown = QVector<int>(std::lower_bound(matched.cbegin(), matched.cend(), firstNew), matched.cend());
+  } else {
+    shown.resize(added.size());
+    std::iota(shown.begin(), shown.end(), firstNew);
+  }
+  emit totalCountChanged();
+  if (shown.isEmpty()) {
+    return;
+  }
+
+  // 先显示已拿到的实例，其余页陆续追加，已有委托不会重建
+  beginInsertRows(QModelIndex(), m_viewRows.size(), m_viewRows.size() + shown.size() - 1);
+  for (int row : shown) {
+    m_viewRowOf[row] = m_viewRows.size();
+    m_viewRows.append(row);
+  }
+  endInsertRows();
+  emit countChanged();
 }
 
-void AndroidInstanceModel::onInstancesReceived(const QList<AndroidInstance>& instances, int totalCount) {
-  m_instances = instances;
+void AndroidInstanceModel::onInstancesDiscoveryFinished(int receivedCount, int totalCount, int failedPages) {
+  if (failedPages > 0) {
+    Logger::warning(QString("Instance discovery incomplete: %1/%2 instances, %3 pages failed")
+                        .arg(receivedCount)
+                        .arg(totalCount)
+                        .arg(failedPages));
+  }
+  if (m_rows.isEmpty()) {
+    return;
+  }
 
   // 1. 提取所有实例ID
   QStringList instanceIds;
-  for (const auto& instance : m_instances) {
-    instanceIds.append(instance.AndroidInstanceId);
+  instanceIds.reserve(m_rows.size());
+  for (const auto& row : m_rows) {
+    instanceIds.append(row.instance.AndroidInstanceId);
   }
 
+  // 截图轮询不依赖 TCR 令牌，发现结束即可开始；可见区间由宫格滚动停止后通过 setVisibleInstances 上报
+  m_imageDownloader->startDownloading(instanceIds);
+
   // 2. 调用创建安卓实例令牌API
   m_apiService->createAndroidInstancesAccessToken(instanceIds);
 
@@ -75,8 +375,7 @@ void AndroidInstanceModel::onInstancesReceived(const QList<AndroidInstance>& ins
               // 使用全部实例数量作为并发拉流数（后续可通过可见性动态切换）
               m_multiStreamViewModel->connectMultipleInstances(instanceIds, instanceIds.size());
             }
-
-            emit instancesChanged();  // 通知QML刷新视图
+            // 各行的连接状态通过 instanceConnectionChanged 逐行更新，无需整体刷新
           });
 }
 
@@ -88,12 +387,16 @@ void AndroidInstanceModel::refreshInstances() {
     m_multiStreamViewModel->closeSession();
   }
 
-  // 2. 清空本地实例列表
-  m_instances.clear();
-  emit instancesChanged();
+  // 2. 停止截图轮询并清空本地实例列表
+  m_imageDownloader->stopDownloading();
+  clearRows();
 
-  // 3. 重新拉取实例列表
-  m_apiService->describeAndroidInstances(0, 200);
+  // 3. 重新拉取实例列表（分页并发拉取，逐页显示）
+  m_apiService->discoverAndroidInstances();
 }
 
 InstanceImageProvider* AndroidInstanceModel::imageProvider() { return s_imageProvider; }
+
+QString AndroidInstanceModel::instanceImageSource(const QString& instanceId) const {
+  return s_imageProvider->imageSource(instanceId);
+}
@@ -1,15 +1,17 @@
 #pragma once
 
+#include <QAbstractListModel>
+#include <QHash>
 #include <QJsonArray>
 #include <QNetworkAccessManager>
-#include <QObject>
+#include <QSet>
 #include <QTimer>
 #include <QVariant>
-#include <QVariantList>
-#include <QVariantMap>
 
 #include "core/BatchTaskOperator.h"
+#include "core/InstanceSearchIndex.h"
 #include "InstanceImageProvider.h"
+#include "utils/InstanceImageDownloader.h"
 
 class ApiService;
 class MultiStreamViewModel;
@@ -30,11 +32,34 @@ struct AndroidInstance {
  *
  * 该模型负责与ApiService交互，获取云手机实例列表，
  * 并通过MultiStreamViewModel管理多实例子流视频。
- * 同时提供QML属性和方法，供前端界面调用。
+ *
+ * 作为 QAbstractListModel 直接交给 QML 视图：
+ * - 分页到达的实例以 beginInsertRows 追加，已有委托不会重建
+ * - 连接状态、缩略图版本变化只标记对应行，同一轮事件循环内合并为按连续行区间发出的 dataChanged
+ * - 实例ID到行号的索引保证单个实例的更新为 O(1)，总代价与变化的行数成正比
+ * - filterText/stateFilter 通过 InstanceSearchIndex 查询出显示的行，视图只看到过滤后的行，
+ *   可见区间的实例ID也取自过滤结果，拉流调度跟随过滤后的宫格
+ * - 实例发现结束后启动截图下载器，可见实例优先轮询；截图解码后放入图像提供者并递增该行的 thumbnailVersion
  */
-class AndroidInstanceModel : public QObject {
+class AndroidInstanceModel : public QAbstractListModel {
   Q_OBJECT
+  Q_PROPERTY(int count READ count NOTIFY countChanged)
+  Q_PROPERTY(int totalCount READ totalCount NOTIFY totalCountChanged)
+  Q_PROPERTY(QString filterText READ filterText WRITE setFilterText NOTIFY filterTextChanged)
+  Q_PROPERTY(QStringList stateFilter READ stateFilter WRITE setStateFilter NOTIFY stateFilterChanged)
+  Q_PROPERTY(QStringList availableStates READ availableStates NOTIFY availableStatesChanged)
+
  public:
+  /// QML 委托中通过 model.<角色名> 访问
+  enum Roles {
+    InstanceIdRole = Qt::UserRole + 1,  ///< "AndroidInstanceId"
+    RegionRole,                         ///< "AndroidInstanceRegion"
+    NameRole,                           ///< "Name"
+    StateRole,                          ///< "State"
+    ConnectionStateRole,                ///< "connectionState"：0=未连接, 1=连接中, 2=已连接
+    ThumbnailVersionRole,               ///< "thumbnailVersion"：缩略图版本号，变化时刷新 Image.source
+  };
+
   /**
    * @brief 构造函数
    * @param apiService API服务指针
@@ -48,11 +73,56 @@ class AndroidInstanceModel : public QObject {
    */
   ~AndroidInstanceModel();
 
+  int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+  QVariant data(const QModelIndex& index, int role) const override;
+  QHash<int, QByteArray> roleNames() const override;
+
+  /**
+   * @brief 过滤后显示的实例数量（QML属性）
+   */
+  int count() const { return m_viewRows.size(); }
+
+  /**
+   * @brief 已拉取的实例总数（QML属性）
+   */
+  int totalCount() const { return m_rows.size(); }
+
+  /**
+   * @brief 按实例ID或名称过滤的文本（忽略大小写的子串匹配），为空表示不过滤
+   */
+  QString filterText() const { return m_filterText; }
+  void setFilterText(const QString& text);
+
   /**
-   * @brief 获取当前实例列表（QML属性）
+   * @brief 显示的实例状态（API 返回的 State 取值），为空表示不过滤
    */
-  Q_PROPERTY(QVariantList instances READ instances NOTIFY instancesChanged)
-  QVariantList instances() const;
+  QStringList stateFilter() const { return m_stateFilter; }
+  void setStateFilter(const QStringList& states);
+
+  /**
+   * @brief 已拉取的实例中出现过的状态取值，只在出现新状态或清空时通知，分页追加不会让下拉框重建
+   */
+  QStringList availableStates() const { return m_searchIndex.states(); }
+
+  /**
+   * @brief 行号区间 [first, last] 内的实例ID，越界部分忽略
+   */
+  Q_INVOKABLE QStringList instanceIds(int first, int last) const;
+
+  /**
+   * @brief 实例所在行号，不存在时返回 -1
+   */
+  Q_INVOKABLE int rowOf(const QString& instanceId) const;
+
+  /**
+   * @brief 宫格中可见的实例ID（取自 instanceIds(first, last)），截图下载器优先轮询这些实例
+   */
+  Q_INVOKABLE void setVisibleInstances(const QStringList& instanceIds);
+
+  /**
+   * @brief 宫格单元格尺寸（逻辑像素）和屏幕缩放，截图按物理像素尺寸请求和解码
+   */
+  Q_INVOKABLE void setTileSize(qreal tileWidth, qreal tileHeight, qreal devicePixelRatio);
 
   /**
    * @brief 获取全局图像提供者实例
@@ -61,7 +131,14 @@ class AndroidInstanceModel : public QObject {
   static InstanceImageProvider* imageProvider();
 
   /**
-   * @brief 设置多实例流媒体ViewModel
+   * @brief 实例缩略图地址（带版本号），截图更新后版本号递增，QML 重新读取即可刷新
+   * @param instanceId 实例ID
+   * @return 形如 "image://instance/<instanceId>?v=<version>" 的地址
+   */
+  Q_INVOKABLE QString instanceImageSource(const QString& instanceId) const;
+
+  /**
+   * @brief 设置多实例流媒体ViewModel，并跟随其实例连接状态更新 connectionState 角色
    * @param viewModel MultiStreamViewModel指针
    */
   void setMultiStreamViewModel(MultiStreamViewModel* viewModel);
@@ -71,11 +148,27 @@ class AndroidInstanceModel : public QObject {
    */
   Q_INVOKABLE void refreshInstances();
 
+ public slots:
+  /**
+   * @brief 实例缩略图已更新（图像提供者中的版本号已递增），刷新该行的 thumbnailVersion
+   * @param instanceId 实例ID
+   */
+  void onThumbnailUpdated(const QString& instanceId);
+
  signals:
   /**
-   * @brief 实例列表发生变化时发出
+   * @brief 实例数量变化时发出
+   */
+  void countChanged();
+
+  /**
+   * @brief 实例总数变化时发出
    */
-  void instancesChanged();
+  void totalCountChanged();
+
+  void filterTextChanged();
+  void stateFilterChanged();
+  void availableStatesChanged();
 
  private slots:
   /**
@@ -85,16 +178,62 @@ class AndroidInstanceModel : public QObject {
   void onLoginSuccess(const QString& userType);
 
   /**
-   * @brief 收到实例列表后回调
-   * @param instances 实例列表
+   * @brief 分页拉取收到一页实例后回调，追加到列表并立即刷新界面
+   * @param instances 本页实例
    * @param totalCount 总数
    */
-  void onInstancesReceived(const QList<AndroidInstance>& instances, int totalCount);
+  void onInstancesPageReceived(const QList<AndroidInstance>& instances, int totalCount);
+
+  /**
+   * @brief 分页拉取结束后回调，为全部实例创建令牌并开始拉流
+   * @param receivedCount 已收到的实例数
+   * @param totalCount 总数
+   * @param failedPages 失败的页数
+   */
+  void onInstancesDiscoveryFinished(int receivedCount, int totalCount, int failedPages);
+
+  /**
+   * @brief 实例连接状态变化后回调
+   */
+  void onInstanceConnectionChanged(const QString& instanceId, bool connected);
 
  private:
+  /// 一行的数据：API 返回的字段加上界面状态
+  struct InstanceRow {
+    AndroidInstance instance;
+    int connectionState = 0;
+    quint64 thumbnailVersion = 0;
+  };
+
+  /// 清空全部行
+  void clearRows();
+
+  /// 是否设置了任何过滤条件
+  bool isFiltered() const { return !m_filterText.isEmpty() || !m_stateFilter.isEmpty(); }
+
+  /// 按过滤条件重新查询显示的行并重置模型
+  void applyFilter();
+
+  /// 标记某行（存储行号）的某个角色已变化，由 flushChangedRows 合并发出；被过滤掉的行忽略
+  void markRowChanged(int row, int role);
+
+  /// 把标记的行按连续区间发出 dataChanged
+  void flushChangedRows();
+
   ApiService* m_apiService;                                ///< API服务指针
-  QList<AndroidInstance> m_instances;                      ///< 当前实例列表
+  QVector<InstanceRow> m_rows;                             ///< 当前实例列表（按显示顺序）
+  QHash<QString, int> m_rowById;                           ///< 实例ID -> 行号
+  InstanceSearchIndex m_searchIndex;                       ///< 行号与 m_rows 一致
+  QVector<int> m_viewRows;                                 ///< 显示行 -> 行号
+  QVector<int> m_viewRowOf;                                ///< 行号 -> 显示行，被过滤掉为 -1
+  QString m_filterText;                                    ///< 过滤文本
+  QStringList m_stateFilter;                               ///< 过滤状态
+  QSet<int> m_changedRows;                                 ///< 待发出 dataChanged 的显示行
+  QSet<int> m_changedRoles;                                ///< 待发出 dataChanged 的角色
+  QTimer m_flushTimer;                                     ///< 合并同一轮事件循环内的行变化
   bool m_tcrConfigured = false;                            ///< TCR SDK是否已配置
   MultiStreamViewModel* m_multiStreamViewModel = nullptr;  ///< 多实例流媒体ViewModel
+  InstanceImageDownloader* m_imageDownloader = nullptr;    ///< 实例截图下载器
+  std::shared_ptr<ThumbnailStore> m_thumbnailStore;        ///< 持久化截图缓存，与图像提供者共享
   static InstanceImageProvider* s_imageProvider;           ///< 静态图像提供者实例
 };
@@ -8,6 +8,7 @@
 #include <QJsonObject>
 #include <QMetaType>
 #include <QVariant>
+#include <chrono>
 
 #include "tcr_c_api.h"
 #include "tcr_types.h"
@@ -28,6 +29,20 @@ MultiStreamViewModel::MultiStreamViewModel(QObject* parent) : QObject(parent) {
   m_renderTimer->setInterval(16);  // 可根据需要调整：16ms(60fps), 33ms(30fps)
   connect(m_renderTimer, &QTimer::timeout, this, &MultiStreamViewModel::batchRenderFrames);
   m_renderTimer->start();
+  m_renderClock.start();
+
+  // 并发数变化时按新的上限重新切换拉流实例
+  m_concurrencyController = new ConcurrencyController(this);
+  connect(m_concurrencyController, &ConcurrencyController::limitChanged, this, [this](int, const QString&) {
+    emit streamingLimitChanged();
+    applyVisibleStreaming();
+  });
+
+  // 拖动窗口或切换列数时单元格尺寸连续变化，稳定后再协商
+  m_tileProfileTimer = new QTimer(this);
+  m_tileProfileTimer->setSingleShot(true);
+  m_tileProfileTimer->setInterval(1000);
+  connect(m_tileProfileTimer, &QTimer::timeout, this, &MultiStreamViewModel::applyTileProfile);
 }
 
 MultiStreamViewModel::~MultiStreamViewModel() {
@@ -57,10 +72,12 @@ MultiStreamViewModel::~MultiStreamViewModel() {
   {
     QMutexLocker locker(&m_frameCacheMutex);
     m_frameCache.clear();
+    m_frameCacheHandles.clear();
   }
 
   // 关闭会话
   closeSession();
+  m_frameFreezeCache.shutdown();
 
   tcr_client_release(tcr_client_get_instance());
 
@@ -101,8 +118,9 @@ void MultiStreamViewModel::initialize(const QStringList& instanceIds, const QStr
 // ==================== 状态查询 ====================
 
 int MultiStreamViewModel::getInstanceConnectionState(const QString& instanceId) const {
-  if (m_instanceConnectionStates.contains(instanceId)) {
-    return static_cast<int>(m_instanceConnectionStates[instanceId]);
+  InstanceHandle handle = m_registry.find(instanceId);
+  if (handle >= 0 && handle < m_instanceConnectionStates.size()) {
+    return static_cast<int>(m_instanceConnectionStates[handle]);
   }
   return static_cast<int>(InstanceConnectionState::Disconnected);
 }
@@ -152,19 +170,63 @@ QString MultiStreamViewModel::getInstanceStats(const QString& instanceId) const
 void MultiStreamViewModel::onVisibilityChanged(const QStringList& visibleIds, const QStringList& invisibleIds) {
   Logger::info("=== 滚动停止 500ms 检测 ===");
   Logger::info(QString("可见实例 (%1): %2").arg(visibleIds.length()).arg(visibleIds.join(", ")));
-  Logger::info(QString("不可见实例 (%1): %2").arg(invisibleIds.length()).arg(invisibleIds.join(", ")));
+  Logger::info(QString("不可见实例: %1 个").arg(invisibleIds.length()));
+
+  // 保存完整的可见列表，并发数扩张时可以直接拉取更多实例
+  m_visibleIds = visibleIds;
+  applyVisibleStreaming();
+}
+
+void MultiStreamViewModel::applyVisibleStreaming() {
+  if (m_visibleIds.isEmpty()) {
+    return;
+  }
 
   // 检查是否有变化
-  QSet<QString> newVisibleSet = QSet<QString>(visibleIds.begin(), visibleIds.end());
+  QStringList targetIds = m_visibleIds.mid(0, m_concurrencyController->limit());
+  QSet<QString> targetSet = QSet<QString>(targetIds.begin(), targetIds.end());
   QSet<QString> currentStreamingSet = QSet<QString>(m_currentStreamingIds.begin(), m_currentStreamingIds.end());
 
-  if (newVisibleSet == currentStreamingSet) {
-    Logger::info("[onVisibilityChanged] 可见实例列表无变化，跳过切换");
+  if (targetSet == currentStreamingSet) {
+    Logger::info("[applyVisibleStreaming] 可见实例列表无变化，跳过切换");
     return;
   }
 
   // 使用 tcr_session_switch_streaming_instances 动态切换拉流实例
-  switchStreamingInstances(visibleIds);
+  switchStreamingInstances(targetIds);
+}
+
+// ==================== 子码流档位协商 ====================
+
+void MultiStreamViewModel::updateTileSize(qreal tileWidth, qreal tileHeight, qreal devicePixelRatio) {
+  qreal px = qMin(tileWidth, tileHeight) * (devicePixelRatio > 0 ? devicePixelRatio : 1.0);
+  if (qFuzzyCompare(px, m_tilePixelShortEdge)) {
+    return;
+  }
+  m_tilePixelShortEdge = px;
+  m_tileProfileTimer->start();
+}
+
+void MultiStreamViewModel::applyTileProfile() {
+  if (!m_session || !m_isConnected) {
+    return;
+  }
+
+  int index = m_tileProfileLadder.select(m_tilePixelShortEdge);
+  if (index < 0 || index == m_tileProfileLadder.currentIndex()) {
+    return;
+  }
+
+  const TileProfileLadder::Step& step = m_tileProfileLadder.step(index);
+  tcr_session_set_remote_video_profile(m_session, step.fps, step.minBitrate, step.maxBitrate, step.shortEdge, 0);
+  m_tileProfileLadder.setCurrentIndex(index);
+
+  Logger::info(QString("[applyTileProfile] 单元格短边 %1px，子码流切换为 短边:%2, 帧率:%3, 码率:%4-%5")
+                   .arg(m_tilePixelShortEdge, 0, 'f', 0)
+                   .arg(step.shortEdge)
+                   .arg(step.fps)
+                   .arg(step.minBitrate)
+                   .arg(step.maxBitrate));
 }
 
 // ==================== 切换拉流实例 ====================
@@ -208,12 +270,43 @@ void MultiStreamViewModel::switchStreamingInstances(const QStringList& streaming
   tcr_session_switch_streaming_instances(m_session, result.pointers.data(),
                                          static_cast<int32_t>(result.pointers.size()));
 
+  // 切出的实例保存最后一帧，滚动回来时先显示冻结帧
+  QSet<QString> validSet(validIds.begin(), validIds.end());
+  QVector<InstanceHandle> switchedOut;
+  for (const QString& id : m_currentStreamingIds) {
+    if (!validSet.contains(id)) {
+      switchedOut.append(m_registry.find(id));
+    }
+  }
+  freezeLastFrames(switchedOut);
+
   // 更新当前拉流实例列表
   m_currentStreamingIds = validIds;
 
   Logger::info(QString("[switchStreamingInstances] 已切换到 %1 个实例").arg(validIds.size()));
 }
 
+void MultiStreamViewModel::freezeLastFrames(const QVector<InstanceHandle>& handles) {
+  for (InstanceHandle handle : handles) {
+    // 尚未上传的延迟帧比最近上传的一帧更新
+    VideoFrameDataPtr frame;
+    if (handle >= 0 && handle < m_deferredFrames.size()) {
+      frame.swap(m_deferredFrames[handle]);
+      m_deferredHandles.removeOne(handle);
+    }
+    if (handle >= 0 && handle < m_lastFrames.size()) {
+      VideoFrameDataPtr uploaded;
+      uploaded.swap(m_lastFrames[handle]);
+      if (!frame) {
+        frame = uploaded;
+      }
+    }
+    if (frame) {
+      m_frameFreezeCache.capture(m_registry.idOf(handle), frame);
+    }
+  }
+}
+
 // ==================== 视频渲染项注册 ====================
 
 void MultiStreamViewModel::registerVideoRenderItem(const QString& instanceId, QObject* item) {
@@ -223,43 +316,140 @@ void MultiStreamViewModel::registerVideoRenderItem(const QString& instanceId, QO
     return;
   }
 
+  InstanceHandle handle = m_registry.intern(instanceId);
   {
     QMutexLocker locker(&m_videoRenderItemsMutex);
-    m_videoRenderItems[instanceId] = vrItem;
+    if (handle >= m_videoRenderItems.size()) {
+      m_videoRenderItems.resize(m_registry.size());
+    }
+    m_videoRenderItems[handle] = vrItem;
+  }
+
+  // 宫格重建（如滚动回来）时先显示冻结帧，实时帧到达后自动替换
+  VideoFrameDataPtr frozen = m_frameFreezeCache.frozenFrame(instanceId);
+  if (frozen) {
+    vrItem->setFrame(frozen);
   }
 
   Logger::debug(QString("[registerVideoRenderItem] 注册成功: %1").arg(instanceId));
 }
 
+// ==================== 客户端抽帧 ====================
+
+void MultiStreamViewModel::setBackgroundTileFps(int fps) {
+  fps = qMax(0, fps);
+  if (m_backgroundTileFps == fps) {
+    return;
+  }
+  m_backgroundTileFps = fps;
+  Logger::info(QString("[setBackgroundTileFps] 后台宫格渲染帧率: %1").arg(fps));
+  emit backgroundTileFpsChanged();
+}
+
+void MultiStreamViewModel::setHoveredInstance(const QString& instanceId) {
+  m_hoveredHandle = instanceId.isEmpty() ? kInvalidInstanceHandle : m_registry.find(instanceId);
+}
+
+void MultiStreamViewModel::setSelectedInstances(const QStringList& instanceIds) {
+  m_selected.fill(false);
+  for (const QString& id : instanceIds) {
+    InstanceHandle handle = m_registry.intern(id);
+    if (handle >= m_selected.size()) {
+      m_selected.resize(m_registry.size());
+    }
+    m_selected[handle] = true;
+  }
+}
+
 // ==================== 批量渲染处理 ====================
 
 void MultiStreamViewModel::batchRenderFrames() {
-  QMap<QString, VideoFrameDataPtr> framesToRender;
+  QVector<InstanceHandle> handles;
+  QVector<VideoFrameDataPtr> frames;
   {
     QMutexLocker locker(&m_frameCacheMutex);
-    if (m_frameCache.isEmpty()) {
-      return;
+    handles.swap(m_frameCacheHandles);
+    frames.reserve(handles.size());
+    for (InstanceHandle handle : handles) {
+      frames.append(VideoFrameDataPtr());
+      frames.last().swap(m_frameCache[handle]);
     }
-    framesToRender.swap(m_frameCache);
   }
 
-  int renderedCount = 0;
-  for (auto it = framesToRender.begin(); it != framesToRender.end(); ++it) {
-    const QString& instanceId = it.key();
-    VideoFrameDataPtr frame = it.value();
+  // 按句柄索引的数组随注册表增长（仅主线程访问）
+  int registered = m_registry.size();
+  if (m_deferredFrames.size() < registered) {
+    m_deferredFrames.resize(registered);
+    m_lastFrames.resize(registered);
+    m_lastUploadMs.resize(registered, -1);
+  }
+
+  // 新帧覆盖尚未上传的旧帧，旧帧随智能指针释放，不做转换和上传
+  for (int i = 0; i < handles.size(); ++i) {
+    const VideoFrameDataPtr& frame = frames[i];
+    m_offeredBytes += qint64(frame->width) * frame->height * 3 / 2;
+    m_offeredFrames++;
+    VideoFrameDataPtr& slot = m_deferredFrames[handles[i]];
+    if (!slot) {
+      m_deferredHandles.append(handles[i]);
+    }
+    slot = frame;
+  }
+
+  qint64 now = m_renderClock.elapsed();
+  qint64 backgroundInterval = m_backgroundTileFps > 0 ? 1000 / m_backgroundTileFps : 0;
+  int kept = 0;
+  for (int i = 0; i < m_deferredHandles.size(); ++i) {
+    InstanceHandle handle = m_deferredHandles[i];
+    bool focused = handle == m_hoveredHandle || (handle < m_selected.size() && m_selected[handle]);
+    qint64 last = m_lastUploadMs[handle];
+    if (!focused && backgroundInterval > 0 && last >= 0 && now - last < backgroundInterval) {
+      m_deferredHandles[kept++] = handle;
+      continue;
+    }
 
     QPointer<VideoRenderItem> renderItem;
     {
       QMutexLocker locker(&m_videoRenderItemsMutex);
-      if (m_videoRenderItems.contains(instanceId)) {
-        renderItem = m_videoRenderItems[instanceId];
+      if (handle < m_videoRenderItems.size()) {
+        renderItem = m_videoRenderItems[handle];
       }
     }
 
+    VideoFrameDataPtr frame;
+    frame.swap(m_deferredFrames[handle]);
     if (renderItem) {
       renderItem->setFrame(frame);
-      renderedCount++;
+      m_uploadedBytes += qint64(frame->width) * frame->height * 3 / 2;
+      m_uploadedFrames++;
+      m_lastFrames[handle] = frame;
+    }
+    m_lastUploadMs[handle] = now;
+  }
+  m_deferredHandles.resize(kept);
+
+  qint64 elapsed = now - m_uploadStatsStartMs;
+  if (elapsed >= 5000) {
+    if (m_offeredFrames > 0) {
+      double sec = elapsed / 1000.0;
+      Logger::info(QString("[batchRenderFrames] 上传 %1 MB/s, %2 fps（不抽帧 %3 MB/s, %4 fps），后台宫格 %5 fps")
+                       .arg(m_uploadedBytes / sec / (1024.0 * 1024.0), 0, 'f', 2)
+                       .arg(m_uploadedFrames / sec, 0, 'f', 1)
+                       .arg(m_offeredBytes / sec / (1024.0 * 1024.0), 0, 'f', 2)
+                       .arg(m_offeredFrames / sec, 0, 'f', 1)
+                       .arg(m_backgroundTileFps));
+    }
+    int lookups = m_frameLookupCount.exchange(0);
+    qint64 lookupNs = m_frameLookupNs.exchange(0);
+    if (lookups > 0) {
+      Logger::debug(QString("[batchRenderFrames] 帧回调实例查找平均 %1 ns/帧（%2 个实例，%3 次）")
+                        .arg(double(lookupNs) / lookups, 0, 'f', 1)
+                        .arg(m_allInstanceIds.size())
+                        .arg(lookups));
     }
+    m_offeredBytes = m_uploadedBytes = 0;
+    m_offeredFrames = m_uploadedFrames = 0;
+    m_uploadStatsStartMs = now;
   }
 }
 
@@ -283,6 +473,18 @@ void MultiStreamViewModel::connectMultipleInstances(const QStringList& allInstan
   m_allInstanceIds = allInstanceIds;
   m_concurrentStreamingInstances = concurrentStreamingInstances;
 
+  // 驻留实例ID；按句柄索引的会话数组在会话创建（回调开始）之前一次性分配好
+  m_sessionHandles.clear();
+  m_sessionHandles.reserve(allInstanceIds.size());
+  for (const QString& instanceId : allInstanceIds) {
+    m_sessionHandles.append(m_registry.intern(instanceId));
+  }
+  m_sessionMembers.fill(false, m_registry.size());
+  m_instanceConnectionStates.fill(InstanceConnectionState::Disconnected, m_registry.size());
+  for (InstanceHandle handle : m_sessionHandles) {
+    m_sessionMembers[handle] = true;
+  }
+
   // 确保 TcrClient 已初始化
   if (!m_tcrClient) {
     m_tcrClient = tcr_client_get_instance();
@@ -301,9 +503,12 @@ void MultiStreamViewModel::connectMultipleInstances(const QStringList& allInstan
   config.stream_profile.fps = streamConfig->subStreamFps();
   config.stream_profile.max_bitrate = streamConfig->subStreamMaxBitrate();
   config.stream_profile.min_bitrate = streamConfig->subStreamMinBitrate();
+  m_tileProfileLadder.reset(config.stream_profile.video_width, config.stream_profile.fps,
+                            config.stream_profile.min_bitrate, config.stream_profile.max_bitrate);
   // config.enable_audio = false;
 
   // 设置并发拉流实例数量
+  // 该值是 SDK 允许的上限，实际同时拉流数由 ConcurrencyController 在 StreamConfig 配置的范围内动态调整
   config.concurrentStreamingInstances = concurrentStreamingInstances;
   Logger::info(QString("[connectMultipleInstances] 使用串流参数 - 宽度:%1, 帧率:%2, 码率:%3-%4, 同时串流数量:%5")
                    .arg(config.stream_profile.video_width)
@@ -346,15 +551,18 @@ void MultiStreamViewModel::connectMultipleInstances(const QStringList& allInstan
   }
 
   // 设置所有实例为连接中状态
-  for (const QString& instanceId : allInstanceIds) {
-    m_instanceConnectionStates[instanceId] = InstanceConnectionState::Connecting;
-    emit instanceConnectionChanged(instanceId, false);
+  for (int i = 0; i < allInstanceIds.size(); ++i) {
+    m_instanceConnectionStates[m_sessionHandles[i]] = InstanceConnectionState::Connecting;
+    emit instanceConnectionChanged(allInstanceIds[i], false);
   }
 
   m_connectedInstanceIds.clear();
   m_currentStreamingIds.clear();
   emit connectedInstanceIdsChanged();
 
+  m_concurrencyController->start(streamConfig->concurrencyPolicy(), concurrentStreamingInstances);
+  emit streamingLimitChanged();
+
   Logger::info(QString("[connectMultipleInstances] 已创建单个Session，管理 %1 个实例").arg(allInstanceIds.size()));
 }
 
@@ -375,6 +583,21 @@ void MultiStreamViewModel::setSessionObservers() {
 void MultiStreamViewModel::closeSession() {
   Logger::info("[closeSession] 开始关闭会话");
 
+  // 先释放尚未上传的帧，再销毁会话；正常关闭时保留各实例最后一帧，重连期间宫格不会变空
+  m_deferredFrames.fill(VideoFrameDataPtr());
+  m_deferredHandles.clear();
+  m_lastUploadMs.fill(-1);
+  if (!m_isDestroying.load(std::memory_order_acquire)) {
+    QVector<InstanceHandle> handles;
+    for (InstanceHandle handle = 0; handle < m_lastFrames.size(); ++handle) {
+      if (m_lastFrames[handle]) {
+        handles.append(handle);
+      }
+    }
+    freezeLastFrames(handles);
+  }
+  m_lastFrames.fill(VideoFrameDataPtr());
+
   if (m_session) {
     // 重要：必须先取消观察者，再销毁会话
     tcr_session_set_observer(m_session, nullptr);
@@ -396,9 +619,13 @@ void MultiStreamViewModel::closeSession() {
   m_allInstanceIds.clear();
   m_connectedInstanceIds.clear();
   m_currentStreamingIds.clear();
-  m_instanceConnectionStates.clear();
+  m_visibleIds.clear();
+  m_sessionHandles.clear();
+  m_sessionMembers.fill(false);
+  m_instanceConnectionStates.fill(InstanceConnectionState::Disconnected);
   m_concurrentStreamingInstances = 0;
   m_isConnected = false;
+  m_concurrencyController->stop();
   emit connectedInstanceIdsChanged();
 
   Logger::info("[closeSession] 会话已关闭");
@@ -488,15 +715,14 @@ void MultiStreamViewModel::SessionEventCallback(void* user_data, TcrSessionEvent
       }
       emit self->requestIdChanged();
 
-      // 更新所有实例为已连接状态
-      for (const QString& instanceId : self->m_allInstanceIds) {
-        self->m_instanceConnectionStates[instanceId] = InstanceConnectionState::Connected;
-
-        if (!self->m_connectedInstanceIds.contains(instanceId)) {
-          self->m_connectedInstanceIds.append(instanceId);
-        }
+      // 连接前上报的单元格尺寸在连接成功后再协商
+      QMetaObject::invokeMethod(self, &MultiStreamViewModel::applyTileProfile, Qt::QueuedConnection);
 
-        emit self->instanceConnectionChanged(instanceId, true);
+      // 更新所有实例为已连接状态（会话内的实例全部连接，直接整体赋值，避免逐个 contains 的 O(n²)）
+      self->m_connectedInstanceIds = self->m_allInstanceIds;
+      for (int i = 0; i < self->m_allInstanceIds.size(); ++i) {
+        self->m_instanceConnectionStates[self->m_sessionHandles[i]] = InstanceConnectionState::Connected;
+        emit self->instanceConnectionChanged(self->m_allInstanceIds[i], true);
       }
 
       emit self->connectedInstanceIdsChanged();
@@ -511,10 +737,10 @@ void MultiStreamViewModel::SessionEventCallback(void* user_data, TcrSessionEvent
       emit self->requestIdChanged();
 
       // 更新所有实例为未连接状态
-      for (const QString& instanceId : self->m_allInstanceIds) {
-        self->m_instanceConnectionStates[instanceId] = InstanceConnectionState::Disconnected;
-        self->m_connectedInstanceIds.removeAll(instanceId);
-        emit self->instanceConnectionChanged(instanceId, false);
+      self->m_connectedInstanceIds.clear();
+      for (int i = 0; i < self->m_allInstanceIds.size(); ++i) {
+        self->m_instanceConnectionStates[self->m_sessionHandles[i]] = InstanceConnectionState::Disconnected;
+        emit self->instanceConnectionChanged(self->m_allInstanceIds[i], false);
       }
 
       emit self->connectedInstanceIdsChanged();
@@ -523,6 +749,7 @@ void MultiStreamViewModel::SessionEventCallback(void* user_data, TcrSessionEvent
 
     case TCR_SESSION_EVENT_CLIENT_STATS:
       self->m_clientStats = eventDataCopy;
+      self->m_concurrencyController->onClientStats(eventDataCopy);
       emit self->clientStatsChanged();
       break;
 
@@ -567,23 +794,19 @@ void MultiStreamViewModel::VideoFrameCallback(void* user_data, TcrVideoFrameHand
     return;
   }
 
-  QString instanceId;
-
-  try {
-    if (frame_buffer->instance_id) {
-      instanceId = QString::fromUtf8(frame_buffer->instance_id);
-    } else {
-      Logger::warning("[VideoFrameCallback] instance_id 为空指针");
-      return;
-    }
-  } catch (...) {
-    Logger::error("[VideoFrameCallback] 复制 instance_id 时发生异常");
+  if (!frame_buffer->instance_id) {
+    Logger::warning("[VideoFrameCallback] instance_id 为空指针");
     return;
   }
 
-  // 验证实例是否在 allInstanceIds 中
-  if (!self->m_allInstanceIds.contains(instanceId)) {
-    Logger::warning(QString("[VideoFrameCallback] 实例 %1 不在实例列表中").arg(instanceId));
+  // 字符串查找只在这里做一次，之后都按句柄索引
+  auto lookupStart = std::chrono::steady_clock::now();
+  InstanceHandle handle = self->m_registry.find(frame_buffer->instance_id);
+
+  // 验证实例是否属于当前会话
+  if (handle < 0 || handle >= self->m_sessionMembers.size() || !self->m_sessionMembers[handle]) {
+    Logger::warning(
+        QString("[VideoFrameCallback] 实例 %1 不在实例列表中").arg(QString::fromUtf8(frame_buffer->instance_id)));
     return;
   }
 
@@ -595,16 +818,14 @@ void MultiStreamViewModel::VideoFrameCallback(void* user_data, TcrVideoFrameHand
       return;
     }
 
-    if (self->m_videoRenderItems.contains(instanceId)) {
-      QPointer<VideoRenderItem> renderItem = self->m_videoRenderItems[instanceId];
-      if (renderItem) {
-        hasValidRenderItem = true;
-      } else {
-        self->m_videoRenderItems.remove(instanceId);
-      }
-    }
+    hasValidRenderItem = handle < self->m_videoRenderItems.size() && self->m_videoRenderItems[handle];
   }
 
+  self->m_frameLookupNs.fetch_add(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - lookupStart).count(),
+      std::memory_order_relaxed);
+  self->m_frameLookupCount.fetch_add(1, std::memory_order_relaxed);
+
   if (!hasValidRenderItem) {
     return;
   }
@@ -627,7 +848,14 @@ void MultiStreamViewModel::VideoFrameCallback(void* user_data, TcrVideoFrameHand
 
   {
     QMutexLocker locker(&self->m_frameCacheMutex);
-    self->m_frameCache[instanceId] = frameDataPtr;
+    if (handle >= self->m_frameCache.size()) {
+      self->m_frameCache.resize(handle + 1);
+    }
+    VideoFrameDataPtr& slot = self->m_frameCache[handle];
+    if (!slot) {
+      self->m_frameCacheHandles.append(handle);
+    }
+    slot = frameDataPtr;
   }
 }
 
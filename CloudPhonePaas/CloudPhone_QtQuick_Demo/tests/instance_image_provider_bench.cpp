@@ -0,0 +1,194 @@
+/**
+ * @file instance_image_provider_bench.cpp
+ * @brief 每轮缩略图刷新在 GUI 线程上的耗时：改动前的同步图像提供者 vs InstanceImageProvider
+ *
+ * 一轮刷新 = 每个实例 updateImage 一张新截图，QML 随后按宫格尺寸请求一次该实例的图片：
+ * - 同步：requestImage 在 GUI 线程持锁查找并缩放（SyncImageProvider 复刻改为异步之前的实现）
+ * - 异步：requestImageResponse 只创建响应对象，查找和缩放在提供者的线程池中完成
+ * 两种截图尺寸各测一次：原图分辨率（未设置宫格尺寸时）和已按宫格尺寸解码（setTileSize 之后）。
+ * 只统计 GUI 线程上的耗时；异步路径另外给出全部响应完成的墙钟时间。纹理上传两条路径相同，不计入。
+ *
+ * 用法：instance_image_provider_bench [实例数=500] [轮数=20]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <QElapsedTimer>
+#include <QGuiApplication>
+#include <QHash>
+#include <QImage>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QQuickImageResponse>
+#include <QVector>
+
+#include "utils/InstanceImageProvider.h"
+
+namespace {
+
+/// 改为异步之前的 InstanceImageProvider::requestImage / updateImage
+class SyncImageProvider {
+ public:
+  QImage requestImage(const QString& id, QSize* size, const QSize& requestedSize) {
+    QMutexLocker locker(&m_mutex);
+    auto it = m_imageCache.find(id);
+    if (it == m_imageCache.end() || it->source.isNull()) {
+      return QImage();
+    }
+    Entry& entry = it.value();
+    if (size) {
+      *size = entry.source.size();
+    }
+    QSize target = targetSize(entry.source.size(), requestedSize);
+    if (target == entry.source.size()) {
+      return entry.source;
+    }
+    quint64 key = (quint64(quint32(target.width())) << 32) | quint32(target.height());
+    auto variant = entry.variants.constFind(key);
+    if (variant != entry.variants.constEnd()) {
+      return variant.value();
+    }
+    if (entry.variants.size() >= 3) {
+      entry.variants.clear();
+    }
+    QImage scaled = entry.source.scaled(target, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    entry.variants.insert(key, scaled);
+    return scaled;
+  }
+
+  void updateImage(const QString& instanceId, const QImage& image) {
+    QMutexLocker locker(&m_mutex);
+    Entry& entry = m_imageCache[instanceId];
+    entry.source = image;
+    entry.variants.clear();
+  }
+
+ private:
+  struct Entry {
+    QImage source;
+    QHash<quint64, QImage> variants;
+  };
+
+  static QSize targetSize(const QSize& sourceSize, const QSize& requestedSize) {
+    if (requestedSize.width() <= 0 || requestedSize.height() <= 0) {
+      return sourceSize;
+    }
+    QSize target = sourceSize.scaled(requestedSize, Qt::KeepAspectRatio);
+    return target.width() >= sourceSize.width() || target.isEmpty() ? sourceSize : target;
+  }
+
+  QMutex m_mutex;
+  QHash<QString, Entry> m_imageCache;
+};
+
+struct Result {
+  double guiMsPerRound = 0;   ///< GUI 线程上每轮的耗时
+  double wallMsPerRound = 0;  ///< 每轮到全部图片可用的耗时（同步路径与 GUI 耗时相同）
+};
+
+/// 每轮换一批像素不同的截图，避免命中上一轮的缩放结果
+QVector<QImage> makeFrames(const QSize& size, int count) {
+  QVector<QImage> frames;
+  for (int i = 0; i < count; ++i) {
+    QImage image(size, QImage::Format_RGB32);
+    image.fill(QColor::fromHsv((i * 37) % 360, 200, 200));
+    frames.append(image);
+  }
+  return frames;
+}
+
+Result runSync(const QStringList& ids, const QVector<QImage>& frames, const QSize& tileSize, int rounds) {
+  SyncImageProvider provider;
+  QElapsedTimer timer;
+  qint64 totalNs = 0;
+  for (int round = 0; round < rounds; ++round) {
+    const QImage& frame = frames[round % frames.size()];
+    timer.start();
+    for (const QString& id : ids) {
+      provider.updateImage(id, frame);
+      QSize size;
+      QImage image = provider.requestImage(id, &size, tileSize);
+      Q_UNUSED(image);
+    }
+    totalNs += timer.nsecsElapsed();
+  }
+  Result result;
+  result.guiMsPerRound = totalNs / 1e6 / rounds;
+  result.wallMsPerRound = result.guiMsPerRound;
+  return result;
+}
+
+Result runAsync(const QStringList& ids, const QVector<QImage>& frames, const QSize& tileSize, int rounds) {
+  InstanceImageProvider provider;
+  QElapsedTimer timer;
+  QElapsedTimer wall;
+  qint64 guiNs = 0;
+  qint64 wallNs = 0;
+  for (int round = 0; round < rounds; ++round) {
+    const QImage& frame = frames[round % frames.size()];
+    int pending = ids.size();
+    wall.start();
+    for (const QString& id : ids) {
+      timer.start();
+      const quint64 version = provider.updateImage(id, frame);
+      QQuickImageResponse* response =
+          provider.requestImageResponse(QStringLiteral("%1?v=%2").arg(id).arg(version), tileSize);
+      guiNs += timer.nsecsElapsed();
+      // 与 QML 引擎相同：finished 排队回到 GUI 线程后释放响应
+      QObject::connect(
+          response, &QQuickImageResponse::finished, response,
+          [response, &pending]() {
+            --pending;
+            response->deleteLater();
+          },
+          Qt::QueuedConnection);
+    }
+    while (pending > 0) {
+      timer.start();
+      QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+      guiNs += timer.nsecsElapsed();
+    }
+    wallNs += wall.nsecsElapsed();
+  }
+  Result result;
+  result.guiMsPerRound = guiNs / 1e6 / rounds;
+  result.wallMsPerRound = wallNs / 1e6 / rounds;
+  return result;
+}
+
+void report(const char* name, const char* path, const Result& result) {
+  std::printf("%-26s %-6s GUI thread %8.2f ms/round   all images ready %8.2f ms/round\n", name, path,
+              result.guiMsPerRound, result.wallMsPerRound);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) {
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+  }
+  QGuiApplication app(argc, argv);
+
+  const int instances = argc > 1 ? std::atoi(argv[1]) : 500;
+  const int rounds = argc > 2 ? std::atoi(argv[2]) : 20;
+  if (instances <= 0 || rounds <= 0) {
+    std::fprintf(stderr, "usage: %s [instances] [rounds]\n", argv[0]);
+    return 2;
+  }
+  QStringList ids;
+  for (int i = 0; i < instances; ++i) {
+    ids.append(QStringLiteral("cai-%1").arg(i));
+  }
+
+  // 宫格物理像素尺寸；原图为 720x1280 的手机截图
+  const QSize tileSize(180, 320);
+  const QVector<QImage> fullFrames = makeFrames(QSize(720, 1280), 4);
+  const QVector<QImage> tileFrames = makeFrames(tileSize, 4);
+
+  std::printf("%d instances x %d rounds, tile %dx%d\n", instances, rounds, tileSize.width(), tileSize.height());
+  report("720x1280 source (scaled)", "sync", runSync(ids, fullFrames, tileSize, rounds));
+  report("720x1280 source (scaled)", "async", runAsync(ids, fullFrames, tileSize, rounds));
+  report("tile-size source", "sync", runSync(ids, tileFrames, tileSize, rounds));
+  report("tile-size source", "async", runAsync(ids, tileFrames, tileSize, rounds));
+  return 0;
+}
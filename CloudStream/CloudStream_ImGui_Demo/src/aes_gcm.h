@@ -0,0 +1,24 @@
+#pragma once
+
+// aes_gcm.h - AES-256-GCM（NIST SP 800-38D）
+// 只用于本地缓存这类小数据的加密和完整性校验，不依赖加密库；
+// 查表实现，没有做常数时间处理，不要用于网络协议或处理他人可控的大量数据
+
+#include <cstddef>
+#include <string>
+
+namespace aes_gcm {
+
+const size_t kKeySize = 32;
+const size_t kNonceSize = 12;
+const size_t kTagSize = 16;
+
+// 加密 plain，返回 密文 || 16 字节标签；aad 只参与认证不加密。
+// key 必须 32 字节、nonce 必须 12 字节（长度不对返回空串），同一 key 下 nonce 不能重复使用
+std::string seal(const std::string& key, const std::string& nonce, const std::string& plain, const std::string& aad);
+
+// 校验标签后解密 seal 的输出；密钥、nonce、aad 不符或内容被改动时返回 false
+bool unseal(const std::string& key, const std::string& nonce, const std::string& sealed, const std::string& aad,
+            std::string& plain);
+
+}  // namespace aes_gcm
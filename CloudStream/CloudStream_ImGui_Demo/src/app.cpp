@@ -6,6 +6,7 @@
 
 #include "http_client.h"
 #include "logger.h"
+#include "startup_timeline.h"
 #if defined(RENDERER_D3D11)
 #  include <imgui_impl_dx11.h>
 #else
@@ -18,15 +19,19 @@
 #endif
 
 #include <algorithm>
+#include <chrono>
 #include <cstring>
 #include <fstream>
 #include <nlohmann/json.hpp>
 #include <sstream>
-#include <thread>
 
 #include "tcr_c_api.h"
 #include "tcr_types.h"
 
+static int64_t unix_now() {
+  return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
 // =============================================================================
 // Lifecycle
 // =============================================================================
@@ -35,11 +40,15 @@ App::App() {}
 
 App::~App() {
   m_is_destroying.store(true, std::memory_order_release);
+  if (m_token_request) m_http.cancel(m_token_request);
+  if (m_prepare_thread.joinable()) m_prepare_thread.join();
   close_all_popups();
   close_session();
-  for (auto& kv : m_instance_renderers) {
-    kv.second->destroy();
-    delete kv.second;
+  m_freeze_cache.shutdown();
+  for (VideoRenderer* r : m_instance_renderers) {
+    if (!r) continue;
+    r->destroy();
+    delete r;
   }
   m_instance_renderers.clear();
 }
@@ -48,14 +57,9 @@ App::~App() {
 // Init
 // =============================================================================
 
-#if defined(RENDERER_D3D11)
-bool App::init(SDL_Window* window, void* d3d_device, void* d3d_context) {
-  m_window = window;
-#else
-bool App::init(SDL_Window* window, SDL_GLContext gl_context) {
-  m_window = window;
-  m_gl_context = gl_context;
-#endif
+void App::preload() {
+  StartupTimeline& timeline = StartupTimeline::instance();
+  timeline.begin("config");
   std::string config_path;
   {
     char* bp = SDL_GetBasePath();
@@ -75,6 +79,25 @@ bool App::init(SDL_Window* window, SDL_GLContext gl_context) {
     if (config_path.empty()) config_path = "config.json";
   }
   m_config.load(config_path);
+  timeline.end("config");
+
+  Log::set_level(m_config.log_level);
+  if (!m_config.log_file.empty()) {
+    std::string log_path = m_config.log_file;
+    const bool absolute = log_path[0] == '/' || log_path[0] == '\\' || (log_path.size() > 1 && log_path[1] == ':');
+    if (!absolute) {
+      char* pref = SDL_GetPrefPath("Tencent", "CloudStreamImGuiDemo");
+      if (pref) {
+        log_path = std::string(pref) + log_path;
+        SDL_free(pref);
+      }
+    }
+    if (Log::set_file(log_path, size_t(m_config.log_file_max_mb) * 1024 * 1024, m_config.log_file_backups)) {
+      LOG_INFO("App", "Logging to %s", log_path.c_str());
+    } else {
+      LOG_WARN("App", "Cannot open log file %s", log_path.c_str());
+    }
+  }
 
   static TcrLogCallback lcb = {};
   lcb.on_log = [](void*, TcrLogLevel lv, const char* tag, const char* msg) {
@@ -96,10 +119,54 @@ bool App::init(SDL_Window* window, SDL_GLContext gl_context) {
     }
   };
   tcr_set_log_callback(&lcb);
-  tcr_set_log_level(TCR_LOG_LEVEL_INFO);
+  // SDK 的 DEBUG 日志只在会被输出时打开
+  const bool sdk_debug = LOG_COMPILE_LEVEL <= 0 && m_config.log_level == Log::Level::Debug;
+  tcr_set_log_level(sdk_debug ? TCR_LOG_LEVEL_DEBUG : TCR_LOG_LEVEL_INFO);
+
+  // Connection warm-up does not need the token; it runs while the window is created and the token is fetched
+  m_tcr_client = tcr_client_get_instance();
+  if (m_tcr_client) {
+    void* client = m_tcr_client;
+    m_prepare_thread = std::thread([client]() {
+      StartupTimeline::instance().begin("tcr_prepare");
+      tcr_client_prepare(static_cast<TcrClientHandle>(client));
+      StartupTimeline::instance().end("tcr_prepare");
+    });
+  }
+
+  if (m_config.token_cache) {
+    char* pref = SDL_GetPrefPath("Tencent", "CloudStreamImGuiDemo");
+    if (pref) {
+      m_token_cache.open(pref, TokenCache::default_key_dir("CloudStreamImGuiDemo"));
+      SDL_free(pref);
+    }
+  }
+  if (m_config.get_instance_id_list().empty()) return;
+  CachedToken cached;
+  if (m_token_cache.load(token_cache_key(), cached)) {
+    m_token = cached.token;
+    m_access_info = cached.access_info;
+    m_token_expires_at = cached.expires_at;
+    m_token_from_cache = true;
+    timeline.mark("token", "cache hit");
+    LOG_INFO("App", "Using cached access token, expires in %lld s", (long long)(cached.expires_at - unix_now()));
+  } else {
+    send_token_request();
+  }
+}
+
+#if defined(RENDERER_D3D11)
+bool App::init(SDL_Window* window, void* d3d_device, void* d3d_context) {
+  m_window = window;
+#else
+bool App::init(SDL_Window* window, SDL_GLContext gl_context) {
+  m_window = window;
+  m_gl_context = gl_context;
+#endif
   LOG_INFO("App", "Init ok. instances=%zu concurrent=%d", m_config.get_instance_id_list().size(),
            m_config.concurrent_streaming);
   m_main_imgui_ctx = ImGui::GetCurrentContext();
+  if (m_config.auto_connect) request_token();
   return true;
 }
 
@@ -147,7 +214,16 @@ void App::update(float dt) {
     }
   }
 
-  batch_render_frames();
+  m_http.poll();
+  if (m_token_rejected.exchange(false)) {
+    // The cached token may have been revoked; the next attempt fetches a fresh one
+    LOG_WARN("App", "Session closed before connecting with a cached token, dropping it");
+    drop_token();
+  }
+  batch_render_frames(dt);
+  apply_frozen_frames();
+
+  if (m_state == AppState::MULTI_STREAM && m_concurrency.tick(dt)) apply_visible(m_visible_ids);
 
   // Upload frames for all popup windows
   for (auto* pw : m_popups) {
@@ -538,48 +614,93 @@ void App::render_single_popup(PopupWindow* pw) {
 
 void App::request_token() {
   if (m_state == AppState::REQUESTING_TOKEN) return;
-  m_state = AppState::REQUESTING_TOKEN;
   m_error_message.clear();
-  auto ids = m_config.get_instance_id_list();
-  if (ids.empty()) {
+  if (m_config.get_instance_id_list().empty()) {
     m_error_message = "No instance IDs";
     m_state = AppState::TOKEN_PAGE;
     return;
   }
+  StartupTimeline::instance().mark("connect_requested");
+  if (!m_token.empty()) {
+    if (m_token_expires_at - unix_now() > TokenCache::kExpiryMarginSec) {
+      start_multi_streaming();
+      return;
+    }
+    drop_token();
+  }
+  // The prefetch may still be in flight; its callback starts streaming once the state is REQUESTING_TOKEN
+  m_state = AppState::REQUESTING_TOKEN;
+  if (!m_token_request) send_token_request();
+}
+
+void App::send_token_request() {
   nlohmann::json req;
   req["RequestId"] = "imgui-" + std::to_string(SDL_GetTicks());
   nlohmann::json arr = nlohmann::json::array();
-  for (const auto& id : ids) arr.push_back(id);
+  for (const auto& id : m_config.get_instance_id_list()) arr.push_back(id);
   req["AndroidInstanceIds"] = arr;
+  if (m_config.token_ttl_hours > 0) req["ExpirationDuration"] = std::to_string(m_config.token_ttl_hours) + "h";
   std::string url = m_config.base_url + m_config.api_path;
   std::string body = req.dump();
-  std::thread([this, url, body]() {
-    HttpResponse r = http_post(url, body);
+  int64_t requested_at = unix_now();
+  StartupTimeline::instance().begin("token_fetch");
+  m_token_request = m_http.post_async(url, body, [this, requested_at](const HttpResponse& r) {
+    m_token_request = 0;
+    std::string error, token, access_info;
     if (!r.ok()) {
-      m_error_message = "HTTP " + std::to_string(r.status_code);
-      m_state = AppState::TOKEN_PAGE;
-      return;
-    }
-    try {
-      auto j = nlohmann::json::parse(r.body);
-      if (j.contains("Error")) {
-        m_error_message = j["Error"].value("Code", "") + ": " + j["Error"].value("Message", "");
-        m_state = AppState::TOKEN_PAGE;
-        return;
+      error = r.error.empty() ? "HTTP " + std::to_string(r.status_code) : r.error;
+    } else {
+      try {
+        auto j = nlohmann::json::parse(r.body);
+        if (j.contains("Error")) {
+          error = j["Error"].value("Code", "") + ": " + j["Error"].value("Message", "");
+        } else {
+          token = j.value("Token", "");
+          access_info = j.value("AccessInfo", "");
+          if (token.empty() || access_info.empty()) error = "Missing Token/AccessInfo";
+        }
+      } catch (const std::exception& e) {
+        error = e.what();
       }
-      m_token = j.value("Token", "");
-      m_access_info = j.value("AccessInfo", "");
-      if (m_token.empty() || m_access_info.empty()) {
-        m_error_message = "Missing Token/AccessInfo";
+    }
+    StartupTimeline::instance().end("token_fetch", error.empty() ? nullptr : "failed");
+    if (!error.empty()) {
+      // A failed prefetch only logs; clicking the button retries
+      if (m_state == AppState::REQUESTING_TOKEN) {
+        m_error_message = error;
         m_state = AppState::TOKEN_PAGE;
-        return;
+      } else {
+        LOG_WARN("App", "Token prefetch failed: %s", error.c_str());
       }
-      start_multi_streaming();
-    } catch (const std::exception& e) {
-      m_error_message = e.what();
-      m_state = AppState::TOKEN_PAGE;
+      return;
     }
-  }).detach();
+    m_token = token;
+    m_access_info = access_info;
+    m_token_expires_at = requested_at + (int64_t)std::max(m_config.token_ttl_hours, 0) * 3600;
+    m_token_from_cache = false;
+    if (m_config.token_ttl_hours > 0) {
+      CachedToken cached;
+      cached.token = m_token;
+      cached.access_info = m_access_info;
+      cached.expires_at = m_token_expires_at;
+      m_token_cache.store(token_cache_key(), cached);
+    }
+    if (m_state == AppState::REQUESTING_TOKEN) start_multi_streaming();
+  });
+}
+
+std::string App::token_cache_key() const {
+  std::string key = m_config.base_url + m_config.api_path;
+  for (const auto& id : m_config.get_instance_id_list()) key += "," + id;
+  return key;
+}
+
+void App::drop_token() {
+  m_token.clear();
+  m_access_info.clear();
+  m_token_expires_at = 0;
+  m_token_from_cache = false;
+  m_token_cache.remove();
 }
 
 // =============================================================================
@@ -588,6 +709,12 @@ void App::request_token() {
 
 void App::start_multi_streaming() {
   m_error_message.clear();
+  StartupTimeline& timeline = StartupTimeline::instance();
+  if (m_prepare_thread.joinable()) {
+    timeline.begin("wait_prepare");
+    m_prepare_thread.join();
+    timeline.end("wait_prepare");
+  }
   m_tcr_client = tcr_client_get_instance();
   if (!m_tcr_client) {
     m_error_message = "No TcrClient";
@@ -598,33 +725,67 @@ void App::start_multi_streaming() {
   TcrConfig cfg = tcr_config_default();
   cfg.token = m_token.c_str();
   cfg.accessInfo = m_access_info.c_str();
+  timeline.begin("tcr_client_init");
   if (tcr_client_init(static_cast<TcrClientHandle>(m_tcr_client), &cfg) != TCR_SUCCESS) {
+    timeline.end("tcr_client_init", "failed");
+    drop_token();
     m_error_message = "tcr_client_init failed";
     m_state = AppState::TOKEN_PAGE;
     return;
   }
+  timeline.end("tcr_client_init");
 
   m_tcr_instance = tcr_client_get_android_instance(static_cast<TcrClientHandle>(m_tcr_client));
+  // Stop the old session's callbacks before the handle-indexed state is resized
+  close_session();
   m_all_instance_ids = m_config.get_instance_id_list();
-  m_instance_states.clear();
+  m_all_instance_handles.clear();
+  for (const auto& id : m_all_instance_ids) m_all_instance_handles.push_back(m_registry.intern(id));
+  size_t slots = (size_t)m_registry.size();
+  m_instance_states.assign(slots, InstanceState::Offline);
+  m_instance_renderers.resize(slots, nullptr);
+  m_deferred_frames.resize(slots);
+  m_last_upload_ms.resize(slots, 0);
+  m_last_frames.resize(slots);
   m_current_streaming_ids.clear();
-  m_checked_instances.clear();
-  for (const auto& id : m_all_instance_ids) m_instance_states[id] = InstanceState::Connecting;
+  m_checked.assign(slots, 0);
+  m_checked_count = 0;
+  for (InstanceHandle h : m_all_instance_handles) m_instance_states[h] = InstanceState::Connecting;
+  m_connected_count.store(0, std::memory_order_relaxed);
+  rebuild_search_index();
 
+  timeline.begin("create_session");
   create_multi_session();
+  timeline.end("create_session");
   access_all_instances();
+  timeline.mark("access_instances");
   m_state = AppState::MULTI_STREAM;
 }
 
 void App::create_multi_session() {
   close_session();
 
+  // The session is created with the upper bound; the controller picks the active count within it
+  ConcurrencyPolicy policy;
+  policy.enabled = m_config.adaptive_concurrency;
+  policy.min_streams = m_config.adaptive_concurrency ? m_config.concurrent_streaming_min : m_config.concurrent_streaming;
+  policy.max_streams = m_config.adaptive_concurrency && m_config.concurrent_streaming_max > 0
+                           ? m_config.concurrent_streaming_max
+                           : m_config.concurrent_streaming;
+  policy.cpu_high = m_config.adaptive_cpu_high;
+  policy.cpu_low = m_config.adaptive_cpu_low;
+  policy.shrink_cooldown_sec = m_config.adaptive_cooldown_sec;
+  policy.grow_cooldown_sec = m_config.adaptive_cooldown_sec * 3;
+  m_concurrency.reset(policy, m_config.concurrent_streaming);
+  m_tile_profile.reset(m_config.video_width, m_config.video_fps, m_config.video_min_bitrate,
+                       m_config.video_max_bitrate);
+
   TcrSessionConfig c = tcr_session_config_default();
   c.stream_profile.video_width = m_config.video_width;
   c.stream_profile.fps = m_config.video_fps;
   c.stream_profile.min_bitrate = m_config.video_min_bitrate;
   c.stream_profile.max_bitrate = m_config.video_max_bitrate;
-  c.concurrentStreamingInstances = m_config.concurrent_streaming;
+  c.concurrentStreamingInstances = policy.max_streams;
 
   m_tcr_session = tcr_client_create_session(static_cast<TcrClientHandle>(m_tcr_client), &c);
   if (!m_tcr_session) {
@@ -663,7 +824,18 @@ void App::close_session() {
     m_tcr_session = nullptr;
   }
   m_multi_frame_cache.clear();
+  for (InstanceHandle h : m_deferred_handles) m_deferred_frames[h] = VideoFrame();
+  m_deferred_handles.clear();
+  std::fill(m_last_upload_ms.begin(), m_last_upload_ms.end(), 0);
+  std::vector<InstanceHandle> last;
+  for (InstanceHandle h = 0; h < (InstanceHandle)m_last_frames.size(); ++h)
+    if (m_last_frames[h].handle) last.push_back(h);
+  if (!m_is_destroying.load(std::memory_order_acquire))
+    freeze_last_frames(last);
+  else
+    for (InstanceHandle h : last) m_last_frames[h] = VideoFrame();
   m_current_streaming_ids.clear();
+  m_visible_ids.clear();
 }
 
 // =============================================================================
@@ -673,14 +845,21 @@ void App::close_session() {
 void App::on_multi_session_event(void* ud, int ev, const char* d) {
   App* s = static_cast<App*>(ud);
   if (!s || s->m_is_destroying.load(std::memory_order_acquire)) return;
-  if ((TcrSessionEvent)ev == TCR_SESSION_EVENT_STATE_CONNECTED)
-    for (auto& kv : s->m_instance_states) kv.second = InstanceState::Connected;
-  else if ((TcrSessionEvent)ev == TCR_SESSION_EVENT_STATE_CLOSED) {
-    for (auto& kv : s->m_instance_states) kv.second = InstanceState::Offline;
+  if ((TcrSessionEvent)ev == TCR_SESSION_EVENT_STATE_CONNECTED) {
+    StartupTimeline::instance().mark("session_connected");
+    for (InstanceHandle h : s->m_all_instance_handles) s->m_instance_states[h] = InstanceState::Connected;
+    s->m_connected_count.store((int)s->m_all_instance_handles.size(), std::memory_order_relaxed);
+    s->m_state_epoch.fetch_add(1, std::memory_order_release);
+  } else if ((TcrSessionEvent)ev == TCR_SESSION_EVENT_STATE_CLOSED) {
+    for (InstanceHandle h : s->m_all_instance_handles) s->m_instance_states[h] = InstanceState::Offline;
+    if (s->m_connected_count.exchange(0, std::memory_order_relaxed) == 0 && s->m_token_from_cache)
+      s->m_token_rejected.store(true);
+    s->m_state_epoch.fetch_add(1, std::memory_order_release);
     s->m_state = AppState::DISCONNECTED;
     s->m_error_message = d ? d : "closed";
   } else if ((TcrSessionEvent)ev == TCR_SESSION_EVENT_CLIENT_STATS && d) {
     s->m_client_stats = d;
+    s->m_concurrency.on_client_stats(d);
   }
 }
 
@@ -690,12 +869,17 @@ void App::on_multi_video_frame(void* ud, void* fh) {
   TcrVideoFrameHandle h = static_cast<TcrVideoFrameHandle>(fh);
   const TcrVideoFrameBuffer* b = tcr_video_frame_get_buffer(h);
   if (!b || b->type != TCR_VIDEO_BUFFER_TYPE_I420) return;
-  std::string id;
-  if (b->instance_id) id = b->instance_id;
-  if (id.empty()) return;
+  // The only string lookup on the frame path; everything downstream is indexed by handle
+  auto t0 = std::chrono::steady_clock::now();
+  InstanceHandle ih = s->m_registry.find(b->instance_id);
+  s->m_frame_lookup_ns.fetch_add(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0).count(),
+      std::memory_order_relaxed);
+  s->m_frame_lookup_count.fetch_add(1, std::memory_order_relaxed);
+  if (ih == kInvalidInstanceHandle) return;
   tcr_video_frame_add_ref(h);
   const TcrI420Buffer& i = b->buffer.i420;
-  s->m_multi_frame_cache.push(id, VideoFrame(h, i.data_y, i.data_u, i.data_v, i.stride_y, i.stride_u, i.stride_v,
+  s->m_multi_frame_cache.push(ih, VideoFrame(h, i.data_y, i.data_u, i.data_v, i.stride_y, i.stride_u, i.stride_v,
                                              i.width, i.height, b->timestamp_us));
 }
 
@@ -703,20 +887,103 @@ void App::on_multi_video_frame(void* ud, void* fh) {
 // Batch render & stream switching
 // =============================================================================
 
-void App::batch_render_frames() {
-  auto frames = m_multi_frame_cache.swap_all();
-  for (auto& kv : frames) {
-    if (!kv.second.valid()) continue;
-    VideoRenderer* r = get_or_create_renderer(kv.first);
-    if (r)
-      r->upload_frame(kv.second.data_y, kv.second.data_u, kv.second.data_v, kv.second.stride_y, kv.second.stride_u,
-                      kv.second.stride_v, kv.second.width, kv.second.height);
+void App::batch_render_frames(float dt) {
+  // Newer frames replace the deferred one, releasing it without conversion or upload
+  m_multi_frame_cache.swap_all(m_incoming_frames);
+  for (auto& kv : m_incoming_frames) {
+    if (!kv.second.valid() || kv.first >= (InstanceHandle)m_deferred_frames.size()) continue;
+    m_offered_bytes += (uint64_t)kv.second.width * kv.second.height * 3 / 2;
+    m_offered_frames++;
+    VideoFrame& slot = m_deferred_frames[kv.first];
+    if (!slot.handle) m_deferred_handles.push_back(kv.first);
+    slot = std::move(kv.second);
+  }
+  m_incoming_frames.clear();
+
+  Uint32 now = SDL_GetTicks();
+  int bg_fps = m_config.background_tile_fps;
+  Uint32 bg_interval = bg_fps > 0 ? 1000u / (Uint32)bg_fps : 0;
+  size_t kept = 0;
+  for (size_t k = 0; k < m_deferred_handles.size(); ++k) {
+    InstanceHandle h = m_deferred_handles[k];
+    bool focused = h == m_hovered || m_checked[h];
+    Uint32& last = m_last_upload_ms[h];
+    if (!focused && bg_interval > 0 && now - last < bg_interval) {
+      m_deferred_handles[kept++] = h;
+      continue;
+    }
+    VideoFrame& f = m_deferred_frames[h];
+    VideoRenderer* r = get_or_create_renderer(h);
+    if (r) {
+      r->upload_frame(f.data_y, f.data_u, f.data_v, f.stride_y, f.stride_u, f.stride_v, f.width, f.height);
+      StartupTimeline::instance().finish("first_frame");
+      m_uploaded_bytes += (uint64_t)f.width * f.height * 3 / 2;
+      m_uploaded_frames++;
+      // Keep the frame referenced so it can be frozen when the tile is switched out
+      m_last_frames[h] = std::move(f);
+    }
+    f = VideoFrame();
+    last = now;
+  }
+  m_deferred_handles.resize(kept);
+
+  m_upload_stats_timer += dt;
+  if (m_upload_stats_timer >= 5.0f) {
+    double sec = m_upload_stats_timer;
+    m_upload_rate = m_uploaded_bytes / sec;
+    if (m_offered_frames > 0)
+      LOG_INFO("App", "Grid upload: %.2f MB/s %.1f fps (without decimation %.2f MB/s %.1f fps), background tiles @%d fps",
+               m_upload_rate / (1024.0 * 1024.0), m_uploaded_frames / sec, m_offered_bytes / sec / (1024.0 * 1024.0),
+               m_offered_frames / sec, bg_fps);
+    uint32_t lookups = m_frame_lookup_count.exchange(0);
+    uint64_t lookup_ns = m_frame_lookup_ns.exchange(0);
+    if (lookups > 0)
+      LOG_DEBUG("App", "Frame callback id lookup: %.1f ns avg over %u frames (%zu instances)",
+                (double)lookup_ns / lookups, lookups, m_all_instance_ids.size());
+    m_offered_bytes = m_uploaded_bytes = 0;
+    m_offered_frames = m_uploaded_frames = 0;
+    m_upload_stats_timer = 0;
+  }
+}
+
+void App::freeze_last_frames(const std::vector<InstanceHandle>& handles) {
+  for (InstanceHandle h : handles) {
+    if (h < 0 || h >= (InstanceHandle)m_last_frames.size()) continue;
+    // A pending deferred frame is newer than the last uploaded one
+    if (m_deferred_frames[h].handle) {
+      m_last_frames[h] = std::move(m_deferred_frames[h]);
+      m_deferred_handles.erase(std::remove(m_deferred_handles.begin(), m_deferred_handles.end(), h),
+                               m_deferred_handles.end());
+    }
+    if (!m_last_frames[h].handle) continue;
+    m_freeze_cache.capture(m_registry.id_of(h), std::move(m_last_frames[h]));
+    m_last_frames[h] = VideoFrame();
   }
 }
 
-VideoRenderer* App::get_or_create_renderer(const std::string& id) {
-  auto it = m_instance_renderers.find(id);
-  if (it != m_instance_renderers.end()) return it->second;
+void App::apply_frozen_frames() {
+  // Swap the full-size texture of a switched-out tile for its small frozen copy
+  for (const auto& id : m_freeze_cache.take_ready()) {
+    if (m_current_streaming_ids.count(id)) continue;
+    InstanceHandle h = m_registry.find(id);
+    VideoRenderer* r = h >= 0 && h < (InstanceHandle)m_instance_renderers.size() ? m_instance_renderers[h] : nullptr;
+    FrozenFrame f;
+    if (!r || !m_freeze_cache.get(id, f)) continue;
+    r->upload_frame(f.y(), f.u(), f.v(), f.width, f.width / 2, f.width / 2, f.width, f.height);
+  }
+  // Evicted entries release their GPU textures too; the tile falls back to the placeholder
+  for (const auto& id : m_freeze_cache.take_evicted()) {
+    if (m_current_streaming_ids.count(id)) continue;
+    InstanceHandle h = m_registry.find(id);
+    if (h < 0 || h >= (InstanceHandle)m_instance_renderers.size() || !m_instance_renderers[h]) continue;
+    m_instance_renderers[h]->destroy();
+    delete m_instance_renderers[h];
+    m_instance_renderers[h] = nullptr;
+  }
+}
+
+VideoRenderer* App::get_or_create_renderer(InstanceHandle h) {
+  if (m_instance_renderers[h]) return m_instance_renderers[h];
   VideoRenderer* r = new VideoRenderer();
 #if !defined(RENDERER_D3D11)
   if (!r->init()) {
@@ -724,30 +991,70 @@ VideoRenderer* App::get_or_create_renderer(const std::string& id) {
     return nullptr;
   }
 #endif
-  m_instance_renderers[id] = r;
+  m_instance_renderers[h] = r;
   return r;
 }
 
+void App::rebuild_search_index() {
+  m_search_index.clear();
+  for (size_t i = 0; i < m_all_instance_ids.size(); ++i)
+    m_search_index.add(m_all_instance_ids[i], (int)m_instance_states[m_all_instance_handles[i]]);
+  m_indexed_state_epoch = m_state_epoch.load(std::memory_order_acquire);
+  m_filter_dirty = true;
+}
+
+// Re-runs the grid query when the filter or any instance state changed; returns true if m_grid_rows was rebuilt
+bool App::refresh_grid_filter() {
+  uint32_t epoch = m_state_epoch.load(std::memory_order_acquire);
+  if (epoch != m_indexed_state_epoch) {
+    m_indexed_state_epoch = epoch;
+    for (size_t i = 0; i < m_all_instance_handles.size(); ++i)
+      m_search_index.set_state((int)i, (int)m_instance_states[m_all_instance_handles[i]]);
+    if (m_filter_state != 0) m_filter_dirty = true;
+  }
+  if (!m_filter_dirty) return false;
+  m_filter_dirty = false;
+
+  uint32_t mask = m_filter_state == 0 ? InstanceSearchIndex::kAllStates : 1u << (m_filter_state - 1);
+  auto t0 = std::chrono::steady_clock::now();
+  m_search_index.query(m_filter_text, mask, false, m_grid_rows);
+  double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+  LOG_DEBUG("App", "Grid filter \"%s\" state %d: %zu/%zu instances in %.0f us", m_filter_text, m_filter_state,
+            m_grid_rows.size(), m_all_instance_ids.size(), us);
+  return true;
+}
+
 std::vector<std::string> App::calculate_visible_instances(float sy, float vh, float ch) {
-  if (ch <= 0 || m_all_instance_ids.empty()) return {};
+  if (ch <= 0 || m_grid_rows.empty()) return {};
   int c = m_grid_columns;
   int sr = std::max(0, (int)(sy / ch));
   int er = (int)((sy + vh) / ch) + 1;
   int si = std::max(0, sr * c);
-  int ei = std::min(er * c, (int)m_all_instance_ids.size());
+  int ei = std::min(er * c, (int)m_grid_rows.size());
   std::vector<std::string> v;
-  for (int i = si; i < ei; ++i) v.push_back(m_all_instance_ids[i]);
+  for (int i = si; i < ei; ++i) v.push_back(m_all_instance_ids[m_grid_rows[i]]);
   return v;
 }
 
-void App::switch_streaming_instances(const std::vector<std::string>& ids) {
+void App::set_visible_instances(const std::vector<std::string>& ids) {
+  if (ids.empty()) return;
+  m_visible_ids = ids;
+  apply_visible(m_visible_ids);
+}
+
+void App::apply_visible(const std::vector<std::string>& ids) {
   if (!m_tcr_session || ids.empty()) return;
-  int lim = m_config.concurrent_streaming;
+  size_t n = std::min(ids.size(), (size_t)m_concurrency.limit());
+  std::set<std::string> next(ids.begin(), ids.begin() + n);
+  if (next == m_current_streaming_ids) return;
   std::vector<const char*> p;
-  for (size_t i = 0; i < ids.size() && (int)i < lim; ++i) p.push_back(ids[i].c_str());
+  for (size_t i = 0; i < n; ++i) p.push_back(ids[i].c_str());
   tcr_session_switch_streaming_instances(static_cast<TcrSessionHandle>(m_tcr_session), p.data(), (int32_t)p.size());
-  m_current_streaming_ids.clear();
-  for (const auto& id : p) m_current_streaming_ids.insert(id);
+  std::vector<InstanceHandle> switched_out;
+  for (const auto& id : m_current_streaming_ids)
+    if (!next.count(id)) switched_out.push_back(m_registry.find(id));
+  m_current_streaming_ids.swap(next);
+  freeze_last_frames(switched_out);
 }
 
 // =============================================================================
@@ -771,7 +1078,8 @@ void App::render_token_page() {
     ImGui::BeginChild("##ids", ImVec2(-1, 80), true);
     for (size_t i = 0; i < ids.size(); ++i) ImGui::Text("%zu. %s", i + 1, ids[i].c_str());
     ImGui::EndChild();
-    ImGui::Text("Total: %zu, concurrent: %d", ids.size(), m_config.concurrent_streaming);
+    ImGui::Text("Total: %zu, concurrent: %d%s", ids.size(), m_config.concurrent_streaming,
+                m_config.adaptive_concurrency ? " (adaptive)" : "");
   }
   if (!m_error_message.empty()) ImGui::TextColored(ImVec4(1, 0.3f, 0.3f, 1), "%s", m_error_message.c_str());
   bool busy = (m_state == AppState::REQUESTING_TOKEN);
@@ -801,91 +1109,137 @@ void App::render_multi_stream_page(float dt) {
     m_state = AppState::TOKEN_PAGE;
   }
   ImGui::SameLine();
-  int conn = 0;
-  for (const auto& kv : m_instance_states)
-    if (kv.second == InstanceState::Connected) conn++;
-  ImGui::Text("Connected: %d/%zu | Streaming: %zu", conn, m_all_instance_ids.size(), m_current_streaming_ids.size());
+  int conn = m_connected_count.load(std::memory_order_relaxed);
+  ImGui::Text("Connected: %d/%zu | Streaming: %zu/%d", conn, m_all_instance_ids.size(), m_current_streaming_ids.size(),
+              m_concurrency.limit());
   ImGui::SameLine(0, 20);
-  if (ImGui::Button(m_checked_instances.size() == m_all_instance_ids.size() ? "Deselect All" : "Select All")) {
-    if (m_checked_instances.size() == m_all_instance_ids.size())
-      m_checked_instances.clear();
-    else
-      for (const auto& id : m_all_instance_ids) m_checked_instances.insert(id);
+  bool all_checked = m_checked_count == m_all_instance_ids.size();
+  if (ImGui::Button(all_checked ? "Deselect All" : "Select All")) {
+    for (InstanceHandle h : m_all_instance_handles) m_checked[h] = !all_checked;
+    m_checked_count = all_checked ? 0 : m_all_instance_ids.size();
   }
   ImGui::SameLine();
-  ImGui::Text("Sel: %zu", m_checked_instances.size());
+  ImGui::Text("Sel: %zu", m_checked_count);
   ImGui::SameLine(0, 20);
-  if (m_checked_instances.empty()) ImGui::BeginDisabled();
-  if (ImGui::Button("Sync Ops")) open_sync_popup(m_checked_instances);
-  if (m_checked_instances.empty()) ImGui::EndDisabled();
+  if (m_checked_count == 0) ImGui::BeginDisabled();
+  if (ImGui::Button("Sync Ops")) {
+    std::set<std::string> ids;
+    for (size_t i = 0; i < m_all_instance_ids.size(); ++i)
+      if (m_checked[m_all_instance_handles[i]]) ids.insert(m_all_instance_ids[i]);
+    open_sync_popup(ids);
+  }
+  if (m_checked_count == 0) ImGui::EndDisabled();
+  ImGui::SameLine(0, 20);
+  ImGui::SetNextItemWidth(220);
+  bool filter_edited = ImGui::InputTextWithHint("##filter", "Filter ID", m_filter_text, sizeof(m_filter_text));
+  ImGui::SameLine();
+  ImGui::SetNextItemWidth(110);
+  const char* state_items[] = {"All", "Off", "Connecting", "On"};
+  filter_edited |= ImGui::Combo("##state", &m_filter_state, state_items, IM_ARRAYSIZE(state_items));
+  if (filter_edited) m_filter_dirty = true;
   ImGui::End();
 
+  bool filter_changed = refresh_grid_filter();
+
   // Grid
   float gt = 44, gb = io.DisplaySize.y - 28, gh = gb - gt;
   ImGui::SetNextWindowPos(ImVec2(0, gt));
   ImGui::SetNextWindowSize(ImVec2(io.DisplaySize.x, gh));
   ImGui::Begin("##grid", nullptr, ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove);
+  if (filter_edited) ImGui::SetScrollY(0);  // a new result set starts at the top
+  if (filter_changed) {
+    // The visible set changed without scrolling; switch streaming now instead of after the scroll debounce
+    m_scroll_dirty = true;
+    m_debounce_timer = 0.5f;
+  }
 
   int cols = m_grid_columns;
   float sp = 6;
   float aw = ImGui::GetContentRegionAvail().x;
   float cw = (aw - sp * (cols - 1)) / cols;
   float vw = cw - 12, vh = vw * 16.0f / 9.0f, ch = vh + 30;
+  float rh = ch + ImGui::GetStyle().ItemSpacing.y;  // row pitch
+
+  // Renegotiate the sub-stream profile once the tile's physical pixel size settles on another ladder step
+  InstanceHandle hovered = kInvalidInstanceHandle;
+
+  float tile_px = std::min(vw, vh) * io.DisplayFramebufferScale.x;
+  if (m_tcr_session && conn > 0 && m_tile_profile.update(tile_px, dt)) {
+    const TileProfileStep& s = m_tile_profile.current();
+    tcr_session_set_remote_video_profile(static_cast<TcrSessionHandle>(m_tcr_session), s.fps, s.min_bitrate,
+                                         s.max_bitrate, s.short_edge, 0);
+    LOG_INFO("App", "Sub-stream profile -> %dp@%dfps %d-%dkbps (tile %.0fpx, scale %.2f)", s.short_edge, s.fps,
+             s.min_bitrate, s.max_bitrate, tile_px, io.DisplayFramebufferScale.x);
+  }
 
-  for (size_t i = 0; i < m_all_instance_ids.size(); ++i) {
-    if (i > 0 && (i % cols) != 0) ImGui::SameLine(0, sp);
-
-    const std::string& id = m_all_instance_ids[i];
-    bool ck = m_checked_instances.count(id) > 0;
-
-    ImGui::PushID((int)i);
-    ImGui::BeginGroup();
-
-    ImVec2 c0 = ImGui::GetCursorScreenPos();
-    ImGui::GetWindowDrawList()->AddRect(c0, ImVec2(c0.x + cw, c0.y + ch), IM_COL32(60, 60, 60, 255));
-
-    VideoRenderer* r = m_instance_renderers.count(id) ? m_instance_renderers[id] : nullptr;
-    if (r && r->has_frame()) {
-      float tw = (float)r->texture_width(), th = (float)r->texture_height();
-      float sc = std::min(vw / tw, vh / th);
-      ImVec2 isz(tw * sc, th * sc);
-      float px = (vw - isz.x) * 0.5f, py = (vh - isz.y) * 0.5f;
-      ImGui::SetCursorScreenPos(ImVec2(c0.x + 6 + px, c0.y + py));
-      ImGui::Image((ImTextureID)(intptr_t)r->get_texture_id(), isz, ImVec2(0, 1), ImVec2(1, 0));
-      if (ImGui::IsItemClicked(0)) open_instance_popup(id);
-    } else {
-      ImGui::GetWindowDrawList()->AddRectFilled(ImVec2(c0.x + 1, c0.y + 1), ImVec2(c0.x + vw, c0.y + vh),
-                                                IM_COL32(30, 30, 30, 255));
-    }
-
-    ImGui::SetCursorScreenPos(ImVec2(c0.x + 4, c0.y + vh + 2));
-
-    InstanceState st = InstanceState::Offline;
-    auto sit = m_instance_states.find(id);
-    if (sit != m_instance_states.end()) st = sit->second;
-    const char* lb[] = {"Off", "...", "On"};
-    ImVec4 cl[] = {ImVec4(1, .3f, .3f, 1), ImVec4(1, 1, .3f, 1), ImVec4(.3f, 1, .3f, 1)};
-
-    ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(1, 1));
-    bool c = ck;
-    if (ImGui::Checkbox("##cb", &c)) {
-      if (c)
-        m_checked_instances.insert(id);
-      else
-        m_checked_instances.erase(id);
+  // Only rows intersecting the viewport are laid out; the clipper fakes the height of the rest
+  size_t count = m_grid_rows.size();
+  int rows = (int)((count + cols - 1) / cols);
+  ImGuiListClipper clipper;
+  clipper.Begin(rows, rh);
+  while (clipper.Step()) {
+    for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+      size_t first = (size_t)row * cols, last = std::min(first + cols, count);
+      for (size_t i = first; i < last; ++i) {
+        if (i > first) ImGui::SameLine(0, sp);
+
+        const std::string& id = m_all_instance_ids[m_grid_rows[i]];
+        InstanceHandle h = m_all_instance_handles[m_grid_rows[i]];
+        bool ck = m_checked[h] != 0;
+
+        ImGui::PushID(h);
+        ImGui::BeginGroup();
+
+        ImVec2 c0 = ImGui::GetCursorScreenPos();
+        ImGui::GetWindowDrawList()->AddRect(c0, ImVec2(c0.x + cw, c0.y + ch), IM_COL32(60, 60, 60, 255));
+        if (ImGui::IsWindowHovered() && ImGui::IsMouseHoveringRect(c0, ImVec2(c0.x + cw, c0.y + ch))) hovered = h;
+
+        VideoRenderer* r = m_instance_renderers[h];
+        if (r && r->has_frame()) {
+          float tw = (float)r->texture_width(), th = (float)r->texture_height();
+          float sc = std::min(vw / tw, vh / th);
+          ImVec2 isz(tw * sc, th * sc);
+          float px = (vw - isz.x) * 0.5f, py = (vh - isz.y) * 0.5f;
+          ImGui::SetCursorScreenPos(ImVec2(c0.x + 6 + px, c0.y + py));
+          ImGui::Image((ImTextureID)(intptr_t)r->get_texture_id(), isz, ImVec2(0, 1), ImVec2(1, 0));
+          if (ImGui::IsItemClicked(0)) open_instance_popup(id);
+        } else {
+          ImGui::GetWindowDrawList()->AddRectFilled(ImVec2(c0.x + 1, c0.y + 1), ImVec2(c0.x + vw, c0.y + vh),
+                                                    IM_COL32(30, 30, 30, 255));
+        }
+
+        ImGui::SetCursorScreenPos(ImVec2(c0.x + 4, c0.y + vh + 2));
+
+        InstanceState st = m_instance_states[h];
+        const char* lb[] = {"Off", "...", "On"};
+        ImVec4 cl[] = {ImVec4(1, .3f, .3f, 1), ImVec4(1, 1, .3f, 1), ImVec4(.3f, 1, .3f, 1)};
+
+        ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(1, 1));
+        bool c = ck;
+        if (ImGui::Checkbox("##cb", &c)) {
+          m_checked[h] = c;
+          if (c)
+            m_checked_count++;
+          else
+            m_checked_count--;
+        }
+        ImGui::PopStyleVar();
+        ImGui::SameLine();
+        ImGui::TextColored(cl[(int)st], "%s", lb[(int)st]);
+        ImGui::SameLine();
+        std::string sid = id.size() > 16 ? "..." + id.substr(id.size() - 13) : id;
+        ImGui::TextColored(ImVec4(.5f, .5f, .5f, 1), "%s", sid.c_str());
+
+        ImGui::SetCursorScreenPos(ImVec2(c0.x, c0.y + ch));
+        ImGui::Dummy(ImVec2(cw, 0));
+        ImGui::EndGroup();
+        ImGui::PopID();
+      }
     }
-    ImGui::PopStyleVar();
-    ImGui::SameLine();
-    ImGui::TextColored(cl[(int)st], "%s", lb[(int)st]);
-    ImGui::SameLine();
-    std::string sid = id.size() > 16 ? "..." + id.substr(id.size() - 13) : id;
-    ImGui::TextColored(ImVec4(.5f, .5f, .5f, 1), "%s", sid.c_str());
-
-    ImGui::SetCursorScreenPos(ImVec2(c0.x, c0.y + ch));
-    ImGui::Dummy(ImVec2(cw, 0));
-    ImGui::EndGroup();
-    ImGui::PopID();
   }
+  clipper.End();
+
+  m_hovered = hovered;
 
   // Scroll debounce
   float cs = ImGui::GetScrollY();
@@ -897,15 +1251,12 @@ void App::render_multi_stream_page(float dt) {
   if (m_scroll_dirty) {
     m_debounce_timer += dt;
     if (m_debounce_timer >= 0.5f) {
-      auto vis = calculate_visible_instances(cs, gh, ch);
-      std::set<std::string> vs(vis.begin(), vis.end());
-      if (vs != m_current_streaming_ids && !vis.empty()) switch_streaming_instances(vis);
+      set_visible_instances(calculate_visible_instances(cs, gh, rh));
       m_scroll_dirty = false;
     }
   }
-  if (m_current_streaming_ids.empty() && !m_all_instance_ids.empty()) {
-    auto vis = calculate_visible_instances(0, gh, ch);
-    if (!vis.empty()) switch_streaming_instances(vis);
+  if (m_current_streaming_ids.empty() && !m_grid_rows.empty()) {
+    set_visible_instances(calculate_visible_instances(0, gh, rh));
   }
   ImGui::End();
 
@@ -915,8 +1266,9 @@ void App::render_multi_stream_page(float dt) {
   ImGui::Begin(
       "##st", nullptr,
       ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoScrollbar);
-  ImGui::Text("Instances: %zu | Connected: %d | Streaming: %zu | Selected: %zu | Popups: %zu",
-              m_all_instance_ids.size(), conn, m_current_streaming_ids.size(), m_checked_instances.size(),
-              m_popups.size());
+  ImGui::Text(
+      "Instances: %zu | Shown: %zu | Connected: %d | Streaming: %zu | Selected: %zu | Popups: %zu | Upload: %.1f MB/s",
+      m_all_instance_ids.size(), m_grid_rows.size(), conn, m_current_streaming_ids.size(), m_checked_count,
+      m_popups.size(), m_upload_rate / (1024.0 * 1024.0));
   ImGui::End();
 }
@@ -9,10 +9,18 @@
 #include <mutex>
 #include <set>
 #include <string>
+#include <thread>
 #include <vector>
 
+#include "concurrency_controller.h"
 #include "config.h"
+#include "frame_freeze_cache.h"
 #include "frame_queue.h"
+#include "http_client.h"
+#include "instance_registry.h"
+#include "instance_search_index.h"
+#include "tile_profile.h"
+#include "token_cache.h"
 #include "video_renderer.h"
 
 struct SDL_Window;
@@ -65,6 +73,10 @@ class App {
   bool init(SDL_Window* window, SDL_GLContext gl_context);
 #endif
 
+  // Loads the config and starts the startup steps that do not need a window (SDK prepare, token prefetch),
+  // so they overlap with window and renderer creation. Call right after SDL_Init.
+  void preload();
+
   void update(float delta_time);
   void process_event(const SDL_Event& event);
   bool should_quit() const { return m_quit; }
@@ -85,6 +97,13 @@ class App {
   // --- Token ---
   std::string m_token;
   std::string m_access_info;
+  int64_t m_token_expires_at = 0;  // Unix seconds
+  bool m_token_from_cache = false;
+  TokenCache m_token_cache;
+  HttpClient m_http;  // 回调在 update() 中由主线程派发
+  HttpClient::RequestId m_token_request = 0;
+  std::thread m_prepare_thread;                // tcr_client_prepare, joined before tcr_client_init
+  std::atomic<bool> m_token_rejected{false};  // session closed before connecting with a cached token
 
   // --- TcrSDK (multi-stream session) ---
   void* m_tcr_client = nullptr;
@@ -95,17 +114,57 @@ class App {
   char m_video_frame_observer_storage[64] = {};
 
   // --- Multi-instance ---
+  // Ids are interned once; per-frame/per-event state below is indexed by handle and sized to m_registry.size()
+  InstanceRegistry m_registry;
   std::vector<std::string> m_all_instance_ids;
-  std::map<std::string, InstanceState> m_instance_states;
+  std::vector<InstanceHandle> m_all_instance_handles;  // parallel to m_all_instance_ids
+  std::vector<InstanceState> m_instance_states;
+  std::atomic<int> m_connected_count{0};  // kept in step with m_instance_states, read by the grid every frame
+  std::atomic<uint32_t> m_state_epoch{0};  // bumped whenever m_instance_states changes
   std::set<std::string> m_current_streaming_ids;
+  std::vector<std::string> m_visible_ids;  // last visible set, re-applied when the concurrency limit changes
   std::string m_client_stats;
 
+  // --- Adaptive concurrency ---
+  ConcurrencyController m_concurrency;
+
+  // --- Sub-stream profile driven by on-screen tile size ---
+  TileProfileLadder m_tile_profile;
+
+  // --- Grid filter: rows of m_all_instance_ids matching the ID filter and state filter ---
+  InstanceSearchIndex m_search_index;  // row = index into m_all_instance_ids
+  std::vector<int> m_grid_rows;        // rows shown in the grid, ascending
+  char m_filter_text[64] = {};
+  int m_filter_state = 0;  // 0 = all, otherwise InstanceState + 1
+  uint32_t m_indexed_state_epoch = 0;
+  bool m_filter_dirty = true;
+
   // --- Checkboxes ---
-  std::set<std::string> m_checked_instances;
+  std::vector<char> m_checked;  // handle -> checked
+  size_t m_checked_count = 0;
 
   // --- Per-instance renderers (multi-stream grid) ---
-  std::map<std::string, VideoRenderer*> m_instance_renderers;
+  std::vector<VideoRenderer*> m_instance_renderers;  // handle -> renderer, created on first frame
   MultiFrameCache m_multi_frame_cache;
+  std::vector<std::pair<InstanceHandle, VideoFrame>> m_incoming_frames;  // reused by batch_render_frames
+  std::atomic<uint64_t> m_frame_lookup_ns{0};  // id -> handle lookup time in the frame callback
+  std::atomic<uint32_t> m_frame_lookup_count{0};
+
+  // --- Render-rate decimation (hovered/selected tiles upload every frame, others at background_tile_fps) ---
+  std::vector<VideoFrame> m_deferred_frames;      // handle -> newest frame not yet uploaded
+  std::vector<InstanceHandle> m_deferred_handles;  // handles holding a deferred frame
+  std::vector<Uint32> m_last_upload_ms;            // handle -> last upload tick
+  InstanceHandle m_hovered = kInvalidInstanceHandle;
+  uint64_t m_offered_bytes = 0;   // bytes the grid would upload without decimation
+  uint64_t m_uploaded_bytes = 0;  // bytes actually uploaded
+  int m_offered_frames = 0;
+  int m_uploaded_frames = 0;
+  float m_upload_stats_timer = 0;
+  double m_upload_rate = 0;  // uploaded bytes/s over the last report window
+
+  // --- Freeze cache: switched-out tiles show a downscaled copy of their last frame ---
+  std::vector<VideoFrame> m_last_frames;  // handle -> last uploaded frame of a streaming instance
+  FrameFreezeCache m_freeze_cache;
 
   // --- Scroll ---
   float m_prev_scroll_y = 0;
@@ -129,6 +188,9 @@ class App {
 
   // === Token ===
   void request_token();
+  void send_token_request();
+  std::string token_cache_key() const;
+  void drop_token();
 
   // === Multi-Stream ===
   void start_multi_streaming();
@@ -136,10 +198,17 @@ class App {
   void access_all_instances();
   void close_session();
 
-  void batch_render_frames();
+  void batch_render_frames(float delta_time);
+  void freeze_last_frames(const std::vector<InstanceHandle>& handles);
+  void apply_frozen_frames();
+  void rebuild_search_index();
+  bool refresh_grid_filter();
   std::vector<std::string> calculate_visible_instances(float scroll_y, float view_height, float cell_height);
-  void switch_streaming_instances(const std::vector<std::string>& ids);
-  VideoRenderer* get_or_create_renderer(const std::string& instance_id);
+  // Remember the visible set (re-applied when the concurrency limit changes) and stream its first limit() ids
+  void set_visible_instances(const std::vector<std::string>& ids);
+  // Switch streaming to the first limit() ids; no-op when that set is already streaming
+  void apply_visible(const std::vector<std::string>& ids);
+  VideoRenderer* get_or_create_renderer(InstanceHandle handle);
 
   // === UI ===
   void render_token_page();
@@ -0,0 +1,149 @@
+#include "concurrency_controller.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <nlohmann/json.hpp>
+#include <vector>
+
+#include "logger.h"
+
+void ConcurrencyController::reset(const ConcurrencyPolicy& policy, int initial) {
+  m_policy = policy;
+  if (m_policy.min_streams < 1) m_policy.min_streams = 1;
+  if (m_policy.max_streams < m_policy.min_streams) m_policy.max_streams = m_policy.min_streams;
+  m_limit = std::max(m_policy.min_streams, std::min(initial, m_policy.max_streams));
+  m_since_change = 0;
+  m_cpu_timer = 0;
+  m_cpu = -1;
+  m_cpu_sampler.sample();  // 建立基准
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_smoothing = m_policy.smoothing;
+  m_stats_enabled.store(m_policy.enabled, std::memory_order_relaxed);
+  m_prev_counters.clear();
+  m_fps = 0;
+  m_drop_ratio = 0;
+  m_decode_lag = 0;
+  m_has_stats = false;
+  m_fresh_stats = false;
+
+  LOG_INFO("Concurrency", "Reset: limit=%d bounds=[%d, %d] adaptive=%s", m_limit, m_policy.min_streams,
+           m_policy.max_streams, m_policy.enabled ? "on" : "off");
+}
+
+void ConcurrencyController::on_client_stats(const char* json) {
+  if (!json || !m_stats_enabled.load(std::memory_order_relaxed)) return;
+  nlohmann::json j = nlohmann::json::parse(json, nullptr, false);
+  if (j.is_discarded() || !j.is_object()) return;
+
+  // 多流场景下每路统计位于 video_streams.<instance_id>，否则使用顶层字段
+  std::vector<std::pair<std::string, const nlohmann::json*>> streams;
+  auto vs = j.find("video_streams");
+  if (vs != j.end() && vs->is_object()) {
+    for (auto it = vs->begin(); it != vs->end(); ++it)
+      if (it.value().is_object()) streams.emplace_back(it.key(), &it.value());
+  } else {
+    streams.emplace_back(std::string(), &j);
+  }
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  std::map<std::string, StreamCounters> current;
+  double d_recv = 0, d_decode = 0, d_drop = 0, fps_sum = 0;
+  int fps_count = 0;
+  try {
+    for (const auto& s : streams) {
+      const nlohmann::json& o = *s.second;
+      StreamCounters c;
+      c.frame_recv = o.value("frame_recv", 0.0);
+      c.frame_decode = o.value("frame_decode", 0.0);
+      c.frame_drop = o.value("frame_drop", 0.0);
+      double fps = o.value("fps", 0.0);
+      if (fps > 0) {
+        fps_sum += fps;
+        fps_count++;
+      }
+
+      // 计数器为累计值；新出现或被重置的流只记录基准，不参与本轮计算
+      auto prev = m_prev_counters.find(s.first);
+      if (prev != m_prev_counters.end() && c.frame_recv >= prev->second.frame_recv) {
+        d_recv += c.frame_recv - prev->second.frame_recv;
+        d_decode += std::max(0.0, c.frame_decode - prev->second.frame_decode);
+        d_drop += std::max(0.0, c.frame_drop - prev->second.frame_drop);
+      }
+      current[s.first] = c;
+    }
+  } catch (const std::exception& e) {
+    LOG_WARN("Concurrency", "Unexpected client stats format: %s", e.what());
+    return;
+  }
+  m_prev_counters.swap(current);
+
+  if (d_recv <= 0) return;
+
+  double fps = fps_count > 0 ? fps_sum / fps_count : 0;
+  double drop = std::min(1.0, d_drop / d_recv);
+  double lag = std::max(0.0, std::min(1.0, (d_recv - d_decode) / d_recv));
+  double a = m_smoothing;
+  if (!m_has_stats) {
+    m_fps = fps;
+    m_drop_ratio = drop;
+    m_decode_lag = lag;
+    m_has_stats = true;
+  } else {
+    m_fps += a * (fps - m_fps);
+    m_drop_ratio += a * (drop - m_drop_ratio);
+    m_decode_lag += a * (lag - m_decode_lag);
+  }
+  m_fresh_stats = true;
+}
+
+bool ConcurrencyController::tick(float dt) {
+  if (!m_policy.enabled) return false;
+  m_since_change += dt;
+  m_cpu_timer += dt;
+  if (m_cpu_timer >= 1.0f) {
+    m_cpu_timer = 0;
+    double c = m_cpu_sampler.sample();
+    if (c >= 0) m_cpu = m_cpu < 0 ? c : m_cpu + m_policy.smoothing * (c - m_cpu);
+  }
+
+  double fps, drop, lag;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_fresh_stats) return false;
+    m_fresh_stats = false;
+    fps = m_fps;
+    drop = m_drop_ratio;
+    lag = m_decode_lag;
+  }
+
+  char reason[96] = {};
+  bool overload = true;
+  if (m_cpu > m_policy.cpu_high)
+    snprintf(reason, sizeof(reason), "cpu %.0f%% > %.0f%%", m_cpu * 100, m_policy.cpu_high * 100);
+  else if (drop > m_policy.drop_high)
+    snprintf(reason, sizeof(reason), "frame drop %.1f%% > %.1f%%", drop * 100, m_policy.drop_high * 100);
+  else if (lag > m_policy.decode_lag_high)
+    snprintf(reason, sizeof(reason), "decode lag %.1f%% > %.1f%%", lag * 100, m_policy.decode_lag_high * 100);
+  else
+    overload = false;
+
+  int next = m_limit;
+  if (overload) {
+    if (m_limit <= m_policy.min_streams || m_since_change < m_policy.shrink_cooldown_sec) return false;
+    next = std::max(m_policy.min_streams, m_limit - std::max(1, m_limit / 4));
+  } else {
+    // 没有 CPU 样本（采样失败或尚未采到）时不扩张
+    bool headroom = m_cpu >= 0 && m_cpu < m_policy.cpu_low && drop < m_policy.drop_high * 0.5 &&
+                    lag < m_policy.decode_lag_high * 0.5;
+    if (!headroom || m_limit >= m_policy.max_streams || m_since_change < m_policy.grow_cooldown_sec) return false;
+    next = m_limit + 1;
+    snprintf(reason, sizeof(reason), "headroom");
+  }
+
+  LOG_INFO("Concurrency", "%s %d -> %d: %s (fps=%.1f drop=%.1f%% lag=%.1f%% cpu=%.0f%%)",
+           overload ? "Shrink" : "Grow", m_limit, next, reason, fps, drop * 100, lag * 100, m_cpu * 100);
+  m_limit = next;
+  m_since_change = 0;
+  return true;
+}
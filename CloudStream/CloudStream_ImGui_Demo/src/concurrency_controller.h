@@ -0,0 +1,67 @@
+#pragma once
+
+// concurrency_controller.h - 自适应并发拉流控制器
+// 根据 TCR_SESSION_EVENT_CLIENT_STATS（帧率、丢帧、解码进度）和本机 CPU 占用率，
+// 在 [min_streams, max_streams] 范围内动态调整同时拉流的实例数：
+// 过载时按比例收缩，持续空闲时逐个扩张（AIMD），两次调整之间有冷却时间
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "cpu_usage.h"
+
+struct ConcurrencyPolicy {
+  bool enabled = true;
+  int min_streams = 1;
+  int max_streams = 4;
+  double cpu_high = 0.85;           // CPU 占用率高于该值视为过载
+  double cpu_low = 0.60;            // CPU 占用率低于该值才允许扩张
+  double drop_high = 0.05;          // 丢帧率高于该值视为过载
+  double decode_lag_high = 0.10;    // 已接收但未解码的帧比例高于该值视为解码跟不上
+  float shrink_cooldown_sec = 3.0f; // 上次调整后至少间隔多久才能收缩
+  float grow_cooldown_sec = 10.0f;  // 上次调整后至少间隔多久才能扩张
+  double smoothing = 0.3;           // EWMA 平滑系数，越大越灵敏
+};
+
+class ConcurrencyController {
+ public:
+  // 会话创建时调用：设置策略和初始并发数（会被夹在 [min, max] 内）
+  void reset(const ConcurrencyPolicy& policy, int initial);
+
+  // 由 SDK 线程调用：解析客户端统计 JSON，累加平滑后的样本
+  void on_client_stats(const char* json);
+
+  // 由主线程每帧调用，返回 true 表示 limit() 发生变化，需要重新切换拉流实例
+  bool tick(float dt);
+
+  // 当前允许同时拉流的实例数
+  int limit() const { return m_limit; }
+
+ private:
+  struct StreamCounters {
+    double frame_recv = 0;
+    double frame_decode = 0;
+    double frame_drop = 0;
+  };
+
+  ConcurrencyPolicy m_policy;  // 主线程读写；SDK 线程只用下面的 m_stats_enabled 和 m_smoothing
+  int m_limit = 1;
+  float m_since_change = 0;
+  float m_cpu_timer = 0;
+  CpuUsageSampler m_cpu_sampler;
+  double m_cpu = -1;  // 平滑后的 CPU 占用率，<0 表示尚无数据
+
+  std::atomic<bool> m_stats_enabled{false};
+
+  // 以下字段由 SDK 线程写入，受 m_mutex 保护
+  std::mutex m_mutex;
+  double m_smoothing = 0.3;
+  std::map<std::string, StreamCounters> m_prev_counters;
+  double m_fps = 0;
+  double m_drop_ratio = 0;
+  double m_decode_lag = 0;
+  bool m_has_stats = false;
+  bool m_fresh_stats = false;
+};
@@ -6,6 +6,18 @@
 
 #include "logger.h"
 
+namespace {
+
+Log::Level parse_log_level(const std::string& name, Log::Level fallback) {
+  if (name == "debug") return Log::Level::Debug;
+  if (name == "info") return Log::Level::Info;
+  if (name == "warning" || name == "warn") return Log::Level::Warning;
+  if (name == "error") return Log::Level::Error;
+  return fallback;
+}
+
+}  // namespace
+
 bool AppConfig::load(const std::string& config_path) {
   std::ifstream file(config_path);
   if (!file.is_open()) {
@@ -26,6 +38,11 @@ bool AppConfig::load(const std::string& config_path) {
     if (j.contains("instanceIds") && j["instanceIds"].is_string()) {
       instance_ids = j["instanceIds"].get<std::string>();
     }
+    if (j.contains("tokenTtlHours") && j["tokenTtlHours"].is_number_integer()) {
+      token_ttl_hours = j["tokenTtlHours"].get<int>();
+    }
+    token_cache = j.value("tokenCache", token_cache);
+    auto_connect = j.value("autoConnect", auto_connect);
     if (j.contains("videoProfile") && j["videoProfile"].is_object()) {
       auto& vp = j["videoProfile"];
       if (vp.contains("width")) video_width = vp["width"].get<int>();
@@ -37,6 +54,25 @@ bool AppConfig::load(const std::string& config_path) {
     if (j.contains("concurrentStreaming") && j["concurrentStreaming"].is_number_integer()) {
       concurrent_streaming = j["concurrentStreaming"].get<int>();
     }
+    if (j.contains("backgroundTileFps") && j["backgroundTileFps"].is_number_integer()) {
+      background_tile_fps = j["backgroundTileFps"].get<int>();
+    }
+    if (j.contains("adaptiveConcurrency") && j["adaptiveConcurrency"].is_object()) {
+      auto& ac = j["adaptiveConcurrency"];
+      adaptive_concurrency = ac.value("enabled", adaptive_concurrency);
+      concurrent_streaming_min = ac.value("min", concurrent_streaming_min);
+      concurrent_streaming_max = ac.value("max", concurrent_streaming_max);
+      adaptive_cpu_high = ac.value("cpuHigh", adaptive_cpu_high);
+      adaptive_cpu_low = ac.value("cpuLow", adaptive_cpu_low);
+      adaptive_cooldown_sec = ac.value("cooldownSec", adaptive_cooldown_sec);
+    }
+    if (j.contains("log") && j["log"].is_object()) {
+      auto& lg = j["log"];
+      log_level = parse_log_level(lg.value("level", std::string()), log_level);
+      log_file = lg.value("file", log_file);
+      log_file_max_mb = lg.value("maxFileSizeMb", log_file_max_mb);
+      log_file_backups = lg.value("maxBackupFiles", log_file_backups);
+    }
 
     LOG_INFO("Config", "Loaded config: baseUrl=%s, instanceIds=%s, concurrent=%d", base_url.c_str(),
              instance_ids.c_str(), concurrent_streaming);
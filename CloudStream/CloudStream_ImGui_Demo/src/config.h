@@ -5,11 +5,19 @@
 #include <string>
 #include <vector>
 
+#include "logger.h"
+
 struct AppConfig {
   std::string base_url = "https://test-accelerator-biz-server.cai.crtrcloud.com";
   std::string api_path = "/CreateAndroidInstancesAccessToken";
   std::string instance_ids;  // 逗号分隔的实例 ID
 
+  // 访问令牌有效期（随请求发送 ExpirationDuration），同一组实例在有效期内重启时复用本地缓存的令牌
+  int token_ttl_hours = 12;
+  bool token_cache = true;
+  // 令牌就绪后直接开始拉流，不等待点击 "Create Access Token"
+  bool auto_connect = false;
+
   // 视频流参数
   int video_width = 720;
   int video_fps = 30;
@@ -19,6 +27,23 @@ struct AppConfig {
   // 多实例并发流数
   int concurrent_streaming = 4;
 
+  // 非悬停、非选中宫格的渲染帧率（客户端抽帧，0 表示不抽帧）
+  int background_tile_fps = 5;
+
+  // 自适应并发：根据客户端统计和本机 CPU 负载在 [min, max] 内动态调整并发流数
+  bool adaptive_concurrency = false;
+  int concurrent_streaming_min = 1;
+  int concurrent_streaming_max = 0;  // <= 0 表示使用 concurrent_streaming
+  double adaptive_cpu_high = 0.85;
+  double adaptive_cpu_low = 0.60;
+  float adaptive_cooldown_sec = 3.0f;
+
+  // 日志：运行期级别（低于编译期 LOG_COMPILE_LEVEL 的日志已被去掉），可选的日志文件
+  Log::Level log_level = Log::Level::Info;
+  std::string log_file;  // 为空不写文件；相对路径相对于用户数据目录（SDL_GetPrefPath）
+  int log_file_max_mb = 20;
+  int log_file_backups = 3;
+
   // 从 config.json 加载（在可执行文件同目录下查找）
   bool load(const std::string& config_path);
 
@@ -0,0 +1,67 @@
+#include "cpu_usage.h"
+
+#if defined(_WIN32)
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <windows.h>
+#elif defined(__APPLE__)
+#  include <mach/mach.h>
+#else
+#  include <cstdio>
+#endif
+
+#if defined(_WIN32)
+static uint64_t filetime_to_u64(const FILETIME& ft) {
+  return (static_cast<uint64_t>(ft.dwHighDateTime) << 32) | ft.dwLowDateTime;
+}
+#endif
+
+bool CpuUsageSampler::read_times(uint64_t& idle, uint64_t& total) {
+#if defined(_WIN32)
+  FILETIME idle_ft, kernel_ft, user_ft;
+  if (!GetSystemTimes(&idle_ft, &kernel_ft, &user_ft)) return false;
+  // kernel 时间已包含 idle 时间
+  idle = filetime_to_u64(idle_ft);
+  total = filetime_to_u64(kernel_ft) + filetime_to_u64(user_ft);
+  return true;
+#elif defined(__APPLE__)
+  host_cpu_load_info_data_t info;
+  mach_msg_type_number_t count = HOST_CPU_LOAD_INFO_COUNT;
+  if (host_statistics(mach_host_self(), HOST_CPU_LOAD_INFO, reinterpret_cast<host_info_t>(&info), &count) !=
+      KERN_SUCCESS)
+    return false;
+  idle = info.cpu_ticks[CPU_STATE_IDLE];
+  total = 0;
+  for (int i = 0; i < CPU_STATE_MAX; ++i) total += info.cpu_ticks[i];
+  return true;
+#else
+  FILE* f = fopen("/proc/stat", "r");
+  if (!f) return false;
+  unsigned long long user = 0, nice = 0, sys = 0, idl = 0, iowait = 0, irq = 0, softirq = 0, steal = 0;
+  int n = fscanf(f, "cpu %llu %llu %llu %llu %llu %llu %llu %llu", &user, &nice, &sys, &idl, &iowait, &irq, &softirq,
+                 &steal);
+  fclose(f);
+  if (n < 4) return false;
+  idle = idl + iowait;
+  total = user + nice + sys + idl + iowait + irq + softirq + steal;
+  return true;
+#endif
+}
+
+double CpuUsageSampler::sample() {
+  uint64_t idle = 0, total = 0;
+  if (!read_times(idle, total)) return -1.0;
+
+  double usage = -1.0;
+  if (m_has_prev && total > m_prev_total) {
+    uint64_t d_total = total - m_prev_total;
+    uint64_t d_idle = idle >= m_prev_idle ? idle - m_prev_idle : 0;
+    if (d_idle > d_total) d_idle = d_total;
+    usage = 1.0 - static_cast<double>(d_idle) / static_cast<double>(d_total);
+  }
+  m_prev_idle = idle;
+  m_prev_total = total;
+  m_has_prev = true;
+  return usage;
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+// cpu_usage.h - 整机 CPU 占用率采样（跨平台）
+// Windows: GetSystemTimes
+// macOS: host_statistics(HOST_CPU_LOAD_INFO)
+// Linux: /proc/stat
+
+#include <cstdint>
+
+class CpuUsageSampler {
+ public:
+  // 返回自上次调用以来的整机 CPU 占用率 [0, 1]
+  // 首次调用（尚无基准）或平台不支持时返回 -1
+  double sample();
+
+ private:
+  uint64_t m_prev_idle = 0;
+  uint64_t m_prev_total = 0;
+  bool m_has_prev = false;
+
+  // 读取累计的空闲/总时间片，失败返回 false
+  static bool read_times(uint64_t& idle, uint64_t& total);
+};
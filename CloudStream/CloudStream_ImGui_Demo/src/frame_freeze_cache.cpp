@@ -0,0 +1,124 @@
+#include "frame_freeze_cache.h"
+
+#include <algorithm>
+
+#include "logger.h"
+
+static const int kMaxShortEdge = 160;
+
+// 最近邻缩放一个平面并写入紧凑缓冲
+static void scale_plane(const uint8_t* src, int src_stride, int src_w, int src_h, uint8_t* dst, int dst_w, int dst_h) {
+  for (int y = 0; y < dst_h; ++y) {
+    const uint8_t* row = src + (int64_t)(y * src_h / dst_h) * src_stride;
+    for (int x = 0; x < dst_w; ++x) dst[x] = row[x * src_w / dst_w];
+    dst += dst_w;
+  }
+}
+
+FrameFreezeCache::FrameFreezeCache(size_t byte_budget) : m_byte_budget(byte_budget) {
+  m_worker = std::thread(&FrameFreezeCache::worker_loop, this);
+}
+
+FrameFreezeCache::~FrameFreezeCache() { shutdown(); }
+
+void FrameFreezeCache::shutdown() {
+  {
+    std::lock_guard<std::mutex> lock(m_task_mutex);
+    m_stop = true;
+    m_tasks.clear();
+  }
+  m_task_cv.notify_all();
+  if (m_worker.joinable()) m_worker.join();
+}
+
+void FrameFreezeCache::capture(const std::string& instance_id, VideoFrame&& frame) {
+  if (!frame.valid() || !frame.data_y || !frame.data_u || !frame.data_v) return;
+  {
+    std::lock_guard<std::mutex> lock(m_task_mutex);
+    if (m_stop) return;
+    m_tasks.emplace_back(instance_id, std::move(frame));
+  }
+  m_task_cv.notify_one();
+}
+
+void FrameFreezeCache::worker_loop() {
+  for (;;) {
+    std::pair<std::string, VideoFrame> task;
+    {
+      std::unique_lock<std::mutex> lock(m_task_mutex);
+      m_task_cv.wait(lock, [this] { return m_stop || !m_tasks.empty(); });
+      if (m_stop) return;
+      task = std::move(m_tasks.front());
+      m_tasks.pop_front();
+    }
+
+    const VideoFrame& f = task.second;
+    int short_edge = std::min(f.width, f.height);
+    float scale = short_edge > kMaxShortEdge ? (float)kMaxShortEdge / short_edge : 1.0f;
+    // I420 要求宽高为偶数
+    FrozenFrame out;
+    out.width = std::max(2, (int)(f.width * scale) & ~1);
+    out.height = std::max(2, (int)(f.height * scale) & ~1);
+    int cw = out.width / 2, ch = out.height / 2;
+    out.i420.resize(out.width * out.height + cw * ch * 2);
+    uint8_t* dst = out.i420.data();
+    scale_plane(f.data_y, f.stride_y, f.width, f.height, dst, out.width, out.height);
+    scale_plane(f.data_u, f.stride_u, (f.width + 1) / 2, (f.height + 1) / 2, dst + out.width * out.height, cw, ch);
+    scale_plane(f.data_v, f.stride_v, (f.width + 1) / 2, (f.height + 1) / 2,
+                dst + out.width * out.height + cw * ch, cw, ch);
+    task.second = VideoFrame();  // 尽早释放 SDK 帧
+
+    store(task.first, std::move(out));
+  }
+}
+
+void FrameFreezeCache::store(const std::string& id, FrozenFrame&& frame) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_entries.find(id);
+  if (it != m_entries.end()) {
+    m_bytes -= it->second.frame.i420.size();
+    m_lru.erase(it->second.lru_it);
+    m_entries.erase(it);
+  }
+  m_bytes += frame.i420.size();
+  Entry& e = m_entries[id];
+  e.frame = std::move(frame);
+  e.lru_it = m_lru.insert(m_lru.end(), id);
+  m_ready.push_back(id);
+
+  size_t evicted = 0;
+  while (m_bytes > m_byte_budget && m_lru.size() > 1) {
+    auto oldest = m_entries.find(m_lru.front());
+    m_bytes -= oldest->second.frame.i420.size();
+    m_evicted.push_back(oldest->first);
+    m_entries.erase(oldest);
+    m_lru.pop_front();
+    evicted++;
+  }
+  if (evicted > 0)
+    LOG_DEBUG("FreezeCache", "Evicted %zu frozen frames, now %zu entries / %zu KB", evicted, m_entries.size(),
+              m_bytes / 1024);
+}
+
+bool FrameFreezeCache::get(const std::string& id, FrozenFrame& out) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_entries.find(id);
+  if (it == m_entries.end()) return false;
+  m_lru.splice(m_lru.end(), m_lru, it->second.lru_it);
+  out = it->second.frame;
+  return true;
+}
+
+std::vector<std::string> FrameFreezeCache::take_ready() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  std::vector<std::string> r;
+  r.swap(m_ready);
+  return r;
+}
+
+std::vector<std::string> FrameFreezeCache::take_evicted() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  std::vector<std::string> r;
+  r.swap(m_evicted);
+  return r;
+}
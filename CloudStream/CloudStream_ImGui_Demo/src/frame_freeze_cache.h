@@ -0,0 +1,71 @@
+#pragma once
+
+// frame_freeze_cache.h - 冻结帧缓存
+// 实例被切出拉流集合时，在后台线程把最后一帧缩小（短边不超过 160）保存为紧凑 I420，
+// 宫格改为显示这张小图直到实时帧恢复；按字节数做 LRU 淘汰，解码线程和主线程都不做缩放
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "frame_queue.h"
+
+struct FrozenFrame {
+  int width = 0;
+  int height = 0;
+  std::vector<uint8_t> i420;  // Y/U/V 三个平面紧密排列
+
+  const uint8_t* y() const { return i420.data(); }
+  const uint8_t* u() const { return i420.data() + width * height; }
+  const uint8_t* v() const { return i420.data() + width * height + (width / 2) * (height / 2); }
+};
+
+class FrameFreezeCache {
+ public:
+  explicit FrameFreezeCache(size_t byte_budget = 16 * 1024 * 1024);
+  ~FrameFreezeCache();
+
+  // 主线程调用：异步保存实例的最后一帧（帧引用在后台处理完后释放）
+  void capture(const std::string& instance_id, VideoFrame&& frame);
+
+  // 复制实例的冻结帧并刷新 LRU 位置，不存在返回 false
+  bool get(const std::string& instance_id, FrozenFrame& out);
+
+  // 主线程轮询：取出自上次调用以来保存完成 / 被淘汰的实例
+  std::vector<std::string> take_ready();
+  std::vector<std::string> take_evicted();
+
+  // 丢弃未处理的任务并停止后台线程（任务持有 SDK 帧引用，需在释放 SDK 前调用）
+  void shutdown();
+
+ private:
+  struct Entry {
+    FrozenFrame frame;
+    std::list<std::string>::iterator lru_it;
+  };
+
+  void worker_loop();
+  void store(const std::string& instance_id, FrozenFrame&& frame);
+
+  size_t m_byte_budget;
+
+  std::mutex m_task_mutex;
+  std::condition_variable m_task_cv;
+  std::deque<std::pair<std::string, VideoFrame>> m_tasks;
+  bool m_stop = false;
+  std::thread m_worker;
+
+  std::mutex m_mutex;
+  std::map<std::string, Entry> m_entries;
+  std::list<std::string> m_lru;  // 最近使用的在末尾
+  size_t m_bytes = 0;
+  std::vector<std::string> m_ready;
+  std::vector<std::string> m_evicted;
+};
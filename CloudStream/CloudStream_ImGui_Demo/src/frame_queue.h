@@ -5,10 +5,12 @@
 // 策略：最新帧覆盖旧帧（丢帧而非延迟）
 
 #include <cstdint>
-#include <map>
 #include <mutex>
 #include <string>
+#include <utility>
+#include <vector>
 
+#include "instance_registry.h"
 #include "tcr_c_api.h"
 
 // 持有一个 TcrVideoFrame 的引用，RAII 自动释放
@@ -122,32 +124,36 @@ class FrameQueue {
   bool m_has_new = false;
 };
 
-// 多实例帧缓存：每个 instance_id 对应一个最新帧
-// 用于多流场景下，解码线程按 instance_id 路由帧到主线程
+// 多实例帧缓存：每个实例句柄对应一个最新帧
+// 用于多流场景下，解码线程按实例句柄路由帧到主线程
 class MultiFrameCache {
  public:
   // 由解码线程调用：缓存指定实例的最新帧
-  void push(const std::string& instance_id, VideoFrame&& frame) {
+  void push(InstanceHandle handle, VideoFrame&& frame) {
     std::lock_guard<std::mutex> lock(m_mutex);
-    m_frames[instance_id] = std::move(frame);
+    if (handle >= (InstanceHandle)m_frames.size()) m_frames.resize(handle + 1);
+    VideoFrame& slot = m_frames[handle];
+    if (!slot.handle) m_pending.push_back(handle);
+    slot = std::move(frame);
   }
 
-  // 由主线程调用：原子地取出所有缓存帧
+  // 由主线程调用：原子地取出所有缓存帧追加到 out
   // 返回后内部缓存为空
-  std::map<std::string, VideoFrame> swap_all() {
+  void swap_all(std::vector<std::pair<InstanceHandle, VideoFrame>>& out) {
     std::lock_guard<std::mutex> lock(m_mutex);
-    std::map<std::string, VideoFrame> result;
-    std::swap(result, m_frames);
-    return result;
+    for (InstanceHandle h : m_pending) out.emplace_back(h, std::move(m_frames[h]));
+    m_pending.clear();
   }
 
   // 清空缓存
   void clear() {
     std::lock_guard<std::mutex> lock(m_mutex);
     m_frames.clear();
+    m_pending.clear();
   }
 
  private:
   std::mutex m_mutex;
-  std::map<std::string, VideoFrame> m_frames;
+  std::vector<VideoFrame> m_frames;       // handle -> 最新帧
+  std::vector<InstanceHandle> m_pending;  // m_frames 中有帧的句柄
 };
@@ -1,105 +1,248 @@
 #include "http_client.h"
 
-#include <array>
-#include <cstdio>
-#include <cstdlib>
-#include <cstring>
-#include <sstream>
+#include <curl/curl.h>
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 #include "logger.h"
 
-#if defined(_WIN32)
-#  define popen _popen
-#  define pclose _pclose
-#endif
-
-// 通过系统 curl 命令执行 HTTP POST（简单可靠，跨平台）
-// 生产环境建议替换为 libcurl 或平台原生网络库
-HttpResponse http_post(const std::string& url, const std::string& json_body) {
-  HttpResponse resp;
-
-  // 构建 curl 命令
-  // -s: 静默模式
-  // -w "\n%{http_code}": 在末尾输出 HTTP 状态码
-  // -H: 设置 Content-Type
-  // -d: POST body
-  // --connect-timeout: 连接超时 10 秒
-  // --max-time: 总超时 30 秒
-  std::string cmd =
-      "curl -s -w \"\\n%{http_code}\" "
-      "--connect-timeout 10 --max-time 30 "
-      "-H \"Content-Type: application/json\" "
-      "-d '";
-
-  // 转义单引号（将 ' 替换为 '\''）
-  for (char c : json_body) {
-    if (c == '\'') {
-      cmd += "'\\''";
-    } else {
-      cmd += c;
+constexpr long HttpClient::kDefaultTimeoutMs;
+constexpr long HttpClient::kConnectTimeoutMs;
+
+namespace {
+
+size_t write_body(char* ptr, size_t size, size_t nmemb, void* userdata) {
+  static_cast<std::string*>(userdata)->append(ptr, size * nmemb);
+  return size * nmemb;
+}
+
+void global_init_once() {
+  static std::once_flag flag;
+  std::call_once(flag, []() { curl_global_init(CURL_GLOBAL_DEFAULT); });
+}
+
+}  // namespace
+
+struct HttpClient::Impl {
+  struct Request {
+    RequestId id = 0;
+    std::string url;
+    std::string body;
+    long timeout_ms = 0;
+  };
+  struct Transfer {
+    RequestId id = 0;
+    std::string response;
+    std::chrono::steady_clock::time_point start;
+  };
+  struct Completed {
+    RequestId id = 0;
+    HttpResponse response;
+  };
+
+  // --- 主线程 ---
+  std::map<RequestId, Callback> callbacks;
+  RequestId next_id = 1;
+
+  // --- 主线程与工作线程共享，受 mtx 保护 ---
+  std::mutex mtx;
+  std::deque<Request> queue;
+  std::vector<RequestId> cancelled;
+  std::vector<Completed> completed;
+  bool stopping = false;
+
+  // --- 仅工作线程 ---
+  CURLM* multi = nullptr;
+  curl_slist* headers = nullptr;
+  std::vector<CURL*> idle;  // 复用的 easy 句柄，保留各自的连接
+  std::unordered_map<CURL*, Transfer> active;
+
+  std::thread worker;
+
+  Impl() {
+    global_init_once();
+    multi = curl_multi_init();
+    headers = curl_slist_append(nullptr, "Content-Type: application/json");
+    worker = std::thread([this]() { run(); });
+  }
+
+  ~Impl() {
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      stopping = true;
     }
+    curl_multi_wakeup(multi);
+    if (worker.joinable()) worker.join();
+    for (auto& kv : active) {
+      curl_multi_remove_handle(multi, kv.first);
+      curl_easy_cleanup(kv.first);
+    }
+    for (CURL* easy : idle) curl_easy_cleanup(easy);
+    curl_multi_cleanup(multi);
+    curl_slist_free_all(headers);
   }
-  cmd += "' '";
-  cmd += url;
-  cmd += "' 2>&1";
 
-  LOG_INFO("HttpClient", "POST %s", url.c_str());
-  LOG_DEBUG("HttpClient", "Body: %s", json_body.c_str());
+  void run() {
+    for (;;) {
+      std::deque<Request> to_start;
+      std::vector<RequestId> to_cancel;
+      {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (stopping) break;
+        to_start.swap(queue);
+        to_cancel.swap(cancelled);
+      }
 
-  // 执行 curl
-  FILE* pipe = popen(cmd.c_str(), "r");
-  if (!pipe) {
-    resp.error = "Failed to execute curl command";
-    LOG_ERROR("HttpClient", "%s", resp.error.c_str());
-    return resp;
-  }
+      // 先启动再取消：同一轮里提交又取消的请求也能被中止
+      for (Request& request : to_start) start(request);
+      for (RequestId id : to_cancel) {
+        auto it = std::find_if(active.begin(), active.end(),
+                               [id](const std::pair<CURL* const, Transfer>& kv) { return kv.second.id == id; });
+        if (it != active.end()) {
+          LOG_INFO("HttpClient", "Request %llu cancelled", (unsigned long long)id);
+          release(it->first);
+        }
+      }
 
-  // 读取输出
-  std::string output;
-  std::array<char, 4096> buf;
-  while (fgets(buf.data(), (int)buf.size(), pipe) != nullptr) {
-    output += buf.data();
+      int running = 0;
+      curl_multi_perform(multi, &running);
+      int left = 0;
+      while (CURLMsg* msg = curl_multi_info_read(multi, &left)) {
+        if (msg->msg == CURLMSG_DONE) finish(msg->easy_handle, msg->data.result);
+      }
+      // 有网络事件、超时或 curl_multi_wakeup() 时返回
+      curl_multi_poll(multi, nullptr, 0, 1000, nullptr);
+    }
   }
 
-  int exit_code = pclose(pipe);
-  if (exit_code != 0) {
-    resp.error = "curl failed with exit code " + std::to_string(exit_code) + ": " + output;
-    LOG_ERROR("HttpClient", "%s", resp.error.c_str());
-    return resp;
+  void start(const Request& request) {
+    CURL* curl = nullptr;
+    if (!idle.empty()) {
+      curl = idle.back();
+      idle.pop_back();
+      curl_easy_reset(curl);  // 保留连接缓存
+    } else {
+      curl = curl_easy_init();
+    }
+    if (!curl) {
+      Completed c;
+      c.id = request.id;
+      c.response.error = "curl_easy_init failed";
+      std::lock_guard<std::mutex> lock(mtx);
+      completed.push_back(std::move(c));
+      return;
+    }
+
+    Transfer& t = active[curl];
+    t.id = request.id;
+    t.response.clear();
+    t.start = std::chrono::steady_clock::now();
+
+    curl_easy_setopt(curl, CURLOPT_URL, request.url.c_str());
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, (long)request.body.size());
+    curl_easy_setopt(curl, CURLOPT_COPYPOSTFIELDS, request.body.c_str());
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_body);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &t.response);
+    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS, kConnectTimeoutMs);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, request.timeout_ms);
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    curl_multi_add_handle(multi, curl);
   }
 
-  // 解析输出：最后一行是 HTTP 状态码
-  size_t last_newline = output.rfind('\n');
-  if (last_newline != std::string::npos && last_newline > 0) {
-    // 找到倒数第二个换行符之前的内容是 body
-    size_t second_last = output.rfind('\n', last_newline - 1);
-    if (second_last != std::string::npos) {
-      resp.body = output.substr(0, second_last);
-      std::string status_str = output.substr(last_newline + 1);
-      // 去除尾部空白
-      while (!status_str.empty() &&
-             (status_str.back() == '\n' || status_str.back() == '\r' || status_str.back() == ' ')) {
-        status_str.pop_back();
-      }
-      resp.status_code = std::atoi(status_str.c_str());
+  void finish(CURL* curl, CURLcode code) {
+    auto it = active.find(curl);
+    if (it == active.end()) return;
+
+    Completed c;
+    c.id = it->second.id;
+    long status = 0;
+    long connects = 0;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
+    curl_easy_getinfo(curl, CURLINFO_NUM_CONNECTS, &connects);
+    if (code == CURLE_OK) {
+      c.response.status_code = (int)status;
+      c.response.body = std::move(it->second.response);
     } else {
-      // body 可能为空，最后一行是状态码
-      std::string status_str = output.substr(last_newline + 1);
-      while (!status_str.empty() &&
-             (status_str.back() == '\n' || status_str.back() == '\r' || status_str.back() == ' ')) {
-        status_str.pop_back();
-      }
-      resp.body = output.substr(0, last_newline);
-      resp.status_code = std::atoi(status_str.c_str());
+      c.response.error = curl_easy_strerror(code);
+    }
+    long long ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() -
+                                                                          it->second.start)
+                       .count();
+    if (code == CURLE_OK) {
+      LOG_INFO("HttpClient", "Response status: %d, body length: %zu, %lld ms (%s connection)", c.response.status_code,
+               c.response.body.size(), ms, connects > 0 ? "new" : "reused");
+      LOG_DEBUG("HttpClient", "Response body: %s", c.response.body.c_str());
+    } else {
+      LOG_ERROR("HttpClient", "Request failed after %lld ms: %s", ms, c.response.error.c_str());
     }
-  } else {
-    // 无换行符 —— 可能全是状态码或全是 body
-    resp.body = output;
-    resp.status_code = 0;
+
+    release(curl);
+    std::lock_guard<std::mutex> lock(mtx);
+    completed.push_back(std::move(c));
+  }
+
+  // 把 easy 句柄移出 multi 放回空闲列表
+  void release(CURL* curl) {
+    curl_multi_remove_handle(multi, curl);
+    active.erase(curl);
+    idle.push_back(curl);
   }
+};
 
-  LOG_INFO("HttpClient", "Response status: %d, body length: %zu", resp.status_code, resp.body.size());
-  LOG_DEBUG("HttpClient", "Response body: %s", resp.body.c_str());
+HttpClient::HttpClient() : m_impl(new Impl()) {}
 
-  return resp;
+HttpClient::~HttpClient() = default;
+
+HttpClient::RequestId HttpClient::post_async(const std::string& url, const std::string& json_body, Callback on_done,
+                                             long timeout_ms) {
+  RequestId id = m_impl->next_id++;
+  m_impl->callbacks[id] = std::move(on_done);
+
+  LOG_INFO("HttpClient", "POST %s", url.c_str());
+  LOG_DEBUG("HttpClient", "Body: %s", json_body.c_str());
+  {
+    std::lock_guard<std::mutex> lock(m_impl->mtx);
+    Impl::Request request;
+    request.id = id;
+    request.url = url;
+    request.body = json_body;
+    request.timeout_ms = timeout_ms;
+    m_impl->queue.push_back(std::move(request));
+  }
+  curl_multi_wakeup(m_impl->multi);
+  return id;
+}
+
+void HttpClient::cancel(RequestId id) {
+  if (m_impl->callbacks.erase(id) == 0) return;
+  {
+    std::lock_guard<std::mutex> lock(m_impl->mtx);
+    m_impl->cancelled.push_back(id);
+  }
+  curl_multi_wakeup(m_impl->multi);
+}
+
+void HttpClient::poll() {
+  std::vector<Impl::Completed> done;
+  {
+    std::lock_guard<std::mutex> lock(m_impl->mtx);
+    if (m_impl->completed.empty()) return;
+    done.swap(m_impl->completed);
+  }
+  for (Impl::Completed& c : done) {
+    auto it = m_impl->callbacks.find(c.id);
+    if (it == m_impl->callbacks.end()) continue;  // 已取消
+    Callback cb = std::move(it->second);
+    m_impl->callbacks.erase(it);
+    if (cb) cb(c.response);
+  }
 }
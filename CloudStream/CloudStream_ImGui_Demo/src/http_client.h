@@ -1,8 +1,11 @@
 #pragma once
 
-// http_client.h - 简易 HTTP POST 客户端（跨平台，无额外依赖）
+// http_client.h - 进程内 HTTP POST 客户端（libcurl multi）
 // 用于调用业务后台 API 获取 Token 和 AccessInfo
 
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include <string>
 
 struct HttpResponse {
@@ -13,8 +16,37 @@ struct HttpResponse {
   bool ok() const { return status_code >= 200 && status_code < 300; }
 };
 
-// 同步 HTTP POST 请求（JSON body）
-// url: 完整 URL (https://host/path)
-// json_body: JSON 字符串
-// 注意：此实现使用系统 curl 命令，兼容 macOS/Linux/Windows (Git Bash)
-HttpResponse http_post(const std::string& url, const std::string& json_body);
+// 异步 HTTP 客户端
+// - 所有请求在一个后台线程的 curl_multi 上执行，easy 句柄复用，同一主机的连接保持复用
+// - 完成回调不在后台线程执行：由主循环每帧调用 poll() 派发，回调里可以直接修改界面状态
+// - 每个请求有连接超时和总超时；cancel() 中止请求且不再回调
+// - 析构时中止全部未完成请求
+class HttpClient {
+ public:
+  using RequestId = uint64_t;
+  using Callback = std::function<void(const HttpResponse&)>;
+
+  static constexpr long kDefaultTimeoutMs = 30000;
+  static constexpr long kConnectTimeoutMs = 10000;
+
+  HttpClient();
+  ~HttpClient();
+
+  HttpClient(const HttpClient&) = delete;
+  HttpClient& operator=(const HttpClient&) = delete;
+
+  // 发起 JSON POST，返回可用于 cancel() 的请求 ID
+  // url: 完整 URL (https://host/path)
+  RequestId post_async(const std::string& url, const std::string& json_body, Callback on_done,
+                       long timeout_ms = kDefaultTimeoutMs);
+
+  // 中止请求；已完成但尚未派发的结果也一并丢弃
+  void cancel(RequestId id);
+
+  // 主循环调用：派发已完成请求的回调
+  void poll();
+
+ private:
+  struct Impl;
+  std::unique_ptr<Impl> m_impl;
+};
@@ -0,0 +1,69 @@
+#include "instance_registry.h"
+
+#include <cstdint>
+#include <cstring>
+
+// FNV-1a
+static size_t hash_id(const char* s, size_t len) {
+  uint64_t h = 14695981039346656037ull;
+  for (size_t i = 0; i < len; ++i) {
+    h ^= (uint8_t)s[i];
+    h *= 1099511628211ull;
+  }
+  return (size_t)h;
+}
+
+InstanceHandle InstanceRegistry::find_locked(const char* id, size_t len, size_t hash) const {
+  if (m_slots.empty()) return kInvalidInstanceHandle;
+  size_t mask = m_slots.size() - 1;
+  for (size_t i = hash & mask;; i = (i + 1) & mask) {
+    InstanceHandle h = m_slots[i];
+    if (h == kInvalidInstanceHandle) return kInvalidInstanceHandle;
+    const std::string& s = m_ids[h];
+    if (m_hashes[h] == hash && s.size() == len && memcmp(s.data(), id, len) == 0) return h;
+  }
+}
+
+void InstanceRegistry::insert_slot(InstanceHandle handle, size_t hash) {
+  size_t mask = m_slots.size() - 1;
+  size_t i = hash & mask;
+  while (m_slots[i] != kInvalidInstanceHandle) i = (i + 1) & mask;
+  m_slots[i] = handle;
+}
+
+InstanceHandle InstanceRegistry::intern(const std::string& id) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  size_t hash = hash_id(id.data(), id.size());
+  InstanceHandle h = find_locked(id.data(), id.size(), hash);
+  if (h != kInvalidInstanceHandle) return h;
+
+  h = (InstanceHandle)m_ids.size();
+  m_ids.push_back(id);
+  m_hashes.push_back(hash);
+  // 负载因子不超过 1/2
+  if (m_ids.size() * 2 > m_slots.size()) {
+    m_slots.assign(m_slots.empty() ? 64 : m_slots.size() * 2, kInvalidInstanceHandle);
+    for (InstanceHandle i = 0; i < (InstanceHandle)m_ids.size(); ++i) insert_slot(i, m_hashes[i]);
+  } else {
+    insert_slot(h, hash);
+  }
+  return h;
+}
+
+InstanceHandle InstanceRegistry::find(const char* id) const {
+  if (!id) return kInvalidInstanceHandle;
+  size_t len = strlen(id);
+  size_t hash = hash_id(id, len);
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return find_locked(id, len, hash);
+}
+
+std::string InstanceRegistry::id_of(InstanceHandle h) const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return h >= 0 && h < (InstanceHandle)m_ids.size() ? m_ids[h] : std::string();
+}
+
+int InstanceRegistry::size() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return (int)m_ids.size();
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+// instance_registry.h - 实例ID驻留表
+// 实例ID只在 API 边界（SDK 回调入口、配置/弹窗）做一次字符串查找，转换为稠密整数句柄；
+// 帧缓存、渲染器、连接状态、勾选状态等逐帧路径都用句柄直接索引 vector。
+// 只增不减，句柄在 App 生命周期内稳定；intern 只在主线程调用，find 可在 SDK 回调线程调用
+
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <vector>
+
+typedef int InstanceHandle;
+static const InstanceHandle kInvalidInstanceHandle = -1;
+
+class InstanceRegistry {
+ public:
+  // 驻留实例ID，已存在时返回原句柄
+  InstanceHandle intern(const std::string& instance_id);
+
+  // 未驻留时返回 kInvalidInstanceHandle；直接接受 SDK 给出的 C 字符串，不构造 std::string
+  InstanceHandle find(const char* instance_id) const;
+  InstanceHandle find(const std::string& instance_id) const { return find(instance_id.c_str()); }
+
+  // 句柄对应的实例ID（返回拷贝，可跨线程使用）
+  std::string id_of(InstanceHandle handle) const;
+
+  // 已驻留的实例数，即有效句柄上界
+  int size() const;
+
+ private:
+  InstanceHandle find_locked(const char* id, size_t len, size_t hash) const;
+  void insert_slot(InstanceHandle handle, size_t hash);
+
+  mutable std::mutex m_mutex;
+  std::vector<std::string> m_ids;       // handle -> id
+  std::vector<size_t> m_hashes;         // handle -> hash，扩容时无需重新计算
+  std::vector<InstanceHandle> m_slots;  // 开放寻址表，容量为 2 的幂，空槽为 kInvalidInstanceHandle
+};
@@ -0,0 +1,185 @@
+#include "instance_search_index.h"
+
+#include <algorithm>
+#include <cctype>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+const int InstanceSearchIndex::kMaxStates;
+const uint32_t InstanceSearchIndex::kAllStates;
+
+namespace {
+
+std::string to_lower(const std::string& s) {
+  std::string r(s);
+  for (char& c : r) c = (char)std::tolower((unsigned char)c);
+  return r;
+}
+
+// 倒排表至少这么长才考虑转为位图，避免行数很少时频繁转换
+const size_t kDenseMinRows = 1024;
+
+int lowest_bit(uint64_t v) {
+#if defined(_MSC_VER)
+  unsigned long i;
+  _BitScanForward64(&i, v);
+  return (int)i;
+#else
+  return __builtin_ctzll(v);
+#endif
+}
+
+}  // namespace
+
+InstanceSearchIndex::GramKey InstanceSearchIndex::gram_key(const char* s, size_t len) {
+  GramKey key = (GramKey)len << 24;
+  for (size_t i = 0; i < len; ++i) key |= (GramKey)(unsigned char)s[i] << (8 * (2 - i));
+  return key;
+}
+
+const InstanceSearchIndex::Postings* InstanceSearchIndex::postings(GramKey key) const {
+  auto it = m_postings.find(key);
+  return it == m_postings.end() ? nullptr : &it->second;
+}
+
+int InstanceSearchIndex::add(const std::string& instance_id, int state) {
+  if (state < 0 || state >= kMaxStates) state = 0;
+  int row = (int)m_texts.size();
+  m_texts.push_back(to_lower(instance_id));
+  m_states.push_back((uint8_t)state);
+
+  size_t words = ((size_t)row >> 6) + 1;
+  if (m_state_bits.size() <= (size_t)state) m_state_bits.resize(state + 1);
+  for (auto& bits : m_state_bits) bits.resize(words, 0);
+  m_state_bits[state][row >> 6] |= 1ull << (row & 63);
+
+  // 每个不同的 1~3 字节子串登记一次，行号递增所以倒排表天然有序
+  const std::string& text = m_texts.back();
+  std::vector<GramKey> grams;
+  grams.reserve(text.size() * 3);
+  for (size_t i = 0; i < text.size(); ++i)
+    for (size_t len = 1; len <= 3 && i + len <= text.size(); ++len) grams.push_back(gram_key(text.data() + i, len));
+  std::sort(grams.begin(), grams.end());
+  grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+  for (GramKey key : grams) {
+    Postings& p = m_postings[key];
+    if (p.dense) {
+      if (p.bits.size() < words) p.bits.resize(words, 0);
+      p.bits[row >> 6] |= 1ull << (row & 63);
+      continue;
+    }
+    p.rows.push_back(row);
+    if (p.rows.size() > kDenseMinRows && p.rows.size() * 32 > (size_t)size()) {
+      p.bits.assign(words, 0);
+      for (int r : p.rows) p.bits[r >> 6] |= 1ull << (r & 63);
+      std::vector<int>().swap(p.rows);
+      p.dense = true;
+    }
+  }
+  return row;
+}
+
+void InstanceSearchIndex::set_state(int row, int state) {
+  if (row < 0 || row >= size() || state < 0 || state >= kMaxStates) return;
+  int old = m_states[row];
+  if (old == state) return;
+  if (m_state_bits.size() <= (size_t)state) m_state_bits.resize(state + 1, std::vector<uint64_t>(m_state_bits[0].size()));
+  m_state_bits[old][row >> 6] &= ~(1ull << (row & 63));
+  m_state_bits[state][row >> 6] |= 1ull << (row & 63);
+  m_states[row] = (uint8_t)state;
+}
+
+void InstanceSearchIndex::clear() {
+  m_texts.clear();
+  m_states.clear();
+  m_state_bits.clear();
+  m_postings.clear();
+}
+
+void InstanceSearchIndex::build_filter(uint32_t state_mask, std::vector<uint64_t>& bits) const {
+  bits.assign(((size_t)size() + 63) >> 6, 0);
+  for (size_t s = 0; s < m_state_bits.size(); ++s) {
+    if (!(state_mask & (1u << s))) continue;
+    const std::vector<uint64_t>& src = m_state_bits[s];
+    for (size_t w = 0; w < bits.size(); ++w) bits[w] |= src[w];
+  }
+}
+
+void InstanceSearchIndex::query(const std::string& text, uint32_t state_mask, bool prefix,
+                                std::vector<int>& out) const {
+  out.clear();
+  if (m_texts.empty()) return;
+
+  std::vector<uint64_t> filter;
+  build_filter(state_mask, filter);
+
+  std::string q = to_lower(text);
+  if (q.empty()) {
+    for (size_t w = 0; w < filter.size(); ++w) {
+      for (uint64_t bits = filter[w]; bits; bits &= bits - 1) out.push_back((int)(w << 6) + lowest_bit(bits));
+    }
+    return;
+  }
+
+  // 查询串的全部 3-gram（短查询只有它本身），任何一个不存在就没有结果
+  std::vector<const Postings*> lists;
+  size_t gram_len = std::min<size_t>(q.size(), 3);
+  for (size_t i = 0; i + gram_len <= q.size(); ++i) {
+    const Postings* p = postings(gram_key(q.data() + i, gram_len));
+    if (!p) return;
+    lists.push_back(p);
+  }
+  std::sort(lists.begin(), lists.end());
+  lists.erase(std::unique(lists.begin(), lists.end()), lists.end());
+
+  // 稠密表直接与状态位图按字相与，稀疏表按长度排序
+  std::vector<const Postings*> sparse;
+  for (const Postings* p : lists) {
+    if (!p->dense) {
+      sparse.push_back(p);
+      continue;
+    }
+    for (size_t w = 0; w < filter.size(); ++w) filter[w] &= w < p->bits.size() ? p->bits[w] : 0;
+  }
+  std::sort(sparse.begin(), sparse.end(),
+            [](const Postings* a, const Postings* b) { return a->rows.size() < b->rows.size(); });
+
+  bool verify = q.size() > 3 || prefix;
+  auto accept = [&](int row) {
+    if (verify) {
+      const std::string& t = m_texts[row];
+      if (prefix ? t.compare(0, q.size(), q) != 0 : t.find(q) == std::string::npos) return;
+    }
+    out.push_back(row);
+  };
+
+  if (sparse.empty()) {
+    for (size_t w = 0; w < filter.size(); ++w) {
+      for (uint64_t bits = filter[w]; bits; bits &= bits - 1) accept((int)(w << 6) + lowest_bit(bits));
+    }
+    return;
+  }
+
+  // 以最短的稀疏表为候选，其余稀疏表单调前移游标求交：
+  // 长度相近的表逐个前移（总代价与表长成正比），长得多的表二分查找
+  size_t shortest = sparse[0]->rows.size();
+  std::vector<std::vector<int>::const_iterator> cursors;
+  for (size_t i = 1; i < sparse.size(); ++i) cursors.push_back(sparse[i]->rows.begin());
+  for (int row : sparse[0]->rows) {
+    if (!(filter[row >> 6] & (1ull << (row & 63)))) continue;
+    bool all = true;
+    for (size_t i = 0; i < cursors.size() && all; ++i) {
+      const std::vector<int>& list = sparse[i + 1]->rows;
+      auto& cur = cursors[i];
+      if (list.size() > shortest * 16) {
+        cur = std::lower_bound(cur, list.end(), row);
+      } else {
+        while (cur != list.end() && *cur < row) ++cur;
+      }
+      all = cur != list.end() && *cur == row;
+    }
+    if (all) accept(row);
+  }
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+// instance_search_index.h - 实例搜索索引
+// 宫格按实例ID过滤时不做逐行线性扫描：
+// - 实例ID（小写）的每个 1~3 字节子串建立倒排表（行号升序），查询不超过 3 个字符时倒排表就是结果，
+//   更长的查询对全部 3-gram 的倒排表求交集后再做一次子串校验
+// - 超过 1/32 行都包含的 n-gram（如共同前缀）改存位图，既省内存，求交也只是按字与
+// - 每个状态一张位图，多个状态取并集后与文本结果求交
+// 行号按 add 的顺序分配；只在主线程访问，不加锁
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class InstanceSearchIndex {
+ public:
+  static const int kMaxStates = 32;
+  static const uint32_t kAllStates = 0xffffffffu;
+
+  // 追加一行，返回行号
+  int add(const std::string& instance_id, int state);
+
+  // 修改行的状态，只更新两张位图中的一位
+  void set_state(int row, int state);
+
+  void clear();
+
+  int size() const { return (int)m_texts.size(); }
+
+  // 实例ID包含 text（忽略大小写；prefix 为 true 时要求以 text 开头）且状态在 state_mask 中的行，按行号升序写入 out
+  void query(const std::string& text, uint32_t state_mask, bool prefix, std::vector<int>& out) const;
+
+ private:
+  typedef uint32_t GramKey;  // 长度(1~3) << 24 | 最多 3 个字节
+
+  // 一个 n-gram 的倒排表：稀疏时是升序行号，稠密后转为行位图（长度可能短于当前行数，缺的字视为 0）
+  struct Postings {
+    std::vector<int> rows;
+    std::vector<uint64_t> bits;
+    bool dense = false;
+  };
+
+  static GramKey gram_key(const char* s, size_t len);
+  const Postings* postings(GramKey key) const;
+  void build_filter(uint32_t state_mask, std::vector<uint64_t>& bits) const;
+
+  std::vector<std::string> m_texts;  // row -> 小写实例ID
+  std::vector<uint8_t> m_states;     // row -> state
+  std::vector<std::vector<uint64_t>> m_state_bits;  // state -> 行位图
+  std::unordered_map<GramKey, Postings> m_postings;
+};
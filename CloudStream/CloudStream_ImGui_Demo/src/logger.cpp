@@ -0,0 +1,399 @@
+#include "logger.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Log {
+
+namespace {
+
+const size_t kQueueCapacity = 8192;  // 2 的幂
+const size_t kInlineSize = 240;      // 不超过该长度的行直接存在槽位里，更长的单独分配
+const size_t kBatchSize = 256;
+const size_t kLineBufferSize = 1024;  // 线程局部格式化缓冲区，超长的行改用可增长的缓冲区
+const int kIdleWaitMs = 100;
+const int kDropReportIntervalMs = 1000;
+
+const char* level_prefix(Level level) {
+  switch (level) {
+    case Level::Debug:
+      return "[DEBUG]";
+    case Level::Info:
+      return "[INFO]";
+    case Level::Warning:
+      return "[WARN]";
+    case Level::Error:
+      return "[ERROR]";
+  }
+  return "";
+}
+
+// 本地时间 "HH:MM:SS"，每个线程按秒缓存，避免每条日志调用 localtime
+const char* time_prefix(time_t sec) {
+  thread_local time_t t_cached_sec = -1;
+  thread_local char t_cached[16] = {};
+  if (sec != t_cached_sec) {
+    t_cached_sec = sec;
+    struct tm tm_buf;
+#if defined(_WIN32)
+    localtime_s(&tm_buf, &sec);
+#else
+    localtime_r(&sec, &tm_buf);
+#endif
+    snprintf(t_cached, sizeof(t_cached), "%02d:%02d:%02d", tm_buf.tm_hour, tm_buf.tm_min, tm_buf.tm_sec);
+  }
+  return t_cached;
+}
+
+// "HH:MM:SS.mmm [LEVEL] [tag] "，返回写入的长度
+int format_prefix(char* buf, size_t size, Level level, const char* tag) {
+  const auto now = std::chrono::system_clock::now();
+  const time_t sec = std::chrono::system_clock::to_time_t(now);
+  const int ms = int(std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count() % 1000);
+  const int n = snprintf(buf, size, "%s.%03d %s [%s] ", time_prefix(sec), ms, level_prefix(level), tag ? tag : "");
+  return n < 0 ? -1 : std::min(n, int(size) - 1);
+}
+
+// 有界多生产者单消费者环形队列 + 后台写入线程
+// 每个槽位带序号：生产者 CAS 抢占写位置，拷贝后发布序号；只有写入线程出队
+class Sink {
+ public:
+  // 不析构：SDK 线程在进程退出过程中仍可能写日志，由 shutdown() 停止写入线程
+  static Sink& instance() {
+    static Sink* sink = new Sink();
+    return *sink;
+  }
+
+  void push(Level level, const char* line, size_t len);
+  bool set_file(const std::string& path, size_t max_bytes, int max_backups);
+  void shutdown();
+  Stats stats() const;
+
+ private:
+  struct Slot {
+    std::atomic<size_t> seq;
+    uint32_t len = 0;
+    char* heap = nullptr;  // len > kInlineSize 时使用
+    char text[kInlineSize];
+  };
+
+  Sink();
+
+  bool try_push(const char* line, size_t len);
+  bool pop(std::string& out);
+  bool empty() const;
+  void wake();
+  void write_direct(const char* line, size_t len);
+
+  void writer_loop();
+  void append_drop_summary(std::string& batch);
+  void write_out(const std::string& batch);
+  bool open_file();  // 以下调用方持有 m_file_mutex
+  void rotate();
+
+  std::unique_ptr<Slot[]> m_slots;
+  std::atomic<size_t> m_head{0};  // 生产者写位置
+  size_t m_tail = 0;              // 读位置，只有写入线程（或 shutdown 中 join 之后）访问
+
+  std::mutex m_wake_mutex;
+  std::condition_variable m_wake_cv;
+  std::atomic<bool> m_writer_idle{false};
+  std::atomic<bool> m_stop{false};
+  std::atomic<bool> m_stopped{false};  // 写入线程已退出，之后的日志直接写出
+  std::mutex m_shutdown_mutex;
+  std::thread m_writer;
+
+  std::mutex m_file_mutex;
+  FILE* m_file = nullptr;
+  std::string m_file_path;
+  size_t m_max_bytes = 0;
+  int m_max_backups = 0;
+  size_t m_file_bytes = 0;
+
+  std::atomic<uint64_t> m_written{0};
+  std::atomic<uint64_t> m_dropped{0};
+  std::atomic<uint64_t> m_blocked{0};
+  uint64_t m_reported_dropped = 0;  // 写入线程已汇总过的丢弃条数
+  std::chrono::steady_clock::time_point m_last_drop_report;
+};
+
+Sink::Sink() : m_slots(new Slot[kQueueCapacity]) {
+  for (size_t i = 0; i < kQueueCapacity; ++i) m_slots[i].seq.store(i, std::memory_order_relaxed);
+  m_writer = std::thread([this]() { writer_loop(); });
+  std::atexit([]() { Sink::instance().shutdown(); });
+}
+
+bool Sink::try_push(const char* line, size_t len) {
+  size_t pos = m_head.load(std::memory_order_relaxed);
+  Slot* slot;
+  for (;;) {
+    slot = &m_slots[pos & (kQueueCapacity - 1)];
+    const size_t seq = slot->seq.load(std::memory_order_acquire);
+    const std::ptrdiff_t diff = std::ptrdiff_t(seq) - std::ptrdiff_t(pos);
+    if (diff == 0) {
+      if (m_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+    } else if (diff < 0) {
+      return false;  // 队列已满
+    } else {
+      pos = m_head.load(std::memory_order_relaxed);
+    }
+  }
+  slot->heap = nullptr;
+  if (len > kInlineSize) {
+    slot->heap = static_cast<char*>(std::malloc(len));
+    if (!slot->heap) len = kInlineSize;  // 分配失败时截断
+  }
+  std::memcpy(slot->heap ? slot->heap : slot->text, line, len);
+  slot->len = uint32_t(len);
+  slot->seq.store(pos + 1, std::memory_order_release);
+  return true;
+}
+
+bool Sink::pop(std::string& out) {
+  Slot& slot = m_slots[m_tail & (kQueueCapacity - 1)];
+  if (slot.seq.load(std::memory_order_acquire) != m_tail + 1) return false;
+  if (slot.heap) {
+    out.append(slot.heap, slot.len);
+    std::free(slot.heap);
+    slot.heap = nullptr;
+  } else {
+    out.append(slot.text, slot.len);
+  }
+  out += '\n';
+  slot.seq.store(m_tail + kQueueCapacity, std::memory_order_release);
+  ++m_tail;
+  return true;
+}
+
+bool Sink::empty() const {
+  return m_slots[m_tail & (kQueueCapacity - 1)].seq.load(std::memory_order_acquire) != m_tail + 1;
+}
+
+void Sink::wake() {
+  std::lock_guard<std::mutex> lock(m_wake_mutex);
+  m_wake_cv.notify_one();
+}
+
+void Sink::write_direct(const char* line, size_t len) {
+  fwrite(line, 1, len, stderr);
+  fputc('\n', stderr);
+  fflush(stderr);
+}
+
+void Sink::push(Level level, const char* line, size_t len) {
+  if (m_stopped.load(std::memory_order_acquire)) {
+    write_direct(line, len);
+    return;
+  }
+  if (!try_push(line, len)) {
+    // 队列满：Debug/Info 直接丢弃（由写入线程汇总），Warning/Error 唤醒写入线程并让出 CPU 直到有空位
+    if (level < Level::Warning) {
+      m_dropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    m_blocked.fetch_add(1, std::memory_order_relaxed);
+    do {
+      if (m_stopped.load(std::memory_order_acquire)) {
+        write_direct(line, len);
+        return;
+      }
+      wake();
+      std::this_thread::yield();
+    } while (!try_push(line, len));
+  }
+
+  // 与写入线程的 m_writer_idle 写入/队列检查配对，保证不会错过唤醒；写入线程忙时不碰互斥锁
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (m_writer_idle.load(std::memory_order_relaxed)) wake();
+}
+
+void Sink::writer_loop() {
+  std::string batch;
+  batch.reserve(64 * 1024);
+  for (;;) {
+    size_t count = 0;
+    while (count < kBatchSize && pop(batch)) ++count;
+    m_written.fetch_add(count, std::memory_order_relaxed);
+    append_drop_summary(batch);
+    if (!batch.empty()) {
+      write_out(batch);
+      batch.clear();
+    }
+    if (count > 0) continue;
+
+    // 队列为空：退出或等待
+    if (m_stop.load(std::memory_order_acquire)) break;
+    std::unique_lock<std::mutex> lock(m_wake_mutex);
+    m_writer_idle.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (empty() && !m_stop.load(std::memory_order_acquire)) {
+      m_wake_cv.wait_for(lock, std::chrono::milliseconds(kIdleWaitMs));
+    }
+    m_writer_idle.store(false, std::memory_order_relaxed);
+  }
+}
+
+// 在写入线程直接追加到本批输出，不经过队列，避免队列满时自己阻塞自己
+void Sink::append_drop_summary(std::string& batch) {
+  const uint64_t dropped = m_dropped.load(std::memory_order_relaxed);
+  if (dropped == m_reported_dropped) return;
+  const auto now = std::chrono::steady_clock::now();
+  if (m_reported_dropped > 0 && now - m_last_drop_report < std::chrono::milliseconds(kDropReportIntervalMs)) return;
+
+  char line[160];
+  const int prefix = std::max(0, format_prefix(line, sizeof(line), Level::Warning, "Log"));
+  const int n = snprintf(line + prefix, sizeof(line) - prefix, "Queue full, %llu messages dropped (%llu in total)\n",
+                         (unsigned long long)(dropped - m_reported_dropped), (unsigned long long)dropped);
+  if (n > 0) batch.append(line, std::min(size_t(prefix + n), sizeof(line) - 1));
+  m_reported_dropped = dropped;
+  m_last_drop_report = now;
+}
+
+void Sink::write_out(const std::string& batch) {
+  // 每批只 flush 一次 stderr
+  fwrite(batch.data(), 1, batch.size(), stderr);
+  fflush(stderr);
+
+  std::lock_guard<std::mutex> lock(m_file_mutex);
+  if (!m_file) return;
+  m_file_bytes += fwrite(batch.data(), 1, batch.size(), m_file);
+  fflush(m_file);
+  if (m_max_bytes > 0 && m_file_bytes >= m_max_bytes) rotate();
+}
+
+bool Sink::set_file(const std::string& path, size_t max_bytes, int max_backups) {
+  std::lock_guard<std::mutex> lock(m_file_mutex);
+  if (m_file) {
+    fclose(m_file);
+    m_file = nullptr;
+  }
+  m_file_path = path;
+  m_max_bytes = max_bytes;
+  m_max_backups = max_backups;
+  return path.empty() || open_file();
+}
+
+bool Sink::open_file() {
+  m_file = fopen(m_file_path.c_str(), "ab");
+  if (!m_file) return false;
+  fseek(m_file, 0, SEEK_END);
+  const long size = ftell(m_file);
+  m_file_bytes = size > 0 ? size_t(size) : 0;
+  return true;
+}
+
+void Sink::rotate() {
+  fclose(m_file);
+  m_file = nullptr;
+  // path.(n-1) -> path.n ... path -> path.1；先删除目标，Windows 上 rename 不覆盖已存在的文件
+  for (int i = m_max_backups - 1; i >= 1; --i) {
+    const std::string from = m_file_path + "." + std::to_string(i);
+    const std::string to = m_file_path + "." + std::to_string(i + 1);
+    std::remove(to.c_str());
+    std::rename(from.c_str(), to.c_str());
+  }
+  if (m_max_backups > 0) {
+    const std::string first = m_file_path + ".1";
+    std::remove(first.c_str());
+    std::rename(m_file_path.c_str(), first.c_str());
+  } else {
+    std::remove(m_file_path.c_str());
+  }
+  open_file();
+}
+
+void Sink::shutdown() {
+  std::lock_guard<std::mutex> guard(m_shutdown_mutex);
+  if (!m_writer.joinable()) return;
+  {
+    std::lock_guard<std::mutex> lock(m_wake_mutex);
+    m_stop.store(true, std::memory_order_release);
+    m_wake_cv.notify_all();
+  }
+  m_writer.join();
+  m_stopped.store(true, std::memory_order_release);
+
+  // 写入线程退出前后入队的剩余日志
+  std::string batch;
+  uint64_t count = 0;
+  while (pop(batch)) ++count;
+  m_written.fetch_add(count, std::memory_order_relaxed);
+  const Stats s = stats();
+  char line[160];
+  const int prefix = std::max(0, format_prefix(line, sizeof(line), Level::Info, "Log"));
+  const int n = snprintf(line + prefix, sizeof(line) - prefix, "%llu lines written, %llu dropped, %llu blocked waits\n",
+                         (unsigned long long)s.written, (unsigned long long)s.dropped, (unsigned long long)s.blocked);
+  if (n > 0) batch.append(line, std::min(size_t(prefix + n), sizeof(line) - 1));
+  write_out(batch);
+
+  std::lock_guard<std::mutex> lock(m_file_mutex);
+  if (m_file) {
+    fclose(m_file);
+    m_file = nullptr;
+  }
+}
+
+Stats Sink::stats() const {
+  Stats s;
+  s.written = m_written.load(std::memory_order_relaxed);
+  s.dropped = m_dropped.load(std::memory_order_relaxed);
+  s.blocked = m_blocked.load(std::memory_order_relaxed);
+  return s;
+}
+
+}  // namespace
+
+void log(Level level, const char* tag, const char* fmt, ...) {
+  if (!enabled(level)) return;
+
+  // 在线程局部缓冲区里格式化 "HH:MM:SS.mmm [LEVEL] [tag] message"
+  thread_local char t_buffer[kLineBufferSize];
+  thread_local std::vector<char> t_large;
+  const int prefix = format_prefix(t_buffer, sizeof(t_buffer), level, tag);
+  if (prefix < 0) return;
+
+  va_list args;
+  va_start(args, fmt);
+  va_list args_copy;
+  va_copy(args_copy, args);
+  const int body = vsnprintf(t_buffer + prefix, sizeof(t_buffer) - prefix, fmt, args);
+  va_end(args);
+  if (body < 0) {
+    va_end(args_copy);
+    return;
+  }
+
+  const char* line = t_buffer;
+  size_t len = size_t(prefix) + size_t(body);
+  if (len >= sizeof(t_buffer)) {
+    t_large.resize(len + 1);
+    std::memcpy(t_large.data(), t_buffer, size_t(prefix));
+    vsnprintf(t_large.data() + prefix, size_t(body) + 1, fmt, args_copy);
+    line = t_large.data();
+  }
+  va_end(args_copy);
+
+  // 去掉消息末尾的换行（SDK 日志常带 \n），每条日志由写入线程补一个
+  while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r')) --len;
+  Sink::instance().push(level, line, len);
+}
+
+bool set_file(const std::string& path, size_t max_bytes, int max_backups) {
+  return Sink::instance().set_file(path, max_bytes, max_backups);
+}
+
+void shutdown() { Sink::instance().shutdown(); }
+
+Stats stats() { return Sink::instance().stats(); }
+
+}  // namespace Log
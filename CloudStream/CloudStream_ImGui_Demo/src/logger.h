@@ -1,53 +1,75 @@
 #pragma once
 
-// logger.h - 简单日志工具
+// logger.h - 日志工具
+// 调用线程只在线程局部缓冲区里格式化，再拷贝进有界环形队列；后台线程批量写 stderr 和（可选）日志文件，
+// 终端或磁盘变慢不会拖住 SDK 网络/解码线程。队列满时丢弃 Debug/Info（后台线程输出丢弃汇总），Warning/Error 等待空位。
+// 低于 LOG_COMPILE_LEVEL 的 LOG_* 调用在编译期去掉，参数不求值
 
-#include <cstdarg>
-#include <cstdio>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// 编译期最低日志级别：0=Debug 1=Info 2=Warning 3=Error，可通过 CMake -DLOG_COMPILE_LEVEL=<n> 指定
+#ifndef LOG_COMPILE_LEVEL
+#ifdef NDEBUG
+#define LOG_COMPILE_LEVEL 1
+#else
+#define LOG_COMPILE_LEVEL 0
+#endif
+#endif
 
 namespace Log {
 
 enum class Level { Debug, Info, Warning, Error };
 
 // Use a function to get/set level (C++14 compatible, no inline variable)
-inline Level& g_level_ref() {
-  static Level level = Level::Info;
+inline std::atomic<Level>& g_level_ref() {
+  static std::atomic<Level> level{Level::Info};
   return level;
 }
 
-inline void set_level(Level level) { g_level_ref() = level; }
-
-inline void log(Level level, const char* tag, const char* fmt, ...) {
-  if (level < g_level_ref()) return;
-
-  const char* prefix = "";
-  switch (level) {
-    case Level::Debug:
-      prefix = "[DEBUG]";
-      break;
-    case Level::Info:
-      prefix = "[INFO]";
-      break;
-    case Level::Warning:
-      prefix = "[WARN]";
-      break;
-    case Level::Error:
-      prefix = "[ERROR]";
-      break;
-  }
-
-  fprintf(stderr, "%s [%s] ", prefix, tag);
-  va_list args;
-  va_start(args, fmt);
-  vfprintf(stderr, fmt, args);
-  va_end(args);
-  fprintf(stderr, "\n");
-  fflush(stderr);
-}
+inline void set_level(Level level) { g_level_ref().store(level, std::memory_order_relaxed); }
+
+inline bool enabled(Level level) { return level >= g_level_ref().load(std::memory_order_relaxed); }
+
+// 格式化一条日志并入队，可在任意线程调用；第一次调用时启动后台写入线程
+void log(Level level, const char* tag, const char* fmt, ...);
+
+// 同时追加写入日志文件，超过 max_bytes 时轮转为 path.1 ... path.<max_backups>；path 为空时关闭文件输出
+bool set_file(const std::string& path, size_t max_bytes = 20 * 1024 * 1024, int max_backups = 3);
+
+// 写出队列中剩余的日志并停止后台线程，之后的日志在调用线程直接写出。已注册到 atexit，可重复调用
+void shutdown();
 
+struct Stats {
+  uint64_t written = 0;  // 已写出的条数
+  uint64_t dropped = 0;  // 队列满被丢弃的 Debug/Info
+  uint64_t blocked = 0;  // 队列满时 Warning/Error 等待的次数
+};
+Stats stats();
+
+}  // namespace Log
+
+// 编译期去掉的调用：保留在 if (false) 中，参数仍做类型检查、不会产生未使用变量的告警，但不生成代码
+#define LOG_DISCARD_(tag, fmt, ...)                                  \
+  do {                                                               \
+    if (false) Log::log(Log::Level::Debug, tag, fmt, ##__VA_ARGS__); \
+  } while (0)
+
+#if LOG_COMPILE_LEVEL <= 0
 #define LOG_DEBUG(tag, fmt, ...) Log::log(Log::Level::Debug, tag, fmt, ##__VA_ARGS__)
+#else
+#define LOG_DEBUG(tag, fmt, ...) LOG_DISCARD_(tag, fmt, ##__VA_ARGS__)
+#endif
+#if LOG_COMPILE_LEVEL <= 1
 #define LOG_INFO(tag, fmt, ...) Log::log(Log::Level::Info, tag, fmt, ##__VA_ARGS__)
+#else
+#define LOG_INFO(tag, fmt, ...) LOG_DISCARD_(tag, fmt, ##__VA_ARGS__)
+#endif
+#if LOG_COMPILE_LEVEL <= 2
 #define LOG_WARN(tag, fmt, ...) Log::log(Log::Level::Warning, tag, fmt, ##__VA_ARGS__)
+#else
+#define LOG_WARN(tag, fmt, ...) LOG_DISCARD_(tag, fmt, ##__VA_ARGS__)
+#endif
 #define LOG_ERROR(tag, fmt, ...) Log::log(Log::Level::Error, tag, fmt, ##__VA_ARGS__)
-
-}  // namespace Log
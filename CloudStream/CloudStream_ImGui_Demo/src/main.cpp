@@ -9,6 +9,7 @@
 
 #include "app.h"
 #include "logger.h"
+#include "startup_timeline.h"
 
 #if defined(RENDERER_D3D11)
 // ======= Windows: D3D11 =======
@@ -93,15 +94,23 @@ int main(int argc, char* argv[]) {
   (void)argc;
   (void)argv;
 
+  StartupTimeline& timeline = StartupTimeline::instance();  // 启动计时从这里开始
   LOG_INFO("Main", "CloudStream ImGui Demo starting...");
 
   // 初始化 SDL2
+  timeline.begin("sdl_init");
   if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER) != 0) {
     LOG_ERROR("Main", "SDL_Init failed: %s", SDL_GetError());
     return 1;
   }
+  timeline.end("sdl_init");
+
+  // 读取配置并在后台开始 SDK 预连接、令牌获取，与下面的窗口和渲染后端创建并行
+  App app;
+  app.preload();
 
   // 创建窗口
+  timeline.begin("window");
   SDL_Window* window = nullptr;
 
 #if defined(RENDERER_D3D11)
@@ -148,7 +157,10 @@ int main(int argc, char* argv[]) {
   SDL_GL_SetSwapInterval(1);  // VSync
 #endif
 
+  timeline.end("window");
+
   // 初始化 ImGui
+  timeline.begin("imgui_init");
   IMGUI_CHECKVERSION();
   ImGui::CreateContext();
   ImGuiIO& io = ImGui::GetIO();
@@ -165,8 +177,9 @@ int main(int argc, char* argv[]) {
   ImGui_ImplOpenGL3_Init("#version 330");
 #endif
 
+  timeline.end("imgui_init");
+
   // 初始化应用
-  App app;
 #if defined(RENDERER_D3D11)
   if (!app.init(window, g_d3d_device, g_d3d_context)) {
     LOG_ERROR("Main", "App init failed");
@@ -0,0 +1,85 @@
+#include "startup_timeline.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "logger.h"
+
+namespace {
+const int kBarWidth = 40;
+}
+
+StartupTimeline& StartupTimeline::instance() {
+  static StartupTimeline timeline;
+  return timeline;
+}
+
+StartupTimeline::StartupTimeline() : m_origin(std::chrono::steady_clock::now()) {}
+
+double StartupTimeline::now_ms() const {
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_origin).count();
+}
+
+void StartupTimeline::begin(const char* phase) {
+  if (finished()) return;
+  Phase p;
+  p.name = phase;
+  p.begin_ms = now_ms();
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_phases.push_back(p);
+}
+
+void StartupTimeline::end(const char* phase, const char* note) {
+  if (finished()) return;
+  double t = now_ms();
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (auto it = m_phases.rbegin(); it != m_phases.rend(); ++it) {
+    if (it->end_ms < 0 && it->name == phase) {
+      it->end_ms = t;
+      if (note) it->note = note;
+      return;
+    }
+  }
+}
+
+void StartupTimeline::mark(const char* event, const char* note) {
+  if (finished()) return;
+  Phase p;
+  p.name = event;
+  p.begin_ms = p.end_ms = now_ms();
+  if (note) p.note = note;
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_phases.push_back(p);
+}
+
+void StartupTimeline::finish(const char* event) {
+  if (finished()) return;
+  mark(event);
+  bool expected = false;
+  if (!m_finished.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) return;
+  report(now_ms());
+}
+
+void StartupTimeline::report(double total_ms) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  std::stable_sort(m_phases.begin(), m_phases.end(),
+                   [](const Phase& a, const Phase& b) { return a.begin_ms < b.begin_ms; });
+  LOG_INFO("Startup", "Time to first frame: %.1f ms", total_ms);
+  double scale = total_ms > 0 ? kBarWidth / total_ms : 0;
+  for (const Phase& p : m_phases) {
+    // 每行一条 [begin, end] 区间的条形图，未结束的阶段画到首帧为止
+    double end = p.end_ms < 0 ? total_ms : p.end_ms;
+    int from = std::min(kBarWidth - 1, (int)(p.begin_ms * scale));
+    int to = std::max(from + 1, std::min(kBarWidth, (int)(end * scale + 0.5)));
+    char bar[kBarWidth + 1];
+    memset(bar, '.', kBarWidth);
+    memset(bar + from, p.end_ms == p.begin_ms ? '|' : '#', to - from);
+    bar[kBarWidth] = '\0';
+    if (p.end_ms == p.begin_ms)
+      LOG_INFO("Startup", "  %-18s [%s] %8.1f ms %s", p.name.c_str(), bar, p.begin_ms, p.note.c_str());
+    else
+      LOG_INFO("Startup", "  %-18s [%s] %8.1f -> %8.1f ms (%7.1f)%s %s", p.name.c_str(), bar, p.begin_ms, end,
+               end - p.begin_ms, p.end_ms < 0 ? " unfinished" : "", p.note.c_str());
+  }
+  m_phases.clear();
+}
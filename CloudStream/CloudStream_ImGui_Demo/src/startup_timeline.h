@@ -0,0 +1,44 @@
+#pragma once
+
+// startup_timeline.h - 启动阶段耗时记录
+// 启动各阶段可能并行（SDK 预连接、令牌获取与窗口/界面初始化重叠），逐个记录开始和结束时间（相对进程启动），
+// 首帧显示时输出一次时间线，得到从启动到首帧的分阶段耗时。可在任意线程调用
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class StartupTimeline {
+ public:
+  // 第一次调用时开始计时，应在 main 的开头调用一次
+  static StartupTimeline& instance();
+
+  void begin(const char* phase);
+  // note 附加在输出中，如 "cache hit"
+  void end(const char* phase, const char* note = nullptr);
+  // 瞬时事件
+  void mark(const char* event, const char* note = nullptr);
+
+  // 记录 event 并输出整条时间线，只生效一次；之后的调用只有一次原子读
+  void finish(const char* event);
+  bool finished() const { return m_finished.load(std::memory_order_acquire); }
+
+ private:
+  struct Phase {
+    std::string name;
+    double begin_ms = 0;
+    double end_ms = -1;  // < 0 表示未结束；瞬时事件与 begin_ms 相同
+    std::string note;
+  };
+
+  StartupTimeline();
+  double now_ms() const;
+  void report(double total_ms);
+
+  std::chrono::steady_clock::time_point m_origin;
+  std::mutex m_mutex;
+  std::vector<Phase> m_phases;
+  std::atomic<bool> m_finished{false};
+};
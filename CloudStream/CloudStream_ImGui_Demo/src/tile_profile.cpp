@@ -0,0 +1,65 @@
+#include "tile_profile.h"
+
+#include <algorithm>
+
+namespace {
+
+// 短边 / 帧率；帧率不会超过配置的子码流帧率
+const int kLadder[][2] = {{96, 10}, {144, 15}, {192, 20}, {288, 25}, {360, 30}, {480, 30}, {720, 30}};
+
+const float kUpscaleTolerance = 1.15f;  // 单元格比当前档位大不超过 15% 时不升档
+const float kDownscaleMargin = 0.85f;   // 单元格比下一档还小 15% 以上才降档
+const float kSettleSec = 1.0f;          // 目标档位需保持稳定的时间
+
+}  // namespace
+
+void TileProfileLadder::reset(int max_short_edge, int max_fps, int min_bitrate, int max_bitrate) {
+  max_short_edge = std::max(max_short_edge, 1);
+  max_fps = std::max(max_fps, 1);
+  m_steps.clear();
+  for (const auto& l : kLadder) {
+    if (l[0] >= max_short_edge) break;
+    // 码率按像素面积等比缩放
+    float area = static_cast<float>(l[0]) * l[0] / (static_cast<float>(max_short_edge) * max_short_edge);
+    TileProfileStep s;
+    s.short_edge = l[0];
+    s.fps = std::min(l[1], max_fps);
+    s.min_bitrate = std::max(30, static_cast<int>(min_bitrate * area));
+    s.max_bitrate = std::max(50, static_cast<int>(max_bitrate * area));
+    s.min_bitrate = std::min(s.min_bitrate, s.max_bitrate);
+    m_steps.push_back(s);
+  }
+  m_steps.push_back({max_short_edge, max_fps, min_bitrate, max_bitrate});
+  // 会话以配置参数创建，初始即为最高档
+  m_current = static_cast<int>(m_steps.size()) - 1;
+  m_pending = -1;
+  m_pending_time = 0;
+}
+
+int TileProfileLadder::select(float px) const {
+  int top = static_cast<int>(m_steps.size()) - 1;
+  int idx = m_current;
+  while (idx < top && px > m_steps[idx].short_edge * kUpscaleTolerance) idx++;
+  if (idx != m_current) return idx;
+  while (idx > 0 && px < m_steps[idx - 1].short_edge * kDownscaleMargin) idx--;
+  return idx;
+}
+
+bool TileProfileLadder::update(float px, float dt) {
+  if (m_steps.empty() || px <= 0) return false;
+  int target = select(px);
+  if (target == m_current) {
+    m_pending = -1;
+    return false;
+  }
+  if (target != m_pending) {
+    m_pending = target;
+    m_pending_time = 0;
+    return false;
+  }
+  m_pending_time += dt;
+  if (m_pending_time < kSettleSec) return false;
+  m_current = target;
+  m_pending = -1;
+  return true;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+// tile_profile.h - 按宫格实际像素尺寸选择子码流档位
+// 宫格列数或窗口大小变化后，根据单元格在屏幕上的物理像素短边（含 DPI 缩放）
+// 选择最接近的分辨率/帧率档位，通过 tcr_session_set_remote_video_profile 重新协商；
+// 升降档各有滞回区间，且尺寸需稳定一段时间才生效，避免拖动窗口时频繁协商
+
+#include <vector>
+
+struct TileProfileStep {
+  int short_edge;   // 视频短边像素
+  int fps;
+  int min_bitrate;  // kbps
+  int max_bitrate;  // kbps
+};
+
+class TileProfileLadder {
+ public:
+  // 以配置的子码流参数作为最高档，档位表中超过该值的档位被裁掉
+  void reset(int max_short_edge, int max_fps, int min_bitrate, int max_bitrate);
+
+  // 每帧调用：tile_px_short_edge 为单元格视频区域的物理像素短边。
+  // 返回 true 表示档位已变化，需要用 current() 重新协商
+  bool update(float tile_px_short_edge, float dt);
+
+  const TileProfileStep& current() const { return m_steps[m_current]; }
+
+ private:
+  int select(float tile_px_short_edge) const;
+
+  std::vector<TileProfileStep> m_steps;
+  int m_current = 0;
+  int m_pending = -1;          // 等待稳定的目标档位
+  float m_pending_time = 0;
+};
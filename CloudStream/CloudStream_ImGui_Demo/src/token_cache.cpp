@@ -0,0 +1,271 @@
+#include "token_cache.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <nlohmann/json.hpp>
+
+#if defined(_WIN32)
+#  include <windows.h>
+#  include <wincrypt.h>
+#  pragma comment(lib, "crypt32.lib")
+#else
+#  include <fcntl.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+#include "aes_gcm.h"
+#include "logger.h"
+
+const int64_t TokenCache::kExpiryMarginSec;
+
+namespace {
+
+// 文件头标识格式版本，其他版本读到时删除（TCK2 在非 Windows 平台上是明文）
+#if defined(_WIN32)
+const char kMagic[4] = {'T', 'C', 'K', '2'};  // DPAPI 密文
+#else
+const char kMagic[4] = {'T', 'C', 'K', '3'};  // nonce || AES-256-GCM 密文 || 标签，文件头作为附加认证数据
+#endif
+const char kCacheFile[] = "token_cache.bin";
+const char kKeyFile[] = "token_cache.key";
+
+bool read_file(const std::string& path, std::string& out) {
+  std::ifstream f(path, std::ios::binary);
+  if (!f.is_open()) return false;
+  out.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+  return true;
+}
+
+#if defined(_WIN32)
+
+// DPAPI：密钥由系统按当前用户管理，不需要密钥文件
+bool protect(const std::string& /*key_dir*/, const std::string& plain, std::string& out) {
+  DATA_BLOB in{(DWORD)plain.size(), (BYTE*)plain.data()};
+  DATA_BLOB blob{0, nullptr};
+  if (!CryptProtectData(&in, L"CloudStream token cache", nullptr, nullptr, nullptr, CRYPTPROTECT_UI_FORBIDDEN, &blob))
+    return false;
+  out.assign((const char*)blob.pbData, blob.cbData);
+  LocalFree(blob.pbData);
+  return true;
+}
+
+bool unprotect(const std::string& /*key_dir*/, const std::string& data, std::string& out) {
+  DATA_BLOB in{(DWORD)data.size(), (BYTE*)data.data()};
+  DATA_BLOB blob{0, nullptr};
+  if (!CryptUnprotectData(&in, nullptr, nullptr, nullptr, nullptr, CRYPTPROTECT_UI_FORBIDDEN, &blob)) return false;
+  out.assign((const char*)blob.pbData, blob.cbData);
+  SecureZeroMemory(blob.pbData, blob.cbData);
+  LocalFree(blob.pbData);
+  return true;
+}
+
+bool write_private_file(const std::string& path, const std::string& data) {
+  std::ofstream f(path, std::ios::binary | std::ios::trunc);
+  if (!f.is_open()) return false;
+  f.write(data.data(), (std::streamsize)data.size());
+  return f.good();
+}
+
+#else
+
+// 以 0600 独占新建临时文件（不会沿用已存在文件或符号链接的权限），写完 fsync 后改名覆盖
+bool write_private_file(const std::string& path, const std::string& data) {
+  std::string tmp = path + ".tmp";
+  ::unlink(tmp.c_str());
+  int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+  if (fd < 0) return false;
+  bool ok = true;
+  for (size_t off = 0; ok && off < data.size();) {
+    ssize_t n = ::write(fd, data.data() + off, data.size() - off);
+    if (n > 0)
+      off += (size_t)n;
+    else
+      ok = n < 0 && errno == EINTR;
+  }
+  ok = ::fsync(fd) == 0 && ok;
+  ok = ::close(fd) == 0 && ok;
+  if (!ok || ::rename(tmp.c_str(), path.c_str()) != 0) {
+    ::unlink(tmp.c_str());
+    return false;
+  }
+  return true;
+}
+
+void wipe(std::string& s) {
+  volatile char* p = &s[0];
+  for (size_t i = 0; i < s.size(); ++i) p[i] = 0;
+  s.clear();
+}
+
+bool random_bytes(size_t n, std::string& out) {
+  int fd = ::open("/dev/urandom", O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return false;
+  out.assign(n, '\0');
+  size_t off = 0;
+  while (off < n) {
+    ssize_t r = ::read(fd, &out[off], n - off);
+    if (r > 0)
+      off += (size_t)r;
+    else if (!(r < 0 && errno == EINTR))
+      break;
+  }
+  ::close(fd);
+  return off == n;
+}
+
+// 逐级创建目录，新建的目录为 0700
+bool make_dirs(const std::string& dir) {
+  for (size_t pos = 1; pos <= dir.size(); ++pos) {
+    if (pos < dir.size() && dir[pos] != '/') continue;
+    std::string part = dir.substr(0, pos);
+    if (::mkdir(part.c_str(), 0700) != 0 && errno != EEXIST) return false;
+  }
+  return true;
+}
+
+// 只接受当前用户所有、组和其他用户无任何权限的 32 字节普通文件，不跟随符号链接
+bool read_key(const std::string& path, std::string& key) {
+  int fd = ::open(path.c_str(), O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+  if (fd < 0) return false;
+  struct stat st;
+  bool ok = ::fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_uid == ::getuid() && (st.st_mode & 077) == 0 &&
+            st.st_size == (off_t)aes_gcm::kKeySize;
+  if (ok) {
+    key.assign(aes_gcm::kKeySize, '\0');
+    ok = ::read(fd, &key[0], key.size()) == (ssize_t)key.size();
+  }
+  ::close(fd);
+  if (!ok) {
+    wipe(key);
+    LOG_WARN("TokenCache", "Ignoring key file %s: not a private %u-byte file of the current user", path.c_str(),
+             (unsigned)aes_gcm::kKeySize);
+  }
+  return ok;
+}
+
+bool protect(const std::string& key_dir, const std::string& plain, std::string& out) {
+  if (key_dir.empty()) return false;
+  const std::string path = key_dir + kKeyFile;
+  std::string key;
+  if (!read_key(path, key)) {
+    // 没有可用的密钥时生成新的；旧密钥加密的缓存随之失效
+    if (!make_dirs(key_dir) || !random_bytes(aes_gcm::kKeySize, key) || !write_private_file(path, key)) {
+      wipe(key);
+      return false;
+    }
+    LOG_INFO("TokenCache", "Created token cache key %s", path.c_str());
+  }
+  std::string nonce;
+  bool ok = random_bytes(aes_gcm::kNonceSize, nonce);
+  if (ok) out = nonce + aes_gcm::seal(key, nonce, plain, std::string(kMagic, sizeof(kMagic)));
+  wipe(key);
+  return ok;
+}
+
+bool unprotect(const std::string& key_dir, const std::string& data, std::string& out) {
+  std::string key;
+  if (key_dir.empty() || data.size() < aes_gcm::kNonceSize || !read_key(key_dir + kKeyFile, key)) return false;
+  bool ok = aes_gcm::unseal(key, data.substr(0, aes_gcm::kNonceSize), data.substr(aes_gcm::kNonceSize),
+                            std::string(kMagic, sizeof(kMagic)), out);
+  wipe(key);
+  return ok;
+}
+
+#endif
+
+int64_t unix_now() {
+  return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+}  // namespace
+
+void TokenCache::open(const std::string& dir, const std::string& key_dir) {
+  m_dir = dir;
+  m_key_dir = key_dir;
+  // 旧版本把密钥文件放在缓存目录中，已不再使用
+  if (!m_dir.empty() && m_dir != m_key_dir) std::remove((m_dir + kKeyFile).c_str());
+}
+
+std::string TokenCache::default_key_dir(const std::string& app_name) {
+#if defined(_WIN32)
+  (void)app_name;
+  return std::string();
+#else
+  const char* xdg = std::getenv("XDG_CONFIG_HOME");
+  std::string base;
+  if (xdg && xdg[0] == '/') {
+    base = xdg;
+  } else {
+    const char* home = std::getenv("HOME");
+    if (!home || !home[0]) return std::string();
+    base = std::string(home) + "/.config";
+  }
+  return base + "/" + app_name + "/";
+#endif
+}
+
+bool TokenCache::load(const std::string& key, CachedToken& out) {
+  if (!enabled()) return false;
+  std::string blob;
+  if (!read_file(m_dir + kCacheFile, blob)) return false;
+  if (blob.size() < sizeof(kMagic) || memcmp(blob.data(), kMagic, sizeof(kMagic)) != 0) {
+    LOG_INFO("TokenCache", "Removing cache file in an unknown format");
+    remove();
+    return false;
+  }
+  std::string plain;
+  if (!unprotect(m_key_dir, blob.substr(sizeof(kMagic)), plain)) {
+    LOG_WARN("TokenCache", "Cannot decrypt cache file (key missing, different user or damaged), ignoring");
+    return false;
+  }
+
+  try {
+    auto j = nlohmann::json::parse(plain);
+    if (j.value("key", "") != key) {
+      LOG_INFO("TokenCache", "Cached token is for a different request, ignoring");
+      return false;
+    }
+    CachedToken t;
+    t.token = j.value("token", "");
+    t.access_info = j.value("accessInfo", "");
+    t.expires_at = j.value("expiresAt", (int64_t)0);
+    if (t.token.empty() || t.access_info.empty()) return false;
+    int64_t left = t.expires_at - unix_now();
+    if (left <= kExpiryMarginSec) {
+      LOG_INFO("TokenCache", "Cached token expires in %lld s, ignoring", (long long)left);
+      return false;
+    }
+    out = t;
+    return true;
+  } catch (const std::exception& e) {
+    LOG_WARN("TokenCache", "Failed to parse cache: %s", e.what());
+    return false;
+  }
+}
+
+void TokenCache::store(const std::string& key, const CachedToken& token) {
+  if (!enabled()) return;
+  nlohmann::json j;
+  j["key"] = key;
+  j["token"] = token.token;
+  j["accessInfo"] = token.access_info;
+  j["expiresAt"] = token.expires_at;
+  std::string sealed;
+  if (!protect(m_key_dir, j.dump(), sealed)) {
+    LOG_WARN("TokenCache", "Cannot encrypt token cache, not storing it");
+    return;
+  }
+  if (!write_private_file(m_dir + kCacheFile, std::string(kMagic, sizeof(kMagic)) + sealed))
+    LOG_WARN("TokenCache", "Cannot write cache file in %s", m_dir.c_str());
+}
+
+void TokenCache::remove() {
+  if (!enabled()) return;
+  std::remove((m_dir + kCacheFile).c_str());
+}
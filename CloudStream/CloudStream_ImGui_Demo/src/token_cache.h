@@ -0,0 +1,39 @@
+#pragma once
+
+// token_cache.h - 访问令牌本地缓存
+// 同一组实例在令牌有效期内重启时直接复用上次的 Token/AccessInfo，省去 CreateAndroidInstancesAccessToken 的往返。
+// 落盘保护：Windows 上用 DPAPI（CryptProtectData，绑定当前用户登录凭据）加密，其他用户或拷走文件都无法解密；
+// 其他平台用 AES-256-GCM 加密，256 位随机密钥按用户保存在另一个目录的 0600 文件中（目录 0700），
+// 只拷走或备份缓存目录得不到明文，文件被改动也能发现。两种文件都以 O_CREAT|O_EXCL 和 0600 新建再改名。
+// 密钥文件权限过宽、不属于当前用户时不使用它，下次写入时重新生成。
+// 解密失败、内容损坏、请求不同或即将过期都视为未命中
+
+#include <cstdint>
+#include <string>
+
+struct CachedToken {
+  std::string token;
+  std::string access_info;
+  int64_t expires_at = 0;  // Unix 时间（秒）
+};
+
+class TokenCache {
+ public:
+  // 剩余有效期不足该值时视为过期，留出建连的时间
+  static const int64_t kExpiryMarginSec = 300;
+
+  // dir 为缓存目录、key_dir 为密钥目录（都以路径分隔符结尾，Windows 上不使用 key_dir）；dir 为空则禁用缓存
+  void open(const std::string& dir, const std::string& key_dir);
+  // 当前用户配置目录下的 app_name/（$XDG_CONFIG_HOME 或 ~/.config），与应用数据目录分开；取不到时返回空串
+  static std::string default_key_dir(const std::string& app_name);
+  bool enabled() const { return !m_dir.empty(); }
+
+  // key 标识一次令牌请求（服务地址 + 实例列表），与缓存中记录的不同则未命中
+  bool load(const std::string& key, CachedToken& out);
+  void store(const std::string& key, const CachedToken& token);
+  void remove();
+
+ private:
+  std::string m_dir;
+  std::string m_key_dir;
+};
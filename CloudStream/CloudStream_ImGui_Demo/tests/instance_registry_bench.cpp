@@ -0,0 +1,79 @@
+// instance_registry_bench.cpp - 帧回调中实例ID -> 句柄查找的基准
+// 对比 InstanceRegistry::find(const char*) 与原先的做法：在实例ID列表中线性查找，
+// 以及用 SDK 给出的 C 字符串构造 std::string 再查 std::map。只依赖标准库：
+//   cmake -DBUILD_TESTS=ON ... && ./instance_registry_bench [实例数] [查找次数]
+//   或 g++ -std=c++14 -O2 -Isrc tests/instance_registry_bench.cpp src/instance_registry.cpp
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "instance_registry.h"
+
+namespace {
+
+// 与 config.json 中的实例ID同形："cai-1300056159-" + 11 位随机字符
+std::vector<std::string> make_ids(int count) {
+  const char kChars[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+  std::mt19937 rng(42);
+  std::vector<std::string> ids;
+  for (int i = 0; i < count; ++i) {
+    std::string id = "cai-1300056159-";
+    for (int k = 0; k < 11; ++k) id += kChars[rng() % 36];
+    ids.push_back(id);
+  }
+  return ids;
+}
+
+template <typename Fn>
+double ns_per_lookup(const std::vector<const char*>& queries, Fn&& fn) {
+  long long checksum = 0;
+  auto t0 = std::chrono::steady_clock::now();
+  for (const char* q : queries) checksum += fn(q);
+  auto t1 = std::chrono::steady_clock::now();
+  if (checksum == -1) std::printf("%lld\n", checksum);  // 防止整个循环被优化掉
+  return std::chrono::duration<double, std::nano>(t1 - t0).count() / queries.size();
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  const int count = argc > 1 ? std::atoi(argv[1]) : 1000;
+  const int lookups = argc > 2 ? std::atoi(argv[2]) : 2000000;
+  if (count <= 0 || lookups <= 0) return 1;
+
+  const std::vector<std::string> ids = make_ids(count);
+  InstanceRegistry registry;
+  std::map<std::string, int> by_id;
+  for (int i = 0; i < count; ++i) {
+    registry.intern(ids[i]);
+    by_id[ids[i]] = i;
+  }
+
+  // 帧回调拿到的是 SDK 缓冲区里的 C 字符串，这里拷贝一份避免与驻留的字符串共享指针
+  std::vector<std::string> sdk_ids = ids;
+  std::vector<const char*> queries(lookups);
+  std::mt19937 rng(7);
+  for (int i = 0; i < lookups; ++i) queries[i] = sdk_ids[rng() % count].c_str();
+
+  const double linear = ns_per_lookup(queries, [&](const char* q) {
+    auto it = std::find(ids.begin(), ids.end(), q);
+    return it == ids.end() ? -1 : int(it - ids.begin());
+  });
+  const double map = ns_per_lookup(queries, [&](const char* q) {
+    auto it = by_id.find(std::string(q));
+    return it == by_id.end() ? -1 : it->second;
+  });
+  const double interned = ns_per_lookup(queries, [&](const char* q) { return registry.find(q); });
+
+  std::printf("%d instances, %d lookups\n", count, lookups);
+  std::printf("  linear scan           %8.1f ns/lookup\n", linear);
+  std::printf("  std::map<std::string> %8.1f ns/lookup\n", map);
+  std::printf("  InstanceRegistry      %8.1f ns/lookup (%.1fx vs linear)\n", interned, linear / interned);
+  return 0;
+}
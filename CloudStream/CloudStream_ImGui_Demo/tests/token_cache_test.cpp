@@ -0,0 +1,235 @@
+// token_cache_test.cpp - AES-256-GCM 与访问令牌缓存的检查
+// aes_gcm 对照 GCM 规范的 AES-256 测试向量；TokenCache 在临时目录中检查往返、请求不同与过期未命中，
+// 非 Windows 平台另外检查密文中没有明文、文件权限、密钥文件权限过宽时不用、内容被改和旧格式文件。
+// Windows 上走 DPAPI 路径，只检查往返和未命中。失败时打印检查项并返回非 0
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#if defined(_WIN32)
+#  include <windows.h>
+#else
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+#include "aes_gcm.h"
+#include "logger.h"
+#include "token_cache.h"
+
+namespace {
+
+int g_failures = 0;
+
+#define CHECK(cond)                                                                 \
+  do {                                                                              \
+    if (!(cond)) {                                                                  \
+      std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+      g_failures++;                                                                 \
+    }                                                                               \
+  } while (0)
+
+std::string from_hex(const char* hex) {
+  std::string out;
+  for (; hex[0] && hex[1]; hex += 2) {
+    unsigned v = 0;
+    std::sscanf(hex, "%2x", &v);
+    out.push_back((char)v);
+  }
+  return out;
+}
+
+std::string read_all(const std::string& path) {
+  std::ifstream f(path, std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+}
+
+void write_all(const std::string& path, const std::string& data) {
+  std::ofstream f(path, std::ios::binary | std::ios::trunc);
+  f.write(data.data(), (std::streamsize)data.size());
+}
+
+int64_t unix_now() {
+  return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+std::string make_temp_dir() {
+#if defined(_WIN32)
+  char base[MAX_PATH];
+  GetTempPathA(MAX_PATH, base);
+  std::string dir = std::string(base) + "token_cache_test_" + std::to_string(GetCurrentProcessId()) + "\\";
+  CreateDirectoryA(dir.c_str(), nullptr);
+  return dir;
+#else
+  char tmpl[] = "/tmp/token_cache_test_XXXXXX";
+  const char* dir = ::mkdtemp(tmpl);
+  return dir ? std::string(dir) + "/" : std::string();
+#endif
+}
+
+// GCM 规范（McGrew & Viega）中的 AES-256 测试用例 13、14、16
+void test_aes_gcm_vectors() {
+  const std::string zero_key(32, '\0');
+  const std::string zero_nonce(12, '\0');
+  CHECK(aes_gcm::seal(zero_key, zero_nonce, "", "") == from_hex("530f8afbc74536b9a963b4f1c4cb738b"));
+  CHECK(aes_gcm::seal(zero_key, zero_nonce, std::string(16, '\0'), "") ==
+        from_hex("cea7403d4d606b6e074ec5d3baf39d18d0d1c8a799996bf0265b98b5d48ab919"));
+
+  const std::string key = from_hex("feffe9928665731c6d6a8f9467308308feffe9928665731c6d6a8f9467308308");
+  const std::string nonce = from_hex("cafebabefacedbaddecaf888");
+  const std::string plain = from_hex(
+      "d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a721c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657"
+      "ba637b39");
+  const std::string aad = from_hex("feedfacedeadbeeffeedfacedeadbeefabaddad2");
+  const std::string sealed = aes_gcm::seal(key, nonce, plain, aad);
+  CHECK(sealed == from_hex("522dc1f099567d07f47f37a32a84427d643a8cdcbfe5c0c97598a2bd2555d1aa8cb08e48590dbb3da7b08b10568288"
+                           "38c5f61e6393ba7a0abcc9f66276fc6ece0f4e1768cddf8853bb2d551b"));
+
+  std::string out;
+  CHECK(aes_gcm::unseal(key, nonce, sealed, aad, out) && out == plain);
+  CHECK(!aes_gcm::unseal(key, nonce, sealed, "other aad", out));
+  CHECK(!aes_gcm::unseal(zero_key, nonce, sealed, aad, out));
+  for (size_t i = 0; i < sealed.size(); i += 7) {
+    std::string damaged = sealed;
+    damaged[i] ^= 0x01;
+    CHECK(!aes_gcm::unseal(key, nonce, damaged, aad, out));
+  }
+  CHECK(aes_gcm::seal(key.substr(1), nonce, plain, aad).empty());
+}
+
+CachedToken sample_token() {
+  CachedToken t;
+  t.token = "token-7f3a9c";
+  t.access_info = "access-info-51d2";
+  t.expires_at = unix_now() + 3600;
+  return t;
+}
+
+void test_round_trip(const std::string& dir, const std::string& key_dir) {
+  TokenCache cache;
+  cache.open(dir, key_dir);
+  CachedToken loaded;
+  CHECK(!cache.load("req-a", loaded));
+
+  const CachedToken token = sample_token();
+  cache.store("req-a", token);
+  CHECK(cache.load("req-a", loaded));
+  CHECK(loaded.token == token.token && loaded.access_info == token.access_info && loaded.expires_at == token.expires_at);
+  CHECK(!cache.load("req-b", loaded));
+
+  // 剩余有效期不足余量时视为过期
+  CachedToken expiring = token;
+  expiring.expires_at = unix_now() + TokenCache::kExpiryMarginSec - 10;
+  cache.store("req-a", expiring);
+  CHECK(!cache.load("req-a", loaded));
+
+  cache.remove();
+  CHECK(!cache.load("req-a", loaded));
+
+  TokenCache disabled;
+  disabled.open("", key_dir);
+  disabled.store("req-a", token);
+  CHECK(!disabled.load("req-a", loaded));
+}
+
+#if !defined(_WIN32)
+
+unsigned file_mode(const std::string& path) {
+  struct stat st;
+  return ::stat(path.c_str(), &st) == 0 ? (unsigned)(st.st_mode & 0777) : 0xffffu;
+}
+
+void test_posix_protection(const std::string& dir, const std::string& key_dir) {
+  const std::string cache_file = dir + "token_cache.bin";
+  const std::string key_file = key_dir + "token_cache.key";
+  ::umask(022);
+
+  TokenCache cache;
+  cache.open(dir, key_dir);
+  const CachedToken token = sample_token();
+  cache.store("req-a", token);
+
+  const std::string blob = read_all(cache_file);
+  CHECK(blob.compare(0, 4, "TCK3") == 0);
+  CHECK(blob.find(token.token) == std::string::npos);
+  CHECK(blob.find(token.access_info) == std::string::npos);
+  CHECK(blob.find("req-a") == std::string::npos);
+  CHECK(file_mode(cache_file) == 0600);
+  CHECK(file_mode(key_file) == 0600);
+  CHECK(read_all(key_file).size() == aes_gcm::kKeySize);
+
+  // 两次写入使用不同的 nonce
+  cache.store("req-a", token);
+  CHECK(read_all(cache_file) != blob);
+
+  // 内容被改动
+  std::string damaged = read_all(cache_file);
+  damaged[damaged.size() - 20] ^= 0x01;
+  write_all(cache_file, damaged);
+  CachedToken loaded;
+  CHECK(!cache.load("req-a", loaded));
+
+  // 密钥文件权限过宽：不使用，下次写入时换新的 0600 密钥
+  cache.store("req-a", token);
+  const std::string old_key = read_all(key_file);
+  ::chmod(key_file.c_str(), 0644);
+  CHECK(!cache.load("req-a", loaded));
+  cache.store("req-a", token);
+  CHECK(file_mode(key_file) == 0600);
+  CHECK(read_all(key_file) != old_key);
+  CHECK(cache.load("req-a", loaded));
+
+  // 密钥丢失
+  ::unlink(key_file.c_str());
+  CHECK(!cache.load("req-a", loaded));
+
+  // 旧版本的明文缓存读到时删除
+  write_all(cache_file, "TCK2{\"key\":\"req-a\",\"token\":\"t\",\"accessInfo\":\"a\",\"expiresAt\":9999999999}");
+  CHECK(!cache.load("req-a", loaded));
+  CHECK(file_mode(cache_file) == 0xffffu);
+}
+
+void remove_dir(const std::string& dir) {
+  ::unlink((dir + "token_cache.bin").c_str());
+  ::unlink((dir + "token_cache.key").c_str());
+  ::rmdir(dir.c_str());
+}
+
+#endif
+
+}  // namespace
+
+int main() {
+  Log::set_level(Log::Level::Error);
+  test_aes_gcm_vectors();
+
+  const std::string dir = make_temp_dir();
+  CHECK(!dir.empty());
+  if (!dir.empty()) {
+#if defined(_WIN32)
+    test_round_trip(dir, std::string());
+    std::remove((dir + "token_cache.bin").c_str());
+    RemoveDirectoryA(dir.c_str());
+#else
+    // 密钥目录放在缓存目录之外，检查逐级创建
+    const std::string key_dir = dir + "config/CloudStreamImGuiDemo/";
+    test_round_trip(dir, key_dir);
+    test_posix_protection(dir, key_dir);
+    remove_dir(key_dir);
+    ::rmdir((dir + "config").c_str());
+    remove_dir(dir);
+#endif
+  }
+
+  Log::shutdown();
+  if (g_failures) {
+    std::fprintf(stderr, "%d check(s) failed\n", g_failures);
+    return 1;
+  }
+  std::printf("token_cache_test: all checks passed\n");
+  return 0;
+}
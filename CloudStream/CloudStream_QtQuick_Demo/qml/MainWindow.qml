@@ -64,6 +64,7 @@ ApplicationWindow {
     
     // 实例管理属性
     property var checkedInstanceIds: []             // 选中的实例ID列表
+    onCheckedInstanceIdsChanged: multiInstanceViewModel.setSelectedInstances(checkedInstanceIds)
     property var instanceConfigs: []                // 格式: [{instanceId: "xxx", instanceIndex: 0}, ...]
     
     // 窗口管理属性
@@ -611,6 +612,15 @@ ApplicationWindow {
             }
         }
 
+        // 单元格尺寸（列数/窗口大小/屏幕缩放）变化时上报物理像素尺寸，用于协商子码流分辨率和帧率
+        function reportTileSize() {
+            multiInstanceViewModel.updateTileSize(cellWidth - 10, cellHeight - 10, Screen.devicePixelRatio);
+        }
+
+        onCellWidthChanged: reportTileSize()
+        Screen.onDevicePixelRatioChanged: reportTileSize()
+        Component.onCompleted: reportTileSize()
+
         function checkVisibleItems() {
             var visibleIds = [];
             var invisibleIds = [];
@@ -768,6 +778,7 @@ ApplicationWindow {
         anchors.fill: videoGridView
         z: 1
         propagateComposedEvents: true
+        hoverEnabled: true                          // 悬停的宫格每帧渲染，其余宫格按后台帧率抽帧
         
         property bool longPressTriggered: false
         property real pressStartX: 0
@@ -805,6 +816,7 @@ ApplicationWindow {
         }
         
         onPositionChanged: {
+            multiInstanceViewModel.setHoveredInstance(getInstanceIdAtPosition(mouse.x, mouse.y));
             if (isDragSelecting) {
                 dragEndX = mouse.x;
                 dragEndY = mouse.y;
@@ -851,6 +863,10 @@ ApplicationWindow {
             dragEndY = 0;
         }
         
+        onExited: {
+            multiInstanceViewModel.setHoveredInstance("");
+        }
+        
         onCanceled: {
             longPressTimer.stop();
             if (isDragSelecting) {
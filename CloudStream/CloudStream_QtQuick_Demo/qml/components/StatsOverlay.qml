@@ -2,6 +2,7 @@ import QtQuick 2.15
 
 import QtQuick 2.15
 import QtQuick.Controls 2.15
+import CustomComponents 1.0
 
 // 统计数据显示蒙层组件
 Rectangle {
@@ -14,34 +15,64 @@ Rectangle {
     
     // 高度自适应内容
     width: parent.width
-    height: statsText.contentHeight + 10
+    height: content.height + 10
     
-    Text {
-        id: statsText
-        anchors.fill: parent
+    Column {
+        id: content
+        anchors.left: parent.left
+        anchors.right: parent.right
+        anchors.top: parent.top
         anchors.margins: 5
-        color: "white"
-        font.pixelSize: 12
-        font.family: "Courier New"
-        wrapMode: Text.WordWrap
-        text: {
-            // 检查输入是否为空
-            if (!root.clientStats || root.clientStats === "") {
-                return ""
+
+        // 主动探测选出的加速节点及其评分
+        Text {
+            id: probeText
+            width: parent.width
+            color: "white"
+            font.pixelSize: 12
+            font.family: "Courier New"
+            wrapMode: Text.WordWrap
+            visible: text !== ""
+            text: {
+                var node = ProbeManager.bestNode
+                if (!node || !node.zone) {
+                    return ""
+                }
+                return "节点: " + node.zone + " (" + node.domain + ")" +
+                       "  评分 " + node.qualityScore.toFixed(1) +
+                       "  RTT " + node.rttMs.toFixed(1) + "ms" +
+                       "  抖动 " + node.jitterMs.toFixed(1) + "ms" +
+                       "  丢包 " + (node.lossRate * 100).toFixed(1) + "%" +
+                       (node.fromCache ? "  [缓存, " + node.ageSec + "s 前]" : "")
             }
+        }
+
+        Text {
+            id: statsText
+            width: parent.width
+            color: "white"
+            font.pixelSize: 12
+            font.family: "Courier New"
+            wrapMode: Text.WordWrap
+            text: {
+                // 检查输入是否为空
+                if (!root.clientStats || root.clientStats === "") {
+                    return ""
+                }
             
-            try {
-                // 验证是否为有效的 JSON
-                var stats = JSON.parse(root.clientStats)
+                try {
+                    // 验证是否为有效的 JSON
+                    var stats = JSON.parse(root.clientStats)
 
-                // 直接返回格式化的 JSON 字符串
-                // C++ 端已经返回了格式化的 JSON（带缩进）
-                return root.clientStats
+                    // 直接返回格式化的 JSON 字符串
+                    // C++ 端已经返回了格式化的 JSON（带缩进）
+                    return root.clientStats
                 
-            } catch (e) {
-                console.error("[StatsOverlay] JSON 解析错误:", e.toString())
-                console.error("[StatsOverlay] 原始数据:", root.clientStats)
-                return "数据解析错误"
+                } catch (e) {
+                    console.error("[StatsOverlay] JSON 解析错误:", e.toString())
+                    console.error("[StatsOverlay] 原始数据:", root.clientStats)
+                    return "数据解析错误"
+                }
             }
         }
     }
@@ -66,6 +66,37 @@ void AppConfig::load(const QString& filePath) {
   } else {
     m_mode = "";
   }
+  if (obj.contains("tokenTtlHours") && obj["tokenTtlHours"].isDouble()) {
+    m_tokenTtlHours = obj["tokenTtlHours"].toInt();
+  }
+  if (obj.contains("tokenCache") && obj["tokenCache"].isBool()) {
+    m_tokenCacheEnabled = obj["tokenCache"].toBool();
+  }
+  if (obj.contains("probeCacheTtlMinutes") && obj["probeCacheTtlMinutes"].isDouble()) {
+    m_probeCacheTtlMinutes = obj["probeCacheTtlMinutes"].toInt();
+  }
+  if (obj.contains("logOverflowPolicy") && obj["logOverflowPolicy"].isString()) {
+    const QString policy = obj["logOverflowPolicy"].toString();
+    if (policy == "block") {
+      m_logOverflowPolicy = Logger::kBlock;
+    } else if (policy == "dropNewest") {
+      m_logOverflowPolicy = Logger::kDropNewest;
+    } else {
+      m_logOverflowPolicy = Logger::kDropOldest;
+    }
+  }
+  if (obj.contains("adaptiveConcurrency") && obj["adaptiveConcurrency"].isObject()) {
+    const QJsonObject ac = obj["adaptiveConcurrency"].toObject();
+    m_concurrencyPolicy.enabled = ac.value("enabled").toBool(m_concurrencyPolicy.enabled);
+    m_concurrencyPolicy.minStreams = ac.value("min").toInt(m_concurrencyPolicy.minStreams);
+    m_concurrencyPolicy.maxStreams = ac.value("max").toInt(m_concurrencyPolicy.maxStreams);
+    m_concurrencyPolicy.cpuHigh = ac.value("cpuHigh").toDouble(m_concurrencyPolicy.cpuHigh);
+    m_concurrencyPolicy.cpuLow = ac.value("cpuLow").toDouble(m_concurrencyPolicy.cpuLow);
+    if (ac.value("cooldownSec").isDouble()) {
+      m_concurrencyPolicy.shrinkCooldownMs = qRound(ac.value("cooldownSec").toDouble() * 1000);
+      m_concurrencyPolicy.growCooldownMs = m_concurrencyPolicy.shrinkCooldownMs * 3;
+    }
+  }
 }
 
 // ----------------------------------------------------------------------------
@@ -127,6 +158,16 @@ QString AppConfig::appId() const { return m_appId; }
 
 QString AppConfig::mode() const { return m_mode; }
 
+int AppConfig::tokenTtlHours() const { return m_tokenTtlHours; }
+
+ConcurrencyPolicy AppConfig::concurrencyPolicy() const { return m_concurrencyPolicy; }
+
+bool AppConfig::tokenCacheEnabled() const { return m_tokenCacheEnabled; }
+
+int AppConfig::probeCacheTtlMinutes() const { return m_probeCacheTtlMinutes; }
+
+Logger::OverflowPolicy AppConfig::logOverflowPolicy() const { return m_logOverflowPolicy; }
+
 QStringList AppConfig::configNames() const { return m_configNames; }
 
 QString AppConfig::currentConfigName() const { return m_currentConfigName; }
@@ -5,6 +5,9 @@
 #include <QString>
 #include <QStringList>
 
+#include "core/ConcurrencyController.h"
+#include "utils/Logger.h"
+
 /**
  * @brief 应用配置单例
  *
@@ -30,6 +33,24 @@ class AppConfig : public QObject {
   QString appId() const;
   QString mode() const;
 
+  /** 访问令牌有效期（小时），随请求发送 ExpirationDuration；<= 0 时不发送也不缓存 */
+  int tokenTtlHours() const;
+
+  /** 是否在本地缓存访问令牌，有效期内重启时复用 */
+  bool tokenCacheEnabled() const;
+
+  /** 节点探测结果的落盘有效期（分钟），启动时在该时间内的排名直接用于选择节点；<= 0 时不落盘 */
+  int probeCacheTtlMinutes() const;
+
+  /** 日志队列满时的处理策略："block" / "dropOldest"（默认）/ "dropNewest" */
+  Logger::OverflowPolicy logOverflowPolicy() const;
+
+  /**
+   * 自适应并发策略，来自 "adaptiveConcurrency": {enabled, min, max, cpuHigh, cpuLow, cooldownSec}；
+   * cooldownSec 为收缩冷却，扩张冷却取其 3 倍
+   */
+  ConcurrencyPolicy concurrencyPolicy() const;
+
   /** 扫描到的配置名列表（不含后缀），不含"默认"条目 */
   QStringList configNames() const;
 
@@ -72,6 +93,11 @@ class AppConfig : public QObject {
   QString m_instanceIds = "";
   QString m_appId = "";
   QString m_mode = "";
+  int m_tokenTtlHours = 12;
+  bool m_tokenCacheEnabled = true;
+  int m_probeCacheTtlMinutes = 30;
+  Logger::OverflowPolicy m_logOverflowPolicy = Logger::kDropOldest;
+  ConcurrencyPolicy m_concurrencyPolicy;
 
   QStringList m_configNames;
   QString m_currentConfigName = "";  // 空字符串表示使用默认 config.json
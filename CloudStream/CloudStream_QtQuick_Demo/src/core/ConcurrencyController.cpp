@@ -0,0 +1,186 @@
+#include "ConcurrencyController.h"
+
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <algorithm>
+
+#include "utils/Logger.h"
+
+ConcurrencyController::ConcurrencyController(QObject* parent) : QObject(parent) {
+  m_timer = new QTimer(this);
+  m_timer->setInterval(kEvaluateIntervalMs);
+  connect(m_timer, &QTimer::timeout, this, &ConcurrencyController::evaluate);
+}
+
+void ConcurrencyController::start(const ConcurrencyPolicy& policy, int sessionMax) {
+  m_policy = policy;
+  sessionMax = std::max(1, sessionMax);
+  m_maxStreams = policy.maxStreams > 0 ? std::min(policy.maxStreams, sessionMax) : sessionMax;
+  m_minStreams = std::clamp(policy.minStreams, 1, m_maxStreams);
+  m_limit = m_maxStreams;
+  m_sinceChangeMs = 0;
+  m_cpu = -1;
+  m_cpuSampler.sample();  // 建立基准
+
+  {
+    QMutexLocker locker(&m_mutex);
+    m_prevCounters.clear();
+    m_fps = 0;
+    m_dropRatio = 0;
+    m_decodeLag = 0;
+    m_hasStats = false;
+    m_freshStats = false;
+  }
+
+  m_enabled = policy.enabled;
+  if (policy.enabled) {
+    m_timer->start();
+  } else {
+    m_timer->stop();
+  }
+  Logger::info(QString("[ConcurrencyController] 启动: limit=%1, 范围=[%2, %3], 自适应=%4")
+                   .arg(m_limit)
+                   .arg(m_minStreams)
+                   .arg(m_maxStreams)
+                   .arg(policy.enabled ? "开" : "关"));
+}
+
+void ConcurrencyController::stop() {
+  m_timer->stop();
+  m_enabled = false;
+  QMutexLocker locker(&m_mutex);
+  m_prevCounters.clear();
+  m_hasStats = false;
+  m_freshStats = false;
+}
+
+void ConcurrencyController::onClientStats(const QString& statsJson) {
+  if (!m_enabled.load(std::memory_order_relaxed)) {
+    return;
+  }
+  QJsonDocument doc = QJsonDocument::fromJson(statsJson.toUtf8());
+  if (!doc.isObject()) {
+    return;
+  }
+  QJsonObject root = doc.object();
+
+  // 多流场景下每路统计位于 video_streams.<instance_id>，否则使用顶层字段
+  QHash<QString, QJsonObject> streams;
+  if (root.value("video_streams").isObject()) {
+    QJsonObject videoStreams = root.value("video_streams").toObject();
+    for (auto it = videoStreams.begin(); it != videoStreams.end(); ++it) {
+      if (it.value().isObject()) {
+        streams.insert(it.key(), it.value().toObject());
+      }
+    }
+  } else {
+    streams.insert(QString(), root);
+  }
+
+  QMutexLocker locker(&m_mutex);
+  QHash<QString, StreamCounters> current;
+  double deltaRecv = 0, deltaDecode = 0, deltaDrop = 0, fpsSum = 0;
+  int fpsCount = 0;
+  for (auto it = streams.begin(); it != streams.end(); ++it) {
+    const QJsonObject& o = it.value();
+    StreamCounters c;
+    c.frameRecv = o.value("frame_recv").toDouble();
+    c.frameDecode = o.value("frame_decode").toDouble();
+    c.frameDrop = o.value("frame_drop").toDouble();
+    double fps = o.value("fps").toDouble();
+    if (fps > 0) {
+      fpsSum += fps;
+      fpsCount++;
+    }
+
+    // 计数器为累计值；新出现或被重置的流只记录基准，不参与本轮计算
+    auto prev = m_prevCounters.constFind(it.key());
+    if (prev != m_prevCounters.constEnd() && c.frameRecv >= prev->frameRecv) {
+      deltaRecv += c.frameRecv - prev->frameRecv;
+      deltaDecode += std::max(0.0, c.frameDecode - prev->frameDecode);
+      deltaDrop += std::max(0.0, c.frameDrop - prev->frameDrop);
+    }
+    current.insert(it.key(), c);
+  }
+  m_prevCounters.swap(current);
+
+  if (deltaRecv <= 0) {
+    return;
+  }
+
+  double fps = fpsCount > 0 ? fpsSum / fpsCount : 0;
+  double drop = std::min(1.0, deltaDrop / deltaRecv);
+  double lag = std::clamp((deltaRecv - deltaDecode) / deltaRecv, 0.0, 1.0);
+  if (!m_hasStats) {
+    m_fps = fps;
+    m_dropRatio = drop;
+    m_decodeLag = lag;
+    m_hasStats = true;
+  } else {
+    m_fps += kSmoothing * (fps - m_fps);
+    m_dropRatio += kSmoothing * (drop - m_dropRatio);
+    m_decodeLag += kSmoothing * (lag - m_decodeLag);
+  }
+  m_freshStats = true;
+}
+
+void ConcurrencyController::evaluate() {
+  m_sinceChangeMs += kEvaluateIntervalMs;
+  double cpu = m_cpuSampler.sample();
+  if (cpu >= 0) {
+    m_cpu = m_cpu < 0 ? cpu : m_cpu + kSmoothing * (cpu - m_cpu);
+  }
+
+  double fps, drop, lag;
+  {
+    QMutexLocker locker(&m_mutex);
+    if (!m_freshStats) {
+      return;
+    }
+    m_freshStats = false;
+    fps = m_fps;
+    drop = m_dropRatio;
+    lag = m_decodeLag;
+  }
+
+  // fps 只作参考：静止画面本身帧率就低，不能据此判断过载
+  QString reason;
+  if (m_cpu > m_policy.cpuHigh) {
+    reason = QString("CPU %1% > %2%").arg(m_cpu * 100, 0, 'f', 0).arg(m_policy.cpuHigh * 100, 0, 'f', 0);
+  } else if (drop > kDropHigh) {
+    reason = QString("丢帧率 %1% > %2%").arg(drop * 100, 0, 'f', 1).arg(kDropHigh * 100, 0, 'f', 1);
+  } else if (lag > kDecodeLagHigh) {
+    reason = QString("解码积压 %1% > %2%").arg(lag * 100, 0, 'f', 1).arg(kDecodeLagHigh * 100, 0, 'f', 1);
+  }
+  bool overload = !reason.isEmpty();
+
+  int next = m_limit;
+  if (overload) {
+    if (m_limit <= m_minStreams || m_sinceChangeMs < m_policy.shrinkCooldownMs) {
+      return;
+    }
+    next = std::max(m_minStreams, m_limit - std::max(1, m_limit / 4));
+  } else {
+    // 没有 CPU 样本（采样失败或尚未采到）时不扩张
+    bool headroom = m_cpu >= 0 && m_cpu < m_policy.cpuLow && drop < kDropHigh * 0.5 && lag < kDecodeLagHigh * 0.5;
+    if (!headroom || m_limit >= m_maxStreams || m_sinceChangeMs < m_policy.growCooldownMs) {
+      return;
+    }
+    next = m_limit + 1;
+    reason = "资源有余量";
+  }
+
+  Logger::info(QString("[ConcurrencyController] %1 %2 -> %3: %4 (fps=%5, 丢帧=%6%, 解码积压=%7%, CPU=%8%)")
+                   .arg(overload ? "收缩" : "扩张")
+                   .arg(m_limit)
+                   .arg(next)
+                   .arg(reason)
+                   .arg(fps, 0, 'f', 1)
+                   .arg(drop * 100, 0, 'f', 1)
+                   .arg(lag * 100, 0, 'f', 1)
+                   .arg(m_cpu * 100, 0, 'f', 0));
+  m_limit = next;
+  m_sinceChangeMs = 0;
+  emit limitChanged(m_limit, reason);
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QTimer>
+#include <atomic>
+
+#include "utils/CpuUsageSampler.h"
+
+/**
+ * @brief 自适应并发策略（来自配置）
+ */
+struct ConcurrencyPolicy {
+  bool enabled = true;          ///< 关闭时固定为会话的并发上限
+  int minStreams = 1;           ///< 并发数下限
+  int maxStreams = 0;           ///< 并发数上限，<= 0 或超过会话的 concurrentStreamingInstances 时取后者
+  double cpuHigh = 0.85;        ///< CPU 占用率高于该值视为过载
+  double cpuLow = 0.60;         ///< CPU 占用率低于该值才允许扩张
+  int shrinkCooldownMs = 3000;  ///< 上次调整后至少间隔多久才能收缩
+  int growCooldownMs = 10000;   ///< 上次调整后至少间隔多久才能扩张
+};
+
+/**
+ * @brief 自适应并发拉流控制器
+ *
+ * 根据 TCR_SESSION_EVENT_CLIENT_STATS（帧率、丢帧、解码进度）和本机 CPU 占用率，
+ * 在 [minStreams, maxStreams] 范围内动态调整同时拉流的实例数：
+ * - 过载（CPU 过高 / 丢帧率过高 / 解码跟不上）时按当前值的 1/4 收缩
+ * - 各项指标均有余量时每次扩张 1 路
+ * - 指标经 EWMA 平滑，两次调整之间有冷却时间，避免来回抖动
+ *
+ * 每次调整都会记录日志（包含触发原因和当时的指标），并通过 limitChanged 信号通知调用方重新切换拉流实例。
+ */
+class ConcurrencyController : public QObject {
+  Q_OBJECT
+
+ public:
+  explicit ConcurrencyController(QObject* parent = nullptr);
+
+  /**
+   * @brief 开始调控，初始并发数为上限
+   * @param policy 调控策略
+   * @param sessionMax 创建会话时的 concurrentStreamingInstances，SDK 不允许超过该值
+   */
+  void start(const ConcurrencyPolicy& policy, int sessionMax);
+
+  /**
+   * @brief 停止调控并清空统计
+   */
+  void stop();
+
+  /**
+   * @brief 当前允许同时拉流的实例数
+   */
+  int limit() const { return m_limit; }
+
+  /**
+   * @brief 输入客户端统计数据（可在 SDK 回调线程调用）
+   * @param statsJson TCR_SESSION_EVENT_CLIENT_STATS 事件数据
+   */
+  void onClientStats(const QString& statsJson);
+
+ signals:
+  /**
+   * @brief 并发数变化
+   * @param limit 新的并发数
+   * @param reason 调整原因
+   */
+  void limitChanged(int limit, const QString& reason);
+
+ private slots:
+  void evaluate();
+
+ private:
+  struct StreamCounters {
+    double frameRecv = 0;
+    double frameDecode = 0;
+    double frameDrop = 0;
+  };
+
+  static constexpr int kEvaluateIntervalMs = 1000;
+  static constexpr double kDropHigh = 0.05;         ///< 丢帧率高于该值视为过载
+  static constexpr double kDecodeLagHigh = 0.10;    ///< 已接收但未解码的帧比例高于该值视为解码跟不上
+  static constexpr double kSmoothing = 0.3;         ///< EWMA 平滑系数
+
+  QTimer* m_timer = nullptr;
+  CpuUsageSampler m_cpuSampler;
+  double m_cpu = -1;  ///< 平滑后的 CPU 占用率，<0 表示尚无数据
+  ConcurrencyPolicy m_policy;
+  std::atomic<bool> m_enabled{false};  ///< SDK 线程读取，决定是否解析统计
+  int m_minStreams = 1;
+  int m_maxStreams = 1;
+  int m_limit = 1;
+  qint64 m_sinceChangeMs = 0;
+
+  // 以下字段由 SDK 线程写入，受 m_mutex 保护
+  QMutex m_mutex;
+  QHash<QString, StreamCounters> m_prevCounters;
+  double m_fps = 0;
+  double m_dropRatio = 0;
+  double m_decodeLag = 0;
+  bool m_hasStats = false;
+  bool m_freshStats = false;
+};
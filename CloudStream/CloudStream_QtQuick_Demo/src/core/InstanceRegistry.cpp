@@ -0,0 +1,52 @@
+#include "InstanceRegistry.h"
+
+#include <QReadLocker>
+#include <QWriteLocker>
+#include <cstring>
+
+InstanceHandle InstanceRegistry::intern(const QString& instanceId) {
+  QByteArray key = instanceId.toUtf8();
+  {
+    QReadLocker locker(&m_lock);
+    auto it = m_handles.constFind(key);
+    if (it != m_handles.constEnd()) {
+      return it.value();
+    }
+  }
+
+  QWriteLocker locker(&m_lock);
+  auto it = m_handles.constFind(key);
+  if (it != m_handles.constEnd()) {
+    return it.value();
+  }
+  InstanceHandle handle = m_ids.size();
+  m_ids.append(instanceId);
+  m_handles.insert(key, handle);
+  return handle;
+}
+
+InstanceHandle InstanceRegistry::find(const QString& instanceId) const {
+  QByteArray key = instanceId.toUtf8();
+  QReadLocker locker(&m_lock);
+  return m_handles.value(key, kInvalidInstanceHandle);
+}
+
+InstanceHandle InstanceRegistry::find(const char* utf8InstanceId) const {
+  if (!utf8InstanceId) {
+    return kInvalidInstanceHandle;
+  }
+  // fromRawData 不拷贝数据，仅用于本次查找
+  QByteArray key = QByteArray::fromRawData(utf8InstanceId, static_cast<qsizetype>(std::strlen(utf8InstanceId)));
+  QReadLocker locker(&m_lock);
+  return m_handles.value(key, kInvalidInstanceHandle);
+}
+
+QString InstanceRegistry::idOf(InstanceHandle handle) const {
+  QReadLocker locker(&m_lock);
+  return handle >= 0 && handle < m_ids.size() ? m_ids[handle] : QString();
+}
+
+int InstanceRegistry::size() const {
+  QReadLocker locker(&m_lock);
+  return m_ids.size();
+}
@@ -0,0 +1,209 @@
+#include "ProbeManager.h"
+
+#include <algorithm>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+
+#include "utils/Logger.h"
+#include "utils/StartupTimeline.h"
+
+namespace {
+
+/// 结果每 2 秒更新一次，排名不变时最多每分钟落盘一次
+constexpr int kSaveIntervalSec = 60;
+
+}  // namespace
+
+ProbeManager::ProbeManager(std::unique_ptr<ProbeSource> source, int cacheTtlMinutes, const QString& cachePath,
+                           QObject* parent)
+    : QObject(parent), m_source(std::move(source)), m_cacheTtlMinutes(cacheTtlMinutes), m_cachePath(cachePath) {
+  loadCache();
+}
+
+ProbeManager::~ProbeManager() { stop(); }
+
+void ProbeManager::setSource(std::unique_ptr<ProbeSource> source) {
+  stop();
+  m_source = std::move(source);
+}
+
+bool ProbeManager::start() {
+  if (m_running) {
+    return true;
+  }
+  if (!m_source) {
+    return false;
+  }
+  m_running = m_source->start([this](const QVector<ProbeNode>& nodes, bool ready) {
+    QMetaObject::invokeMethod(this, [this, nodes, ready]() { onResult(nodes, ready); }, Qt::QueuedConnection);
+  });
+  if (m_running) {
+    Logger::info("[ProbeManager] 开始主动探测");
+    StartupTimeline::instance()->mark("probe_started");
+  }
+  return m_running;
+}
+
+void ProbeManager::stop() {
+  if (m_running && m_source) {
+    m_source->stop();
+  }
+  m_running = false;
+}
+
+QByteArray ProbeManager::preferredDomain() const {
+  const ProbeNode* node = best();
+  if (!node || node->domain.isEmpty()) {
+    return QByteArray();
+  }
+  Logger::info(QString("[ProbeManager] 首选节点 %1 (%2), 评分 %3, RTT %4 ms%5")
+                   .arg(node->zone, node->domain)
+                   .arg(node->qualityScore, 0, 'f', 1)
+                   .arg(node->rttMs, 0, 'f', 1)
+                   .arg(m_fromCache ? ", 来自缓存" : ""));
+  return node->domain.toUtf8();
+}
+
+QVariantMap ProbeManager::bestNode() const {
+  const ProbeNode* node = best();
+  if (!node) {
+    return QVariantMap();
+  }
+  QVariantMap map = toVariant(*node);
+  map["fromCache"] = m_fromCache;
+  map["ageSec"] = m_measuredAt.secsTo(QDateTime::currentDateTimeUtc());
+  return map;
+}
+
+QVariantList ProbeManager::nodeList() const {
+  QVariantList list;
+  for (const ProbeNode& node : m_nodes) {
+    list.append(toVariant(node));
+  }
+  return list;
+}
+
+QVariantMap ProbeManager::toVariant(const ProbeNode& node) {
+  QVariantMap map;
+  map["zone"] = node.zone;
+  map["domain"] = node.domain;
+  map["rttMs"] = node.rttMs;
+  map["jitterMs"] = node.jitterMs;
+  map["lossRate"] = node.lossRate;
+  map["qualityScore"] = node.qualityScore;
+  map["connectTimeMs"] = node.connectTimeMs;
+  return map;
+}
+
+void ProbeManager::onResult(QVector<ProbeNode> nodes, bool ready) {
+  // 部分节点尚未完成时不覆盖缓存中的完整排名
+  if (!m_running || nodes.isEmpty() || (!ready && m_fromCache)) {
+    return;
+  }
+  std::stable_sort(nodes.begin(), nodes.end(),
+                   [](const ProbeNode& a, const ProbeNode& b) { return a.qualityScore > b.qualityScore; });
+
+  const QString prevDomain = m_nodes.isEmpty() ? QString() : m_nodes.first().domain;
+  const bool firstReady = ready && !m_ready;
+  m_nodes = nodes;
+  m_measuredAt = QDateTime::currentDateTimeUtc();
+  m_fromCache = false;
+  m_ready = m_ready || ready;
+
+  const ProbeNode& top = m_nodes.first();
+  if (firstReady || top.domain != prevDomain) {
+    Logger::info(QString("[ProbeManager] 探测%1，%2 个节点，最佳 %3 (%4) 评分 %5, RTT %6 ms, 抖动 %7 ms, 丢包 %8%")
+                     .arg(ready ? "完成" : "中")
+                     .arg(m_nodes.size())
+                     .arg(top.zone, top.domain)
+                     .arg(top.qualityScore, 0, 'f', 1)
+                     .arg(top.rttMs, 0, 'f', 1)
+                     .arg(top.jitterMs, 0, 'f', 1)
+                     .arg(top.lossRate * 100, 0, 'f', 1));
+  }
+  if (firstReady) {
+    StartupTimeline::instance()->mark("probe_ready");
+  }
+  if (ready && (firstReady || top.domain != prevDomain || !m_savedAt.isValid() ||
+                m_savedAt.secsTo(m_measuredAt) >= kSaveIntervalSec)) {
+    saveCache();
+  }
+  emit nodesChanged();
+}
+
+void ProbeManager::loadCache() {
+  if (m_cacheTtlMinutes <= 0 || m_cachePath.isEmpty()) {
+    return;
+  }
+  QFile file(m_cachePath);
+  if (!file.open(QIODevice::ReadOnly)) {
+    return;
+  }
+  const QJsonObject obj = QJsonDocument::fromJson(file.readAll()).object();
+  const QDateTime measuredAt = QDateTime::fromSecsSinceEpoch(obj["measuredAt"].toInteger());
+  const qint64 ageSec = measuredAt.secsTo(QDateTime::currentDateTimeUtc());
+  if (ageSec < 0 || ageSec > qint64(m_cacheTtlMinutes) * 60) {
+    Logger::info(QString("[ProbeManager] 节点缓存已过期（%1 s 前），忽略").arg(ageSec));
+    return;
+  }
+
+  QVector<ProbeNode> nodes;
+  for (const QJsonValue& value : obj["nodes"].toArray()) {
+    const QJsonObject n = value.toObject();
+    ProbeNode node;
+    node.zone = n["zone"].toString();
+    node.domain = n["domain"].toString();
+    node.rttMs = n["rttMs"].toDouble();
+    node.jitterMs = n["jitterMs"].toDouble();
+    node.lossRate = n["lossRate"].toDouble();
+    node.qualityScore = n["qualityScore"].toDouble();
+    node.connectTimeMs = n["connectTimeMs"].toInteger();
+    if (!node.domain.isEmpty()) {
+      nodes.append(node);
+    }
+  }
+  if (nodes.isEmpty()) {
+    return;
+  }
+  m_nodes = nodes;
+  m_measuredAt = measuredAt;
+  m_fromCache = true;
+  Logger::info(QString("[ProbeManager] 使用 %1 s 前的节点排名，最佳 %2 (%3)")
+                   .arg(ageSec)
+                   .arg(m_nodes.first().zone, m_nodes.first().domain));
+}
+
+void ProbeManager::saveCache() {
+  if (m_cacheTtlMinutes <= 0 || m_cachePath.isEmpty()) {
+    return;
+  }
+  QJsonArray nodes;
+  for (const ProbeNode& node : m_nodes) {
+    QJsonObject n;
+    n["zone"] = node.zone;
+    n["domain"] = node.domain;
+    n["rttMs"] = node.rttMs;
+    n["jitterMs"] = node.jitterMs;
+    n["lossRate"] = node.lossRate;
+    n["qualityScore"] = node.qualityScore;
+    n["connectTimeMs"] = node.connectTimeMs;
+    nodes.append(n);
+  }
+  QJsonObject obj;
+  obj["measuredAt"] = m_measuredAt.toSecsSinceEpoch();
+  obj["nodes"] = nodes;
+
+  QDir().mkpath(QFileInfo(m_cachePath).absolutePath());
+  QSaveFile file(m_cachePath);
+  if (!file.open(QIODevice::WriteOnly) || file.write(QJsonDocument(obj).toJson(QJsonDocument::Compact)) < 0 ||
+      !file.commit()) {
+    Logger::warning(QString("[ProbeManager] 无法写入节点缓存 %1").arg(m_cachePath));
+    return;
+  }
+  m_savedAt = m_measuredAt;
+}
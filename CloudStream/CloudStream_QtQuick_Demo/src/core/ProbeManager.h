@@ -0,0 +1,128 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <QDateTime>
+#include <QObject>
+#include <QString>
+#include <QVariantList>
+#include <QVariantMap>
+#include <QVector>
+
+/**
+ * @brief 单个加速节点的探测结果（TcrProbeNodeInfo 的拷贝）
+ */
+struct ProbeNode {
+  QString zone;
+  QString domain;
+  double rttMs = 0;
+  double jitterMs = 0;
+  double lossRate = 0;      ///< 0.0~1.0
+  double qualityScore = 0;  ///< 0~100，越高越好
+  qint64 connectTimeMs = 0;
+};
+
+/**
+ * @brief 探测数据来源
+ *
+ * 默认实现调用 tcr_client_start_probe；替换为假数据源即可在没有网络和 SDK 的情况下驱动 ProbeManager。
+ * 回调可以在任意线程触发。
+ */
+class ProbeSource {
+ public:
+  using ResultCallback = std::function<void(const QVector<ProbeNode>& nodes, bool ready)>;
+
+  virtual ~ProbeSource() = default;
+
+  /**
+   * @brief 开始探测，结果通过 callback 持续返回
+   * @return false 表示暂时无法开始（如 SDK 未就绪），稍后可重试
+   */
+  virtual bool start(ResultCallback callback) = 0;
+  virtual void stop() = 0;
+};
+
+/**
+ * @brief 加速节点主动探测管理
+ *
+ * 原先每个会话都是冷启动：创建会话后才由被动探测选择节点。现在：
+ * - 构造时读取上次落盘的节点排名（在 probeCacheTtlMinutes 有效期内），首次探测完成前即可使用
+ * - tcr_client_init 成功后开始主动探测（tcr_client_start_probe 需要已初始化的客户端，
+ *   因此在此之前只有落盘的排名可用，预连接阶段不会提前探测）
+ * - 探测完成的结果按 quality_score 排名并落盘
+ * - 创建会话时通过 preferredDomain() 填入 TcrSessionConfig::preferred_domain，
+ *   QML 通过 bestNode 属性在 StatsOverlay 中显示当前节点的评分
+ *
+ * 只在 GUI 线程使用，数据源回调经队列转到 GUI 线程处理。
+ * instance() 是生产环境装配（SDK 数据源 + AppConfig + AppLocalDataLocation），测试可直接构造独立实例。
+ */
+class ProbeManager : public QObject {
+  Q_OBJECT
+
+  Q_PROPERTY(QVariantMap bestNode READ bestNode NOTIFY nodesChanged)
+  Q_PROPERTY(QVariantList nodes READ nodeList NOTIFY nodesChanged)
+
+ public:
+  /**
+   * @brief 应用单例：SDK 数据源，缓存有效期取 probeCacheTtlMinutes，落盘到 AppLocalDataLocation
+   */
+  static ProbeManager* instance();
+
+  /**
+   * @param source 探测数据源
+   * @param cacheTtlMinutes 落盘排名的有效期，<= 0 时不读写缓存
+   * @param cachePath 排名落盘路径，为空时不读写缓存
+   */
+  ProbeManager(std::unique_ptr<ProbeSource> source, int cacheTtlMinutes, const QString& cachePath,
+               QObject* parent = nullptr);
+  ~ProbeManager() override;
+
+  /**
+   * @brief 替换数据源（需在 start() 之前调用），默认使用 SDK 主动探测
+   */
+  void setSource(std::unique_ptr<ProbeSource> source);
+
+  /**
+   * @brief 开始探测；已在探测中时直接返回 true
+   */
+  bool start();
+  void stop();
+
+  bool isRunning() const { return m_running; }
+
+  /**
+   * @brief 排名第一的节点；没有可用结果时返回 nullptr
+   */
+  const ProbeNode* best() const { return m_nodes.isEmpty() ? nullptr : &m_nodes.first(); }
+
+  /**
+   * @brief 创建会话时使用的首选节点域名（UTF-8），没有可用结果时为空
+   */
+  QByteArray preferredDomain() const;
+
+  /**
+   * @brief 供 QML 使用：zone/domain/rttMs/jitterMs/lossRate/qualityScore/fromCache/ageSec，没有结果时为空
+   */
+  QVariantMap bestNode() const;
+  QVariantList nodeList() const;
+
+ signals:
+  void nodesChanged();
+
+ private:
+  void onResult(QVector<ProbeNode> nodes, bool ready);
+  void loadCache();
+  void saveCache();
+
+  static QVariantMap toVariant(const ProbeNode& node);
+
+  std::unique_ptr<ProbeSource> m_source;
+  int m_cacheTtlMinutes = 0;
+  QString m_cachePath;
+  bool m_running = false;
+  bool m_ready = false;        ///< 本次运行已收到完整的探测结果
+  QVector<ProbeNode> m_nodes;  ///< 按 qualityScore 降序
+  QDateTime m_measuredAt;      ///< m_nodes 的探测时间
+  bool m_fromCache = false;    ///< m_nodes 来自上次落盘的结果
+  QDateTime m_savedAt;
+};
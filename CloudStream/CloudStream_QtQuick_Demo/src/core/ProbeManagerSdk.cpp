@@ -0,0 +1,84 @@
+/**
+ * @file ProbeManagerSdk.cpp
+ * @brief ProbeManager 的生产环境装配：SDK 数据源、AppConfig 中的缓存有效期和落盘路径
+ *
+ * 与 ProbeManager.cpp 分开，测试只编译 ProbeManager.cpp 即可用假数据源驱动独立的实例。
+ */
+
+#include <QCoreApplication>
+#include <QStandardPaths>
+
+#include "AppConfig.h"
+#include "ProbeManager.h"
+#include "tcr_c_api.h"
+#include "utils/Logger.h"
+
+namespace {
+
+/**
+ * @brief 基于 tcr_client_start_probe 的数据源，需在 tcr_client_init 成功之后启动
+ */
+class SdkProbeSource : public ProbeSource {
+ public:
+  ~SdkProbeSource() override { stop(); }
+
+  bool start(ResultCallback callback) override {
+    m_callback = std::move(callback);
+    TcrErrorCode code = tcr_client_start_probe(tcr_client_get_instance(), &SdkProbeSource::onResult, this);
+    if (code != TCR_SUCCESS) {
+      Logger::warning(QString("[ProbeManager] tcr_client_start_probe 失败, code=%1").arg(code));
+      return false;
+    }
+    m_started = true;
+    return true;
+  }
+
+  void stop() override {
+    if (m_started) {
+      tcr_client_stop_probe(tcr_client_get_instance());
+      m_started = false;
+    }
+  }
+
+ private:
+  /// SDK 内部线程回调，result 只在回调期间有效，这里直接拷贝
+  static void onResult(void* user_data, const TcrProbeResult* result) {
+    auto* self = static_cast<SdkProbeSource*>(user_data);
+    if (!self || !result) {
+      return;
+    }
+    QVector<ProbeNode> nodes;
+    nodes.reserve(result->node_count);
+    for (int i = 0; i < result->node_count; ++i) {
+      const TcrProbeNodeInfo& info = result->nodes[i];
+      ProbeNode node;
+      node.zone = QString::fromUtf8(info.zone ? info.zone : "");
+      node.domain = QString::fromUtf8(info.domain ? info.domain : "");
+      node.rttMs = info.rtt_ms;
+      node.jitterMs = info.jitter_ms;
+      node.lossRate = info.packet_loss_rate;
+      node.qualityScore = info.quality_score;
+      node.connectTimeMs = info.connect_time_ms;
+      nodes.append(node);
+    }
+    self->m_callback(nodes, result->is_ready);
+  }
+
+  ResultCallback m_callback;
+  bool m_started = false;
+};
+
+}  // namespace
+
+ProbeManager* ProbeManager::instance() {
+  // 在 main 中首次调用，保证对象属于 GUI 线程
+  static ProbeManager* manager = []() {
+    auto* m = new ProbeManager(std::make_unique<SdkProbeSource>(), AppConfig::instance()->probeCacheTtlMinutes(),
+                               QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) +
+                                   "/probe_cache.json");
+    // 单例不会析构，退出前停止探测释放连接
+    QObject::connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, m, &ProbeManager::stop);
+    return m;
+  }();
+  return manager;
+}
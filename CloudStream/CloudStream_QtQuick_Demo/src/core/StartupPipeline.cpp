@@ -0,0 +1,105 @@
+#include "StartupPipeline.h"
+
+#include <QMetaObject>
+#include <QMutexLocker>
+#include <QtConcurrent>
+#include <string>
+
+#include "ProbeManager.h"
+#include "tcr_c_api.h"
+#include "utils/Logger.h"
+#include "utils/StartupTimeline.h"
+
+QFuture<void> StartupPipeline::s_prepare;
+QFuture<TcrErrorCode> StartupPipeline::s_init;
+QString StartupPipeline::s_initAccessInfo;
+QString StartupPipeline::s_initToken;
+bool StartupPipeline::s_initStarted = false;
+QMutex StartupPipeline::s_mutex;
+
+void StartupPipeline::prepareSdkAsync() {
+  QMutexLocker locker(&s_mutex);
+  if (s_prepare.isValid()) {
+    return;
+  }
+  s_prepare = QtConcurrent::run([]() {
+    StartupTimeline::instance()->begin("tcr_prepare");
+    tcr_client_prepare(tcr_client_get_instance());
+    StartupTimeline::instance()->end("tcr_prepare");
+  });
+}
+
+void StartupPipeline::waitSdkPrepared() {
+  QMutexLocker locker(&s_mutex);
+  if (!s_prepare.isValid() || s_prepare.isFinished()) {
+    return;
+  }
+  Logger::info("[StartupPipeline] Waiting for tcr_client_prepare");
+  StartupTimeline::instance()->begin("wait_prepare");
+  s_prepare.waitForFinished();
+  StartupTimeline::instance()->end("wait_prepare");
+}
+
+void StartupPipeline::initSdkAsync(const QString& accessInfo, const QString& token) {
+  QMutexLocker locker(&s_mutex);
+  if (s_initStarted) {
+    return;
+  }
+  s_initStarted = true;
+  s_initAccessInfo = accessInfo;
+  s_initToken = token;
+  QFuture<void> prepare = s_prepare;
+  s_init = QtConcurrent::run([prepare, accessInfo, token]() mutable {
+    if (prepare.isValid()) {
+      prepare.waitForFinished();
+    }
+    TcrErrorCode result = initClient(accessInfo, token);
+    if (result != TCR_SUCCESS) {
+      Logger::warning(QString("[StartupPipeline] 提前初始化 TcrSdk 失败, code=%1").arg(result));
+      return result;
+    }
+    Logger::info("[StartupPipeline] 提前初始化 TcrSdk 成功，开始节点探测");
+    // ProbeManager 属于 GUI 线程
+    ProbeManager* probe = ProbeManager::instance();
+    QMetaObject::invokeMethod(probe, [probe]() { probe->start(); }, Qt::QueuedConnection);
+    return result;
+  });
+}
+
+TcrErrorCode StartupPipeline::initSdk(const QString& accessInfo, const QString& token) {
+  QFuture<TcrErrorCode> early;
+  bool sameCredentials = false;
+  {
+    QMutexLocker locker(&s_mutex);
+    early = s_init;
+    s_init = QFuture<TcrErrorCode>();
+    sameCredentials = s_initAccessInfo == accessInfo && s_initToken == token;
+  }
+  if (early.isValid()) {
+    if (!early.isFinished()) {
+      Logger::info("[StartupPipeline] 等待提前的 tcr_client_init");
+      StartupTimeline::instance()->begin("wait_early_init");
+      early.waitForFinished();
+      StartupTimeline::instance()->end("wait_early_init");
+    }
+    if (sameCredentials && early.result() == TCR_SUCCESS) {
+      return TCR_SUCCESS;
+    }
+  }
+  waitSdkPrepared();
+  return initClient(accessInfo, token);
+}
+
+TcrErrorCode StartupPipeline::initClient(const QString& accessInfo, const QString& token) {
+  std::string tokenStr = token.toStdString();
+  std::string accessInfoStr = accessInfo.toStdString();
+
+  TcrConfig config = tcr_config_default();
+  config.token = tokenStr.c_str();
+  config.accessInfo = accessInfoStr.c_str();
+
+  StartupTimeline::instance()->begin("tcr_client_init");
+  TcrErrorCode result = tcr_client_init(tcr_client_get_instance(), &config);
+  StartupTimeline::instance()->end("tcr_client_init", result == TCR_SUCCESS ? QString() : "failed");
+  return result;
+}
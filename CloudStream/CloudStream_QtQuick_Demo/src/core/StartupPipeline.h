@@ -0,0 +1,56 @@
+#pragma once
+
+#include <QFuture>
+#include <QMutex>
+#include <QString>
+
+#include "tcr_types.h"
+
+/**
+ * @brief 启动流水线中的 SDK 步骤
+ *
+ * 原先启动是串行的：读配置 → 请求令牌 → tcr_client_init → 创建会话 → 连接实例。
+ * 现在 tcr_client_prepare（提前建立网络连接）在 main 中放到线程池执行，
+ * 与 QML 引擎加载、令牌预取（InstanceTokenViewModel::prefetchAccessToken）并行。
+ * 令牌一就绪（命中缓存或预取返回）就在线程池中 tcr_client_init 并开始节点探测（ProbeManager），
+ * 不等用户确认和登录请求；探测需要已初始化的客户端，令牌就绪之前只能使用落盘的节点排名。
+ * tcr_client_init 总在 tcr_client_prepare 返回之后调用，SDK 未说明两者可以并发。
+ */
+class StartupPipeline {
+ public:
+  /**
+   * @brief 在线程池中调用 tcr_client_prepare，只在启动时调用一次
+   */
+  static void prepareSdkAsync();
+
+  /**
+   * @brief 等待 tcr_client_prepare 返回；未启动或已结束时立即返回
+   */
+  static void waitSdkPrepared();
+
+  /**
+   * @brief 启动时令牌就绪后提前初始化 SDK：等待 prepare、tcr_client_init，成功后在 GUI 线程开始节点探测
+   *
+   * 每个进程只执行一次，之后的调用直接返回
+   */
+  static void initSdkAsync(const QString& accessInfo, const QString& token);
+
+  /**
+   * @brief ViewModel 使用的 tcr_client_init
+   *
+   * 提前初始化已用相同凭据成功时直接复用（只复用一次，客户端释放后重新初始化）；
+   * 否则等待提前初始化结束后用给定凭据同步初始化
+   * @return SDK 错误码
+   */
+  static TcrErrorCode initSdk(const QString& accessInfo, const QString& token);
+
+ private:
+  static TcrErrorCode initClient(const QString& accessInfo, const QString& token);
+
+  static QFuture<void> s_prepare;
+  static QFuture<TcrErrorCode> s_init;  ///< 提前初始化，被 initSdk 取走后置为无效
+  static QString s_initAccessInfo;
+  static QString s_initToken;
+  static bool s_initStarted;
+  static QMutex s_mutex;
+};
@@ -0,0 +1,68 @@
+#include "TileProfileLadder.h"
+
+#include <algorithm>
+
+namespace {
+
+struct LadderEntry {
+  int shortEdge;
+  int fps;
+};
+
+constexpr LadderEntry kLadder[] = {{96, 10}, {144, 15}, {192, 20}, {288, 25}, {360, 30}, {480, 30}, {720, 30}};
+
+constexpr qreal kUpscaleTolerance = 1.15;  // 单元格比当前档位大不超过 15% 时不升档
+constexpr qreal kDownscaleMargin = 0.85;   // 单元格比下一档还小 15% 以上才降档
+
+}  // namespace
+
+void TileProfileLadder::reset(int maxShortEdge, int maxFps, int minBitrate, int maxBitrate) {
+  maxShortEdge = std::max(maxShortEdge, 1);
+  maxFps = std::max(maxFps, 1);
+
+  m_steps.clear();
+  for (const LadderEntry& entry : kLadder) {
+    if (entry.shortEdge >= maxShortEdge) {
+      break;
+    }
+    // 码率按像素面积等比缩放
+    qreal area = qreal(entry.shortEdge) * entry.shortEdge / (qreal(maxShortEdge) * maxShortEdge);
+    Step s;
+    s.shortEdge = entry.shortEdge;
+    s.fps = std::min(entry.fps, maxFps);
+    s.maxBitrate = std::max(50, int(maxBitrate * area));
+    s.minBitrate = std::min(s.maxBitrate, std::max(30, int(minBitrate * area)));
+    m_steps.append(s);
+  }
+
+  Step top;
+  top.shortEdge = maxShortEdge;
+  top.fps = maxFps;
+  top.minBitrate = minBitrate;
+  top.maxBitrate = maxBitrate;
+  m_steps.append(top);
+
+  m_current = m_steps.size() - 1;
+}
+
+int TileProfileLadder::select(qreal px) const {
+  if (m_steps.isEmpty() || m_current < 0) {
+    return -1;
+  }
+  if (px <= 0) {
+    return m_current;
+  }
+
+  int top = m_steps.size() - 1;
+  int index = m_current;
+  while (index < top && px > m_steps[index].shortEdge * kUpscaleTolerance) {
+    index++;
+  }
+  if (index != m_current) {
+    return index;
+  }
+  while (index > 0 && px < m_steps[index - 1].shortEdge * kDownscaleMargin) {
+    index--;
+  }
+  return index;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <QVector>
+
+/**
+ * @brief 子码流档位表：按宫格单元格的实际像素尺寸选择分辨率/帧率
+ *
+ * 以 StreamConfig 中配置的子码流参数作为最高档，向下按短边 96/144/192/288/360/480/720 分档，
+ * 码率按像素面积等比缩放，帧率不超过配置值。
+ *
+ * 选档带滞回：单元格比当前档位大 15% 以上才升档，比下一档小 15% 以上才降档，
+ * 避免单元格尺寸在档位边界附近抖动时反复调用 tcr_session_set_remote_video_profile。
+ */
+class TileProfileLadder {
+ public:
+  struct Step {
+    int shortEdge = 0;   ///< 视频短边像素
+    int fps = 0;         ///< 帧率
+    int minBitrate = 0;  ///< 最小码率（kbps）
+    int maxBitrate = 0;  ///< 最大码率（kbps）
+  };
+
+  /**
+   * @brief 以配置的子码流参数重建档位表，当前档位重置为最高档（即会话创建时使用的参数）
+   */
+  void reset(int maxShortEdge, int maxFps, int minBitrate, int maxBitrate);
+
+  /**
+   * @brief 根据单元格物理像素短边选择档位（带滞回，不修改当前档位）
+   * @param tilePixelShortEdge 单元格视频区域短边 × devicePixelRatio
+   * @return 档位下标；档位表为空时返回 -1
+   */
+  int select(qreal tilePixelShortEdge) const;
+
+  int currentIndex() const { return m_current; }
+  void setCurrentIndex(int index) { m_current = index; }
+  const Step& step(int index) const { return m_steps[index]; }
+
+ private:
+  QVector<Step> m_steps;
+  int m_current = -1;
+};
@@ -0,0 +1,255 @@
+#include "TokenCache.h"
+
+#include <QDir>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRandomGenerator>
+#include <QStandardPaths>
+
+#ifdef _WIN32
+#include <QSaveFile>
+#include <windows.h>
+#include <wincrypt.h>
+#pragma comment(lib, "crypt32.lib")
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "AppConfig.h"
+#include "utils/AesGcm.h"
+#include "utils/Logger.h"
+
+namespace {
+
+/// 文件头标识格式版本，其他版本读到时删除（TCK2 在非 Windows 平台上是明文）
+#ifdef _WIN32
+const QByteArray kMagic("TCK2");  ///< DPAPI 密文
+#else
+const QByteArray kMagic("TCK3");  ///< nonce || AES-256-GCM 密文 || 标签，文件头作为附加认证数据
+#endif
+const char kCacheFile[] = "/token_cache.bin";
+const char kKeyFile[] = "/token_cache.key";
+
+#ifdef _WIN32
+
+/// DPAPI：密钥由系统按当前用户管理，不需要密钥文件
+bool protect(const QString& /*keyDir*/, const QByteArray& plain, QByteArray* out) {
+  DATA_BLOB in{DWORD(plain.size()), reinterpret_cast<BYTE*>(const_cast<char*>(plain.data()))};
+  DATA_BLOB blob{0, nullptr};
+  if (!CryptProtectData(&in, L"CloudStream token cache", nullptr, nullptr, nullptr, CRYPTPROTECT_UI_FORBIDDEN,
+                        &blob)) {
+    return false;
+  }
+  *out = QByteArray(reinterpret_cast<const char*>(blob.pbData), int(blob.cbData));
+  LocalFree(blob.pbData);
+  return true;
+}
+
+bool unprotect(const QString& /*keyDir*/, const QByteArray& data, QByteArray* out) {
+  DATA_BLOB in{DWORD(data.size()), reinterpret_cast<BYTE*>(const_cast<char*>(data.data()))};
+  DATA_BLOB blob{0, nullptr};
+  if (!CryptUnprotectData(&in, nullptr, nullptr, nullptr, nullptr, CRYPTPROTECT_UI_FORBIDDEN, &blob)) {
+    return false;
+  }
+  *out = QByteArray(reinterpret_cast<const char*>(blob.pbData), int(blob.cbData));
+  SecureZeroMemory(blob.pbData, blob.cbData);
+  LocalFree(blob.pbData);
+  return true;
+}
+
+bool writePrivateFile(const QString& path, const QByteArray& data) {
+  QSaveFile file(path);
+  return file.open(QIODevice::WriteOnly) && file.write(data) == data.size() && file.commit();
+}
+
+#else
+
+/// 以 0600 独占新建临时文件（不会沿用已存在文件或符号链接的权限），写完 fsync 后改名覆盖
+bool writePrivateFile(const QString& path, const QByteArray& data) {
+  const QByteArray target = QFile::encodeName(path);
+  const QByteArray tmp = target + ".tmp";
+  ::unlink(tmp.constData());
+  const int fd = ::open(tmp.constData(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+  if (fd < 0) {
+    return false;
+  }
+  bool ok = true;
+  for (qsizetype off = 0; ok && off < data.size();) {
+    const ssize_t n = ::write(fd, data.constData() + off, size_t(data.size() - off));
+    if (n > 0) {
+      off += n;
+    } else {
+      ok = n < 0 && errno == EINTR;
+    }
+  }
+  ok = ::fsync(fd) == 0 && ok;
+  ok = ::close(fd) == 0 && ok;
+  if (!ok || ::rename(tmp.constData(), target.constData()) != 0) {
+    ::unlink(tmp.constData());
+    return false;
+  }
+  return true;
+}
+
+void wipe(QByteArray* data) {
+  volatile char* p = data->data();
+  for (qsizetype i = 0; i < data->size(); ++i) {
+    p[i] = 0;
+  }
+  data->clear();
+}
+
+QByteArray randomBytes(int size) {
+  QByteArray out(size, '\0');
+  QRandomGenerator::system()->generate(out.begin(), out.end());
+  return out;
+}
+
+/// 只接受当前用户所有、组和其他用户无任何权限的 32 字节普通文件，不跟随符号链接
+bool readKey(const QString& path, QByteArray* key) {
+  const int fd = ::open(QFile::encodeName(path).constData(), O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat st;
+  bool ok = ::fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_uid == ::getuid() && (st.st_mode & 077) == 0 &&
+            st.st_size == AesGcm::kKeySize;
+  if (ok) {
+    key->resize(AesGcm::kKeySize);
+    ok = ::read(fd, key->data(), size_t(key->size())) == ssize_t(key->size());
+  }
+  ::close(fd);
+  if (!ok) {
+    wipe(key);
+    Logger::warning(QString("[TokenCache] Ignoring key file %1: not a private %2-byte file of the current user")
+                        .arg(path)
+                        .arg(AesGcm::kKeySize));
+  }
+  return ok;
+}
+
+bool protect(const QString& keyDir, const QByteArray& plain, QByteArray* out) {
+  if (keyDir.isEmpty()) {
+    return false;
+  }
+  const QString path = keyDir + kKeyFile;
+  QByteArray key;
+  if (!readKey(path, &key)) {
+    // 没有可用的密钥时生成新的；旧密钥加密的缓存随之失效
+    key = randomBytes(AesGcm::kKeySize);
+    const bool created = QDir().mkpath(keyDir) &&
+                         QFile::setPermissions(keyDir, QFile::ReadOwner | QFile::WriteOwner | QFile::ExeOwner) &&
+                         writePrivateFile(path, key);
+    if (!created) {
+      wipe(&key);
+      return false;
+    }
+    Logger::info(QString("[TokenCache] Created token cache key %1").arg(path));
+  }
+  const QByteArray nonce = randomBytes(AesGcm::kNonceSize);
+  *out = nonce + AesGcm::seal(key, nonce, plain, kMagic);
+  wipe(&key);
+  return true;
+}
+
+bool unprotect(const QString& keyDir, const QByteArray& data, QByteArray* out) {
+  QByteArray key;
+  if (keyDir.isEmpty() || data.size() < AesGcm::kNonceSize || !readKey(keyDir + kKeyFile, &key)) {
+    return false;
+  }
+  const bool ok = AesGcm::unseal(key, data.left(AesGcm::kNonceSize), data.mid(AesGcm::kNonceSize), kMagic, out);
+  wipe(&key);
+  return ok;
+}
+
+#endif
+
+}  // namespace
+
+TokenCache::TokenCache()
+    : m_dir(QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation)),
+      m_keyDir(QStandardPaths::writableLocation(QStandardPaths::AppConfigLocation)) {
+  // 旧版本把密钥文件放在缓存目录中，已不再使用
+  if (!m_dir.isEmpty() && m_dir != m_keyDir) {
+    QFile::remove(m_dir + kKeyFile);
+  }
+}
+
+QString TokenCache::requestKey(const QStringList& instanceIds, const QString& userIp) {
+  AppConfig* config = AppConfig::instance();
+  return QStringList{config->baseUrl() + config->apiPath(), config->appId(), config->mode(), instanceIds.join(','),
+                     userIp}
+      .join('\n');
+}
+
+bool TokenCache::load(const QString& key, Entry* out) {
+  if (m_dir.isEmpty()) {
+    return false;
+  }
+  QFile file(m_dir + kCacheFile);
+  if (!file.open(QIODevice::ReadOnly)) {
+    return false;
+  }
+  const QByteArray blob = file.readAll();
+  if (!blob.startsWith(kMagic)) {
+    Logger::info("[TokenCache] Removing cache file in an unknown format");
+    file.close();
+    remove();
+    return false;
+  }
+  QByteArray plain;
+  if (!unprotect(m_keyDir, blob.mid(kMagic.size()), &plain)) {
+    Logger::warning("[TokenCache] Cannot decrypt cache file (key missing, different user or damaged), ignoring");
+    return false;
+  }
+
+  const QJsonObject obj = QJsonDocument::fromJson(plain).object();
+  if (obj["key"].toString() != key) {
+    Logger::info("[TokenCache] Cached token is for a different request, ignoring");
+    return false;
+  }
+  Entry entry;
+  entry.accessInfo = obj["accessInfo"].toString();
+  entry.token = obj["token"].toString();
+  entry.expiresAt = QDateTime::fromSecsSinceEpoch(obj["expiresAt"].toInteger());
+  if (entry.accessInfo.isEmpty() || entry.token.isEmpty()) {
+    return false;
+  }
+  const qint64 left = QDateTime::currentDateTimeUtc().secsTo(entry.expiresAt);
+  if (left <= kExpiryMarginSec) {
+    Logger::info(QString("[TokenCache] Cached token expires in %1 s, ignoring").arg(left));
+    return false;
+  }
+  *out = entry;
+  return true;
+}
+
+void TokenCache::store(const QString& key, const Entry& entry) {
+  if (m_dir.isEmpty()) {
+    return;
+  }
+  QJsonObject obj;
+  obj["key"] = key;
+  obj["accessInfo"] = entry.accessInfo;
+  obj["token"] = entry.token;
+  obj["expiresAt"] = entry.expiresAt.toSecsSinceEpoch();
+  QByteArray sealed;
+  if (!protect(m_keyDir, QJsonDocument(obj).toJson(QJsonDocument::Compact), &sealed)) {
+    Logger::warning("[TokenCache] Cannot encrypt token cache, not storing it");
+    return;
+  }
+  QDir().mkpath(m_dir);
+  if (!writePrivateFile(m_dir + kCacheFile, kMagic + sealed)) {
+    Logger::warning(QString("[TokenCache] Cannot write cache file in %1").arg(m_dir));
+  }
+}
+
+void TokenCache::remove() {
+  if (!m_dir.isEmpty()) {
+    QFile::remove(m_dir + kCacheFile);
+  }
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <QDateTime>
+#include <QString>
+#include <QStringList>
+
+/**
+ * @brief 访问令牌本地缓存
+ *
+ * 同一组实例在令牌有效期内重启时直接复用上次的 Token/AccessInfo，省去 CreateAndroidInstancesAccessToken 的往返。
+ *
+ * 落盘保护：Windows 上用 DPAPI（CryptProtectData，绑定当前用户登录凭据）加密，其他用户或拷走文件都无法解密；
+ * 其他平台用 AES-256-GCM（AesGcm）加密，256 位随机密钥按用户保存在配置目录（AppConfigLocation，与缓存所在的
+ * AppLocalDataLocation 分开）的 0600 文件中，只拷走或备份数据目录得不到明文，文件被改动也能发现；
+ * 密钥文件权限过宽或不属于当前用户时不使用，下次写入时重新生成。两种文件都以 O_CREAT|O_EXCL 和 0600 新建再改名。
+ * 解密失败、内容损坏、请求参数不同或即将过期都视为未命中。
+ * 只缓存最近一次请求；非线程安全，只在 GUI 线程使用。
+ */
+class TokenCache {
+ public:
+  struct Entry {
+    QString accessInfo;
+    QString token;
+    QDateTime expiresAt;
+  };
+
+  /// 剩余有效期不足该值时视为过期，留出建连的时间
+  static constexpr int kExpiryMarginSec = 300;
+
+  /**
+   * @brief 缓存放在应用数据目录（QStandardPaths::AppLocalDataLocation），密钥放在配置目录（AppConfigLocation）
+   */
+  TokenCache();
+
+  /**
+   * @brief 一次令牌请求的标识：当前配置的服务地址、AppId、Mode 加上实例列表和用户IP
+   */
+  static QString requestKey(const QStringList& instanceIds, const QString& userIp);
+
+  bool load(const QString& key, Entry* out);
+  void store(const QString& key, const Entry& entry);
+  void remove();
+
+ private:
+  QString m_dir;
+  QString m_keyDir;
+};
@@ -0,0 +1,126 @@
+#include "FrameFreezeCache.h"
+
+#include <QMutexLocker>
+#include <algorithm>
+
+#include "utils/Logger.h"
+
+namespace {
+
+// 最近邻缩放一个平面并写入紧凑缓冲
+void scalePlane(const uint8_t* src, int srcStride, int srcW, int srcH, uint8_t* dst, int dstW, int dstH) {
+  for (int y = 0; y < dstH; ++y) {
+    const uint8_t* row = src + static_cast<qint64>(y * srcH / dstH) * srcStride;
+    for (int x = 0; x < dstW; ++x) {
+      dst[x] = row[x * srcW / dstW];
+    }
+    dst += dstW;
+  }
+}
+
+}  // namespace
+
+FrameFreezeCache::FrameFreezeCache(qint64 byteBudget) : m_byteBudget(byteBudget) {
+  m_pool.setMaxThreadCount(1);
+}
+
+FrameFreezeCache::~FrameFreezeCache() {
+  shutdown();
+}
+
+void FrameFreezeCache::shutdown() {
+  m_pool.clear();
+  m_pool.waitForDone();
+}
+
+void FrameFreezeCache::capture(const QString& instanceId, const VideoFrameDataPtr& frame) {
+  if (!frame || frame->width <= 0 || frame->height <= 0 || !frame->data_y || !frame->data_u || !frame->data_v) {
+    return;
+  }
+
+  m_pool.start([this, instanceId, frame]() {
+    int shortEdge = std::min(frame->width, frame->height);
+    qreal scale = shortEdge > kMaxShortEdge ? qreal(kMaxShortEdge) / shortEdge : 1.0;
+    // I420 要求宽高为偶数
+    int w = std::max(2, int(frame->width * scale) & ~1);
+    int h = std::max(2, int(frame->height * scale) & ~1);
+    int cw = w / 2;
+    int ch = h / 2;
+
+    QByteArray raw(w * h + cw * ch * 2, Qt::Uninitialized);
+    uint8_t* dst = reinterpret_cast<uint8_t*>(raw.data());
+    scalePlane(frame->data_y, frame->strideY, frame->width, frame->height, dst, w, h);
+    scalePlane(frame->data_u, frame->strideU, (frame->width + 1) / 2, (frame->height + 1) / 2, dst + w * h, cw, ch);
+    scalePlane(frame->data_v, frame->strideV, (frame->width + 1) / 2, (frame->height + 1) / 2,
+               dst + w * h + cw * ch, cw, ch);
+
+    Entry entry;
+    entry.width = w;
+    entry.height = h;
+    entry.compressed = qCompress(raw, 1);
+    store(instanceId, std::move(entry));
+  });
+}
+
+void FrameFreezeCache::store(const QString& instanceId, Entry entry) {
+  QMutexLocker locker(&m_mutex);
+  auto it = m_entries.find(instanceId);
+  if (it != m_entries.end()) {
+    m_bytes -= it->compressed.size();
+    m_lru.removeOne(instanceId);
+  }
+  m_bytes += entry.compressed.size();
+  m_entries.insert(instanceId, std::move(entry));
+  m_lru.append(instanceId);
+
+  int evicted = 0;
+  while (m_bytes > m_byteBudget && m_lru.size() > 1) {
+    QString oldest = m_lru.takeFirst();
+    m_bytes -= m_entries.take(oldest).compressed.size();
+    evicted++;
+  }
+  if (evicted > 0) {
+    Logger::debug(QString("[FrameFreezeCache] 淘汰 %1 个冻结帧，当前 %2 个 / %3 KB")
+                      .arg(evicted)
+                      .arg(m_entries.size())
+                      .arg(m_bytes / 1024));
+  }
+}
+
+VideoFrameDataPtr FrameFreezeCache::frozenFrame(const QString& instanceId) {
+  Entry entry;
+  {
+    QMutexLocker locker(&m_mutex);
+    auto it = m_entries.constFind(instanceId);
+    if (it == m_entries.constEnd()) {
+      return VideoFrameDataPtr();
+    }
+    entry = it.value();  // QByteArray 隐式共享，拷贝开销很小
+    m_lru.removeOne(instanceId);
+    m_lru.append(instanceId);
+  }
+
+  QByteArray raw = qUncompress(entry.compressed);
+  int w = entry.width;
+  int h = entry.height;
+  int cw = w / 2;
+  int ch = h / 2;
+  if (raw.size() != w * h + cw * ch * 2) {
+    return VideoFrameDataPtr();
+  }
+
+  VideoFrameDataPtr frame(new VideoFrameData(nullptr, nullptr, nullptr, nullptr, w, cw, cw, w, h, 0));
+  frame->ownedBuffer = raw;
+  const uint8_t* base = reinterpret_cast<const uint8_t*>(frame->ownedBuffer.constData());
+  frame->data_y = base;
+  frame->data_u = base + w * h;
+  frame->data_v = base + w * h + cw * ch;
+  return frame;
+}
+
+void FrameFreezeCache::clear() {
+  QMutexLocker locker(&m_mutex);
+  m_entries.clear();
+  m_lru.clear();
+  m_bytes = 0;
+}
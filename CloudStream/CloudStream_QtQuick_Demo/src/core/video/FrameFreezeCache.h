@@ -0,0 +1,69 @@
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QThreadPool>
+
+#include "Frame.h"
+
+/**
+ * @brief 冻结帧缓存：实例停止拉流后仍能显示其最后一帧
+ *
+ * 实例被切出拉流集合时，将其最后一帧缩小（短边不超过 kMaxShortEdge）并用 zlib 压缩后保存；
+ * 宫格重新创建或滚动回来时先显示冻结帧，直到实时帧恢复。
+ *
+ * - 缩放和压缩在内部的单线程线程池中执行，不占用解码线程和 GUI 线程
+ * - 按压缩后字节数做 LRU 淘汰，总大小不超过 byteBudget
+ */
+class FrameFreezeCache {
+ public:
+  explicit FrameFreezeCache(qint64 byteBudget = 16 * 1024 * 1024);
+  ~FrameFreezeCache();
+
+  /**
+   * @brief 异步保存实例的最后一帧（GUI 线程调用）
+   * @param instanceId 实例ID
+   * @param frame 最后一帧，任务完成后释放
+   */
+  void capture(const QString& instanceId, const VideoFrameDataPtr& frame);
+
+  /**
+   * @brief 获取实例的冻结帧（解压为自持有数据的 I420 帧），并刷新其 LRU 位置
+   * @return 不存在时返回空指针
+   */
+  VideoFrameDataPtr frozenFrame(const QString& instanceId);
+
+  /**
+   * @brief 清空缓存
+   */
+  void clear();
+
+  /**
+   * @brief 丢弃尚未开始的保存任务并等待进行中的任务结束
+   *
+   * 任务持有 SDK 帧引用，必须在 tcr_client_release 之前调用
+   */
+  void shutdown();
+
+ private:
+  struct Entry {
+    int width = 0;
+    int height = 0;
+    QByteArray compressed;  ///< qCompress 后的紧凑 I420 数据
+  };
+
+  static constexpr int kMaxShortEdge = 160;
+
+  void store(const QString& instanceId, Entry entry);
+
+  QThreadPool m_pool;
+  qint64 m_byteBudget;
+
+  QMutex m_mutex;
+  QHash<QString, Entry> m_entries;
+  QList<QString> m_lru;  ///< 最近使用的在末尾
+  qint64 m_bytes = 0;
+};
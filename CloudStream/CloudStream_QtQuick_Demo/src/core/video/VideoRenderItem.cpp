@@ -9,6 +9,7 @@
 #include <QThread>
 
 #include "utils/Logger.h"
+#include "utils/StartupTimeline.h"
 #include "YuvNode.h"
 #include "YuvTestPattern.h"
 
@@ -63,6 +64,7 @@ void VideoRenderItem::setFrame(VideoFrameDataPtr frame) {
 
   // 如果帧状态发生变化，发射信号
   if (wasEmpty && hasFrame()) {
+    StartupTimeline::instance()->finish("first_frame");
     emit hasFrameChanged();
   }
 
@@ -99,8 +101,13 @@ bool VideoRenderItem::hasFrame() const {
  * 如果没有有效帧数据，返回nullptr表示不渲染任何内容。
  */
 QSGNode* VideoRenderItem::updatePaintNode(QSGNode* oldNode, UpdatePaintNodeData*) {
-  // 如果没有有效帧数据，删除旧节点并返回空
+  // 帧引用在上传后即释放，此时纹理仍在 GPU 上：保留旧节点继续显示上一帧，只更新尺寸
   if (!hasFrame()) {
+    if (YuvNode* yuvNode = dynamic_cast<YuvNode*>(oldNode)) {
+      yuvNode->setItemSize(QSizeF(width(), height()));
+      return yuvNode;
+    }
+
     // Logger::info(QString("[VideoRenderItem::updatePaintNode] No frame data, not rendering, "
     //                    "this=%1, thread_id=%2")
     //            .arg(reinterpret_cast<quintptr>(this))
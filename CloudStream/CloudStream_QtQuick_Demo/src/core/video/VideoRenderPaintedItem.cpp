@@ -4,6 +4,7 @@
 #include <QPainter>
 
 #include "utils/Logger.h"
+#include "utils/StartupTimeline.h"
 #include "viewmodels/StreamingViewModel.h"
 
 VideoRenderPaintedItem::VideoRenderPaintedItem(QQuickItem* parent) : QQuickPaintedItem(parent) {
@@ -28,6 +29,9 @@ void VideoRenderPaintedItem::setFrame(VideoFrameDataPtr frame) {
     m_frame.reset();
   }
 
+  if (m_frame) {
+    StartupTimeline::instance()->finish("first_frame");
+  }
   update();
 }
 
@@ -51,7 +51,7 @@ bool YuvDynamicTexture::updateTexture() {
 
   // 如果数据未标记为脏或纹理无效，则无需更新
   if (!dataDirty || !m_rhiTexture) {
-    Logger::info("[YuvDynamicTexture::updateTexture] No update needed, returning false");
+    LOGGER_RATE_LIMITED(Logger::kDEBUG, 1, 5, "[YuvDynamicTexture::updateTexture] No update needed, returning false");
     return false;
   }
 
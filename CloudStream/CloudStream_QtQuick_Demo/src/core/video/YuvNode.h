@@ -41,6 +41,15 @@ class YuvNode : public QSGGeometryNode {
    */
   void setFrame(QQuickWindow* window, const VideoFrameData* frame, const QSizeF& itemSize, bool frameDirty);
 
+  /**
+   * @brief 仅更新渲染尺寸，保留已上传的纹理
+   *
+   * 没有新帧时（帧引用在上传后已释放）用于继续显示上一帧
+   *
+   * @param itemSize 渲染区域的尺寸
+   */
+  void setItemSize(const QSizeF& itemSize) { updateGeometry(itemSize); }
+
  private:
   /**
    * @brief 更新几何信息
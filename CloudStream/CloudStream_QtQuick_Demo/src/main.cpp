@@ -10,7 +10,9 @@
 #include <QResource>
 
 #include "core/AppConfig.h"
+#include "core/StartupPipeline.h"
 #include "core/input/InputCaptureItem.h"
+#include "core/ProbeManager.h"
 #include "core/StreamConfig.h"
 #include "core/video/VideoRenderItem.h"
 #include "core/video/VideoRenderPaintedItem.h"
@@ -18,6 +20,7 @@
 #include "services/NetworkService.h"
 #include "tcr_c_api.h"
 #include "utils/Logger.h"
+#include "utils/StartupTimeline.h"
 #include "viewmodels/DesktopViewModel.h"
 #include "viewmodels/InstanceTokenViewModel.h"
 #include "viewmodels/MultiStreamViewModel.h"
@@ -34,6 +37,9 @@
  * - 处理QML对象创建失败的情况
  */
 int main(int argc, char *argv[]) {
+  // 启动耗时从这里开始计时，首帧显示时输出分阶段时间线
+  StartupTimeline::instance();
+
   // 创建Qt GUI应用程序对象
   QGuiApplication app(argc, argv);
 
@@ -46,6 +52,13 @@ int main(int argc, char *argv[]) {
   // -------------------- 日志系统初始化 --------------------
   /// 初始化全局日志系统，确保日志功能在应用生命周期内可用
   Logger::globalInit();
+  Logger::instance()->setOverflowPolicy(AppConfig::instance()->logOverflowPolicy());
+
+  // -------------------- 并行启动 --------------------
+  /// 读取上次的节点排名；对象需在 GUI 线程创建
+  ProbeManager::instance();
+  /// SDK 预连接在后台线程执行，与 QML 加载和令牌获取重叠；令牌就绪后提前 tcr_client_init 并开始节点探测（StartupPipeline::initSdkAsync）
+  StartupPipeline::prepareSdkAsync();
 
   // -------------------- 服务层与模型层对象创建 --------------------
   /// 创建网络服务对象，负责HTTP请求
@@ -55,6 +68,9 @@ int main(int argc, char *argv[]) {
   ApiService *apiService = new ApiService(networkService, &app);
 
   InstanceTokenViewModel *instanceAccessViewModel = new InstanceTokenViewModel(apiService, &app);
+  /// 配置了实例ID时提前获取令牌（或确认缓存可用），用户点击连接时通常已就绪
+  instanceAccessViewModel->prefetchAccessToken();
+
   // -------------------- QML引擎与上下文注册 --------------------
   QQmlApplicationEngine engine;
 
@@ -92,6 +108,14 @@ int main(int argc, char *argv[]) {
                                         return AppConfig::instance();
                                       });
 
+  /// 注册ProbeManager单例，供StatsOverlay显示当前节点的探测评分
+  qmlRegisterSingletonType<ProbeManager>("CustomComponents", 1, 0, "ProbeManager",
+                                         [](QQmlEngine *engine, QJSEngine *scriptEngine) -> QObject * {
+                                           Q_UNUSED(engine)
+                                           Q_UNUSED(scriptEngine)
+                                           return ProbeManager::instance();
+                                         });
+
   engine.rootContext()->setContextProperty("instanceAccessViewModel", instanceAccessViewModel);
   engine.rootContext()->setContextProperty("apiService", apiService);
 
@@ -105,7 +129,9 @@ int main(int argc, char *argv[]) {
       Qt::QueuedConnection);
 
   // -------------------- 加载QML主界面 --------------------
+  StartupTimeline::instance()->begin("qml_load");
   engine.loadFromModule("QtQuick_Demo", "InstanceTokenWindow");
+  StartupTimeline::instance()->end("qml_load");
 
   // -------------------- 进入主事件循环 --------------------
   return app.exec();
@@ -152,6 +152,12 @@ void ApiService::createAndroidInstancesAccessToken(const QStringList& androidIns
     data["Mode"] = mode;
   }
 
+  // 明确令牌有效期，本地缓存据此判断过期
+  int ttlHours = AppConfig::instance()->tokenTtlHours();
+  if (ttlHours > 0) {
+    data["ExpirationDuration"] = QString("%1h").arg(ttlHours);
+  }
+
   // 发送请求并处理响应
   sendRequest(
       AppConfig::instance()->apiPath(), data,
@@ -0,0 +1,258 @@
+#include "AesGcm.h"
+
+#include <cstdint>
+#include <cstring>
+
+namespace {
+
+const uint8_t kSbox[256] = {
+    0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
+    0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0, 0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0,
+    0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
+    0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2, 0xeb, 0x27, 0xb2, 0x75,
+    0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0, 0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84,
+    0x53, 0xd1, 0x00, 0xed, 0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
+    0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f, 0x50, 0x3c, 0x9f, 0xa8,
+    0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5, 0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2,
+    0xcd, 0x0c, 0x13, 0xec, 0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
+    0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14, 0xde, 0x5e, 0x0b, 0xdb,
+    0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c, 0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79,
+    0xe7, 0xc8, 0x37, 0x6d, 0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
+    0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f, 0x4b, 0xbd, 0x8b, 0x8a,
+    0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e, 0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e,
+    0xe1, 0xf8, 0x98, 0x11, 0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
+    0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16,
+};
+
+inline uint8_t xtime(uint8_t x) { return (uint8_t)((x << 1) ^ ((x & 0x80) ? 0x1b : 0)); }
+
+// AES-256 加密方向；状态按列存放 s[列 * 4 + 行]
+class Aes256 {
+ public:
+  explicit Aes256(const uint8_t* key) {
+    memcpy(m_rk, key, 32);
+    uint8_t rcon = 1;
+    for (int i = 8; i < 60; ++i) {
+      uint8_t t[4];
+      memcpy(t, m_rk + (i - 1) * 4, 4);
+      if (i % 8 == 0) {
+        uint8_t first = t[0];
+        t[0] = (uint8_t)(kSbox[t[1]] ^ rcon);
+        t[1] = kSbox[t[2]];
+        t[2] = kSbox[t[3]];
+        t[3] = kSbox[first];
+        rcon = xtime(rcon);
+      } else if (i % 8 == 4) {
+        for (int j = 0; j < 4; ++j) {
+          t[j] = kSbox[t[j]];
+        }
+      }
+      for (int j = 0; j < 4; ++j) {
+        m_rk[i * 4 + j] = (uint8_t)(m_rk[(i - 8) * 4 + j] ^ t[j]);
+      }
+    }
+  }
+
+  ~Aes256() {
+    volatile uint8_t* p = m_rk;
+    for (size_t i = 0; i < sizeof(m_rk); ++i) {
+      p[i] = 0;
+    }
+  }
+
+  void encrypt(const uint8_t in[16], uint8_t out[16]) const {
+    uint8_t s[16];
+    for (int i = 0; i < 16; ++i) {
+      s[i] = (uint8_t)(in[i] ^ m_rk[i]);
+    }
+    for (int round = 1; round <= 14; ++round) {
+      uint8_t t[16];
+      // SubBytes + ShiftRows：第 r 行循环左移 r 个字节
+      for (int c = 0; c < 4; ++c) {
+        for (int r = 0; r < 4; ++r) {
+          t[c * 4 + r] = kSbox[s[((c + r) % 4) * 4 + r]];
+        }
+      }
+      if (round < 14) {
+        for (int c = 0; c < 4; ++c) {
+          uint8_t* a = t + c * 4;
+          uint8_t all = (uint8_t)(a[0] ^ a[1] ^ a[2] ^ a[3]);
+          uint8_t first = a[0];
+          a[0] ^= (uint8_t)(all ^ xtime((uint8_t)(a[0] ^ a[1])));
+          a[1] ^= (uint8_t)(all ^ xtime((uint8_t)(a[1] ^ a[2])));
+          a[2] ^= (uint8_t)(all ^ xtime((uint8_t)(a[2] ^ a[3])));
+          a[3] ^= (uint8_t)(all ^ xtime((uint8_t)(a[3] ^ first)));
+        }
+      }
+      for (int i = 0; i < 16; ++i) {
+        s[i] = (uint8_t)(t[i] ^ m_rk[round * 16 + i]);
+      }
+    }
+    memcpy(out, s, 16);
+  }
+
+ private:
+  uint8_t m_rk[240];
+};
+
+// GF(2^128) 元素，hi 为块的前 8 字节（大端）
+struct Block {
+  uint64_t hi = 0;
+  uint64_t lo = 0;
+};
+
+Block loadBlock(const uint8_t* p) {
+  Block b;
+  for (int i = 0; i < 8; ++i) {
+    b.hi = (b.hi << 8) | p[i];
+    b.lo = (b.lo << 8) | p[8 + i];
+  }
+  return b;
+}
+
+void storeBlock(const Block& b, uint8_t* p) {
+  for (int i = 0; i < 8; ++i) {
+    p[i] = (uint8_t)(b.hi >> (56 - i * 8));
+    p[8 + i] = (uint8_t)(b.lo >> (56 - i * 8));
+  }
+}
+
+// SP 800-38D 算法 1，逐位乘法；缓存只有几百字节，不值得查表
+Block gfMul(const Block& x, const Block& y) {
+  Block z;
+  Block v = y;
+  for (int i = 0; i < 128; ++i) {
+    uint64_t bit = i < 64 ? (x.hi >> (63 - i)) & 1 : (x.lo >> (127 - i)) & 1;
+    if (bit) {
+      z.hi ^= v.hi;
+      z.lo ^= v.lo;
+    }
+    bool carry = (v.lo & 1) != 0;
+    v.lo = (v.lo >> 1) | (v.hi << 63);
+    v.hi >>= 1;
+    if (carry) {
+      v.hi ^= 0xe100000000000000ULL;
+    }
+  }
+  return z;
+}
+
+class Ghash {
+ public:
+  explicit Ghash(const Block& h) : m_h(h) {}
+
+  // 按 16 字节分块吸收，末块补零
+  void update(const uint8_t* data, size_t len) {
+    for (size_t off = 0; off < len; off += 16) {
+      uint8_t buf[16] = {0};
+      memcpy(buf, data + off, len - off < 16 ? len - off : 16);
+      absorb(loadBlock(buf));
+    }
+  }
+
+  Block finish(uint64_t aadLen, uint64_t textLen) {
+    Block lengths;
+    lengths.hi = aadLen * 8;
+    lengths.lo = textLen * 8;
+    absorb(lengths);
+    return m_y;
+  }
+
+ private:
+  void absorb(const Block& b) {
+    m_y.hi ^= b.hi;
+    m_y.lo ^= b.lo;
+    m_y = gfMul(m_y, m_h);
+  }
+
+  Block m_h;
+  Block m_y;
+};
+
+void increment32(uint8_t counter[16]) {
+  for (int i = 15; i >= 12; --i) {
+    if (++counter[i] != 0) {
+      break;
+    }
+  }
+}
+
+// 从 inc32(J0) 开始的计数器模式，加解密相同
+void ctr(const Aes256& aes, const uint8_t j0[16], const uint8_t* in, uint8_t* out, size_t len) {
+  uint8_t counter[16];
+  memcpy(counter, j0, 16);
+  for (size_t off = 0; off < len; off += 16) {
+    increment32(counter);
+    uint8_t ks[16];
+    aes.encrypt(counter, ks);
+    for (size_t i = 0; i < 16 && off + i < len; ++i) {
+      out[off + i] = (uint8_t)(in[off + i] ^ ks[i]);
+    }
+  }
+}
+
+void computeTag(const Aes256& aes, const uint8_t j0[16], const QByteArray& aad, const uint8_t* cipher, size_t len,
+                 uint8_t tag[16]) {
+  uint8_t zero[16] = {0};
+  uint8_t h[16];
+  aes.encrypt(zero, h);
+  Ghash ghash(loadBlock(h));
+  ghash.update((const uint8_t*)aad.constData(), size_t(aad.size()));
+  ghash.update(cipher, len);
+  uint8_t s[16];
+  storeBlock(ghash.finish(uint64_t(aad.size()), len), s);
+  uint8_t ek[16];
+  aes.encrypt(j0, ek);
+  for (int i = 0; i < 16; ++i) {
+    tag[i] = (uint8_t)(ek[i] ^ s[i]);
+  }
+}
+
+void makeJ0(const QByteArray& nonce, uint8_t j0[16]) {
+  memcpy(j0, nonce.constData(), AesGcm::kNonceSize);
+  j0[12] = j0[13] = j0[14] = 0;
+  j0[15] = 1;
+}
+
+}  // namespace
+
+QByteArray AesGcm::seal(const QByteArray& key, const QByteArray& nonce, const QByteArray& plain,
+                        const QByteArray& aad) {
+  if (key.size() != kKeySize || nonce.size() != kNonceSize) {
+    return QByteArray();
+  }
+  Aes256 aes(reinterpret_cast<const uint8_t*>(key.constData()));
+  uint8_t j0[16];
+  makeJ0(nonce, j0);
+  const size_t len = size_t(plain.size());
+  QByteArray out(plain.size() + kTagSize, '\0');
+  uint8_t* cipher = reinterpret_cast<uint8_t*>(out.data());
+  ctr(aes, j0, reinterpret_cast<const uint8_t*>(plain.constData()), cipher, len);
+  computeTag(aes, j0, aad, cipher, len, cipher + len);
+  return out;
+}
+
+bool AesGcm::unseal(const QByteArray& key, const QByteArray& nonce, const QByteArray& sealed, const QByteArray& aad,
+                    QByteArray* plain) {
+  if (key.size() != kKeySize || nonce.size() != kNonceSize || sealed.size() < kTagSize) {
+    return false;
+  }
+  Aes256 aes(reinterpret_cast<const uint8_t*>(key.constData()));
+  uint8_t j0[16];
+  makeJ0(nonce, j0);
+  const uint8_t* cipher = reinterpret_cast<const uint8_t*>(sealed.constData());
+  const size_t len = size_t(sealed.size() - kTagSize);
+  uint8_t tag[16];
+  computeTag(aes, j0, aad, cipher, len, tag);
+  uint8_t diff = 0;
+  for (int i = 0; i < kTagSize; ++i) {
+    diff |= uint8_t(tag[i] ^ cipher[len + i]);
+  }
+  if (diff != 0) {
+    return false;
+  }
+  QByteArray out(qsizetype(len), '\0');
+  ctr(aes, j0, cipher, reinterpret_cast<uint8_t*>(out.data()), len);
+  *plain = out;
+  return true;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <QByteArray>
+
+/**
+ * @brief AES-256-GCM（NIST SP 800-38D）
+ *
+ * 只用于本地缓存这类小数据的加密和完整性校验，Qt 没有提供对称加密，也不引入加密库；
+ * 查表实现，没有做常数时间处理，不要用于网络协议或处理他人可控的大量数据。
+ */
+class AesGcm {
+ public:
+  static constexpr int kKeySize = 32;
+  static constexpr int kNonceSize = 12;
+  static constexpr int kTagSize = 16;
+
+  /**
+   * @brief 加密 plain，aad 只参与认证不加密
+   * @param key 32 字节密钥
+   * @param nonce 12 字节，同一密钥下不能重复使用
+   * @return 密文 || 16 字节标签；密钥或 nonce 长度不对时返回空
+   */
+  static QByteArray seal(const QByteArray& key, const QByteArray& nonce, const QByteArray& plain,
+                         const QByteArray& aad);
+
+  /**
+   * @brief 校验标签后解密 seal 的输出
+   * @return 密钥、nonce、aad 不符或内容被改动时返回 false
+   */
+  static bool unseal(const QByteArray& key, const QByteArray& nonce, const QByteArray& sealed, const QByteArray& aad,
+                     QByteArray* plain);
+};
@@ -0,0 +1,81 @@
+#ifdef _WIN32
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  ifndef WIN32_LEAN_AND_MEAN
+#    define WIN32_LEAN_AND_MEAN
+#  endif
+#  include <windows.h>
+#elif defined(__APPLE__)
+#  include <mach/mach.h>
+#else
+#  include <cstdio>
+#endif
+
+#include "CpuUsageSampler.h"
+
+bool CpuUsageSampler::readTimes(quint64& idle, quint64& total) {
+#ifdef _WIN32
+  FILETIME idleFt, kernelFt, userFt;
+  if (!GetSystemTimes(&idleFt, &kernelFt, &userFt)) {
+    return false;
+  }
+  auto toU64 = [](const FILETIME& ft) {
+    return (static_cast<quint64>(ft.dwHighDateTime) << 32) | ft.dwLowDateTime;
+  };
+  // kernel 时间已包含 idle 时间
+  idle = toU64(idleFt);
+  total = toU64(kernelFt) + toU64(userFt);
+  return true;
+#elif defined(__APPLE__)
+  host_cpu_load_info_data_t info;
+  mach_msg_type_number_t count = HOST_CPU_LOAD_INFO_COUNT;
+  if (host_statistics(mach_host_self(), HOST_CPU_LOAD_INFO, reinterpret_cast<host_info_t>(&info), &count) !=
+      KERN_SUCCESS) {
+    return false;
+  }
+  idle = info.cpu_ticks[CPU_STATE_IDLE];
+  total = 0;
+  for (int i = 0; i < CPU_STATE_MAX; ++i) {
+    total += info.cpu_ticks[i];
+  }
+  return true;
+#else
+  FILE* f = fopen("/proc/stat", "r");
+  if (!f) {
+    return false;
+  }
+  unsigned long long user = 0, nice = 0, sys = 0, idl = 0, iowait = 0, irq = 0, softirq = 0, steal = 0;
+  int n = fscanf(f, "cpu %llu %llu %llu %llu %llu %llu %llu %llu", &user, &nice, &sys, &idl, &iowait, &irq, &softirq,
+                 &steal);
+  fclose(f);
+  if (n < 4) {
+    return false;
+  }
+  idle = idl + iowait;
+  total = user + nice + sys + idl + iowait + irq + softirq + steal;
+  return true;
+#endif
+}
+
+double CpuUsageSampler::sample() {
+  quint64 idle = 0;
+  quint64 total = 0;
+  if (!readTimes(idle, total)) {
+    return -1.0;
+  }
+
+  double usage = -1.0;
+  if (m_hasPrev && total > m_prevTotal) {
+    quint64 deltaTotal = total - m_prevTotal;
+    quint64 deltaIdle = idle >= m_prevIdle ? idle - m_prevIdle : 0;
+    if (deltaIdle > deltaTotal) {
+      deltaIdle = deltaTotal;
+    }
+    usage = 1.0 - static_cast<double>(deltaIdle) / static_cast<double>(deltaTotal);
+  }
+  m_prevIdle = idle;
+  m_prevTotal = total;
+  m_hasPrev = true;
+  return usage;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <QtGlobal>
+
+/**
+ * @brief 整机 CPU 占用率采样器（跨平台）
+ *
+ * - Windows: GetSystemTimes
+ * - macOS: host_statistics(HOST_CPU_LOAD_INFO)
+ * - Linux: /proc/stat
+ */
+class CpuUsageSampler {
+ public:
+  /**
+   * @brief 采样一次 CPU 占用率
+   * @return 自上次调用以来的整机 CPU 占用率 [0, 1]；首次调用或平台不支持时返回 -1
+   */
+  double sample();
+
+ private:
+  static bool readTimes(quint64& idle, quint64& total);
+
+  quint64 m_prevIdle = 0;
+  quint64 m_prevTotal = 0;
+  bool m_hasPrev = false;
+};
@@ -5,6 +5,10 @@
 #include <QDir>
 #include <QElapsedTimer>
 #include <QFileInfo>
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <vector>
 
 #include "tcr_c_api.h"
 #include "tcr_types.h"
@@ -13,6 +17,17 @@
 // 静态成员初始化
 Logger* Logger::m_instance = nullptr;
 
+namespace {
+/// "[RateLimit] N messages suppressed at file:line"，site 只取文件名
+QString suppressedMessage(const char* site, int line, quint64 count) {
+  QString where = QFileInfo(QString::fromUtf8(site)).fileName();
+  if (line > 0) {
+    where += QString(":%1").arg(line);
+  }
+  return QString("[RateLimit] %1 messages suppressed at %2").arg(count).arg(where);
+}
+}  // namespace
+
 /**
  * @brief 获取Logger单例实例
  * @return Logger* 单例指针
@@ -41,6 +56,7 @@ Logger::Logger() : m_logLevel(kDEBUG), m_logToFile(false), m_stopThread(false),
 Logger::~Logger() {
   stopLogThread();
 
+  QMutexLocker locker(&m_fileMutex);
   if (m_logFile.isOpen()) {
     m_logFile.close();
   }
@@ -62,23 +78,38 @@ void Logger::globalInit() {
   logCallback.user_data = nullptr;
 
   // 设置日志回调函数，将TCR SDK的日志转发到Logger系统
+  // 回调在 SDK 网络/解码线程触发，只拷贝原始字节，拼接和解码由写入线程完成
+  // DEBUG/INFO 级别的 SDK 日志按级别限流，WARN/ERROR 原样转发
   logCallback.on_log = [](void* /*user_data*/, TcrLogLevel level, const char* tag, const char* log) {
-    QString msg = QString("[%1] %2").arg(tag).arg(log);
+    static LogRateLimiter debugLimiter(kDEBUG, "TcrSdk", 0, SDK_DEBUG_LOGS_PER_SEC, SDK_LOG_BURST);
+    static LogRateLimiter infoLimiter(kINFO, "TcrSdk", 0, SDK_INFO_LOGS_PER_SEC, SDK_LOG_BURST);
+    Logger* logger = Logger::instance();
+    quint64 suppressed = 0;
 
     // 根据TCR日志级别映射到Logger日志级别
     switch (level) {
       case TCR_LOG_LEVEL_TRACE:
       case TCR_LOG_LEVEL_DEBUG:
-        Logger::debug(msg);
+        if (logger->isEnabled(kDEBUG) && debugLimiter.allow(&suppressed)) {
+          if (suppressed > 0) {
+            logger->logSuppressed(kDEBUG, "TcrSdk", 0, suppressed);
+          }
+          logger->logRaw(kDEBUG, tag, log);
+        }
         break;
       case TCR_LOG_LEVEL_INFO:
-        Logger::info(msg);
+        if (logger->isEnabled(kINFO) && infoLimiter.allow(&suppressed)) {
+          if (suppressed > 0) {
+            logger->logSuppressed(kINFO, "TcrSdk", 0, suppressed);
+          }
+          logger->logRaw(kINFO, tag, log);
+        }
         break;
       case TCR_LOG_LEVEL_WARN:
-        Logger::warning(msg);
+        Logger::instance()->logRaw(kWARNING, tag, log);
         break;
       case TCR_LOG_LEVEL_ERROR:
-        Logger::error(msg);
+        Logger::instance()->logRaw(kERROR, tag, log);
         break;
     }
   };
@@ -104,6 +135,11 @@ void Logger::globalInit() {
 
   // 6. 打印运行环境信息
   EnvInfoPrinter::printEnvironmentInfo();
+
+  // 7. 设置 LOGGER_BENCHMARK 环境变量时测量日志调用开销
+  if (qEnvironmentVariableIsSet("LOGGER_BENCHMARK")) {
+    Logger::instance()->benchmark();
+  }
 }
 
 /**
@@ -112,13 +148,53 @@ void Logger::globalInit() {
  */
 void Logger::setLogLevel(LogLevel level) { m_logLevel = level; }
 
+/**
+ * @brief 设置队列满时的处理策略
+ * @param policy 处理策略
+ */
+void Logger::setOverflowPolicy(OverflowPolicy policy) { m_overflowPolicy = policy; }
+
+/**
+ * @brief 获取丢弃/限流计数
+ */
+Logger::Counters Logger::counters() const {
+  Counters c;
+  c.dropped = m_dropped.load(std::memory_order_relaxed);
+  c.suppressed = m_suppressed.load(std::memory_order_relaxed);
+  c.blocked = m_fullWaits.load(std::memory_order_relaxed);
+  return c;
+}
+
+/**
+ * @brief 输出调用点的限流汇总
+ */
+void Logger::logSuppressed(LogLevel level, const char* site, int line, quint64 count) {
+  log(level, suppressedMessage(site, line, count));
+}
+
+/**
+ * @brief 登记调用点限流器
+ */
+void Logger::registerLimiter(LogRateLimiter* limiter) {
+  QMutexLocker locker(&m_limiterMutex);
+  m_limiters.push_back(limiter);
+}
+
+/**
+ * @brief 注销调用点限流器（静态限流器在进程退出时析构）
+ */
+void Logger::unregisterLimiter(LogRateLimiter* limiter) {
+  QMutexLocker locker(&m_limiterMutex);
+  m_limiters.erase(std::remove(m_limiters.begin(), m_limiters.end(), limiter), m_limiters.end());
+}
+
 /**
  * @brief 设置是否写入日志文件
  * @param enable 是否启用文件日志
  * @param filePath 日志文件路径
  */
 void Logger::setLogToFile(bool enable, const QString& filePath) {
-  QMutexLocker locker(&m_queueMutex);
+  QMutexLocker locker(&m_fileMutex);
 
   m_logToFile = enable;
 
@@ -136,9 +212,8 @@ void Logger::setLogToFile(bool enable, const QString& filePath) {
     m_logFilePath = filePath;
     m_logFile.setFileName(m_logFilePath);
 
-    if (m_logFile.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
-      m_textStream.setDevice(&m_logFile);
-    }
+    m_logFile.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text);
+    m_fileBytes = m_logFile.isOpen() ? m_logFile.size() : 0;
   }
 }
 
@@ -157,30 +232,181 @@ void Logger::setMaxBackupFiles(int count) { m_maxBackupFiles = count; }
 /**
  * @brief 记录日志
  *
- * 将日志消息添加到队列中，由后台线程异步写入
+ * 只记录原始时间戳和线程ID并放入队列，由后台线程格式化后异步写入
  *
  * @param level 日志级别
  * @param message 日志消息
  */
 void Logger::log(LogLevel level, const QString& message) {
   // 过滤低于当前日志级别的消息
-  if (level < m_logLevel) {
+  if (level < m_logLevel.load(std::memory_order_relaxed)) {
+    return;
+  }
+
+  LogRecord record;
+  record.timeMs = QDateTime::currentMSecsSinceEpoch();
+  record.threadId = reinterpret_cast<quintptr>(QThread::currentThreadId());
+  record.level = level;
+  record.message = message;  // 隐式共享，只增加引用计数
+  enqueue(std::move(record));
+}
+
+/**
+ * @brief 记录 SDK 日志
+ *
+ * 只做一次内存拷贝，"[tag] text" 的拼接和 UTF-8 解码在写入线程完成
+ */
+void Logger::logRaw(LogLevel level, const char* tag, const char* text) {
+  if (level < m_logLevel.load(std::memory_order_relaxed)) {
     return;
   }
 
-  // 获取线程ID和时间戳
-  QString threadIdStr = QString::number(reinterpret_cast<quintptr>(QThread::currentThreadId()));
-  QString timeStr = QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss.zzz");
+  const qsizetype tagLen = tag ? qsizetype(qstrlen(tag)) : 0;
+  const qsizetype textLen = text ? qsizetype(qstrlen(text)) : 0;
+
+  LogRecord record;
+  record.timeMs = QDateTime::currentMSecsSinceEpoch();
+  record.threadId = reinterpret_cast<quintptr>(QThread::currentThreadId());
+  record.level = level;
+  record.raw.resize(tagLen + 1 + textLen);
+  char* out = record.raw.data();
+  if (tagLen > 0) {
+    memcpy(out, tag, size_t(tagLen));
+  }
+  out[tagLen] = '\0';
+  if (textLen > 0) {
+    memcpy(out + tagLen + 1, text, size_t(textLen));
+  }
+  enqueue(std::move(record));
+}
+
+/**
+ * @brief 入队并唤醒写入线程
+ *
+ * 锁内只移动记录，不做格式化。队列满时按策略处理：
+ * - kBlock（以及所有 WARNING/ERROR）：等待写入线程取走一批后再入队
+ * - kDropOldest：淘汰队列中最老的记录；最老的是 WARNING/ERROR 时保留它，改为丢弃当前这条，
+ *   DEBUG/INFO 的生产者不会挤掉更高级别的日志，也不会打乱队列顺序
+ * - kDropNewest：丢弃当前记录
+ */
+void Logger::enqueue(LogRecord&& record) {
+  LogRecord evicted;  // 在锁外释放被淘汰的记录
+  QMutexLocker locker(&m_queueMutex);
+  if (m_logQueue.size() >= QUEUE_CAPACITY && !m_stopThread) {
+    const OverflowPolicy policy =
+        record.level >= kWARNING ? kBlock : m_overflowPolicy.load(std::memory_order_relaxed);
+    if (policy == kDropNewest || (policy == kDropOldest && m_logQueue.front().level >= kWARNING)) {
+      m_dropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    if (policy == kDropOldest) {
+      evicted = std::move(m_logQueue.front());
+      m_logQueue.pop_front();
+      m_dropped.fetch_add(1, std::memory_order_relaxed);
+    } else {
+      m_fullWaits.fetch_add(1, std::memory_order_relaxed);
+      // 停止后写入线程不再取记录，不再等待空位
+      while (m_logQueue.size() >= QUEUE_CAPACITY && !m_stopThread) {
+        m_queueNotFull.wait(&m_queueMutex);
+      }
+    }
+  }
+  m_logQueue.push_back(std::move(record));
+  m_queueNotEmpty.wakeOne();
+}
+
+/**
+ * @brief 测量日志调用开销
+ *
+ * 多个线程同时调用入队路径（时间戳、线程ID、加锁入队）。记录进入私有队列（与 m_logQueue 同容量），
+ * 队列满时按 kBlock 等待，由一个消费线程按批取出并释放，不经过正在使用的日志队列，
+ * 也就不会淘汰真实日志。结果以 INFO 级别输出，附带期间真实日志队列的丢弃条数（m_dropped 增量）
+ */
+double Logger::benchmark(int threads, int callsPerThread) {
+  const QString message = QStringLiteral("[Benchmark] Frame callback sample message with some text");
+  const quint64 droppedBefore = m_dropped.load(std::memory_order_relaxed);
+
+  QMutex mutex;
+  QWaitCondition notEmpty;
+  QWaitCondition notFull;
+  std::deque<LogRecord> queue;
+  bool producing = true;
+  quint64 fullWaits = 0;
+
+  // 代替写入线程：按批取出记录并在本线程释放，不格式化、不写文件
+  QThread* consumer = QThread::create([&]() {
+    std::vector<LogRecord> batch;
+    batch.reserve(BATCH_SIZE);
+    while (true) {
+      {
+        QMutexLocker locker(&mutex);
+        if (queue.empty() && producing) {
+          notEmpty.wait(&mutex, FLUSH_INTERVAL_MS);
+        }
+        while (!queue.empty() && batch.size() < size_t(BATCH_SIZE)) {
+          batch.push_back(std::move(queue.front()));
+          queue.pop_front();
+        }
+        notFull.wakeAll();
+        if (batch.empty() && !producing) {
+          break;
+        }
+      }
+      batch.clear();
+    }
+  });
+  consumer->start();
 
-  // 构造日志消息
-  LogMsg logMsg{level, message, timeStr, threadIdStr};
+  QElapsedTimer timer;
+  timer.start();
+  std::vector<QThread*> workers;
+  for (int t = 0; t < threads; ++t) {
+    workers.push_back(QThread::create([&, callsPerThread]() {
+      for (int i = 0; i < callsPerThread; ++i) {
+        LogRecord record;
+        record.timeMs = QDateTime::currentMSecsSinceEpoch();
+        record.threadId = reinterpret_cast<quintptr>(QThread::currentThreadId());
+        record.level = kINFO;
+        record.message = message;
+        QMutexLocker locker(&mutex);
+        if (queue.size() >= QUEUE_CAPACITY) {
+          ++fullWaits;
+          while (queue.size() >= QUEUE_CAPACITY) {
+            notFull.wait(&mutex);
+          }
+        }
+        queue.push_back(std::move(record));
+        notEmpty.wakeOne();
+      }
+    }));
+    workers.back()->start();
+  }
+  for (QThread* worker : workers) {
+    worker->wait();
+    delete worker;
+  }
+  const qint64 elapsedNs = timer.nsecsElapsed();
 
-  // 将日志消息添加到队列
   {
-    QMutexLocker locker(&m_queueMutex);
-    m_logQueue.push(logMsg);
-    m_queueNotEmpty.wakeOne();  // 唤醒日志写入线程
+    QMutexLocker locker(&mutex);
+    producing = false;
+    notEmpty.wakeOne();
   }
+  consumer->wait();
+  delete consumer;
+
+  const double totalCalls = double(threads) * callsPerThread;
+  const double nsPerCall = totalCalls > 0 ? elapsedNs / totalCalls : 0;
+  info(QString("[Logger] Benchmark: %1 threads x %2 calls, %3 ns/call (wall %4 ms, %5 ns per call per thread), "
+               "queue full %6 times, %7 live log messages dropped meanwhile")
+           .arg(threads)
+           .arg(callsPerThread)
+           .arg(nsPerCall, 0, 'f', 1)
+           .arg(elapsedNs / 1e6, 0, 'f', 1)
+           .arg(threads > 0 ? nsPerCall * threads : 0, 0, 'f', 1)
+           .arg(fullWaits)
+           .arg(m_dropped.load(std::memory_order_relaxed) - droppedBefore));
+  return nsPerCall;
 }
 
 /**
@@ -194,12 +420,12 @@ void Logger::rotateLogFileIfNeeded() {
     return;
   }
 
-  if (m_logFile.size() < m_maxFileSize) {
+  // 使用写入时累计的字节数，避免每次查询文件大小
+  if (m_fileBytes < m_maxFileSize) {
     return;
   }
 
   // 执行轮转操作
-  m_textStream.flush();
   m_logFile.close();
 
   doRotate();
@@ -207,7 +433,7 @@ void Logger::rotateLogFileIfNeeded() {
   // 重新打开日志文件
   m_logFile.setFileName(m_logFilePath);
   m_logFile.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text);
-  m_textStream.setDevice(&m_logFile);
+  m_fileBytes = m_logFile.isOpen() ? m_logFile.size() : 0;
 }
 
 /**
@@ -261,90 +487,178 @@ void Logger::doRotate() {
   m_logFilePath = QString("%1/%2_%3.%4").arg(dirPath).arg(baseName).arg(m_currentFileIndex).arg(extension);
 }
 
+/**
+ * @brief 写入线程：把一条记录格式化为一行
+ *
+ * 时间前缀按秒缓存，同一秒内的日志只拼接毫秒部分
+ */
+QString Logger::formatRecord(const LogRecord& record) {
+  const qint64 second = record.timeMs / 1000;
+  if (second != m_cachedSecond) {
+    m_cachedSecond = second;
+    m_cachedTimePrefix = QDateTime::fromMSecsSinceEpoch(second * 1000).toString("yyyy-MM-dd hh:mm:ss");
+  }
+
+  // 格式化日志级别字符串
+  const char* levelStr = "DEBUG";
+  switch (record.level) {
+    case kDEBUG:
+      levelStr = "DEBUG";
+      break;
+    case kINFO:
+      levelStr = "INFO ";
+      break;
+    case kWARNING:
+      levelStr = "WARN ";
+      break;
+    case kERROR:
+      levelStr = "ERROR";
+      break;
+  }
+
+  // SDK 日志在这里才拼接并解码
+  QString message = record.message;
+  if (message.isEmpty() && !record.raw.isEmpty()) {
+    const qsizetype sep = record.raw.indexOf('\0');
+    message = QString("[%1] %2").arg(QString::fromUtf8(record.raw.constData(), sep),
+                                     QString::fromUtf8(record.raw.constData() + sep + 1, record.raw.size() - sep - 1));
+  }
+
+  return QString("[%1.%2] [%3] [%4] %5")
+      .arg(m_cachedTimePrefix)
+      .arg(int(record.timeMs % 1000), 3, 10, QLatin1Char('0'))
+      .arg(record.threadId)
+      .arg(QLatin1String(levelStr))
+      .arg(message);
+}
+
+/**
+ * @brief 有新的丢弃时追加一行汇总
+ *
+ * 在写入线程直接格式化进缓冲区，不经过队列，避免队列满时自己阻塞自己
+ */
+void Logger::appendDropSummary(QByteArray& buffer) {
+  const quint64 dropped = m_dropped.load(std::memory_order_relaxed);
+  if (dropped == m_reportedDropped) {
+    return;
+  }
+  const qint64 now = QDateTime::currentMSecsSinceEpoch();
+  if (now - m_lastDropReportMs < DROP_REPORT_INTERVAL_MS) {
+    return;
+  }
+
+  appendDirect(buffer, kWARNING,
+               QString("[Logger] Queue full, %1 messages dropped (%2 in total)")
+                   .arg(dropped - m_reportedDropped)
+                   .arg(dropped));
+
+  m_reportedDropped = dropped;
+  m_lastDropReportMs = now;
+}
+
+/**
+ * @brief 汇总各调用点尚未输出的限流抑制条数
+ *
+ * LOGGER_RATE_LIMITED 只在下一次放行时输出汇总，突发停止后的计数由这里补上；
+ * 与 allow() 通过 takeSuppressed 交换计数，每条只汇总一次
+ */
+void Logger::appendSuppressedSummaries(QByteArray& buffer, bool force) {
+  const qint64 now = QDateTime::currentMSecsSinceEpoch();
+  if (!force && now - m_lastSuppressedReportMs < DROP_REPORT_INTERVAL_MS) {
+    return;
+  }
+  m_lastSuppressedReportMs = now;
+
+  QMutexLocker locker(&m_limiterMutex);
+  for (LogRateLimiter* limiter : m_limiters) {
+    const quint64 count = limiter->takeSuppressed();
+    if (count > 0) {
+      appendDirect(buffer, limiter->level(), suppressedMessage(limiter->site(), limiter->line(), count));
+    }
+  }
+}
+
+/**
+ * @brief 在写入线程格式化一行并追加到缓冲区
+ */
+void Logger::appendDirect(QByteArray& buffer, LogLevel level, const QString& message) {
+  LogRecord record;
+  record.timeMs = QDateTime::currentMSecsSinceEpoch();
+  record.threadId = reinterpret_cast<quintptr>(QThread::currentThreadId());
+  record.level = level;
+  record.message = message;
+  const QString line = formatRecord(record);
+  qDebug() << line;
+  buffer += line.toUtf8();
+  buffer += '\n';
+}
+
+/**
+ * @brief 写入一批已编码的日志并累计文件大小
+ */
+void Logger::writeBatch(const QByteArray& data) {
+  QMutexLocker locker(&m_fileMutex);
+  if (!m_logToFile || !m_logFile.isOpen()) {
+    return;
+  }
+  const qint64 written = m_logFile.write(data);
+  if (written > 0) {
+    m_fileBytes += written;
+  }
+  m_logFile.flush();
+  rotateLogFileIfNeeded();  // 检查是否需要轮转
+}
+
 /**
  * @brief 日志写入线程的主循环
  *
  * 功能：
- * 1. 从队列中批量获取日志消息
- * 2. 批量写入文件和控制台
- * 3. 定期刷新缓冲区
+ * 1. 在锁内批量取出日志记录
+ * 2. 锁外格式化时间戳、线程ID和级别，编码为 UTF-8
+ * 3. 批量写入文件和控制台
  * 4. 检查并执行日志轮转
  */
 void Logger::logWriterLoop() {
-  std::vector<QString> batch;
+  QByteArray buffer;
+  std::vector<LogRecord> batch;
   batch.reserve(BATCH_SIZE);
 
-  QElapsedTimer timer;
-  timer.start();
-
   while (true) {
-    // 从队列中获取日志消息
+    bool stop = false;
     {
       QMutexLocker locker(&m_queueMutex);
-
-      // 等待队列非空或超时
-      while (m_logQueue.empty() && !m_stopThread) {
+      if (m_logQueue.empty() && !m_stopThread) {
         m_queueNotEmpty.wait(&m_queueMutex, FLUSH_INTERVAL_MS);
-        break;  // 超时后也要检查是否需要flush
       }
-
-      // 批量获取日志消息
-      while (!m_logQueue.empty() && batch.size() < BATCH_SIZE) {
-        const LogMsg& msg = m_logQueue.front();
-
-        // 格式化日志级别字符串
-        QString levelStr;
-        switch (msg.level) {
-          case kDEBUG:
-            levelStr = "DEBUG";
-            break;
-          case kINFO:
-            levelStr = "INFO ";
-            break;
-          case kWARNING:
-            levelStr = "WARN ";
-            break;
-          case kERROR:
-            levelStr = "ERROR";
-            break;
-        }
-
-        // 构造完整的日志消息
-        QString logMsg =
-            QString("[%1] [%2] [%3] %4").arg(msg.timeStr).arg(msg.threadIdStr).arg(levelStr).arg(msg.message);
-
-        batch.push_back(logMsg);
-        m_logQueue.pop();
+      while (!m_logQueue.empty() && batch.size() < size_t(BATCH_SIZE)) {
+        batch.push_back(std::move(m_logQueue.front()));
+        m_logQueue.pop_front();
       }
-
-      // 检查是否需要退出线程
-      if (m_stopThread && m_logQueue.empty() && batch.empty()) {
-        break;
+      if (!batch.empty()) {
+        m_queueNotFull.wakeAll();
       }
+      stop = m_stopThread && m_logQueue.empty();
     }
 
-    // 批量写入日志
-    if (!batch.empty()) {
-      if (m_logToFile && m_logFile.isOpen()) {
-        for (const auto& logMsg : batch) {
-          m_textStream << logMsg << "\n";
-          qDebug() << logMsg;  // 同时输出到控制台
-        }
+    // 锁外格式化
+    for (const LogRecord& record : batch) {
+      const QString line = formatRecord(record);
+      qDebug() << line;  // 同时输出到控制台
+      buffer += line.toUtf8();
+      buffer += '\n';
+    }
+    batch.clear();  // 在写入线程释放消息内存
 
-        m_textStream.flush();
-        rotateLogFileIfNeeded();  // 检查是否需要轮转
-      }
+    appendDropSummary(buffer);
+    appendSuppressedSummaries(buffer, stop);
 
-      batch.clear();
-      timer.restart();
+    // 批量写入日志
+    if (!buffer.isEmpty()) {
+      writeBatch(buffer);
+      buffer.clear();
     }
-    // 定时刷新缓冲区
-    else if (timer.elapsed() > FLUSH_INTERVAL_MS) {
-      if (m_logToFile && m_logFile.isOpen()) {
-        m_textStream.flush();
-        rotateLogFileIfNeeded();
-      }
-      timer.restart();
+    if (stop) {
+      break;
     }
   }
 }
@@ -367,6 +681,7 @@ void Logger::stopLogThread() {
     QMutexLocker locker(&m_queueMutex);
     m_stopThread = true;
     m_queueNotEmpty.wakeAll();
+    m_queueNotFull.wakeAll();
   }
 
   // 等待线程结束
@@ -377,6 +692,45 @@ void Logger::stopLogThread() {
   }
 }
 
+// ==================== LogRateLimiter ====================
+
+namespace {
+qint64 steadyNowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+}  // namespace
+
+LogRateLimiter::LogRateLimiter(Logger::LogLevel level, const char* site, int line, double perSecond, int burst)
+    : m_level(level),
+      m_site(site),
+      m_line(line),
+      m_intervalNs(perSecond > 0 ? qint64(1e9 / perSecond) : 0),
+      m_burstNs(m_intervalNs * qMax(1, burst)) {
+  Logger::instance()->registerLimiter(this);
+}
+
+LogRateLimiter::~LogRateLimiter() { Logger::instance()->unregisterLimiter(this); }
+
+bool LogRateLimiter::allow(quint64* suppressed) {
+  const qint64 now = steadyNowNs();
+  qint64 tat = m_tat.load(std::memory_order_relaxed);
+  for (;;) {
+    // 每条日志把理论到达时间推后一个间隔，超出 burst 个间隔即为令牌耗尽
+    const qint64 next = qMax(tat, now) + m_intervalNs;
+    if (next - now > m_burstNs) {
+      m_suppressed.fetch_add(1, std::memory_order_relaxed);
+      Logger::instance()->noteSuppressed();
+      return false;
+    }
+    if (m_tat.compare_exchange_weak(tat, next, std::memory_order_relaxed)) {
+      break;
+    }
+  }
+  *suppressed = m_suppressed.exchange(0, std::memory_order_relaxed);
+  return true;
+}
+
 // 便捷的静态日志记录方法实现
 void Logger::debug(const QString& message) { instance()->log(kDEBUG, message); }
 
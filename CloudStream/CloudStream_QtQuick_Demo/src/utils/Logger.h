@@ -1,15 +1,20 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <vector>
+#include <QByteArray>
 #include <QDateTime>
 #include <QFile>
 #include <QMutex>
 #include <QObject>
-#include <QTextStream>
 #include <QThread>
 #include <QTimer>
-#include <queue>
 #include <QWaitCondition>
 
+class LogRateLimiter;
+
 /**
  * @brief 日志管理类
  *
@@ -18,7 +23,9 @@
  * - 异步写入日志文件，避免阻塞主线程
  * - 支持日志文件自动轮转（按文件大小）
  * - 批量写入优化，提高I/O性能
- * - 线程安全的日志队列
+ * - 有界队列：调用线程只在锁内放入原始时间戳、线程ID、级别和消息，
+ *   时间格式化、拼接、编码和文件大小统计都在写入线程完成
+ * - 队列满时按 OverflowPolicy 等待或丢弃，热点路径可用 LOGGER_RATE_LIMITED 按调用点限流
  * - 同时输出到控制台和文件
  *
  * 使用方式：
@@ -39,6 +46,26 @@ class Logger : public QObject {
     kERROR     // 错误信息
   };
 
+  /**
+   * @brief 队列满时的处理策略
+   *
+   * 只作用于 DEBUG/INFO；WARNING/ERROR 总是等待空位。
+   */
+  enum OverflowPolicy {
+    kBlock,       // 等待写入线程腾出空位，不丢日志
+    kDropOldest,  // 淘汰队列中最老的一条；最老的是 WARNING/ERROR 时保留它，改为丢弃当前这条
+    kDropNewest   // 丢弃当前这条
+  };
+
+  /**
+   * @brief 丢弃/限流计数（进程启动以来累计）
+   */
+  struct Counters {
+    quint64 dropped = 0;     // 队列满被丢弃的条数
+    quint64 suppressed = 0;  // 被调用点限流抑制的条数
+    quint64 blocked = 0;     // 队列满时等待的次数
+  };
+
   /**
    * @brief 全局初始化日志系统
    *
@@ -63,6 +90,29 @@ class Logger : public QObject {
    */
   void setLogLevel(LogLevel level);
 
+  /**
+   * @brief 该级别的日志是否会被记录
+   */
+  bool isEnabled(LogLevel level) const { return level >= m_logLevel.load(std::memory_order_relaxed); }
+
+  /**
+   * @brief 设置队列满时的处理策略，默认 kDropOldest
+   */
+  void setOverflowPolicy(OverflowPolicy policy);
+
+  Counters counters() const;
+
+  /**
+   * @brief 输出 "N messages suppressed" 汇总，由 LOGGER_RATE_LIMITED 调用
+   * @param site 调用点（__FILE__）
+   */
+  void logSuppressed(LogLevel level, const char* site, int line, quint64 count);
+
+  /**
+   * @brief 记录一条被限流抑制的日志
+   */
+  void noteSuppressed() { m_suppressed.fetch_add(1, std::memory_order_relaxed); }
+
   /**
    * @brief 设置是否写入日志文件
    * @param enable 是否启用文件日志
@@ -89,6 +139,19 @@ class Logger : public QObject {
    */
   void log(LogLevel level, const QString& message);
 
+  /**
+   * @brief 记录 SDK 日志，"[tag] log" 的拼接和 UTF-8 解码推迟到写入线程
+   */
+  void logRaw(LogLevel level, const char* tag, const char* text);
+
+  /**
+   * @brief 日志调用开销基准：threads 个线程各调用 callsPerThread 次
+   *
+   * 使用与日志队列同容量的私有队列并按 kBlock 入队，不占用也不淘汰正在使用的日志队列
+   * @return 平均每次调用的耗时（纳秒），同时写入日志
+   */
+  double benchmark(int threads = 8, int callsPerThread = 100000);
+
   // 便捷的静态日志记录方法
   static void debug(const QString& message);    // 记录调试日志
   static void info(const QString& message);     // 记录信息日志
@@ -132,40 +195,168 @@ class Logger : public QObject {
   void doRotate();
 
   /**
-   * @brief 日志消息结构体
+   * @brief 日志记录：调用线程只填原始数据，格式化在写入线程完成
    */
-  struct LogMsg {
-    LogLevel level;       // 日志级别
-    QString message;      // 日志内容
-    QString timeStr;      // 时间戳字符串
-    QString threadIdStr;  // 线程ID字符串
+  struct LogRecord {
+    qint64 timeMs = 0;        // 毫秒时间戳（UTC）
+    quintptr threadId = 0;    // 线程ID
+    LogLevel level = kDEBUG;  // 日志级别
+    QString message;          // 日志内容
+    QByteArray raw;           // 未解码的 SDK 日志 "tag\0text"，message 为空时使用
   };
 
+  /**
+   * @brief 入队；队列满时按 m_overflowPolicy 等待或丢弃
+   */
+  void enqueue(LogRecord&& record);
+
+  /**
+   * @brief 写入线程：把一条记录格式化为一行
+   */
+  QString formatRecord(const LogRecord& record);
+
+  /**
+   * @brief 写入线程：有新的丢弃时追加一行汇总（最多每秒一次），直接写入缓冲区，不经过队列
+   */
+  void appendDropSummary(QByteArray& buffer);
+
+  /**
+   * @brief 写入线程：输出各调用点尚未汇总的限流抑制条数（最多每秒一次，停止时强制输出）
+   *
+   * 突发结束后不再有放行的调用，抑制条数也会由这里汇总
+   */
+  void appendSuppressedSummaries(QByteArray& buffer, bool force);
+
+  /**
+   * @brief 写入线程：格式化一行并直接追加到缓冲区，不经过队列
+   */
+  void appendDirect(QByteArray& buffer, LogLevel level, const QString& message);
+
+  /**
+   * @brief 写入一批已编码的日志并累计文件大小
+   */
+  void writeBatch(const QByteArray& data);
+
+  friend class LogRateLimiter;
+
+  /**
+   * @brief 登记/注销调用点限流器，供写入线程汇总抑制条数
+   */
+  void registerLimiter(LogRateLimiter* limiter);
+  void unregisterLimiter(LogRateLimiter* limiter);
+
   // 单例实例
   static Logger* m_instance;
 
   // 日志配置
-  LogLevel m_logLevel;       // 当前日志级别
-  bool m_logToFile;          // 是否写入文件
-  QString m_logFilePath;     // 日志文件路径
-  QFile m_logFile;           // 日志文件对象
-  QTextStream m_textStream;  // 文本流对象
+  std::atomic<LogLevel> m_logLevel;  // 当前日志级别
+  bool m_logToFile;                  // 是否写入文件
+  QString m_logFilePath;             // 日志文件路径
+  QFile m_logFile;                   // 日志文件对象
+  QMutex m_fileMutex;                // 保护日志文件（写入线程与 setLogToFile）
+  qint64 m_fileBytes = 0;            // 当前日志文件已写入的字节数，代替每条日志查询文件大小
 
   // 线程安全队列相关
-  QMutex m_queueMutex;             // 队列互斥锁
-  QWaitCondition m_queueNotEmpty;  // 队列非空条件变量
-  std::queue<LogMsg> m_logQueue;   // 日志消息队列
-  bool m_stopThread;               // 停止线程标志
-  QThread* m_logThread;            // 日志写入线程
+  static constexpr size_t QUEUE_CAPACITY = 8192;  // 队列容量（条）
+  QMutex m_queueMutex;                            // 队列互斥锁
+  QWaitCondition m_queueNotEmpty;                 // 队列非空条件变量
+  QWaitCondition m_queueNotFull;                  // 队列有空位条件变量（kBlock 等待）
+  std::deque<LogRecord> m_logQueue;               // 日志记录队列
+  bool m_stopThread;                              // 停止线程标志（受 m_queueMutex 保护）
+  QThread* m_logThread;                           // 日志写入线程
+
+  // 溢出策略与计数
+  std::atomic<OverflowPolicy> m_overflowPolicy{kDropOldest};  // 队列满时的处理策略
+  std::atomic<quint64> m_fullWaits{0};                        // 队列满时等待的次数
+  std::atomic<quint64> m_dropped{0};                          // 队列满被丢弃的条数
+  std::atomic<quint64> m_suppressed{0};                       // 被调用点限流抑制的条数
+  quint64 m_reportedDropped = 0;                              // 写入线程已汇总过的丢弃条数
+  qint64 m_lastDropReportMs = 0;                              // 上次输出丢弃汇总的时间
+  QMutex m_limiterMutex;                                      // 保护 m_limiters
+  std::vector<LogRateLimiter*> m_limiters;                    // 已登记的调用点限流器
+  qint64 m_lastSuppressedReportMs = 0;                        // 上次汇总限流抑制条数的时间
 
   // 批量写入优化相关
-  static constexpr int BATCH_SIZE = 100;         // 批量写入大小
-  static constexpr int FLUSH_INTERVAL_MS = 100;  // 强制刷新间隔（毫秒）
-  qint64 m_lastFlushTime = 0;                    // 上次刷新时间
+  static constexpr int BATCH_SIZE = 256;                // 批量写入大小
+  static constexpr int FLUSH_INTERVAL_MS = 100;         // 强制刷新间隔（毫秒）
+  static constexpr int DROP_REPORT_INTERVAL_MS = 1000;  // 丢弃汇总的最小间隔（毫秒）
+
+  // SDK 日志限流（WARN/ERROR 不限流）
+  static constexpr double SDK_DEBUG_LOGS_PER_SEC = 50;
+  static constexpr double SDK_INFO_LOGS_PER_SEC = 100;
+  static constexpr int SDK_LOG_BURST = 200;
+
+  // 写入线程的时间格式缓存：同一秒内的日志复用 "yyyy-MM-dd hh:mm:ss"
+  qint64 m_cachedSecond = -1;
+  QString m_cachedTimePrefix;
 
   // 日志轮转配置
   qint64 m_maxFileSize = 200 * 1024 * 1024;  // 单个日志文件最大大小（默认200MB）
   int m_maxBackupFiles = 50;                 // 最大备份文件数（默认50个）
   QString m_baseLogFileName;                 // 基础日志文件名（不含序号），格式：YYYYMMDD_HHMMSS_PID.log
   int m_currentFileIndex = 0;                // 当前日志文件序号（0表示无序号）
-};
\ No newline at end of file
+};
+
+/**
+ * @brief 单个调用点的令牌桶限流
+ *
+ * 以 GCRA（理论到达时间）形式实现，状态只有一个原子变量，可在任意线程调用。
+ * 每秒补充 perSecond 个令牌，最多积攒 burst 个；被拒绝的条数累计下来，
+ * 下一次放行时由 LOGGER_RATE_LIMITED 先输出一行 "N messages suppressed"。
+ * 限流器登记在 Logger 中，突发停止后不再有放行的调用时，由写入线程每秒汇总一次。
+ */
+class LogRateLimiter {
+ public:
+  /**
+   * @param level 汇总行的日志级别
+   * @param site 调用点（__FILE__ 或来源名称，需为静态字符串）
+   * @param line 调用点行号，0 表示不输出
+   */
+  LogRateLimiter(Logger::LogLevel level, const char* site, int line, double perSecond, int burst);
+  ~LogRateLimiter();
+
+  LogRateLimiter(const LogRateLimiter&) = delete;
+  LogRateLimiter& operator=(const LogRateLimiter&) = delete;
+
+  /**
+   * @brief 是否放行
+   * @param suppressed 放行时返回上次放行以来被抑制的条数
+   */
+  bool allow(quint64* suppressed);
+
+  /**
+   * @brief 取走尚未汇总的抑制条数，与 allow 之间每条只会被汇总一次
+   */
+  quint64 takeSuppressed() { return m_suppressed.exchange(0, std::memory_order_relaxed); }
+
+  Logger::LogLevel level() const { return m_level; }
+  const char* site() const { return m_site; }
+  int line() const { return m_line; }
+
+ private:
+  Logger::LogLevel m_level;
+  const char* m_site;
+  int m_line;
+  qint64 m_intervalNs;
+  qint64 m_burstNs;
+  std::atomic<qint64> m_tat{0};  ///< 理论到达时间（steady_clock 纳秒）
+  std::atomic<quint64> m_suppressed{0};
+};
+
+/**
+ * @brief 按调用点限流记录日志，message 只在放行时才求值
+ *
+ * 用法：LOGGER_RATE_LIMITED(Logger::kDEBUG, 2, 10, QString("...").arg(x));
+ */
+#define LOGGER_RATE_LIMITED(level, perSecond, burst, message)                                                          \
+  do {                                                                                                                 \
+    static LogRateLimiter loggerRateLimiter_((level), __FILE__, __LINE__, (perSecond), (burst));                       \
+    quint64 loggerSuppressed_ = 0;                                                                                     \
+    Logger* logger_ = Logger::instance();                                                                              \
+    if (logger_->isEnabled(level) && loggerRateLimiter_.allow(&loggerSuppressed_)) {                                   \
+      if (loggerSuppressed_ > 0) {                                                                                     \
+        logger_->logSuppressed((level), __FILE__, __LINE__, loggerSuppressed_);                                        \
+      }                                                                                                                \
+      logger_->log((level), (message));                                                                                \
+    }                                                                                                                  \
+  } while (0)
@@ -0,0 +1,103 @@
+#include "StartupTimeline.h"
+
+#include <algorithm>
+#include <QMutexLocker>
+
+#include "Logger.h"
+
+namespace {
+constexpr int kBarWidth = 40;
+}
+
+StartupTimeline* StartupTimeline::instance() {
+  static StartupTimeline timeline;
+  return &timeline;
+}
+
+StartupTimeline::StartupTimeline() { m_clock.start(); }
+
+void StartupTimeline::begin(const QString& phase) {
+  if (finished()) {
+    return;
+  }
+  Phase p;
+  p.name = phase;
+  p.beginUs = nowUs();
+  QMutexLocker locker(&m_mutex);
+  m_phases.append(p);
+}
+
+void StartupTimeline::end(const QString& phase, const QString& note) {
+  if (finished()) {
+    return;
+  }
+  const qint64 t = nowUs();
+  QMutexLocker locker(&m_mutex);
+  for (auto it = m_phases.rbegin(); it != m_phases.rend(); ++it) {
+    if (it->endUs < 0 && it->name == phase) {
+      it->endUs = t;
+      it->note = note;
+      return;
+    }
+  }
+}
+
+void StartupTimeline::mark(const QString& event, const QString& note) {
+  if (finished()) {
+    return;
+  }
+  Phase p;
+  p.name = event;
+  p.beginUs = p.endUs = nowUs();
+  p.note = note;
+  QMutexLocker locker(&m_mutex);
+  m_phases.append(p);
+}
+
+void StartupTimeline::finish(const QString& event) {
+  if (finished()) {
+    return;
+  }
+  mark(event);
+  bool expected = false;
+  if (!m_finished.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+    return;
+  }
+  report(nowUs());
+}
+
+void StartupTimeline::report(qint64 totalUs) {
+  QMutexLocker locker(&m_mutex);
+  std::stable_sort(m_phases.begin(), m_phases.end(),
+                   [](const Phase& a, const Phase& b) { return a.beginUs < b.beginUs; });
+  Logger::info(QString("[Startup] Time to first frame: %1 ms").arg(totalUs / 1000.0, 0, 'f', 1));
+
+  const double scale = totalUs > 0 ? double(kBarWidth) / totalUs : 0;
+  for (const Phase& p : m_phases) {
+    // 每行一条 [begin, end] 区间的条形图，未结束的阶段画到首帧为止
+    const bool instant = p.endUs == p.beginUs;
+    const qint64 endUs = p.endUs < 0 ? totalUs : p.endUs;
+    const int from = qMin(kBarWidth - 1, int(p.beginUs * scale));
+    const int to = qMax(from + 1, qMin(kBarWidth, int(endUs * scale + 0.5)));
+    QString bar(kBarWidth, QLatin1Char('.'));
+    bar.replace(from, to - from, QString(to - from, QLatin1Char(instant ? '|' : '#')));
+
+    QString line;
+    if (instant) {
+      line = QString("[Startup]   %1 [%2] %3 ms").arg(p.name, -18).arg(bar).arg(p.beginUs / 1000.0, 8, 'f', 1);
+    } else {
+      line = QString("[Startup]   %1 [%2] %3 -> %4 ms (%5)%6")
+                 .arg(p.name, -18)
+                 .arg(bar)
+                 .arg(p.beginUs / 1000.0, 8, 'f', 1)
+                 .arg(endUs / 1000.0, 8, 'f', 1)
+                 .arg((endUs - p.beginUs) / 1000.0, 7, 'f', 1)
+                 .arg(p.endUs < 0 ? " unfinished" : "");
+    }
+    if (!p.note.isEmpty()) {
+      line += " " + p.note;
+    }
+    Logger::info(line);
+  }
+  m_phases.clear();
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief 启动阶段耗时记录
+ *
+ * 启动各阶段可能并行（QML 引擎加载、SDK 预连接 tcr_client_prepare、令牌获取），
+ * 逐个记录开始和结束时间（相对进程启动），首帧显示时按开始时间排序输出一次时间线，
+ * 得到从启动到首帧的分阶段耗时。线程安全，首帧之后的调用只有一次原子读。
+ */
+class StartupTimeline {
+ public:
+  /**
+   * @brief 获取单例，第一次调用时开始计时（应在 main 的开头调用一次）
+   */
+  static StartupTimeline* instance();
+
+  void begin(const QString& phase);
+
+  /**
+   * @brief 结束最近一个同名且未结束的阶段
+   * @param note 附加在输出中，如 "cache hit"、"failed"
+   */
+  void end(const QString& phase, const QString& note = QString());
+
+  /**
+   * @brief 记录瞬时事件
+   */
+  void mark(const QString& event, const QString& note = QString());
+
+  /**
+   * @brief 记录 event 并输出整条时间线，只生效一次
+   */
+  void finish(const QString& event);
+
+  bool finished() const { return m_finished.load(std::memory_order_acquire); }
+
+ private:
+  struct Phase {
+    QString name;
+    qint64 beginUs = 0;
+    qint64 endUs = -1;  ///< < 0 表示未结束；瞬时事件与 beginUs 相同
+    QString note;
+  };
+
+  StartupTimeline();
+  qint64 nowUs() const { return m_clock.nsecsElapsed() / 1000; }
+  void report(qint64 totalUs);
+
+  QElapsedTimer m_clock;
+  QMutex m_mutex;
+  QVector<Phase> m_phases;
+  std::atomic<bool> m_finished{false};
+};
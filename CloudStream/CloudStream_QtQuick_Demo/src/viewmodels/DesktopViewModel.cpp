@@ -9,7 +9,10 @@
 #include <QVariant>
 
 #include "core/input/InputCaptureItem.h"
+#include "core/ProbeManager.h"
+#include "core/StartupPipeline.h"
 #include "core/StreamConfig.h"
+#include "core/TokenCache.h"
 #include "tcr_c_api.h"
 #include "tcr_types.h"
 #include "utils/Logger.h"
@@ -124,23 +127,18 @@ void DesktopViewModel::initialize(const QStringList& instanceIds, const QString&
   Logger::info(QString("[initialize] Instance IDs: %1").arg(instanceIds.join(", ")));
   Logger::info(QString("[initialize] Access Info: %1").arg(accessInfo));
 
-  // 配置 TcrSdk 初始化参数（与 MultiStreamViewModel::initialize 等价）
-  std::string tokenStr = token.toStdString();
-  std::string accessInfoStr = accessInfo.toStdString();
-
-  TcrConfig config = tcr_config_default();
-  config.token = tokenStr.c_str();
-  config.accessInfo = accessInfoStr.c_str();
-
-  // 获取 TcrClient 全局单例并初始化
-  TcrClientHandle client = tcr_client_get_instance();
-  TcrErrorCode result = tcr_client_init(client, &config);
+  // 初始化 TcrClient 全局单例（与 MultiStreamViewModel::initialize 等价）
+  TcrErrorCode result = StartupPipeline::initSdk(accessInfo, token);
   if (result != TCR_SUCCESS) {
     Logger::error(QString("[initialize] TcrSdk 初始化失败, code=%1").arg(result));
+    TokenCache().remove();
     return;
   }
 
   Logger::info("[initialize] TcrSdk 初始化成功");
+
+  // 探测需要已初始化的客户端；提前初始化时已经开始，重复调用无副作用
+  ProbeManager::instance()->start();
 }
 
 // ==================== 会话管理 ====================
@@ -204,6 +202,11 @@ void DesktopViewModel::createAndInitSession() {
   config.stream_profile.max_bitrate = streamConfig->mainStreamMaxBitrate();
   config.stream_profile.min_bitrate = streamConfig->mainStreamMinBitrate();
 
+  QByteArray preferredDomain = ProbeManager::instance()->preferredDomain();
+  if (!preferredDomain.isEmpty()) {
+    config.preferred_domain = preferredDomain.constData();
+  }
+
   Logger::info(QString("[createAndInitSession] 大流参数 - 宽:%1, 帧率:%2, 码率:%3-%4")
                    .arg(config.stream_profile.video_width)
                    .arg(config.stream_profile.fps)
@@ -264,8 +267,12 @@ void DesktopViewModel::sendJson(const QJsonObject& payload) {
   TcrErrorCode code =
       tcr_data_channel_send(m_dataChannel, reinterpret_cast<const uint8_t*>(data.constData()), data.size());
 
-  // 同时打印，便于调试
-  Logger::info(QString("[DesktopInput] → %1 (code=%2)").arg(QString::fromUtf8(data)).arg(code));
+  // 每个键鼠事件都会走到这里：发送失败单独告警，成功只按调用点限流打印调试日志
+  if (code != TCR_SUCCESS) {
+    Logger::warning(QString("[DesktopInput] 发送失败 %1 (code=%2)").arg(QString::fromUtf8(data)).arg(code));
+    return;
+  }
+  LOGGER_RATE_LIMITED(Logger::kDEBUG, 5, 20, QString("[DesktopInput] → %1").arg(QString::fromUtf8(data)));
 }
 
 // ==================== 输入事件槽（来自 InputCaptureItem） ====================
@@ -2,7 +2,23 @@
 
 #include <QStringList>
 
+#include "core/AppConfig.h"
+#include "core/StartupPipeline.h"
 #include "utils/Logger.h"
+#include "utils/StartupTimeline.h"
+
+namespace {
+
+/// 按逗号分割并去除空白字符
+QStringList parseInstanceIds(const QString& instanceIds) {
+  QStringList idList = instanceIds.split(",", Qt::SkipEmptyParts);
+  for (int i = 0; i < idList.size(); ++i) {
+    idList[i] = idList[i].trimmed();
+  }
+  return idList;
+}
+
+}  // namespace
 
 // ============================================================================
 // 构造函数
@@ -38,20 +54,84 @@ void InstanceTokenViewModel::createAccessToken(const QString& instanceIds, const
     return;
   }
 
+  // 解析实例ID列表
+  QStringList idList = parseInstanceIds(instanceIds);
+  const QString ip = userIp.trimmed();
+  const QString key = TokenCache::requestKey(idList, ip);
+
+  Logger::info(QString("Parsed %1 instance IDs").arg(idList.size()));
+  StartupTimeline::instance()->mark("connect_requested");
+
+  // 预取到的或缓存中未过期的令牌直接使用
+  TokenCache::Entry entry;
+  bool ready = false;
+  if (m_prefetchedKey == key &&
+      QDateTime::currentDateTimeUtc().secsTo(m_prefetched.expiresAt) > TokenCache::kExpiryMarginSec) {
+    entry = m_prefetched;
+    ready = true;
+  } else if (AppConfig::instance()->tokenCacheEnabled()) {
+    ready = m_cache.load(key, &entry);
+  }
+  m_prefetchedKey.clear();
+  if (ready) {
+    Logger::info(QString("Reusing access token, expires at %1").arg(entry.expiresAt.toString(Qt::ISODate)));
+    emit accessTokenCreated(entry.accessInfo, entry.token);
+    return;
+  }
+
   // 设置忙碌状态
   m_isBusy = true;
   emit isBusyChanged();
+  m_waitingKey = key;
 
-  // 解析实例ID列表：按逗号分割并去除空白字符
-  QStringList idList = instanceIds.split(",", Qt::SkipEmptyParts);
-  for (int i = 0; i < idList.size(); ++i) {
-    idList[i] = idList[i].trimmed();
+  if (m_inflightKey == key) {
+    Logger::info("Waiting for the prefetched access token");
+    return;
+  }
+  if (!m_inflightKey.isEmpty()) {
+    // 在途的预取是另一组实例，结束后再发送
+    m_waitingIds = idList;
+    m_waitingUserIp = ip;
+    return;
   }
+  sendRequest(idList, ip);
+}
 
-  Logger::info(QString("Parsed %1 instance IDs").arg(idList.size()));
+void InstanceTokenViewModel::prefetchAccessToken() {
+  AppConfig* config = AppConfig::instance();
+  QStringList idList = parseInstanceIds(config->instanceIds());
+  // 有效期未知时无法判断预取结果何时失效，不预取
+  if (idList.isEmpty() || config->tokenTtlHours() <= 0 || !m_inflightKey.isEmpty()) {
+    return;
+  }
+
+  TokenCache::Entry entry;
+  if (config->tokenCacheEnabled() && m_cache.load(TokenCache::requestKey(idList, QString()), &entry)) {
+    Logger::info(QString("Cached access token valid until %1").arg(entry.expiresAt.toString(Qt::ISODate)));
+    StartupTimeline::instance()->mark("token", "cache hit");
+    StartupPipeline::initSdkAsync(entry.accessInfo, entry.token);
+    return;
+  }
+
+  Logger::info(QString("Prefetching access token for %1 configured instances").arg(idList.size()));
+  sendRequest(idList, QString());
+}
+
+void InstanceTokenViewModel::sendRequest(const QStringList& instanceIds, const QString& userIp) {
+  m_inflightKey = TokenCache::requestKey(instanceIds, userIp);
+  m_inflightSentAt = QDateTime::currentDateTimeUtc();
+  StartupTimeline::instance()->begin("token_fetch");
 
   // 调用ApiService创建访问令牌
-  m_apiService->createAndroidInstancesAccessToken(idList, userIp.trimmed());
+  m_apiService->createAndroidInstancesAccessToken(instanceIds, userIp);
+}
+
+void InstanceTokenViewModel::setIdle() {
+  m_isBusy = false;
+  m_waitingKey.clear();
+  m_waitingIds.clear();
+  m_waitingUserIp.clear();
+  emit isBusyChanged();
 }
 
 // ============================================================================
@@ -60,10 +140,35 @@ void InstanceTokenViewModel::createAccessToken(const QString& instanceIds, const
 
 void InstanceTokenViewModel::onAccessTokenCreated(const QString& accessInfo, const QString& token) {
   Logger::info("Access token created successfully");
+  StartupTimeline::instance()->end("token_fetch");
+  const QString key = m_inflightKey;
+  m_inflightKey.clear();
+
+  // 写入缓存，有效期从发出请求时算起
+  const int ttlHours = AppConfig::instance()->tokenTtlHours();
+  if (ttlHours > 0) {
+    TokenCache::Entry entry{accessInfo, token, m_inflightSentAt.addSecs(qint64(ttlHours) * 3600)};
+    if (AppConfig::instance()->tokenCacheEnabled()) {
+      m_cache.store(key, entry);
+    }
+    if (!m_isBusy || m_waitingKey != key) {
+      m_prefetchedKey = key;
+      m_prefetched = entry;
+    }
+  }
+
+  // 预取完成，等待用户确认；期间提前初始化 SDK 并开始节点探测
+  if (!m_isBusy) {
+    StartupPipeline::initSdkAsync(accessInfo, token);
+    return;
+  }
+  if (m_waitingKey != key) {
+    sendRequest(m_waitingIds, m_waitingUserIp);
+    return;
+  }
 
   // 重置忙碌状态
-  m_isBusy = false;
-  emit isBusyChanged();
+  setIdle();
 
   // 向UI层发送成功信号
   emit accessTokenCreated(accessInfo, token);
@@ -71,10 +176,22 @@ void InstanceTokenViewModel::onAccessTokenCreated(const QString& accessInfo, con
 
 void InstanceTokenViewModel::onApiError(const QString& errorCode, const QString& message) {
   Logger::error(QString("API error occurred - Code: %1, Message: %2").arg(errorCode, message));
+  StartupTimeline::instance()->end("token_fetch", "failed");
+  const QString key = m_inflightKey;
+  m_inflightKey.clear();
+
+  // 预取失败只记日志，用户确认时重新请求
+  if (!m_isBusy) {
+    Logger::warning("Access token prefetch failed");
+    return;
+  }
+  if (m_waitingKey != key) {
+    sendRequest(m_waitingIds, m_waitingUserIp);
+    return;
+  }
 
   // 重置忙碌状态
-  m_isBusy = false;
-  emit isBusyChanged();
+  setIdle();
 
   // 向UI层发送错误信号（格式化错误信息）
   emit errorOccurred(QString("错误 %1: %2").arg(errorCode, message));
@@ -1,8 +1,10 @@
 #pragma once
 
+#include <QDateTime>
 #include <QObject>
 #include <QStringList>
 
+#include "../core/TokenCache.h"
 #include "../services/ApiService.h"
 
 /**
@@ -17,6 +19,10 @@
  * - 接收用户输入的实例ID列表和用户IP
  * - 调用ApiService创建访问令牌
  * - 向UI层发送结果通知（成功/失败）
+ *
+ * 令牌复用：启动时按配置中的实例预取令牌（与 QML 加载、SDK 预连接并行），
+ * 成功后写入 TokenCache；用户确认时预取结果或未过期的缓存直接使用，不再等待请求往返。
+ * 同一时刻只有一个请求在途，结果按请求标识（TokenCache::requestKey）归属。
  */
 class InstanceTokenViewModel : public QObject {
   Q_OBJECT
@@ -45,6 +51,14 @@ class InstanceTokenViewModel : public QObject {
    */
   Q_INVOKABLE void createAccessToken(const QString& instanceIds, const QString& userIp);
 
+  /**
+   * @brief 按配置中的实例ID预取访问令牌
+   *
+   * 缓存命中时不发请求；否则在后台请求，结果留给随后的 createAccessToken 使用。
+   * 预取失败只记日志，用户确认时会重新请求。
+   */
+  void prefetchAccessToken();
+
   /**
    * @brief 获取忙碌状态
    * @return true表示正在处理请求，false表示空闲
@@ -94,6 +108,25 @@ class InstanceTokenViewModel : public QObject {
   void onApiError(const QString& errorCode, const QString& message);
 
  private:
+  /**
+   * @brief 发送令牌请求并记录其标识
+   */
+  void sendRequest(const QStringList& instanceIds, const QString& userIp);
+
+  /**
+   * @brief 结束等待状态
+   */
+  void setIdle();
+
   ApiService* m_apiService;  ///< API服务实例（不拥有所有权）
   bool m_isBusy = false;     ///< 请求处理状态标志
+
+  TokenCache m_cache;              ///< 落盘的令牌缓存
+  QString m_inflightKey;           ///< 在途请求的标识，为空表示没有在途请求
+  QDateTime m_inflightSentAt;      ///< 在途请求的发送时间，令牌有效期从此算起
+  QString m_waitingKey;            ///< 用户正在等待的请求标识（m_isBusy 时有效）
+  QStringList m_waitingIds;        ///< 用户的请求与在途的预取不同时，预取结束后再发送
+  QString m_waitingUserIp;         ///< 同上
+  QString m_prefetchedKey;         ///< 预取结果的请求标识，使用一次后清空
+  TokenCache::Entry m_prefetched;  ///< 预取结果（关闭缓存时也可用）
 };
\ No newline at end of file
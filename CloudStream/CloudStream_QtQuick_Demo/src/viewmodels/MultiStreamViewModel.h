@@ -1,6 +1,7 @@
 #pragma once
 
 #include <atomic>
+#include <QElapsedTimer>
 #include <QHash>
 #include <QJsonDocument>
 #include <QJsonObject>
@@ -8,12 +9,17 @@
 #include <QMutexLocker>
 #include <QObject>
 #include <QPointer>
+#include <QSet>
 #include <QStringList>
 #include <QTimer>
 #include <QVariantList>
 
+#include "core/ConcurrencyController.h"
+#include "core/InstanceRegistry.h"
 #include "core/StreamConfig.h"
+#include "core/TileProfileLadder.h"
 #include "core/video/Frame.h"
+#include "core/video/FrameFreezeCache.h"
 #include "core/video/VideoRenderItem.h"
 #include "tcr_c_api.h"
 
@@ -51,6 +57,8 @@ class MultiStreamViewModel : public QObject {
   Q_PROPERTY(QStringList connectedInstanceIds READ connectedInstanceIds NOTIFY connectedInstanceIdsChanged)
   Q_PROPERTY(QString clientStats READ clientStats NOTIFY clientStatsChanged)
   Q_PROPERTY(QString requestId READ requestId NOTIFY requestIdChanged)
+  Q_PROPERTY(int streamingLimit READ streamingLimit NOTIFY streamingLimitChanged)
+  Q_PROPERTY(int backgroundTileFps READ backgroundTileFps WRITE setBackgroundTileFps NOTIFY backgroundTileFpsChanged)
 
  public:
   explicit MultiStreamViewModel(QObject* parent = nullptr);
@@ -75,6 +83,22 @@ class MultiStreamViewModel : public QObject {
    */
   QString requestId() const { return m_requestId; }
 
+  /**
+   * @brief 获取当前允许同时拉流的实例数
+   * @return 由 ConcurrencyController 根据客户端统计和 CPU 占用率动态调整，
+   *         不超过创建会话时的 concurrentStreamingInstances
+   */
+  int streamingLimit() const { return m_concurrencyController->limit(); }
+
+  /**
+   * @brief 获取/设置非悬停、非选中宫格的渲染帧率
+   *
+   * 悬停和选中的宫格每帧都上传，其余宫格按该帧率上传，中间的帧直接释放，不做转换和上传；
+   * 设置为 0 表示不抽帧
+   */
+  int backgroundTileFps() const { return m_backgroundTileFps; }
+  void setBackgroundTileFps(int fps);
+
   /**
    * @brief 根据实例ID获取该实例的统计数据（JSON 格式）
    * @param instanceId 实例ID
@@ -107,6 +131,27 @@ class MultiStreamViewModel : public QObject {
    */
   void copyToClipboard(const QString& text);
 
+  /**
+   * @brief 上报宫格单元格尺寸（从QML调用）
+   * @param tileWidth 单元格视频区域宽度（逻辑像素）
+   * @param tileHeight 单元格视频区域高度（逻辑像素）
+   * @param devicePixelRatio 屏幕缩放比
+   *
+   * 说明：尺寸稳定 1 秒后按物理像素短边选择档位，
+   *       档位变化时通过 tcr_session_set_remote_video_profile 重新协商子码流分辨率和帧率
+   */
+  void updateTileSize(qreal tileWidth, qreal tileHeight, qreal devicePixelRatio);
+
+  /**
+   * @brief 设置鼠标悬停的实例（从QML调用），空字符串表示无悬停
+   */
+  void setHoveredInstance(const QString& instanceId);
+
+  /**
+   * @brief 设置选中的实例列表（从QML调用）
+   */
+  void setSelectedInstances(const QStringList& instanceIds);
+
  public:
   /**
    * @brief 注册 VideoRenderItem 到指定实例
@@ -195,6 +240,13 @@ class MultiStreamViewModel : public QObject {
    */
   void requestIdChanged();
 
+  /**
+   * @brief 并发拉流数变化信号
+   */
+  void streamingLimitChanged();
+
+  void backgroundTileFpsChanged();
+
  private:
   // ==================== 内部数据结构 ====================
 
@@ -215,17 +267,23 @@ class MultiStreamViewModel : public QObject {
   QStringList m_allInstanceIds;            ///< 所有管理的实例ID列表
   QStringList m_connectedInstanceIds;      ///< 已连接的实例ID列表
   QStringList m_currentStreamingIds;       ///< 当前正在拉流的实例ID列表
+  QStringList m_visibleIds;                ///< 当前可见的实例ID列表（按显示顺序）
   QString m_clientStats;                   ///< 客户端统计数据（JSON 格式）
   QString m_requestId;                     ///< 会话的 RequestId（连接成功后获取）
   int m_concurrentStreamingInstances = 0;  ///< 并发拉流实例数
   bool m_isConnected = false;              ///< 会话连接状态
 
-  /// 实例连接状态映射：instanceId -> InstanceConnectionState
-  QHash<QString, InstanceConnectionState> m_instanceConnectionStates;
+  /// 实例ID驻留表：逐帧/逐事件路径只使用句柄，下面按句柄索引的 QVector 长度不超过 m_registry.size()
+  InstanceRegistry m_registry;
+  QVector<InstanceHandle> m_sessionHandles;  ///< 与 m_allInstanceIds 一一对应的句柄
+  QVector<bool> m_sessionMembers;            ///< 句柄 -> 是否属于当前会话（仅在没有回调时修改）
 
-  /// 视频渲染项映射：instanceId -> VideoRenderItem
+  /// 实例连接状态：句柄 -> InstanceConnectionState
+  QVector<InstanceConnectionState> m_instanceConnectionStates;
+
+  /// 视频渲染项：句柄 -> VideoRenderItem
   /// 使用 QPointer 防止访问已销毁的对象
-  QHash<QString, QPointer<VideoRenderItem>> m_videoRenderItems;
+  QVector<QPointer<VideoRenderItem>> m_videoRenderItems;
 
   // 观察者结构体（必须在整个会话生命周期内保持有效）
   TcrSessionObserver m_sessionObserver = {};        ///< 会话事件观察者
@@ -233,10 +291,42 @@ class MultiStreamViewModel : public QObject {
   SessionUserData* m_userData = nullptr;            ///< 用户数据，传递给回调函数（堆分配）
 
   // 帧缓存优化相关
-  QMap<QString, VideoFrameDataPtr> m_frameCache;  // instanceId -> 最新帧
-  QMutex m_frameCacheMutex;                       // 保护帧缓存的互斥锁
+  QVector<VideoFrameDataPtr> m_frameCache;      // 句柄 -> 最新帧
+  QVector<InstanceHandle> m_frameCacheHandles;  // m_frameCache 中有帧的句柄
+  QMutex m_frameCacheMutex;                     // 保护帧缓存的互斥锁
   QTimer* m_renderTimer = nullptr;                // 定时刷新定时器
 
+  // 客户端抽帧：悬停/选中的宫格每帧上传，其余宫格按 m_backgroundTileFps 上传
+  int m_backgroundTileFps = 5;
+  InstanceHandle m_hoveredHandle = kInvalidInstanceHandle;
+  QVector<bool> m_selected;                     // 句柄 -> 是否选中
+  QVector<VideoFrameDataPtr> m_deferredFrames;  // 句柄 -> 尚未上传的最新帧（仅主线程访问）
+  QVector<InstanceHandle> m_deferredHandles;    // m_deferredFrames 中有帧的句柄
+  QVector<qint64> m_lastUploadMs;               // 句柄 -> 上次上传时间，-1 表示尚未上传
+  QElapsedTimer m_renderClock;
+
+  // 上传统计：每 5 秒输出一次抽帧前后的上传字节数
+  qint64 m_offeredBytes = 0;   // 不抽帧时需要上传的字节数
+  qint64 m_uploadedBytes = 0;  // 实际上传的字节数
+  int m_offeredFrames = 0;
+  int m_uploadedFrames = 0;
+  qint64 m_uploadStatsStartMs = 0;
+
+  // 帧回调中实例查找（句柄查找 + 会话/渲染项检查）的耗时统计，随上传统计一起输出
+  std::atomic<qint64> m_frameLookupNs{0};
+  std::atomic<int> m_frameLookupCount{0};
+
+  // 冻结帧：实例切出拉流集合时保存缩小压缩后的最后一帧，宫格重建后先显示冻结帧
+  QVector<VideoFrameDataPtr> m_lastFrames;  // 句柄 -> 正在拉流实例最近上传的一帧（仅主线程访问）
+  FrameFreezeCache m_frameFreezeCache;
+
+  ConcurrencyController* m_concurrencyController = nullptr;  ///< 自适应并发拉流控制器
+
+  // 子码流档位协商
+  TileProfileLadder m_tileProfileLadder;    ///< 子码流档位表
+  qreal m_tilePixelShortEdge = 0;           ///< 单元格视频区域物理像素短边
+  QTimer* m_tileProfileTimer = nullptr;     ///< 单元格尺寸稳定后再协商的防抖定时器
+
   // 线程安全保护
   std::atomic<bool> m_isDestroying{false};  // 析构标志，用于快速检测
   QMutex m_videoRenderItemsMutex;           // 保护 m_videoRenderItems 的互斥锁
@@ -261,6 +351,27 @@ class MultiStreamViewModel : public QObject {
    */
   void switchStreamingInstances(const QStringList& streamingIds);
 
+  /**
+   * @brief 按当前并发数截取可见实例并切换拉流
+   *
+   * 可见实例超过 streamingLimit 时只拉取前 streamingLimit 个
+   */
+  void applyVisibleStreaming();
+
+  /**
+   * @brief 按当前单元格尺寸选择子码流档位，档位变化时重新协商
+   *
+   * TcrSdk API 调用：
+   * - tcr_session_set_remote_video_profile()：对所有实例设置短边分辨率、帧率和码率
+   */
+  void applyTileProfile();
+
+  /**
+   * @brief 将已停止拉流实例的最后一帧交给冻结帧缓存
+   * @param handles 停止拉流的实例句柄列表
+   */
+  void freezeLastFrames(const QVector<InstanceHandle>& handles);
+
   // 批量渲染缓存的帧
   void batchRenderFrames();
 
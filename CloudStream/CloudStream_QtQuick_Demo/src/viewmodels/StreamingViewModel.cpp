@@ -7,6 +7,7 @@
 #include <QMetaType>
 #include <QVariant>
 
+#include "core/ProbeManager.h"
 #include "core/StreamConfig.h"
 #include "tcr_c_api.h"
 #include "tcr_types.h"
@@ -199,6 +200,12 @@ void StreamingViewModel::createAndInitSession() {
   config.stream_profile.max_bitrate = streamConfig->mainStreamMaxBitrate();  // 最大码率
   config.stream_profile.min_bitrate = streamConfig->mainStreamMinBitrate();  // 最小码率
   config.enable_passive_probe = true;
+
+  // 使用主动探测排名第一的节点，省去会话建立后的选点
+  QByteArray preferredDomain = ProbeManager::instance()->preferredDomain();
+  if (!preferredDomain.isEmpty()) {
+    config.preferred_domain = preferredDomain.constData();
+  }
   Logger::info(QString("[createAndInitSession] 使用大流串流参数 - 宽度:%1, 帧率:%2, 码率:%3-%4")
                    .arg(config.stream_profile.video_width)
                    .arg(config.stream_profile.fps)
@@ -0,0 +1,21 @@
+/**
+ * @file logger_stub.cpp
+ * @brief 测试用的 Logger 静态接口，直接写 stderr
+ *
+ * Logger.cpp 在初始化时注册 TcrSdk 日志回调，测试不链接 SDK，也不需要后台写入线程。
+ */
+
+#include <cstdio>
+
+#include "utils/Logger.h"
+
+namespace {
+void print(const char* level, const QString& message) {
+  std::fprintf(stderr, "[%s] %s\n", level, message.toLocal8Bit().constData());
+}
+}  // namespace
+
+void Logger::debug(const QString& message) { print("DEBUG", message); }
+void Logger::info(const QString& message) { print("INFO", message); }
+void Logger::warning(const QString& message) { print("WARNING", message); }
+void Logger::error(const QString& message) { print("ERROR", message); }
@@ -0,0 +1,215 @@
+/**
+ * @file probe_manager_test.cpp
+ * @brief 用假数据源驱动独立的 ProbeManager 实例
+ *
+ * 覆盖排名、完整结果落盘、下次启动从落盘排名热启动、缓存有效期、部分结果不覆盖缓存、启动失败后重试。
+ * 只依赖 Qt Core，不需要 TcrSdk 和网络；失败时输出检查位置并返回非零。
+ */
+
+#include <cstdio>
+#include <memory>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+
+#include "core/ProbeManager.h"
+
+namespace {
+
+int g_failures = 0;
+
+#define CHECK(cond)                                                                  \
+  do {                                                                               \
+    if (!(cond)) {                                                                   \
+      std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+      g_failures++;                                                                  \
+    }                                                                                \
+  } while (0)
+
+/**
+ * @brief 由测试决定何时推送结果；前 failStarts 次 start() 返回 false，模拟 SDK 未就绪
+ */
+class FakeProbeSource : public ProbeSource {
+ public:
+  bool start(ResultCallback callback) override {
+    ++startCalls;
+    if (failStarts > 0) {
+      --failStarts;
+      return false;
+    }
+    m_callback = std::move(callback);
+    return true;
+  }
+
+  void stop() override { m_callback = nullptr; }
+
+  bool running() const { return static_cast<bool>(m_callback); }
+
+  /// 推送一次结果并处理 ProbeManager 投递到 GUI 线程的事件
+  void push(const QVector<ProbeNode>& nodes, bool ready) {
+    if (m_callback) {
+      m_callback(nodes, ready);
+    }
+    QCoreApplication::processEvents();
+  }
+
+  int failStarts = 0;
+  int startCalls = 0;
+
+ private:
+  ResultCallback m_callback;
+};
+
+ProbeNode node(const QString& zone, double score) {
+  ProbeNode n;
+  n.zone = zone;
+  n.domain = zone + ".example.com";
+  n.qualityScore = score;
+  n.rttMs = 100 - score;
+  return n;
+}
+
+/// 按 ProbeManager 的落盘格式写一份 ageSec 秒前的排名
+void writeCache(const QString& path, qint64 ageSec, const QVector<ProbeNode>& nodes) {
+  QJsonArray array;
+  for (const ProbeNode& n : nodes) {
+    QJsonObject obj;
+    obj["zone"] = n.zone;
+    obj["domain"] = n.domain;
+    obj["qualityScore"] = n.qualityScore;
+    obj["rttMs"] = n.rttMs;
+    array.append(obj);
+  }
+  QJsonObject root;
+  root["measuredAt"] = QDateTime::currentDateTimeUtc().addSecs(-ageSec).toSecsSinceEpoch();
+  root["nodes"] = array;
+  QFile file(path);
+  if (file.open(QIODevice::WriteOnly)) {
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+  }
+}
+
+void testRankAndSave(const QString& path) {
+  auto* source = new FakeProbeSource();
+  ProbeManager manager(std::unique_ptr<ProbeSource>(source), 30, path);
+  CHECK(manager.best() == nullptr);
+  CHECK(manager.preferredDomain().isEmpty());
+
+  CHECK(manager.start());
+  CHECK(manager.isRunning() && source->running());
+
+  // 部分结果：立即可用，但不落盘
+  source->push({node("sh", 50), node("gz", 90), node("bj", 70)}, false);
+  CHECK(manager.best() && manager.best()->zone == "gz");
+  CHECK(manager.nodeList().size() == 3);
+  CHECK(manager.nodeList().at(1).toMap()["zone"].toString() == "bj");
+  CHECK(!QFile::exists(path));
+
+  source->push({node("sh", 50), node("gz", 90), node("bj", 95)}, true);
+  CHECK(manager.best() && manager.best()->zone == "bj");
+  CHECK(manager.preferredDomain() == "bj.example.com");
+  CHECK(!manager.bestNode()["fromCache"].toBool());
+  CHECK(QFile::exists(path));
+
+  // 停止后到达的结果被忽略
+  manager.stop();
+  CHECK(!manager.isRunning() && !source->running());
+  source->push({node("cd", 99)}, true);
+  CHECK(manager.best() && manager.best()->zone == "bj");
+}
+
+void testWarmStartFromCache(const QString& path) {
+  auto* source = new FakeProbeSource();
+  ProbeManager manager(std::unique_ptr<ProbeSource>(source), 30, path);
+  // testRankAndSave 落盘的排名，探测开始前即可使用
+  CHECK(manager.best() && manager.best()->zone == "bj");
+  CHECK(manager.nodeList().size() == 3);
+  CHECK(manager.bestNode()["fromCache"].toBool());
+
+  // 部分结果不覆盖缓存中的完整排名，完整结果到达后才替换
+  CHECK(manager.start());
+  source->push({node("cd", 99)}, false);
+  CHECK(manager.best() && manager.best()->zone == "bj");
+  CHECK(manager.bestNode()["fromCache"].toBool());
+
+  source->push({node("cd", 99), node("bj", 95)}, true);
+  CHECK(manager.best() && manager.best()->zone == "cd");
+  CHECK(!manager.bestNode()["fromCache"].toBool());
+}
+
+void testCacheTtl(const QString& dir) {
+  const QString path = dir + "/ttl_cache.json";
+
+  writeCache(path, 2 * 3600, {node("sh", 80)});
+  {
+    ProbeManager manager(std::make_unique<FakeProbeSource>(), 30, path);
+    CHECK(manager.best() == nullptr);
+  }
+
+  writeCache(path, 60, {node("sh", 80)});
+  {
+    ProbeManager manager(std::make_unique<FakeProbeSource>(), 30, path);
+    CHECK(manager.best() && manager.best()->zone == "sh");
+    CHECK(manager.bestNode()["ageSec"].toLongLong() >= 60);
+  }
+
+  // 有效期 <= 0 时既不读取也不落盘
+  {
+    ProbeManager manager(std::make_unique<FakeProbeSource>(), 0, path);
+    CHECK(manager.best() == nullptr);
+  }
+  const QString disabledPath = dir + "/disabled_cache.json";
+  {
+    auto* source = new FakeProbeSource();
+    ProbeManager manager(std::unique_ptr<ProbeSource>(source), 0, disabledPath);
+    CHECK(manager.start());
+    source->push({node("sh", 80)}, true);
+    CHECK(manager.best() && manager.best()->zone == "sh");
+  }
+  CHECK(!QFile::exists(disabledPath));
+}
+
+void testStartRetry(const QString& dir) {
+  auto* source = new FakeProbeSource();
+  source->failStarts = 1;
+  ProbeManager manager(std::unique_ptr<ProbeSource>(source), 30, dir + "/retry_cache.json");
+
+  // 数据源暂时无法开始（SDK 未初始化）：start() 返回 false，之后可以重试
+  CHECK(!manager.start());
+  CHECK(!manager.isRunning());
+  CHECK(manager.start());
+  CHECK(manager.isRunning());
+  CHECK(manager.start());
+  CHECK(source->startCalls == 2);
+
+  source->push({node("sh", 80)}, true);
+  CHECK(manager.best() && manager.best()->zone == "sh");
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  QCoreApplication app(argc, argv);
+  QTemporaryDir dir;
+  if (!dir.isValid()) {
+    std::fprintf(stderr, "cannot create temporary directory\n");
+    return 1;
+  }
+  const QString cachePath = dir.filePath("probe_cache.json");
+
+  testRankAndSave(cachePath);
+  testWarmStartFromCache(cachePath);
+  testCacheTtl(dir.path());
+  testStartRetry(dir.path());
+
+  if (g_failures) {
+    std::fprintf(stderr, "%d check(s) failed\n", g_failures);
+    return 1;
+  }
+  std::printf("probe_manager_test: all checks passed\n");
+  return 0;
+}